@@ -9,6 +9,7 @@
 #include <inttypes.h>
 #include <algorithm>
 #include <fstream>
+#include <thread>
 #include <unordered_map>
 
 #include "Eval.h"
@@ -19,6 +20,8 @@
 using namespace std;
 using namespace Microsoft::MSR::CNTK;
 
+void SharedModelThroughput(size_t maxThreads);
+
 // Used for retrieving the model appropriate for the element type (float / double)
 template<typename ElemType>
 using GetEvalProc = void(*)(IEvaluateModelExtended<ElemType>**);
@@ -189,8 +192,15 @@ IEvaluateModelExtended<float>* SetupNetworkAndGetLayouts(std::string modelDefini
 /// first run the example in <CNTK>/Examples/LanguageUnderstanding/ATIS/BrainScript. Once the model file ATIS.slot.lstm is created,
 /// you can run this client.
 /// This program demonstrates the usage of the Evaluate method requiring the input and output layers as parameters.
+/// Run with --sharedModelThroughput to measure the throughput of concurrent evaluation instead (see EvalSharedModel.cpp).
 int main(int argc, char* argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--sharedModelThroughput")
+    {
+        SharedModelThroughput(std::max(1u, std::thread::hardware_concurrency()));
+        return 0;
+    }
+
     // Get the binary path (current working directory)
     argc = 0;
     std::string app = argv[0];
@@ -0,0 +1,95 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalSharedModel.cpp : Sample application shows how to evaluate one model from multiple threads with shared parameters,
+// and measures how the throughput scales with the number of threads.
+//
+
+#include <inttypes.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Eval.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+/// <summary>
+/// Evaluates a fully connected network from 1, 2, 4, ... threads, up to maxThreads.
+/// </summary>
+/// <description>
+/// The model is loaded once through IEvaluateModelShared. Every thread gets its own light-weight evaluator from
+/// CreateEvaluator(), which shares the parameters and only owns its activations. Each evaluator uses one BLAS thread,
+/// so with enough cores the throughput should grow about linearly with the number of threads.
+/// </description>
+void SharedModelThroughput(size_t maxThreads)
+{
+    const size_t inputDim = 512;
+    const size_t hiddenDim = 1024;
+    const size_t outputDim = 512;
+    const size_t framesPerRequest = 16;
+    const size_t requestsPerThread = 200;
+
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "numCPUThreads = 1 \n"
+        "traceLevel = 0 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "features = Input(" + std::to_string(inputDim) + ") \n"
+        "W1 = Parameter(" + std::to_string(hiddenDim) + ", " + std::to_string(inputDim) + ", init=\"uniform\") \n"
+        "W2 = Parameter(" + std::to_string(hiddenDim) + ", " + std::to_string(hiddenDim) + ", init=\"uniform\") \n"
+        "W3 = Parameter(" + std::to_string(outputDim) + ", " + std::to_string(hiddenDim) + ", init=\"uniform\") \n"
+        "h1 = Sigmoid(Times(W1, features)) \n"
+        "h2 = Sigmoid(Times(W2, h1)) \n"
+        "out = Times(W3, h2, tag=\"output\") \n"
+        "FeatureNodes = (features) \n"
+        "] \n";
+
+    IEvaluateModelShared<float>* model;
+    GetEvalSharedF(&model);
+    model->Init("numCPUThreads=1");
+    model->CreateNetwork(modelDefinition);
+
+    double singleThreadThroughput = 0;
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        std::vector<IEvaluateModelExtended<float>*> evaluators;
+        for (size_t i = 0; i < numThreads; i++)
+        {
+            evaluators.push_back(model->CreateEvaluator());
+            evaluators.back()->StartForwardEvaluation({ L"out" });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < numThreads; i++)
+        {
+            threads.push_back(std::thread([&, i]()
+            {
+                IEvaluateModelExtended<float>* eval = evaluators[i];
+                Values<float> inputs = eval->GetInputSchema().CreateBuffers<float>({ framesPerRequest });
+                Values<float> outputs = eval->GetOutputSchema().CreateBuffers<float>({ framesPerRequest });
+                inputs[0].m_buffer.assign(inputDim * framesPerRequest, 0.5f);
+                for (size_t request = 0; request < requestsPerThread; request++)
+                    eval->ForwardPass(inputs, outputs);
+            }));
+        }
+        for (auto& thread : threads)
+            thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double throughput = numThreads * requestsPerThread / seconds;
+        if (numThreads == 1)
+            singleThreadThroughput = throughput;
+        fprintf(stdout, "%3d threads: %9.1f requests/s, speed-up %5.2f\n", (int)numThreads, throughput, throughput / singleThreadThroughput);
+
+        for (auto eval : evaluators)
+            eval->Destroy();
+    }
+
+    model->Destroy();
+}
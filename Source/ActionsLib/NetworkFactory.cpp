@@ -179,7 +179,7 @@ ComputationNetworkPtr GetModelFromConfig(const ConfigRecordType& config, const w
         // By not compiling the network before patching, we avoid double log output for validation.
         net = make_shared<ComputationNetwork>(deviceId);
         net->SetTraceLevel(config(L"traceLevel", 0));
-        net->Read<ElemType>(modelPath);
+        net->Read<ElemType>(modelPath, config(L"memoryMapModel", false));
         if (outputNodeNames.size() > 0)
             PatchOutputNodes(net, outputNodeNames, outputNodeNamesVector);
         net->CompileNetwork();
@@ -93,7 +93,7 @@ void DoTrain(const ConfigRecordType& config)
         return;
     }
 
-    wstring modelFileName = optimizer->GetModelNameForEpoch(int(startEpoch) - 1);
+    wstring modelFileName = optimizer->GetModelNameForStartEpoch(startEpoch);
     bool loadNetworkFromCheckpoint = startEpoch >= 0;
     if (loadNetworkFromCheckpoint)
         LOGPRINTF(stderr, "\nStarting from checkpoint. Loading network from '%ls'.\n", modelFileName.c_str());
@@ -303,3 +303,59 @@ void DoBatchNormalizationStat(const ConfigParameters& config)
 template void DoBatchNormalizationStat<double>(const ConfigParameters& config);
 template void DoBatchNormalizationStat<float>(const ConfigParameters& config);
 
+// ===========================================================================
+// DoQuantize() - implements CNTK "quantize" command
+// With precision="int8" (default), replaces the Times and Convolution nodes of a trained model by int8 quantized
+// nodes for CPU evaluation, with the input ranges calibrated on the data of the given reader.
+// With precision="float16" or "bfloat16", stores the weights of the Times nodes in 16 bits instead; no data is needed.
+// ===========================================================================
+
+template <typename ElemType>
+void DoQuantize(const ConfigParameters& config)
+{
+    int traceLevel = config(L"traceLevel", "0");
+    wstring precision = config(L"precision", L"int8");
+
+    wstring curModelPath = config(L"modelPath", L"");
+    wstring newModelPath = config(L"newModelPath", L"");
+    if (newModelPath == L"")
+    {
+        newModelPath = curModelPath + L"." + precision;
+    }
+
+    std::vector<std::wstring> evalNodeNames;
+
+    if (precision == L"float16" || precision == L"bfloat16")
+    {
+        let net = GetModelFromConfig<ConfigParameters, ElemType>(config, L"evalNodeNames", evalNodeNames);
+        net->template ReduceParameterPrecision<ElemType>(precision == L"float16" ? HalfPrecisionFormat::Float16 : HalfPrecisionFormat::BFloat16);
+        let mpi = MPIWrapper::GetInstance();
+        if (!mpi || mpi->CurrentNodeRank() == mpi->MainNodeRank())
+            net->Save(newModelPath);
+        return;
+    }
+    if (precision != L"int8")
+        InvalidArgument("quantize: Unknown precision '%ls', expected 'int8', 'float16' or 'bfloat16'.", precision.c_str());
+
+    ConfigParameters readerConfig(config(L"reader"));
+    readerConfig.Insert("traceLevel", config(L"traceLevel", "0"));
+
+    auto dataReader = make_shared<DataReader>(readerConfig);
+
+    int calibrationMinibatches = config(L"calibrationMinibatches", 30);
+
+    ConfigArray minibatchSize = config(L"minibatchSize", "1024");
+    intargvector mbSize = minibatchSize;
+
+    bool enableDistributedMBReading = config(L"enableDistributedMBReading", false);
+
+    let net = GetModelFromConfig<ConfigParameters, ElemType>(config, L"evalNodeNames", evalNodeNames);
+
+    PostComputingActions<ElemType> postComputingActions(net, MPIWrapper::GetInstance(), enableDistributedMBReading, traceLevel);
+
+    postComputingActions.QuantizeModel(dataReader.get(), evalNodeNames, newModelPath, mbSize[0], calibrationMinibatches);
+}
+
+template void DoQuantize<double>(const ConfigParameters& config);
+template void DoQuantize<float>(const ConfigParameters& config);
+
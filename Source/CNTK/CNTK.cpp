@@ -106,6 +106,7 @@ void ForceDeterministicAlgorithmsOnCPU()
     LOGPRINTF(stderr, "WARNING: forceDeterministcAlgorithms flag is specified. Using 1 CPU thread for processing.\n");
     CPUMatrix<float /*any type will do*/>::SetNumThreads(1);
     CPUMatrix<float /*any type will do*/>::SetCompatibleMode();
+    CPUMatrix<float /*any type will do*/>::ForceDeterministicAlgorithms();
 }
 
 #ifndef CPUONLY
@@ -160,7 +161,7 @@ static void DisableLegacyUsage(const ConfigParameters& TopLevelConfig, const Con
 
 // When running in parallel with MPI, only commands in 'commandstoRunOnAllRanks' should
 // be run in parallel across multiple ranks. Others should only run on rank 0
-const std::set<std::string> commandstoRunOnAllRanks = { "train", "trainRNN", "adapt", "test", "eval", "cv", "devtest", "bnstat" };
+const std::set<std::string> commandstoRunOnAllRanks = { "train", "trainRNN", "adapt", "test", "eval", "cv", "devtest", "bnstat", "quantize" };
 
 // process the command
 template <typename ElemType>
@@ -275,6 +276,10 @@ void DoCommands(const ConfigParameters& config, const shared_ptr<MPIWrapper>& mp
                 {
                     DoBatchNormalizationStat<ElemType>(commandParams);
                 }
+                else if (thisAction == "quantize")
+                {
+                    DoQuantize<ElemType>(commandParams);
+                }
                 else if (thisAction == "adapt")
                 {
                     DoAdapt<ElemType>(commandParams);
@@ -565,6 +570,8 @@ int wmainWithBS(int argc, wchar_t* argv[]) // called from wmain which is a wrapp
         Globals::EnableShareNodeValueMatrices();
     if (config(L"hyperCompressMemory", false))
         Globals::EnableHyperCompressMemory();
+    if (config(L"enableDirectConvolutionEngines", false))
+        Globals::EnableDirectConvolutionEngines();
 
     TracingGPUMemoryAllocator::SetTraceLevel(config(L"traceGPUMemoryAllocations", 0));
 
@@ -710,6 +717,8 @@ int wmainOldCNTKConfig(int argc, wchar_t* argv[])
         Globals::EnableShareNodeValueMatrices();
     if (config(L"hyperCompressMemory", false))
         Globals::EnableHyperCompressMemory();
+    if (config(L"enableDirectConvolutionEngines", false))
+        Globals::EnableDirectConvolutionEngines();
 
     TracingGPUMemoryAllocator::SetTraceLevel(config(L"traceGPUMemoryAllocations", 0));
 
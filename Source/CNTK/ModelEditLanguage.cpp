@@ -181,7 +181,7 @@ void MELScript<ElemType>::CallFunction(const std::string& p_name, const ConfigPa
     {
         size_t numFixedParams = 1, numOptionalParams = 1;
         if (params.size() > numFixedParams + numOptionalParams || params.size() < numFixedParams)
-            RuntimeError("Invalid number of parameters. Valid parameters: SaveDefaultModel(modelFileName, [format=cntk]).");
+            RuntimeError("Invalid number of parameters. Valid parameters: SaveDefaultModel(modelFileName, [format=cntk|cntk_aligned]).");
 
         std::wstring modelFormat = GetOptionalModelFormat(params, numFixedParams);
 
@@ -193,13 +193,13 @@ void MELScript<ElemType>::CallFunction(const std::string& p_name, const ConfigPa
 
         // validate the network before we save it out
         ProcessNDLScript(m_netNdlDefault, ndlPassAll, true);
-        cn->SaveEdited(fileName);
+        cn->SaveEdited(fileName, GetModelFileOptions(modelFormat));
     }
     else if (EqualInsensitive(name, "SaveModel"))
     {
         size_t numFixedParams = 2, numOptionalParams = 1;
         if (params.size() > numFixedParams + numOptionalParams || params.size() < numFixedParams)
-            RuntimeError("Invalid number of parameters. Valid parameters: SaveModel(modelName, modelFileName, [format=cntk]).");
+            RuntimeError("Invalid number of parameters. Valid parameters: SaveModel(modelName, modelFileName, [format=cntk|cntk_aligned]).");
 
         std::wstring modelFormat = GetOptionalModelFormat(params, numFixedParams);
 
@@ -212,7 +212,7 @@ void MELScript<ElemType>::CallFunction(const std::string& p_name, const ConfigPa
 
         // validate and finish the second pass through NDL if any in-line NDL was defined
         ProcessNDLScript(netNdl, ndlPassAll, true);
-        netNdl->cn->SaveEdited(fileName);
+        netNdl->cn->SaveEdited(fileName, GetModelFileOptions(modelFormat));
     }
     else if (EqualInsensitive(name, "SetDefaultModel"))
     {
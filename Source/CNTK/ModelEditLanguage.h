@@ -437,6 +437,13 @@ public:
 
         return includeData;
     }
+    // file options for saving a model in the given format
+    FileOptions GetModelFileOptions(const wstring& modelFormat)
+    {
+        if (modelFormat == L"cntk_aligned")
+            return (FileOptions)(FileOptions::fileOptionsBinary | FileOptions::fileOptionsAlignedData);
+        return FileOptions::fileOptionsBinary;
+    }
     wstring GetOptionalModelFormat(const ConfigParamList& params, const size_t numFixedParams)
     {
         wstring modelFormat = L"cntk"; // default
@@ -456,9 +463,13 @@ public:
                     {
                         modelFormat = L"cntk_legacy_no_tensorlib";
                     }
+                    else if (EqualInsensitive(value, "cntk_aligned")) // parameters stored aligned, for loading with memoryMapModel=true
+                    {
+                        modelFormat = L"cntk_aligned";
+                    }
                     else
                     {
-                        RuntimeError("Invalid optional parameter value %s, valid values are: format=(cntk)", value.c_str());
+                        RuntimeError("Invalid optional parameter value %s, valid values are: format=(cntk|cntk_aligned)", value.c_str());
                     }
                 }
                 else
@@ -816,6 +816,23 @@ namespace CNTK
         template <typename ElementType>
         CNTK_API static ValuePtr Create(size_t vocabularySize, const std::vector<std::vector<size_t>>& oneHotSequences, const DeviceDescriptor& device, bool readOnly = false);
 
+        ///
+        /// Create a new Value object containing a collection of variable length sequences in the packed form used by the computation itself.
+        /// Instead of padding each sequence to the length of the longest one, the sequences are packed one after another into parallel
+        /// streams (as the built-in MinibatchSource does), so the Value can be fed to a Function without any repacking.
+        /// Data() and Mask() of the created Value unpack it to the padded form on first access.
+        /// The created Value object contains a copy of the specified 'sequences' data.
+        ///
+        template <typename ElementType>
+        CNTK_API static ValuePtr CreatePacked(const NDShape& sampleShape, const std::vector<std::vector<ElementType>>& sequences, const DeviceDescriptor& device, bool readOnly = false);
+
+        ///
+        /// Create a new Value object containing a collection of variable length sequences of one hot vectors in the packed form used by the computation itself.
+        /// The created Value object contains a copy of the specified 'sequences' data.
+        ///
+        template <typename ElementType>
+        CNTK_API static ValuePtr CreatePacked(size_t vocabularySize, const std::vector<std::vector<size_t>>& oneHotSequences, const DeviceDescriptor& device, bool readOnly = false);
+
         ///
         /// Destruct 'this' Value object.
         ///
@@ -872,6 +889,15 @@ namespace CNTK
         ///
         virtual NDMaskPtr Mask() const;
 
+        ///
+        /// Returns the data of each of the sequences in 'this' Value as a separate NDArrayView of shape 'sampleShape' x sequence length,
+        /// in the order in which the sequences were batched. Masked steps are not included.
+        /// A view aliases the storage of 'this' Value when the steps of its sequence are stored contiguously, which is always the case
+        /// for a padded Value; the sequences of a Value packed into more than one parallel stream are gathered into new storage.
+        /// A packed Value is not unpacked by this call.
+        ///
+        virtual std::vector<NDArrayViewPtr> SequenceViews(const NDShape& sampleShape) const;
+
         ///
         /// Creates a new Value with newly allocated storage on the same device as 'this' Value and copies 'this' Value's contents into the newly allocated Value.
         ///
@@ -3129,6 +3155,10 @@ namespace CNTK
 #endif
         double gradientClippingThresholdPerSample = std::numeric_limits<double>::infinity();
         bool gradientClippingWithTruncation = true;
+
+        // Update all dense parameters on the CPU in one parallel pass (with the learner state in one contiguous buffer),
+        // instead of one parameter after the other. Has no effect with gradient clipping by norm or noise injection.
+        bool fuseParameterUpdates = false;
     };
 
     ///
@@ -247,6 +247,11 @@ namespace CNTK
 
         CNTK_API bool AreEqual(const ::CNTK::NDArrayView& view1, const ::CNTK::NDArrayView& view2, double relativeTolerance = 0.0, double absoluteTolerance = 0.0);
 
+        // For Functions cloned with ParameterCloningMethod::Share: whether both copy the same compiled networks, and whether
+        // their (already created) ComputationNetworks hold the same LearnableParameter value matrices
+        CNTK_API bool AreSharingComputationNetworks(const ::CNTK::FunctionPtr& f1, const ::CNTK::FunctionPtr& f2);
+        CNTK_API bool AreSharingParameterValues(const ::CNTK::FunctionPtr& f1, const ::CNTK::FunctionPtr& f2);
+
         template <typename ElementType>
         Variable GetVariable(const  Microsoft::MSR::CNTK::ComputationNodeBasePtr& node,
                              std::unordered_map<Microsoft::MSR::CNTK::ComputationNodeBasePtr, ::CNTK::Variable>& nodeToVariableMap,
@@ -261,6 +261,7 @@ namespace CNTK
         void ForceDeterministicAlgorithms()
         {
             Microsoft::MSR::CNTK::Globals::ForceDeterministicAlgorithms();
+            Microsoft::MSR::CNTK::CPUMatrix<float>::ForceDeterministicAlgorithms();
         }
     }
 
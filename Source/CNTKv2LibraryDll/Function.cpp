@@ -498,6 +498,39 @@ namespace CNTK
 
         auto clonedComposite = CompositeFunction::Create(clonedRootFunction, compositeFunction->Name());
         clonedComposite->ReplacePlaceholders(placeholderReplacements);
+
+        // A clone that shares the parameters and is otherwise identical to the original does not need to compile its own network;
+        // it copies the network compiled once for the original graph
+        if ((parameterCloneMethod == ParameterCloningMethod::Share) && replacements.empty() && compositeFunction->Placeholders().empty())
+        {
+            std::unordered_map<Variable, Variable> cloneeToCloneVariableMap(leafVariablesCloneMap);
+            for (auto& clonePair : cloneMap)
+            {
+                auto& cloneeOutputs = clonePair.first->Outputs();
+                auto& cloneOutputs = clonePair.second->Outputs();
+                for (size_t i = 0; i < cloneeOutputs.size(); ++i)
+                    cloneeToCloneVariableMap[cloneeOutputs[i]] = cloneOutputs[i];
+            }
+
+            auto correspondingCloneVariable = [&cloneeToCloneVariableMap](const Variable& cloneeVar) {
+                auto iter = cloneeToCloneVariableMap.find(cloneeVar);
+                return (iter != cloneeToCloneVariableMap.end()) ? iter->second : cloneeVar;
+            };
+
+            if (compositeFunction->m_sharedNetworks != nullptr)
+            {
+                // The clonee is a clone itself; the networks are compiled from the graph it was cloned from
+                clonedComposite->m_sharedNetworks = compositeFunction->m_sharedNetworks;
+                for (auto& varPair : compositeFunction->m_sharedNetworksVariableMap)
+                    clonedComposite->m_sharedNetworksVariableMap[varPair.first] = correspondingCloneVariable(varPair.second);
+            }
+            else
+            {
+                clonedComposite->m_sharedNetworks = std::make_shared<SharedComputationNetworks>(compositeFunction->RootFunction());
+                clonedComposite->m_sharedNetworksVariableMap = std::move(cloneeToCloneVariableMap);
+            }
+        }
+
         return clonedComposite;
     }
 
@@ -1869,6 +1902,35 @@ namespace CNTK
                 LogicError("Changing device across different Forward calls on a CNTK composite Function is currently unsupported");
 
         }
+        else if (m_sharedNetworks != nullptr)
+        {
+            // TODO: We currently only support one backprop root
+            if (backpropRoots.size() > 1)
+                LogicError("More than one backprop roots is currently unsupported");
+
+            // Copy the network compiled once for all the Functions sharing their parameters with 'this' Function
+            auto compiledFunction = m_sharedNetworks->GetCompiledFunction<ElementType>(device);
+            m_computationNetwork = compiledFunction->m_computationNetwork->CloneSharingParameters();
+
+            auto correspondingVariable = [this](const Variable& var) {
+                auto iter = m_sharedNetworksVariableMap.find(var);
+                return (iter != m_sharedNetworksVariableMap.end()) ? iter->second : var;
+            };
+
+            for (auto varNodePair : compiledFunction->m_variableToNodeMap)
+                m_variableToNodeMap[correspondingVariable(varNodePair.first)] = m_computationNetwork->GetNodeFromName(varNodePair.second->NodeName());
+
+            for (auto varIsRootPair : compiledFunction->m_isVariableRootMap)
+                m_isVariableRootMap[correspondingVariable(varIsRootPair.first)] = varIsRootPair.second;
+
+            m_currentBackpropRoots = backpropRoots;
+
+            // Record the timestamps of Parameter values
+            assert(m_lastRecordedParameterValueTimeStamps.empty());
+            auto functionParameters = Parameters();
+            for (auto parameter : functionParameters)
+                m_lastRecordedParameterValueTimeStamps.insert({ parameter, parameter.CurrentValueTimeStamp() });
+        }
         else
         {
             m_computationNetwork = std::make_shared<ComputationNetwork>(AsCNTKImplDeviceId(device));
@@ -1977,6 +2039,23 @@ namespace CNTK
         return m_computationNetwork;
     }
 
+    template <typename ElementType>
+    CompositeFunctionPtr SharedComputationNetworks::GetCompiledFunction(const DeviceDescriptor& device)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto iter = std::find_if(m_compiledFunctions.begin(), m_compiledFunctions.end(), [&device](const std::pair<DeviceDescriptor, CompositeFunctionPtr>& compiledFunction) {
+            return (compiledFunction.first == device);
+        });
+
+        if (iter != m_compiledFunctions.end())
+            return iter->second;
+
+        auto compiledFunction = CompositeFunction::Create(m_rootFunction);
+        compiledFunction->GetComputationNetwork<ElementType>(device, {}, /*allocateNetworkMatrices =*/ false);
+        m_compiledFunctions.push_back({ device, compiledFunction });
+        return compiledFunction;
+    }
+
     template <typename ElementType>
     /*static*/ std::pair<std::shared_ptr<const Matrix<ElementType>>, MBLayoutPtr> CompositeFunction::GetCNTKImplMatrixAndMBLayoutFromValueObject(Variable var, const ValuePtr& value)
     {
@@ -3340,5 +3419,39 @@ namespace CNTK
 
             LogicError("CNTK::ReduceElements: Invalid axis argument provided. To reduce a sequence along its ordered dynamic axis use Sequence::ReduceElements.");
         }
+
+        bool AreSharingComputationNetworks(const FunctionPtr& f1, const FunctionPtr& f2)
+        {
+            auto compositeFunction1 = dynamic_cast<const CompositeFunction*>(f1.get());
+            auto compositeFunction2 = dynamic_cast<const CompositeFunction*>(f2.get());
+            if ((compositeFunction1 == nullptr) || (compositeFunction2 == nullptr))
+                return false;
+
+            return (compositeFunction1->m_sharedNetworks != nullptr) && (compositeFunction1->m_sharedNetworks == compositeFunction2->m_sharedNetworks);
+        }
+
+        bool AreSharingParameterValues(const FunctionPtr& f1, const FunctionPtr& f2)
+        {
+            auto compositeFunction1 = dynamic_cast<const CompositeFunction*>(f1.get());
+            auto compositeFunction2 = dynamic_cast<const CompositeFunction*>(f2.get());
+            if ((compositeFunction1 == nullptr) || (compositeFunction2 == nullptr) ||
+                (compositeFunction1->m_computationNetwork == nullptr) || (compositeFunction2->m_computationNetwork == nullptr))
+                return false;
+
+            size_t numParameters = 0;
+            for (const auto& node : compositeFunction1->m_computationNetwork->GetAllNodes())
+            {
+                if (node->OperationName() != OperationNameOf(LearnableParameter))
+                    continue;
+
+                if (!compositeFunction2->m_computationNetwork->NodeNameExists(node->NodeName()) ||
+                    (compositeFunction2->m_computationNetwork->GetNodeFromName(node->NodeName())->ValuePtr() != node->ValuePtr()))
+                    return false;
+
+                numParameters++;
+            }
+
+            return (numParameters > 0);
+        }
    }
 }
@@ -669,17 +669,22 @@ namespace CNTK
     class CompositeFunction;
     typedef std::shared_ptr<CompositeFunction> CompositeFunctionPtr;
 
+    class SharedComputationNetworks;
+
     class CompositeFunction final : public Function
     {
         friend class Function;
         friend class Trainer;
         friend class CompositeMinibatchSource;
         friend class PackedValue;
+        friend class SharedComputationNetworks;
 
         template <typename T, typename ...CtorArgTypes>
         friend inline std::shared_ptr<T> MakeSharedObject(CtorArgTypes&& ...ctorArgs);
 
         friend void Internal::SaveAsLegacyModel(const FunctionPtr& rootFunction, const std::wstring& modelFile);
+        friend bool Internal::AreSharingComputationNetworks(const FunctionPtr& f1, const FunctionPtr& f2);
+        friend bool Internal::AreSharingParameterValues(const FunctionPtr& f1, const FunctionPtr& f2);
 
         friend void ComputeInputPerDimMeansAndInvStdDevs(const MinibatchSourcePtr& minibatchSource,
                                                          std::unordered_map<StreamInformation, std::pair<NDArrayViewPtr, NDArrayViewPtr>>& computedMeanAndInvStdDevs,
@@ -871,9 +876,36 @@ namespace CNTK
 
         std::unordered_map<Parameter, size_t> m_lastRecordedParameterValueTimeStamps;
 
+        // Set for Functions cloned with ParameterCloningMethod::Share: the networks compiled once for all such clones, and the
+        // Variable of 'this' Function corresponding to each Variable of the graph these networks were compiled from (where different)
+        std::shared_ptr<SharedComputationNetworks> m_sharedNetworks;
+        std::unordered_map<Variable, Variable> m_sharedNetworksVariableMap;
+
         static const size_t s_serializationVersion = 1;
     };
 
+    // The compiled ComputationNetworks of a Function graph and all its clones that share its parameters.
+    // For each device, the graph is compiled once into a network that is never evaluated itself; every clone
+    // evaluates its own copy of it (ComputationNetwork::CloneSharingParameters), which takes over the compiled structure and
+    // the parameter values and only allocates its own activations.
+    class SharedComputationNetworks final
+    {
+    public:
+        explicit SharedComputationNetworks(const FunctionPtr& rootFunction)
+            : m_rootFunction(rootFunction)
+        {}
+
+        // Returns the (never evaluated) CompositeFunction whose network is compiled for the specified device
+        template <typename ElementType>
+        CompositeFunctionPtr GetCompiledFunction(const DeviceDescriptor& device);
+
+    private:
+        FunctionPtr m_rootFunction;
+
+        std::mutex m_mutex;
+        std::vector<std::pair<DeviceDescriptor, CompositeFunctionPtr>> m_compiledFunctions;
+    };
+
     inline std::vector<CNTK::Axis> DynamicAxesFromInternalDynamicAxisName(const std::wstring& internalDynamicAxisName)
     {
         std::vector<CNTK::Axis> inputVarDynamicAxes;
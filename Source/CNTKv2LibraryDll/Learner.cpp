@@ -232,7 +232,11 @@ namespace CNTK
         // make sure trainingSampleCount is a valid value
         assert(trainingSampleCount > 0);
 
-        for (const auto& parameter : Parameters())
+        vector<Parameter> remainingParameters;
+        if (m_additionalOptions.fuseParameterUpdates)
+            remainingParameters = FusedUpdate(gradientValues, trainingSampleCount);
+
+        for (const auto& parameter : m_additionalOptions.fuseParameterUpdates ? remainingParameters : Parameters())
         {
             const auto& smoothedGradientValue = m_smoothedGradientValues.at(parameter);
             const auto& gradientValue = gradientValues.at(parameter);
@@ -286,6 +290,112 @@ namespace CNTK
         paramRef.RecordValueUpdate();
     }
 
+    vector<Parameter> LearnerBase::FusedUpdate(const unordered_map<Parameter, NDArrayViewPtr>& gradientValues, size_t trainingSampleCount)
+    {
+        // Gradient clipping by norm needs the norm of the whole gradient before the update, and noise injection
+        // random numbers; both are left to the per-parameter update.
+        FusedUpdateParameters update;
+        const bool clipByNorm = m_additionalOptions.gradientClippingThresholdPerSample != numeric_limits<double>::infinity() &&
+                                !m_additionalOptions.gradientClippingWithTruncation;
+        if (clipByNorm || GetCurrentTrainingParameterValue(m_additionalOptions.gaussianNoiseInjectionStdDev) > 0 ||
+            !GetFusedUpdate(trainingSampleCount, update))
+        {
+            return Parameters();
+        }
+
+        // the same per-minibatch values as PreProcess() and PostProcess()
+        update.m_learningRate = LearningRate(trainingSampleCount);
+        update.m_clipThreshold = m_additionalOptions.gradientClippingThresholdPerSample * trainingSampleCount;
+        update.m_l2Weight = m_additionalOptions.l2RegularizationWeight > 0 ? m_additionalOptions.l2RegularizationWeight * trainingSampleCount : 0;
+        update.m_l1Weight = m_additionalOptions.l1RegularizationWeight > 0 ? update.m_learningRate * m_additionalOptions.l1RegularizationWeight * trainingSampleCount : 0;
+
+        vector<Parameter> floatParameters, doubleParameters, remainingParameters;
+        for (const auto& parameter : Parameters())
+        {
+            const auto& gradientValue = gradientValues.at(parameter);
+            const auto& smoothedGradientValue = m_smoothedGradientValues.at(parameter);
+            const bool isDenseOnCPU = parameter.Value()->Device().Type() == DeviceKind::CPU &&
+                                      gradientValue->Device().Type() == DeviceKind::CPU &&
+                                      !IsSparseStorageFormat(gradientValue->GetStorageFormat()) &&
+                                      smoothedGradientValue->Shape().TotalSize() == update.StateSize() * parameter.Shape().TotalSize();
+            if (!isDenseOnCPU)
+                remainingParameters.push_back(parameter);
+            else if (parameter.GetDataType() == DataType::Float)
+                floatParameters.push_back(parameter);
+            else if (parameter.GetDataType() == DataType::Double)
+                doubleParameters.push_back(parameter);
+            else
+                LogicError("Unsupported DataType %s", DataTypeName(parameter.GetDataType()));
+        }
+
+        FusedUpdate<float>(update, floatParameters, gradientValues, trainingSampleCount);
+        FusedUpdate<double>(update, doubleParameters, gradientValues, trainingSampleCount);
+
+        return remainingParameters;
+    }
+
+    template <typename ElementType>
+    void LearnerBase::FusedUpdate(const FusedUpdateParameters& update, const vector<Parameter>& parameters,
+                                  const unordered_map<Parameter, NDArrayViewPtr>& gradientValues, size_t trainingSampleCount)
+    {
+        if (parameters.empty())
+            return;
+
+        if (m_smoothedGradientArenas.find(AsDataType<ElementType>()) == m_smoothedGradientArenas.end())
+            AllocateSmoothedGradientArena<ElementType>(parameters);
+
+        vector<FusedUpdateTensor<ElementType>> tensors;
+        tensors.reserve(parameters.size());
+        for (const auto& parameter : parameters)
+        {
+            FusedUpdateTensor<ElementType> tensor;
+            tensor.m_value = GetWritableMatrix<ElementType>(parameter.Value())->Data();
+            tensor.m_gradient = GetWritableMatrix<ElementType>(gradientValues.at(parameter))->Data();
+            tensor.m_state = GetWritableMatrix<ElementType>(m_smoothedGradientValues.at(parameter))->Data();
+            tensor.m_size = parameter.Shape().TotalSize();
+            tensor.m_adaMultiplier = PrepareFusedUpdate(parameter, trainingSampleCount);
+            tensors.push_back(tensor);
+        }
+
+        // the NaN check is part of the update pass, so unlike the per-parameter update it is done in release builds too
+        size_t nanIndex = CPUFusedUpdate::Update(update, tensors);
+        if (nanIndex != SIZE_MAX)
+            LogicError("%ls has NaNs in parameter values after parameter update.", parameters[nanIndex].Uid().c_str());
+
+        for (const auto& parameter : parameters)
+        {
+            auto paramRef = parameter;
+            paramRef.RecordValueUpdate();
+        }
+    }
+
+    template <typename ElementType>
+    void LearnerBase::AllocateSmoothedGradientArena(const vector<Parameter>& parameters)
+    {
+        // each state starts at a multiple of 64 bytes from the start of the arena
+        const size_t alignment = 64 / sizeof(ElementType);
+        vector<size_t> offsets;
+        size_t arenaSize = 0;
+        for (const auto& parameter : parameters)
+        {
+            offsets.push_back(arenaSize);
+            const size_t stateSize = m_smoothedGradientValues.at(parameter)->Shape().TotalSize();
+            arenaSize += (stateSize + alignment - 1) / alignment * alignment;
+        }
+
+        NDArrayViewPtr arena = MakeSharedObject<NDArrayView>(ElementType(0), NDShape({ arenaSize }), DeviceDescriptor::CPUDevice());
+        ElementType* buffer = arena->WritableDataBuffer<ElementType>();
+        for (size_t i = 0; i < parameters.size(); i++)
+        {
+            auto& smoothedGradientValue = m_smoothedGradientValues.at(parameters[i]);
+            const auto& shape = smoothedGradientValue->Shape();
+            auto view = MakeSharedObject<NDArrayView>(shape, buffer + offsets[i], shape.TotalSize(), DeviceDescriptor::CPUDevice());
+            view->CopyFrom(*smoothedGradientValue);
+            smoothedGradientValue = view;
+        }
+        m_smoothedGradientArenas[AsDataType<ElementType>()] = arena;
+    }
+
     string LearnerBase::LearnerType() const
     {
         return Typename(this);
@@ -387,6 +497,13 @@ namespace CNTK
                                            learningRate, momentum, UseNesterovMomentum());
     }
 
+    /*virtual*/ bool LearnerSGD::GetFusedUpdate(size_t trainingSampleCount, FusedUpdateParameters& update) const /*override*/
+    {
+        update.m_kind = UseNesterovMomentum() ? FusedUpdateKind::Nesterov : FusedUpdateKind::SGD;
+        update.m_momentum = MomentumValueForMB(trainingSampleCount);
+        return true;
+    }
+
     double LearnerMomentumSGD::MomentumValueForMB(const MomentumSchedule& schedule, size_t minibatchSize) const
     {
         double currentMomentum = GetCurrentTrainingParameterValue(schedule);
@@ -418,6 +535,13 @@ namespace CNTK
         Matrix<ElementType>::ScaleAndAdd(ElementType(-learningRate / aveMultiplier), *gradientMatrix, *parameterMatrix);
     }
 
+    /*virtual*/ bool LearnerAdaGrad::GetFusedUpdate(size_t /*trainingSampleCount*/, FusedUpdateParameters& update) const /*override*/
+    {
+        update.m_kind = FusedUpdateKind::AdaGrad;
+        update.m_needAveMultiplier = m_needAveMultiplier;
+        return true;
+    }
+
     /*static*/ const double LearnerFSAdaGrad::s_targetAdagradAvDenom = 1.0;
 
     LearnerFSAdaGrad::LearnerFSAdaGrad(const vector<Parameter>& parameters,
@@ -460,6 +584,23 @@ namespace CNTK
         smoothedGradientMatrix->FSAdagradUpdate(trainingSampleCount, *gradientMatrix, *parameterMatrix, smoothedCount, learningRate, s_targetAdagradAvDenom, momentum, varMomentum);
     }
 
+    /*virtual*/ bool LearnerFSAdaGrad::GetFusedUpdate(size_t trainingSampleCount, FusedUpdateParameters& update) const /*override*/
+    {
+        update.m_kind = FusedUpdateKind::FSAdaGrad;
+        update.m_momentum = MomentumValueForMB(trainingSampleCount);
+        update.m_varianceMomentum = VarianceMomentumValueForMB(trainingSampleCount);
+        return true;
+    }
+
+    // Same bookkeeping as Matrix::FSAdagradUpdate.
+    /*virtual*/ double LearnerFSAdaGrad::PrepareFusedUpdate(const Parameter& parameter, size_t trainingSampleCount) const /*override*/
+    {
+        const auto varMomentum = VarianceMomentumValueForMB(trainingSampleCount);
+        double& smoothedCount = m_smoothedCounts.at(parameter);
+        smoothedCount = varMomentum * smoothedCount + (1.0 - varMomentum) * trainingSampleCount;
+        return s_targetAdagradAvDenom * sqrt(smoothedCount);
+    }
+
     LearnerRMSProp::LearnerRMSProp(const vector<Parameter>& parameters,
                                    const LearningRateSchedule& learningRateSchedule,
                                    double gamma, double inc, double dec, double max, double min,
@@ -511,6 +652,18 @@ namespace CNTK
         Matrix<ElementType>::ScaleAndAdd(ElementType(-learningRate / aveMultiplier), *gradientMatrix, *parameterMatrix);
     }
 
+    /*virtual*/ bool LearnerRMSProp::GetFusedUpdate(size_t /*trainingSampleCount*/, FusedUpdateParameters& update) const /*override*/
+    {
+        update.m_kind = FusedUpdateKind::RmsProp;
+        update.m_needAveMultiplier = m_needAveMultiplier;
+        update.m_rmsGamma = m_gamma;
+        update.m_rmsWeightInc = m_inc;
+        update.m_rmsWeightDec = m_dec;
+        update.m_rmsWeightMax = m_max;
+        update.m_rmsWeightMin = m_min;
+        return true;
+    }
+
     // Explicit template instantiations
     template shared_ptr<Matrix<float>> LearnerBase::GetWritableMatrix<float>(const NDArrayViewPtr& arrayView);
     template shared_ptr<Matrix<double>> LearnerBase::GetWritableMatrix<double>(const NDArrayViewPtr& arrayView);
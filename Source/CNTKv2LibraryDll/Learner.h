@@ -7,6 +7,7 @@
 
 #include "stdafx.h"
 #include "CNTKLibrary.h"
+#include "CPUFusedUpdate.h"
 #include <numeric>
 
 namespace CNTK 
@@ -39,6 +40,20 @@ namespace CNTK
 
         virtual void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const = 0;
 
+        // Learners that have a fused kernel (see AdditionalLearningOptions::fuseParameterUpdates) describe their step
+        // for the current minibatch and return true. The learning rate and the regularization are filled in by LearnerBase.
+        virtual bool GetFusedUpdate(size_t /*trainingSampleCount*/, Microsoft::MSR::CNTK::FusedUpdateParameters& /*update*/) const
+        {
+            return false;
+        }
+
+        // Invoked for each parameter that is part of the fused update of a minibatch, returns the per-parameter
+        // multiplier of FSAdaGrad (FusedUpdateTensor::m_adaMultiplier).
+        virtual double PrepareFusedUpdate(const Parameter& /*parameter*/, size_t /*trainingSampleCount*/) const
+        {
+            return 1.0;
+        }
+
         std::string LearnerType() const;
 
         // Returns current (per-sample) learning rate.
@@ -100,11 +115,28 @@ namespace CNTK
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
 
+        // Updates the dense parameters on the CPU with the fused kernel, and returns the parameters that need
+        // the per-parameter update (those on the GPU or with sparse gradients, or all of them if the learner or
+        // the additional learning options don't allow a fused update).
+        std::vector<Parameter> FusedUpdate(const std::unordered_map<Parameter, NDArrayViewPtr>& gradientValues, size_t trainingSampleCount);
+
+        template <typename ElementType>
+        void FusedUpdate(const Microsoft::MSR::CNTK::FusedUpdateParameters& update, const std::vector<Parameter>& parameters,
+                         const std::unordered_map<Parameter, NDArrayViewPtr>& gradientValues, size_t trainingSampleCount);
+
+        // Moves the smoothed gradients of the parameters into one buffer, in the order of the parameters, such that
+        // the fused update reads the learner state sequentially. m_smoothedGradientValues then holds views into it.
+        template <typename ElementType>
+        void AllocateSmoothedGradientArena(const std::vector<Parameter>& parameters);
+
         // TODO: make these functions friends of NDViewArray and move to Utils?
         static bool HasNan(const NDArrayViewPtr& value, const char* name);
         static void Print(const NDArrayViewPtr& value, const char* msg);
 
         static const size_t s_serializationVersion = 1;
+
+        // one buffer per data type, allocated at the first fused update
+        std::map<DataType, NDArrayViewPtr> m_smoothedGradientArenas;
     };
 
     // Vanilla gradient descent optimization algorithm.
@@ -133,6 +165,8 @@ namespace CNTK
 
         virtual void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const override;
 
+        virtual bool GetFusedUpdate(size_t trainingSampleCount, Microsoft::MSR::CNTK::FusedUpdateParameters& update) const override;
+
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
     };
@@ -200,6 +234,8 @@ namespace CNTK
 
         virtual void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const override;
 
+        virtual bool GetFusedUpdate(size_t trainingSampleCount, Microsoft::MSR::CNTK::FusedUpdateParameters& update) const override;
+
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
     };
@@ -218,6 +254,10 @@ namespace CNTK
 
         virtual void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const override;
 
+        virtual bool GetFusedUpdate(size_t trainingSampleCount, Microsoft::MSR::CNTK::FusedUpdateParameters& update) const override;
+
+        virtual double PrepareFusedUpdate(const Parameter& parameter, size_t trainingSampleCount) const override;
+
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
 
@@ -255,6 +295,8 @@ namespace CNTK
 
         virtual void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const override;
 
+        virtual bool GetFusedUpdate(size_t trainingSampleCount, Microsoft::MSR::CNTK::FusedUpdateParameters& update) const override;
+
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
     };
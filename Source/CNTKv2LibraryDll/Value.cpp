@@ -14,6 +14,8 @@
 #include "Value.h"
 #include "Function.h"
 
+using namespace Microsoft::MSR::CNTK;
+
 namespace CNTK
 {
     Value::Value(const NDArrayViewPtr& data)
@@ -139,6 +141,98 @@ namespace CNTK
         return MakeSharedObject<Value>(deviceValueData, deviceValueMask);
     }
 
+    // Packs the sequences one after another into as few parallel streams as the longest sequence allows, in the order in which
+    // they are specified; the sequence id of each sequence in the layout is its index in 'sequences'
+    template <typename T>
+    static MBLayoutPtr CreatePackedLayout(size_t numElementsPerSample, const std::vector<std::vector<T>>& sequences)
+    {
+        if (sequences.empty())
+            InvalidArgument("Value::CreatePacked: No sequences specified");
+
+        std::vector<MBLayout::SequenceInfo> sequenceInfos;
+        for (size_t i = 0; i < sequences.size(); ++i)
+        {
+            if (sequences[i].empty() || ((sequences[i].size() % numElementsPerSample) != 0))
+                InvalidArgument("Value::CreatePacked: The size (%d) of sequence %d is not a non-zero multiple of the sample size (%d)", (int)sequences[i].size(), (int)i, (int)numElementsPerSample);
+
+            sequenceInfos.push_back({ i, SIZE_MAX, 0, sequences[i].size() / numElementsPerSample });
+        }
+
+        auto layout = std::make_shared<MBLayout>();
+        std::vector<std::pair<size_t, size_t>> placement;
+        std::vector<size_t> rowAllocations;
+        layout->InitAsPackedSequences(sequenceInfos, placement, rowAllocations);
+        return layout;
+    }
+
+    template <typename ElementType>
+    /*static*/ ValuePtr Value::CreatePacked(size_t vocabularySize, const std::vector<std::vector<size_t>>& oneHotSequences, const DeviceDescriptor& device, bool readOnly/* = false*/)
+    {
+        auto layout = CreatePackedLayout(1, oneHotSequences);
+        size_t numParallelSequences = layout->GetNumParallelSequences();
+        size_t numCols = layout->GetNumCols();
+
+        // The row of the one hot entry of each column of the packed matrix, or SIZE_MAX for the columns of gaps
+        std::vector<size_t> oneHotRows(numCols, SIZE_MAX);
+        for (const auto& sequenceInfo : layout->GetAllSequences())
+        {
+            if (sequenceInfo.seqId == GAP_SEQUENCE_ID)
+                continue;
+
+            const auto& sequence = oneHotSequences[sequenceInfo.seqId];
+            for (size_t j = 0; j < sequence.size(); ++j)
+            {
+                if (sequence[j] >= vocabularySize)
+                    InvalidArgument("Value::CreatePacked: one-hot data exceeds vocabulary size");
+
+                oneHotRows[((sequenceInfo.tBegin + j) * numParallelSequences) + sequenceInfo.s] = sequence[j];
+            }
+        }
+
+        std::vector<SparseIndexType> colStarts(numCols + 1);
+        std::vector<SparseIndexType> rowIndices;
+        for (size_t j = 0; j < numCols; ++j)
+        {
+            colStarts[j] = (SparseIndexType)rowIndices.size();
+            if (oneHotRows[j] != SIZE_MAX)
+                rowIndices.push_back((SparseIndexType)oneHotRows[j]);
+        }
+
+        colStarts[numCols] = (SparseIndexType)rowIndices.size();
+        std::vector<ElementType> nonZeroValues(rowIndices.size(), 1);
+
+        auto packedMatrix = std::make_shared<Matrix<ElementType>>(vocabularySize, numCols, AsCNTKImplDeviceId(device), MatrixType::SPARSE, matrixFormatSparseCSC);
+        packedMatrix->SetMatrixFromCSCFormat(colStarts.data(), rowIndices.data(), nonZeroValues.data(), nonZeroValues.size(), vocabularySize, numCols);
+        return MakeSharedObject<PackedValue>(NDShape({ vocabularySize }), packedMatrix, layout, readOnly);
+    }
+
+    template <typename ElementType>
+    /*static*/ ValuePtr Value::CreatePacked(const NDShape& sampleShape, const std::vector<std::vector<ElementType>>& sequences, const DeviceDescriptor& device, bool readOnly/* = false*/)
+    {
+        size_t numElementsPerSample = sampleShape.TotalSize();
+        auto layout = CreatePackedLayout(numElementsPerSample, sequences);
+        size_t numParallelSequences = layout->GetNumParallelSequences();
+
+        // Copy each step of each sequence straight to its column in the packed matrix; the columns of gaps stay zero
+        std::vector<ElementType> packedData(numElementsPerSample * layout->GetNumCols(), 0);
+        for (const auto& sequenceInfo : layout->GetAllSequences())
+        {
+            if (sequenceInfo.seqId == GAP_SEQUENCE_ID)
+                continue;
+
+            const ElementType* sequenceData = sequences[sequenceInfo.seqId].data();
+            size_t sequenceLength = sequenceInfo.GetNumTimeSteps();
+            for (size_t j = 0; j < sequenceLength; ++j)
+            {
+                size_t packedColIdx = ((sequenceInfo.tBegin + j) * numParallelSequences) + sequenceInfo.s;
+                std::copy(sequenceData + (j * numElementsPerSample), sequenceData + ((j + 1) * numElementsPerSample), packedData.data() + (packedColIdx * numElementsPerSample));
+            }
+        }
+
+        auto packedMatrix = std::make_shared<Matrix<ElementType>>(numElementsPerSample, layout->GetNumCols(), packedData.data(), AsCNTKImplDeviceId(device));
+        return MakeSharedObject<PackedValue>(sampleShape, packedMatrix, layout, readOnly);
+    }
+
     /*virtual*/ Value::~Value()
     {
     }
@@ -155,6 +249,59 @@ namespace CNTK
         return m_mask;
     }
 
+    /*virtual*/ std::vector<NDArrayViewPtr> Value::SequenceViews(const NDShape& sampleShape) const
+    {
+        auto data = Data();
+        auto mask = Mask();
+        auto valueShape = data->Shape();
+        size_t sampleRank = sampleShape.Rank();
+        if ((valueShape.Rank() < sampleRank) || (valueShape.Rank() > (sampleRank + 2)) || (valueShape.SubShape(0, sampleRank) != sampleShape))
+            InvalidArgument("Value::SequenceViews: The shape %S of the Value is not the sample shape %S followed by at most 2 dynamic axes",
+                            AsStringForErrorReporting(valueShape).c_str(), AsStringForErrorReporting(sampleShape).c_str());
+
+        auto dynamicAxesShape = valueShape.SubShape(sampleRank);
+        size_t maxNumTimeSteps = (dynamicAxesShape.Rank() > 0) ? dynamicAxesShape[0] : 1;
+        size_t numSequences = (dynamicAxesShape.Rank() > 1) ? dynamicAxesShape[1] : 1;
+
+        std::vector<size_t> sequenceLengths(numSequences, maxNumTimeSteps);
+        if (mask != nullptr)
+        {
+            if (mask->Shape() != dynamicAxesShape)
+                InvalidArgument("Value::SequenceViews: The shape %S of the mask of the Value does not match the shape %S of its dynamic axes",
+                                AsStringForErrorReporting(mask->Shape()).c_str(), AsStringForErrorReporting(dynamicAxesShape).c_str());
+
+            auto cpuMask = (mask->Device() != DeviceDescriptor::CPUDevice()) ? mask->DeepClone(DeviceDescriptor::CPUDevice()) : mask;
+            const MaskKind* maskBuffer = cpuMask->DataBuffer();
+            for (size_t i = 0; i < numSequences; ++i)
+            {
+                size_t j = 0;
+                while ((j < maxNumTimeSteps) && (maskBuffer[(i * maxNumTimeSteps) + j] != MaskKind::Invalid))
+                    j++;
+
+                sequenceLengths[i] = j;
+            }
+        }
+
+        // The padded sequences are laid out one after another in a single stream
+        auto layout = std::make_shared<MBLayout>();
+        layout->Init(1, maxNumTimeSteps * numSequences);
+        for (size_t i = 0; i < numSequences; ++i)
+        {
+            layout->AddSequence(i, 0, i * maxNumTimeSteps, (i * maxNumTimeSteps) + sequenceLengths[i]);
+            layout->AddGap(0, (i * maxNumTimeSteps) + sequenceLengths[i], (i + 1) * maxNumTimeSteps);
+        }
+
+        switch (GetDataType())
+        {
+        case DataType::Float:
+            return PackedValue::SequenceViews<float>(sampleShape, data, sampleRank, layout);
+        case DataType::Double:
+            return PackedValue::SequenceViews<double>(sampleShape, data, sampleRank, layout);
+        default:
+            LogicError("Unsupported DataType %s", DataTypeName(GetDataType()));
+        }
+    }
+
     /*virtual*/ ValuePtr Value::DeepClone(bool readOnly/* = false*/) const
     {
         // TODO: Check if this is a derived type and throw an exception in that case
@@ -219,9 +366,87 @@ namespace CNTK
         }
     }
 
+    std::vector<NDArrayViewPtr> PackedValue::SequenceViews(const NDShape& sampleShape) const /*override*/
+    {
+        if (!m_isPacked || !m_packedDataLayout)
+            return Value::SequenceViews(sampleShape);
+
+        if (sampleShape != m_sampleShape)
+            InvalidArgument("PackedValue::SequenceViews: The specified sample shape %S does not match the sample shape %S of the Value",
+                            AsStringForErrorReporting(sampleShape).c_str(), AsStringForErrorReporting(m_sampleShape).c_str());
+
+        switch (m_packedData->GetDataType())
+        {
+        case DataType::Float:
+            return SequenceViews<float>(m_sampleShape, m_packedData, 1, m_packedDataLayout);
+        case DataType::Double:
+            return SequenceViews<double>(m_sampleShape, m_packedData, 1, m_packedDataLayout);
+        default:
+            LogicError("Unsupported DataType %s", DataTypeName(m_packedData->GetDataType()));
+        }
+    }
+
+    template <typename ElementType>
+    /*static*/ std::vector<NDArrayViewPtr> PackedValue::SequenceViews(const NDShape& sampleShape, const NDArrayViewPtr& data, size_t rowColSplitPoint, const MBLayoutPtr& layout)
+    {
+        auto matrix = data->GetMatrix<ElementType>(rowColSplitPoint);
+        if (layout->GetNumCols() != matrix->GetNumCols())
+            LogicError("Bad MBLayout: The number of columns in the MBLayout does not match the number of columns in the data matrix!");
+
+        size_t numParallelSequences = layout->GetNumParallelSequences();
+        size_t maxNumTimeSteps = layout->GetNumTimeSteps();
+
+        // The [first column, number of columns] of each sequence in the matrix the views are created over
+        std::vector<std::pair<size_t, size_t>> sequenceColumns;
+        std::vector<ElementType> gatherIndicesVector;
+        for (const auto& sequenceInfo : layout->GetAllSequences())
+        {
+            if (sequenceInfo.seqId == GAP_SEQUENCE_ID)
+                continue;
+
+            size_t sequenceBeginIdx = (size_t)std::max<ptrdiff_t>(0, sequenceInfo.tBegin);
+            size_t sequenceLength = std::min(maxNumTimeSteps, sequenceInfo.tEnd) - sequenceBeginIdx;
+            if (numParallelSequences == 1)
+                sequenceColumns.push_back({ sequenceBeginIdx, sequenceLength });
+            else
+            {
+                sequenceColumns.push_back({ gatherIndicesVector.size(), sequenceLength });
+                for (size_t j = 0; j < sequenceLength; ++j)
+                    gatherIndicesVector.push_back((ElementType)(((sequenceBeginIdx + j) * numParallelSequences) + sequenceInfo.s));
+            }
+        }
+
+        std::shared_ptr<const Matrix<ElementType>> sequencesMatrix = matrix;
+        if (numParallelSequences != 1)
+        {
+            auto gatheredMatrix = std::make_shared<Matrix<ElementType>>(matrix->GetNumRows(), gatherIndicesVector.size(), matrix->GetDeviceId(), matrix->GetMatrixType(), matrix->GetFormat());
+            if (!gatherIndicesVector.empty())
+            {
+                Matrix<ElementType> gatherIdxMatrix(1, gatherIndicesVector.size(), gatherIndicesVector.data(), matrix->GetDeviceId());
+                gatheredMatrix->DoGatherColumnsOf(0, gatherIdxMatrix, *matrix, 1);
+            }
+
+            sequencesMatrix = gatheredMatrix;
+        }
+
+        std::vector<NDArrayViewPtr> sequenceViews;
+        for (const auto& columns : sequenceColumns)
+        {
+            NDShape sequenceShape = sampleShape.AppendShape({ columns.second });
+            auto tensorView = new TensorView<ElementType>(std::make_shared<Matrix<ElementType>>(sequencesMatrix->ColumnSlice(columns.first, columns.second)), AsTensorViewShape(sequenceShape));
+            sequenceViews.push_back(MakeSharedObject<NDArrayView>(AsDataType<ElementType>(), data->Device(), data->GetStorageFormat(), sequenceShape, data->IsReadOnly(), tensorView));
+        }
+
+        return sequenceViews;
+    }
+
     // Explicit template instantiations
     template /*static*/ CNTK_API ValuePtr Value::Create<float>(const NDShape& sampleShape, const std::vector<std::vector<float>>& sequences, const DeviceDescriptor& device, bool readOnly/* = false*/);
     template /*static*/ CNTK_API ValuePtr Value::Create<double>(const NDShape& sampleShape, const std::vector<std::vector<double>>& sequences, const DeviceDescriptor& device, bool readOnly/* = false*/);
     template /*static*/ CNTK_API ValuePtr Value::Create<float>(size_t vocabSize, const std::vector<std::vector<size_t>>& oneHotSequences, const DeviceDescriptor& device, bool readOnly/* = false*/);
     template /*static*/ CNTK_API ValuePtr Value::Create<double>(size_t vocabSize, const std::vector<std::vector<size_t>>& oneHotSequences, const DeviceDescriptor& device, bool readOnly/* = false*/);
+    template /*static*/ CNTK_API ValuePtr Value::CreatePacked<float>(const NDShape& sampleShape, const std::vector<std::vector<float>>& sequences, const DeviceDescriptor& device, bool readOnly/* = false*/);
+    template /*static*/ CNTK_API ValuePtr Value::CreatePacked<double>(const NDShape& sampleShape, const std::vector<std::vector<double>>& sequences, const DeviceDescriptor& device, bool readOnly/* = false*/);
+    template /*static*/ CNTK_API ValuePtr Value::CreatePacked<float>(size_t vocabSize, const std::vector<std::vector<size_t>>& oneHotSequences, const DeviceDescriptor& device, bool readOnly/* = false*/);
+    template /*static*/ CNTK_API ValuePtr Value::CreatePacked<double>(size_t vocabSize, const std::vector<std::vector<size_t>>& oneHotSequences, const DeviceDescriptor& device, bool readOnly/* = false*/);
 }
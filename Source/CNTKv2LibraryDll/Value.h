@@ -61,6 +61,8 @@ namespace CNTK
             return Value::Mask();
         }
 
+        std::vector<NDArrayViewPtr> SequenceViews(const NDShape& sampleShape) const override;
+
         ValuePtr DeepClone(bool readOnly) const override
         {
             if (m_isPacked)
@@ -96,6 +98,12 @@ namespace CNTK
             return { m_packedData->GetMatrix<ElementType>(), m_packedDataLayout };
         }
 
+        // Returns a view of each non-gap sequence of 'layout' over the columns of 'data' (viewed as a matrix split at 'rowColSplitPoint').
+        // The columns of a sequence are contiguous if the layout has a single parallel stream; otherwise all sequences are first
+        // gathered, one after another, into a new matrix.
+        template <typename ElementType>
+        static std::vector<NDArrayViewPtr> SequenceViews(const NDShape& sampleShape, const NDArrayViewPtr& data, size_t rowColSplitPoint, const Microsoft::MSR::CNTK::MBLayoutPtr& layout);
+
     private:
         PackedValue(const NDShape& sampleShape, const NDArrayViewPtr& packedData, const std::shared_ptr<Microsoft::MSR::CNTK::MBLayout>& packedDataLayout, bool isReadOnly)
             : Value(nullptr), m_isPacked(true), m_sampleShape(sampleShape), m_packedData(packedData), m_packedDataLayout(packedDataLayout), m_isReadOnly(isReadOnly)
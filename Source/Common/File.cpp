@@ -19,10 +19,12 @@
 #include "Windows.h"
 #include <VersionHelpers.h>
 #include <Shlwapi.h>
+#include <io.h>
 #pragma comment(lib, "Shlwapi.lib")
 #endif
 #ifdef __unix__
 #include <unistd.h>
+#include <sys/mman.h>
 #include <linux/limits.h> // for PATH_MAX
 #endif
 
@@ -85,6 +87,10 @@ void File::Init(const wchar_t* filename, int fileOptions)
 {
     m_filename = filename;
     m_options = fileOptions;
+    m_memoryBuffer = nullptr;
+    m_memoryBufferSize = 0;
+    m_mappingSize = 0;
+    m_alignedDataWritten = false;
     if (m_filename.empty())
         RuntimeError("File: filename is empty");
     const auto outputPipe = (m_filename.front() == '|');
@@ -145,6 +151,91 @@ void File::Init(const wchar_t* filename, int fileOptions)
                     m_file = fopenOrDie(filename, options.c_str());
                     m_seekable = true;
                 });
+
+    if ((fileOptions & fileOptionsMemoryMapped) && reading && !writing && m_seekable && !IsTextBased())
+        MapIntoMemory();
+}
+
+// map the whole file into memory, copy-on-write
+// Reading through the FILE* continues to work as before; ReadMapped() gives access to the mapping.
+void File::MapIntoMemory()
+{
+    size_t size = Size();
+    if (size == 0)
+        return;
+#ifdef _WIN32
+    HANDLE fileHandle = (HANDLE)_get_osfhandle(_fileno(m_file));
+    HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (!mappingHandle)
+        RuntimeError("File: failed to map '%S' into memory (error %d)", m_filename.c_str(), (int)GetLastError());
+    void* data = MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mappingHandle); // the view keeps the mapping alive
+    if (!data)
+        RuntimeError("File: failed to map a view of '%S' (error %d)", m_filename.c_str(), (int)GetLastError());
+    m_mapping = std::shared_ptr<void>(data, [](void* p) { UnmapViewOfFile(p); });
+#else
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(m_file), 0);
+    if (data == MAP_FAILED)
+        RuntimeError("File: failed to map '%S' into memory: %s", m_filename.c_str(), strerror(errno));
+    m_mapping = std::shared_ptr<void>(data, [size](void* p) { munmap(p, size); });
+#endif
+    m_mappingSize = size;
+}
+
+char* File::ReadMapped(size_t size)
+{
+    if (!m_mapping)
+        return nullptr;
+    uint64_t position = GetPosition();
+    if (position + size > m_mappingSize)
+        RuntimeError("File: attempted to read %d bytes past the end of '%S'", (int)(position + size - m_mappingSize), m_filename.c_str());
+    SetPosition(position + size);
+    return (char*)m_mapping.get() + position;
+}
+
+bool File::AlignsData()
+{
+    return (m_options & fileOptionsAlignedData) && !IsTextBased() && CanSeek();
+}
+
+size_t File::PaddingToAlignment(size_t headerSize)
+{
+    m_alignedDataWritten = true;
+    return (s_dataAlignment - (GetPosition() + headerSize) % s_dataAlignment) % s_dataAlignment;
+}
+
+// create a File that writes into memory
+// The buffer is owned by the File and can be accessed through GetMemoryBuffer() while the File lives.
+/*static*/ std::unique_ptr<File> File::CreateMemoryWriter(int fileOptions)
+{
+    if (fileOptions & fileOptionsRead)
+        RuntimeError("File: in-memory files can only be written");
+#ifdef _WIN32
+    RuntimeError("File: in-memory files are not supported on Windows");
+#else
+    std::unique_ptr<File> file(new File());
+    file->m_filename = L"<memory>";
+    file->m_options = fileOptions | fileOptionsWrite;
+    file->m_pcloseNeeded = false;
+    file->m_seekable = true;
+    file->m_memoryBuffer = nullptr;
+    file->m_memoryBufferSize = 0;
+    file->m_mappingSize = 0;
+    file->m_alignedDataWritten = false;
+    file->m_file = open_memstream(&file->m_memoryBuffer, &file->m_memoryBufferSize);
+    if (!file->m_file)
+        RuntimeError("File: failed to create in-memory file: %s", strerror(errno));
+    return file;
+#endif
+}
+
+const char* File::GetMemoryBuffer(size_t& size)
+{
+    if (m_filename != L"<memory>")
+        LogicError("File: GetMemoryBuffer() called on '%S', which is not an in-memory file", m_filename.c_str());
+    Flush(); // this updates m_memoryBuffer and m_memoryBufferSize
+    size = m_memoryBufferSize;
+    return m_memoryBuffer;
 }
 
 // determine the directory for a given pathname
@@ -275,6 +366,7 @@ File::~File(void)
             RuntimeError("File: failed to close file at %S", m_filename.c_str());
         }
     }
+    free(m_memoryBuffer); // (in-memory files only; nullptr otherwise)
 }
 
 void File::Flush()
@@ -15,5 +15,6 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 
     std::atomic<bool> Globals::m_enableShareNodeValueMatrices(false);
     std::atomic<bool> Globals::m_enableHyperCompressMemory(false);
+    std::atomic<bool> Globals::m_enableDirectConvolutionEngines(false);
 
 }}}
\ No newline at end of file
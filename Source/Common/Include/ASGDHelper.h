@@ -62,6 +62,7 @@ ASGDHelper<ElemType>* NewASGDHelper(
     double adjustCoef = 0.2,                                                 // see in DecayCoefficient()
     size_t adjustPerMinibatches = 600,                                       //
     int traceLevel = 0,                                                      // log level
-    int syncPerfStats = 0);                                                  // shown perf data every syncPerfStats
+    int syncPerfStats = 0,                                                   // shown perf data every syncPerfStats
+    size_t maxStaleness = 0);                                                // max #syncs a worker may be ahead of the slowest one (0: unbounded)
 
 }}}
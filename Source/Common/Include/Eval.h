@@ -42,6 +42,16 @@ public:
 
     //
     // Create a network based on an (NDL) network description.
+    // With optimizeForInference=true (here or in Init()), the network is rewritten for evaluation only: nodes not
+    // needed for outputNodeNames (default: the model's output nodes) are removed, batch normalization is folded into
+    // the preceding Times or Convolution, dropout is removed, parameter-only subgraphs are replaced by constants, and
+    // convolutions are fused with the following bias and ReLU, sigmoid or tanh. The network cannot be trained afterwards.
+    // With memoryMapModel=true, the model file given by modelPath is mapped into memory, and CPU parameters that were saved
+    // aligned (MEL: SaveModel(..., format=cntk_aligned)) are used in place; processes loading the same file share them.
+    // With parameterPrecision=float16 or bfloat16, the weights of Times nodes are stored in 16 bits (CPU only). The
+    // products are still computed in single precision; this mainly speeds up evaluation with small minibatches.
+    // With channelBlockSize=8 or 16, convolutional networks are evaluated with the channels stored in blocks of that
+    // size (NCHW8c resp. NCHW16c; CPU only). Values are reordered to CHW layout only where the convolutional part ends.
     //
     virtual void CreateNetwork(const std::string& networkDescription) = 0;
 
@@ -296,6 +306,27 @@ class VariableSchema : public std::vector<VariableLayout>
         }
 };
 
+//
+// A streaming session holds the state of the recurrent (PastValue) nodes of a model for one input stream, e.g. one audio
+// stream that is evaluated chunk by chunk as it arrives. Sessions are created by an evaluator and can only be used with it.
+//
+class IEvaluateSession
+{
+public:
+    //
+    // Reset - forget the history; the next chunk starts a new sequence.
+    //
+    virtual void Reset() = 0;
+
+    //
+    // Free resources
+    //
+    virtual void Destroy() = 0;
+
+protected:
+    virtual ~IEvaluateSession() {}
+};
+
 //
 // Extended interface, allowing for sparse input.
 // Implementation constraints: 
@@ -315,7 +346,9 @@ public:
 
     //
     // Allocate internal state for calling ForwardPass(). The call restricts the network (inputs and outputs)
-    // to the functions represented by the output name.
+    // to the functions represented by the output name. All outputs are computed in one traversal of the network,
+    // and, if Init() was given shareNodeValueMatrices=true, intermediate values are released as soon as no output
+    // needs them anymore.
     //
     virtual void StartForwardEvaluation(const std::vector<std::wstring>& outputs) = 0;
 
@@ -355,6 +388,40 @@ public:
     // resetRNN - flags whether to reset memory cells of RNN. 
     //
     virtual void ForwardPass(const ValueRefs<ElemType>& inputs, ValueRefs<ElemType>& output, bool resetRNN) = 0;
+
+    //
+    // Batched ForwardPass - Evaluate several independent (variable length) sequences in one minibatch, which is
+    // considerably more efficient than evaluating them one by one.
+    // inputs - for every sequence, a vector of input buffers as for ForwardPass() above
+    // outputs - for every sequence, a vector of output buffers. Must be sized to fit output schema and sequence length.
+    // RNN memory cells are reset at the beginning of every sequence.
+    //
+    virtual void ForwardPass(const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs) = 0;
+
+    //
+    // Same as above, but takes references to static arrays instead of std::vector 
+    //
+    virtual void ForwardPass(const std::vector<ValueRefs<ElemType>>& inputs, std::vector<ValueRefs<ElemType>>& outputs) = 0;
+
+    //
+    // CreateSession - create a streaming session for the outputs given to StartForwardEvaluation(). The model must not
+    // look into the future (FutureValue). Release the session through its Destroy() method.
+    //
+    virtual IEvaluateSession* CreateSession() = 0;
+
+    //
+    // Streaming ForwardPass - Evaluate the next chunk of several sessions in one minibatch. Every session continues from
+    // the state its previous chunk left behind, and afterwards holds the state at the end of this chunk.
+    // The RNN state that ForwardPass(..., resetRNN = false) carries over is not kept across this call.
+    // sessions - the sessions to advance; a session must not appear more than once
+    // inputs, outputs - for every session, the input and output buffers of its chunk, as for the batched ForwardPass() above
+    //
+    virtual void ForwardPass(const std::vector<IEvaluateSession*>& sessions, const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs) = 0;
+
+    //
+    // Same as above, but takes references to static arrays instead of std::vector 
+    //
+    virtual void ForwardPass(const std::vector<IEvaluateSession*>& sessions, const std::vector<ValueRefs<ElemType>>& inputs, std::vector<ValueRefs<ElemType>>& outputs) = 0;
 };
 
 template <typename ElemType>
@@ -362,4 +429,30 @@ void EVAL_API GetEvalExtended(IEvaluateModelExtended<ElemType>** peval);
 extern "C" EVAL_API void GetEvalExtendedF(IEvaluateModelExtended<float>** peval);
 extern "C" EVAL_API void GetEvalExtendedD(IEvaluateModelExtended<double>** peval);
 
+// ------------------------------------------------------------------------
+// Shared model for concurrent evaluation
+// ------------------------------------------------------------------------
+
+//
+// A model that is loaded once and evaluated from several threads. Every thread gets its own evaluator from
+// CreateEvaluator(); the evaluators share the parameters of the model read-only, and own only their activations.
+// An evaluator must not be used by two threads at the same time, but different evaluators can run concurrently.
+// Set numCPUThreads in the configuration to the number of cores per evaluator, as the BLAS thread count is process-wide.
+//
+template <typename ElemType>
+class IEvaluateModelShared : public IEvaluateModelBase<ElemType>
+{
+public:
+    //
+    // CreateEvaluator - create a light-weight evaluator over the shared parameters. This call is thread-safe.
+    // The evaluator keeps the parameters alive; it must be released through its Destroy() method.
+    //
+    virtual IEvaluateModelExtended<ElemType>* CreateEvaluator() = 0;
+};
+
+template <typename ElemType>
+void EVAL_API GetEvalShared(IEvaluateModelShared<ElemType>** peval);
+extern "C" EVAL_API void GetEvalSharedF(IEvaluateModelShared<float>** peval);
+extern "C" EVAL_API void GetEvalSharedD(IEvaluateModelShared<double>** peval);
+
 } } }
@@ -0,0 +1,326 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalBatchingQueue.h -- dynamic batching of single-sequence evaluation requests on top of IEvaluateModelExtended
+//
+// Callers submit one sequence at a time from any thread and get a future for its outputs. A scheduler thread
+// collects pending requests until either maxBatchSize requests are waiting or the oldest one has waited for
+// maxQueueDelay, and then evaluates them together with one batched ForwardPass().
+//
+// This header only depends on Eval.h, so that it can be used by clients of the evaluation library.
+//
+
+#pragma once
+
+#include "Eval.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Counters of an EvalBatchingQueue, see EvalBatchingQueue::GetStatistics().
+struct EvalBatchingStatistics
+{
+    size_t m_numRequests;          // requests completed so far
+    size_t m_numBatches;           // ForwardPass() calls so far
+    double m_meanBatchOccupancy;   // average batch size / maxBatchSize, in [0, 1]
+    double m_latencyP50Ms;         // median latency from Submit() until the result is available, in milliseconds
+    double m_latencyP99Ms;         // 99th percentile of the same
+};
+
+template <typename ElemType>
+class EvalBatchingQueue
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    //
+    // eval - evaluator on which StartForwardEvaluation() was already called. The queue does not take ownership,
+    //        but the evaluator must not be used otherwise while the queue exists.
+    // maxBatchSize - maximum number of sequences evaluated together
+    // maxQueueDelay - maximum time the oldest request waits for the batch to fill up
+    // latencyWindow - number of most recent requests the latency percentiles are computed over
+    //
+    EvalBatchingQueue(IEvaluateModelExtended<ElemType>* eval, size_t maxBatchSize, std::chrono::microseconds maxQueueDelay, size_t latencyWindow = 10000)
+        : m_eval(eval), m_maxBatchSize(maxBatchSize), m_maxQueueDelay(maxQueueDelay), m_stop(false),
+          m_numRequests(0), m_numBatches(0), m_latencyWindow(latencyWindow), m_nextLatency(0)
+    {
+        if (!eval)
+            throw std::invalid_argument("EvalBatchingQueue: evaluator must not be null.");
+        if (maxBatchSize == 0)
+            throw std::invalid_argument("EvalBatchingQueue: maxBatchSize must be at least 1.");
+        if (latencyWindow == 0)
+            throw std::invalid_argument("EvalBatchingQueue: latencyWindow must be at least 1.");
+
+        m_inputSchema = eval->GetInputSchema();
+        m_outputSchema = eval->GetOutputSchema();
+        m_scheduler = std::thread([this]() { Schedule(); });
+    }
+
+    // Evaluates all requests still pending, then stops the scheduler.
+    ~EvalBatchingQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wakeup.notify_one();
+        m_scheduler.join();
+    }
+
+    EvalBatchingQueue(const EvalBatchingQueue&) = delete;
+    EvalBatchingQueue& operator=(const EvalBatchingQueue&) = delete;
+
+    //
+    // Submit - queue one sequence for evaluation. Thread-safe.
+    // inputs - input buffers as for IEvaluateModelExtended::ForwardPass(); they are moved into the queue.
+    // Returns the output buffers of the sequence. Inputs that don't match the input schema are rejected here with
+    // std::invalid_argument; errors of the evaluation are reported through the future.
+    //
+    std::future<Values<ElemType>> Submit(Values<ElemType>&& inputs)
+    {
+        ValidateInputs(inputs);
+
+        std::unique_ptr<Request> request(new Request());
+        request->m_length = SequenceLength(inputs);
+        request->m_inputs = std::move(inputs);
+        request->m_submitTime = Clock::now();
+        auto result = request->m_result.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop)
+                throw std::runtime_error("EvalBatchingQueue: Submit() called on a queue that is shutting down.");
+            m_pending.push_back(std::move(request));
+        }
+        m_wakeup.notify_one();
+        return result;
+    }
+
+    EvalBatchingStatistics GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_statisticsMutex);
+        EvalBatchingStatistics statistics;
+        statistics.m_numRequests = m_numRequests;
+        statistics.m_numBatches = m_numBatches;
+        statistics.m_meanBatchOccupancy = m_numBatches == 0 ? 0 : (double)m_numRequests / (m_numBatches * m_maxBatchSize);
+        std::vector<double> latencies(m_latenciesMs);
+        statistics.m_latencyP50Ms = Percentile(latencies, 0.50);
+        statistics.m_latencyP99Ms = Percentile(latencies, 0.99);
+        return statistics;
+    }
+
+    void ResetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_statisticsMutex);
+        m_numRequests = 0;
+        m_numBatches = 0;
+        m_latenciesMs.clear();
+        m_nextLatency = 0;
+    }
+
+private:
+    struct Request
+    {
+        Values<ElemType> m_inputs;
+        size_t m_length;
+        Clock::time_point m_submitTime;
+        std::promise<Values<ElemType>> m_result;
+    };
+
+    // checks the buffers of a sequence against the input schema, so that a malformed request fails on its own
+    // instead of failing the batch it would be evaluated with
+    void ValidateInputs(const Values<ElemType>& inputs) const
+    {
+        if (inputs.size() != m_inputSchema.size())
+            throw std::invalid_argument("EvalBatchingQueue: number of inputs does not match the input schema.");
+
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            const auto& layout = m_inputSchema[i];
+            const auto& input = inputs[i];
+            if (layout.m_storageType == VariableLayout::Sparse)
+            {
+                const auto& colIndices = input.m_colIndices;
+                if (colIndices.size() < 2 || colIndices.front() != 0 || (size_t)colIndices.back() != input.m_buffer.size() ||
+                    input.m_indices.size() != input.m_buffer.size())
+                    throw std::invalid_argument("EvalBatchingQueue: sparse input with inconsistent buffer, indices and column indices.");
+                for (size_t j = 1; j < colIndices.size(); ++j)
+                {
+                    if (colIndices[j] < colIndices[j - 1])
+                        throw std::invalid_argument("EvalBatchingQueue: sparse input with descending column indices.");
+                }
+                for (int index : input.m_indices)
+                {
+                    if (index < 0 || (size_t)index >= layout.m_numElements)
+                        throw std::invalid_argument("EvalBatchingQueue: sparse input with an index outside of the input dimension.");
+                }
+            }
+            else if (input.m_buffer.empty() || input.m_buffer.size() % std::max<size_t>(layout.m_numElements, 1) != 0)
+                throw std::invalid_argument("EvalBatchingQueue: dense input whose size is not a positive multiple of the input dimension.");
+        }
+    }
+
+    // number of samples of a sequence: the longest of its inputs (outputs are allocated per sample)
+    size_t SequenceLength(const Values<ElemType>& inputs) const
+    {
+        size_t length = 1;
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            const auto& layout = m_inputSchema[i];
+            size_t inputLength = layout.m_storageType == VariableLayout::Sparse
+                                     ? (inputs[i].m_colIndices.empty() ? 0 : inputs[i].m_colIndices.size() - 1)
+                                     : inputs[i].m_buffer.size() / std::max<size_t>(layout.m_numElements, 1);
+            length = std::max(length, inputLength);
+        }
+        return length;
+    }
+
+    static double Percentile(std::vector<double>& values, double fraction)
+    {
+        if (values.empty())
+            return 0;
+        auto nth = values.begin() + (size_t)(fraction * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), nth, values.end());
+        return *nth;
+    }
+
+    void Schedule()
+    {
+        std::vector<std::unique_ptr<Request>> batch;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeup.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+                if (m_pending.empty())
+                    return; // stopped and drained
+
+                // give the batch until the oldest request's deadline to fill up; don't wait when shutting down
+                auto deadline = m_pending.front()->m_submitTime + m_maxQueueDelay;
+                m_wakeup.wait_until(lock, deadline, [this]() { return m_stop || m_pending.size() >= m_maxBatchSize; });
+
+                // oldest first, so that no request is starved
+                size_t batchSize = std::min(m_pending.size(), m_maxBatchSize);
+                for (size_t i = 0; i < batchSize; ++i)
+                {
+                    batch.push_back(std::move(m_pending.front()));
+                    m_pending.pop_front();
+                }
+            }
+
+            EvaluateBatch(batch);
+            batch.clear();
+        }
+    }
+
+    void EvaluateBatch(std::vector<std::unique_ptr<Request>>& batch)
+    {
+        // Longest first: the batched ForwardPass() packs sequences into parallel streams in the given order,
+        // and this lets the short ones fill the gaps behind the long ones, which limits padding.
+        std::stable_sort(batch.begin(), batch.end(), [](const std::unique_ptr<Request>& a, const std::unique_ptr<Request>& b)
+        {
+            return a->m_length > b->m_length;
+        });
+
+        bool staged = false;
+        try
+        {
+            m_inputs.resize(batch.size());
+            m_outputs.resize(batch.size());
+            for (size_t seq = 0; seq < batch.size(); ++seq)
+            {
+                m_inputs[seq] = std::move(batch[seq]->m_inputs);
+                m_outputs[seq].resize(m_outputSchema.size());
+                for (size_t i = 0; i < m_outputSchema.size(); ++i)
+                {
+                    m_outputs[seq][i].m_buffer.clear();
+                    m_outputs[seq][i].m_buffer.reserve(m_outputSchema[i].m_numElements * batch[seq]->m_length);
+                }
+            }
+
+            staged = true;
+            m_eval->ForwardPass(m_inputs, m_outputs);
+        }
+        catch (...)
+        {
+            // Submit() rejects malformed inputs, but in case a request still fails, evaluate the requests one by one,
+            // so that the error only reaches the futures of the ones that fail.
+            if (staged && batch.size() > 1)
+            {
+                for (size_t seq = 0; seq < batch.size(); ++seq)
+                    batch[seq]->m_inputs = std::move(m_inputs[seq]);
+                std::vector<std::unique_ptr<Request>> single(1);
+                for (auto& request : batch)
+                {
+                    single[0] = std::move(request);
+                    EvaluateBatch(single);
+                }
+                return;
+            }
+
+            for (auto& request : batch)
+                request->m_result.set_exception(std::current_exception());
+            RecordBatch(batch);
+            return;
+        }
+
+        for (size_t seq = 0; seq < batch.size(); ++seq)
+            batch[seq]->m_result.set_value(std::move(m_outputs[seq]));
+        RecordBatch(batch);
+    }
+
+    void RecordBatch(const std::vector<std::unique_ptr<Request>>& batch)
+    {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(m_statisticsMutex);
+        m_numBatches++;
+        m_numRequests += batch.size();
+        for (const auto& request : batch)
+        {
+            double latencyMs = std::chrono::duration<double, std::milli>(now - request->m_submitTime).count();
+            if (m_latenciesMs.size() < m_latencyWindow)
+                m_latenciesMs.push_back(latencyMs);
+            else
+                m_latenciesMs[m_nextLatency] = latencyMs;
+            m_nextLatency = (m_nextLatency + 1) % m_latencyWindow;
+        }
+    }
+
+    IEvaluateModelExtended<ElemType>* m_eval;
+    VariableSchema m_inputSchema;
+    VariableSchema m_outputSchema;
+    const size_t m_maxBatchSize;
+    const std::chrono::microseconds m_maxQueueDelay;
+
+    // pending requests, guarded by m_mutex
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<std::unique_ptr<Request>> m_pending;
+    bool m_stop;
+
+    // staging buffers of the scheduler thread
+    std::vector<Values<ElemType>> m_inputs;
+    std::vector<Values<ElemType>> m_outputs;
+
+    // counters, guarded by m_statisticsMutex
+    mutable std::mutex m_statisticsMutex;
+    size_t m_numRequests;
+    size_t m_numBatches;
+    const size_t m_latencyWindow;
+    std::vector<double> m_latenciesMs; // ring buffer of the most recent latencies
+    size_t m_nextLatency;
+
+    std::thread m_scheduler;
+};
+
+}}}
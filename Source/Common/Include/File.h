@@ -19,6 +19,7 @@
 #include "fileutil.h" // for f{ge,pu}t{,Text}()
 #include <fstream>    // for LoadMatrixFromTextFile() --TODO: change to using this File class
 #include <sstream>
+#include <memory>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -35,6 +36,8 @@ enum FileOptions
     fileOptionsWrite = 16,                                      // open in write mode
     fileOptionsSequential = 32,                                 // optimize for sequential reads (allocates big buffer)
     fileOptionsReadWrite = fileOptionsRead | fileOptionsWrite,  // read/write mode
+    fileOptionsMemoryMapped = 64,                               // read: also map the file into memory, so that aligned data can be used in place (see ReadMapped())
+    fileOptionsAlignedData = 128,                               // write: align the data of dense matrices, so that they can be used in place from a memory-mapped file
 };
 
 // markers used for text files
@@ -99,7 +102,14 @@ private:
     bool m_pcloseNeeded; // was opened with popen(), use pclose() when destructing
     bool m_seekable;     // this stream is seekable
     int m_options;       // FileOptions ored togther
+    char* m_memoryBuffer;       // for in-memory files (CreateMemoryWriter()): the buffer written to
+    size_t m_memoryBufferSize;
+    std::shared_ptr<void> m_mapping; // for fileOptionsMemoryMapped: the whole file, mapped copy-on-write
+    size_t m_mappingSize;
+    bool m_alignedDataWritten;       // PaddingToAlignment() was called, i.e. data was written aligned
     void Init(const wchar_t* filename, int fileOptions);
+    void MapIntoMemory();
+    File() {} // (used by CreateMemoryWriter())
 
 public:
     File(const std::wstring& filename, int fileOptions);
@@ -107,6 +117,12 @@ public:
     File(const wchar_t* filename, int fileOptions);
     ~File();
 
+    // create a File that writes into a growing memory buffer instead of to disk,
+    // e.g. to take a serialized snapshot that is persisted later by a background thread
+    static std::unique_ptr<File> CreateMemoryWriter(int fileOptions);
+    // for in-memory files: flush and return the bytes written so far (owned by this object)
+    const char* GetMemoryBuffer(size_t& size);
+
     void Flush();
 
     bool CanSeek() const { return m_seekable; }
@@ -117,6 +133,20 @@ public:
 
     bool IsTextBased();
 
+    // aligned data (fileOptionsAlignedData)
+    // Data is aligned relative to the start of the file. This is only possible for seekable binary files.
+    static const size_t s_dataAlignment = 64; // cache line; also a multiple of the size of all element types
+    bool AlignsData();
+    size_t PaddingToAlignment(size_t headerSize); // number of padding bytes to write so that data following the padding and a header of headerSize bytes is aligned
+    bool HasWrittenAlignedData() const { return m_alignedDataWritten; }
+
+    // memory-mapped reading (fileOptionsMemoryMapped)
+    // ReadMapped() skips the next 'size' bytes and returns a pointer to them inside the mapping, or nullptr if the file is not mapped.
+    // The mapping is copy-on-write: pages are shared with the page cache, and thus with other processes that map the same file,
+    // until they are modified. The pointer is only valid as long as a reference to GetMemoryMapping() is held.
+    char* ReadMapped(size_t size);
+    std::shared_ptr<void> GetMemoryMapping() const { return m_mapping; }
+
     bool IsUnicodeBOM(bool skip = false);
     bool IsEOF();
     bool IsWhiteSpace(bool skip = false);
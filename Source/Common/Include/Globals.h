@@ -42,12 +42,24 @@ namespace Microsoft { namespace MSR { namespace CNTK {
             return m_enableHyperCompressMemory;
         }
 
+        static void EnableDirectConvolutionEngines()
+        {
+            m_enableDirectConvolutionEngines = true;
+        }
+
+        static bool ShouldEnableDirectConvolutionEngines()
+        {
+            return m_enableDirectConvolutionEngines;
+        }
+
     private:
         static std::atomic<bool> m_forceDeterministicAlgorithms;
         // The global flag to enable matrices values in forward and backward prop
         static std::atomic<bool> m_enableShareNodeValueMatrices;
         // The global flag to enable hyper memory compression 
         static std::atomic<bool> m_enableHyperCompressMemory;
+        // The global flag to let convolution nodes pick the direct and Winograd CPU engines
+        static std::atomic<bool> m_enableDirectConvolutionEngines;
         static std::atomic<bool> m_forceConstantRandomSeed;
     };
 }}}
@@ -464,6 +464,12 @@ public:
         MPI_Allgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator()) || MpiFail("AllReduceAsync: MPI_Allgather");
     }
 
+    template <class ElemType>
+    void AllGatherv(const ElemType *sendData, size_t numSendElements, ElemType *receiveData, int recvCounts[], int offsets[]) const
+    {
+        MPI_Allgatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), Communicator()) || MpiFail("AllGatherv: MPI_Allgatherv");
+    }
+
     template <class ElemType>
     void AllReduceAsync(ElemType *sendData, ElemType *receiveData, size_t numElements, MPI_Request* request, MPI_Op op = MPI_SUM) const
     {
@@ -488,6 +494,19 @@ public:
         MPI_Gatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gatherv");
     }
 
+    // each rank sends 'numElementsPerNode' elements to every rank (including itself)
+    template <class ElemType>
+    void AllToAll(const ElemType *sendData, size_t numElementsPerNode, ElemType *receiveData) const
+    {
+        MPI_Alltoall(sendData, (int)numElementsPerNode, GetDataType(receiveData), receiveData, (int)numElementsPerNode, GetDataType(receiveData), Communicator()) || MpiFail("AllToAll: MPI_Alltoall");
+    }
+
+    template <class ElemType>
+    void AllToAllv(const ElemType *sendData, int sendCounts[], int sendOffsets[], ElemType *receiveData, int recvCounts[], int recvOffsets[]) const
+    {
+        MPI_Alltoallv(sendData, sendCounts, sendOffsets, GetDataType(receiveData), receiveData, recvCounts, recvOffsets, GetDataType(receiveData), Communicator()) || MpiFail("AllToAllv: MPI_Alltoallv");
+    }
+
     template <class ElemType>
     void Bcast(ElemType *pData, size_t nData, size_t srcRank)
     {
@@ -0,0 +1,262 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// BlockedLayoutNodes.h -- nodes that evaluate convolutional networks on the CPU with the channels stored in blocks
+// (NCHW8c, NCHW16c); see ComputationNetwork::ConvertToBlockedLayout()
+//
+#pragma once
+
+#include "Basics.h"
+#include "Matrix.h"
+#include "ComputationNode.h"
+#include "ConvolutionalNodes.h"
+#include "CPUConvolution.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// ChannelBlockReorderNode (input)
+// Converts samples [(spatial dims) x C] in CHW layout into the channel-blocked layout [B x (spatial dims) x C/B], or
+// back. See CPUConvolution for the layout. Element-wise operations, and pooling with a kernel of 1 in the B axis, can
+// be applied to channel-blocked tensors as they are.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class ChannelBlockReorderNode : public ComputationNode<ElemType>, public NumInputs<1>
+{
+    typedef ComputationNode<ElemType> Base; UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName() { return L"ChannelBlockReorder"; }
+
+public:
+    DeclareConstructorFromConfigWithNumInputs(ChannelBlockReorderNode);
+    ChannelBlockReorderNode(DEVICEID_TYPE deviceId, const wstring& name, size_t blockSize = 8, bool toBlocked = true)
+        : Base(deviceId, name), m_blockSize(blockSize), m_toBlocked(toBlocked)
+    {
+    }
+
+    void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        fstream << m_blockSize << m_toBlocked;
+    }
+
+    void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        fstream >> m_blockSize >> m_toBlocked;
+    }
+
+    void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<ChannelBlockReorderNode<ElemType>>(nodeP);
+            node->m_blockSize = m_blockSize;
+            node->m_toBlocked = m_toBlocked;
+        }
+    }
+
+    // [(spatial dims) x C] -> [B x (spatial dims) x C/B], or an empty shape if 'shape' can't be blocked
+    static TensorShape BlockedShape(const TensorShape& shape, size_t blockSize)
+    {
+        if (shape.GetRank() < 2 || shape.GetDims().back() % blockSize != 0)
+            return TensorShape();
+        SmallVector<size_t> dims(1, blockSize);
+        for (size_t i = 0; i < shape.GetRank(); i++)
+            dims.push_back(shape[i]);
+        dims.back() /= blockSize;
+        return TensorShape(dims);
+    }
+
+    // [B x (spatial dims) x C/B] -> [(spatial dims) x C], or an empty shape if 'shape' is not blocked by B
+    static TensorShape UnblockedShape(const TensorShape& shape, size_t blockSize)
+    {
+        if (shape.GetRank() < 3 || shape[0] != blockSize)
+            return TensorShape();
+        SmallVector<size_t> dims;
+        for (size_t i = 1; i < shape.GetRank(); i++)
+            dims.push_back(shape[i]);
+        dims.back() *= blockSize;
+        return TensorShape(dims);
+    }
+
+    void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        if (Value().GetDeviceId() != CPUDEVICE)
+            LogicError("%ls %ls operation: The channel-blocked layout is only implemented on the CPU.", NodeName().c_str(), OperationName().c_str());
+
+        auto input = InputRef(0).ValueFor(fr);
+        auto result = ValueFor(fr);
+        const auto& plainShape = m_toBlocked ? GetInputSampleLayout(0) : GetSampleLayout();
+        size_t channels = plainShape.GetDims().back();
+        size_t spatialSize = plainShape.GetNumElements() / channels;
+        if (m_toBlocked)
+            CPUConvolution::ToChannelBlocked(input.Data(), spatialSize, channels, m_blockSize, input.GetNumCols(), result.Data());
+        else
+            CPUConvolution::FromChannelBlocked(input.Data(), spatialSize, channels, m_blockSize, input.GetNumCols(), result.Data());
+    }
+
+    void /*ComputationNode::*/ BackpropTo(const size_t /*inputIndex*/, const FrameRange& /*fr*/) override
+    {
+        LogicError("%ls %ls operation: Channel-blocked nodes can only be used for evaluation.", NodeName().c_str(), OperationName().c_str());
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+
+    void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase(isFinalValidationPass);
+
+        if (!CPUConvolution::IsChannelBlockSupported(m_blockSize))
+            InvalidArgument("%ls %ls operation: Unsupported channel block size %d, expected 8 or 16.", NodeName().c_str(), OperationName().c_str(), (int)m_blockSize);
+
+        const auto& inputShape = GetInputSampleLayout(0);
+        auto outputShape = m_toBlocked ? BlockedShape(inputShape, m_blockSize) : UnblockedShape(inputShape, m_blockSize);
+        if (outputShape.GetRank() == 0)
+            InvalidArgument("%ls %ls operation: The input [%s] can't be %s with a channel block size of %d.", NodeName().c_str(), OperationName().c_str(),
+                            string(inputShape).c_str(), m_toBlocked ? "blocked" : "unblocked", (int)m_blockSize);
+        SetDims(outputShape, HasMBLayout());
+    }
+
+private:
+    size_t m_blockSize;
+    bool m_toBlocked;
+};
+
+template class ChannelBlockReorderNode<float>;
+template class ChannelBlockReorderNode<double>;
+
+// -----------------------------------------------------------------------
+// BlockedConvolutionNode (W, input[, bias])
+// Replacement of ConvolutionNode (W, input), or FusedConvolutionNode (W, input[, bias]), for 2D convolutions in "cudnn" (CHW) layout with full weight sharing,
+// whose output is computed in channel-blocked layout [B x W' x H' x K/B]. The input is either channel-blocked as
+// well, or in plain CHW layout, which saves the reorder after a network input. W holds the kernel reordered by
+// CPUConvolution::BlockKernel() as [B x X x Y x C x K/B]. The geometry parameters are those of the original node. The
+// optional bias holds one value per output map in the original order; it and the activation are applied in the
+// epilogue of the convolution.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class BlockedConvolutionNode : public ConvolutionNodeBase<ElemType>
+{
+    typedef ConvolutionNodeBase<ElemType> Base; UsingConvolutionNodeBaseMembers;
+    static const std::wstring TypeName() { return L"BlockedConvolution"; }
+
+public:
+    DeclareConstructorFromConfig(BlockedConvolutionNode);
+    BlockedConvolutionNode(DEVICEID_TYPE deviceId, const wstring& name)
+        : Base(deviceId, name), m_blockSize(8), m_inputBlocked(false), m_activation(FusedActivation::None)
+    {
+    }
+    BlockedConvolutionNode(DEVICEID_TYPE deviceId, const wstring& name, const TensorShape& kernelShape, const TensorShape& mapCount, const TensorShape& strideShape,
+                           const std::vector<bool>& sharing, const std::vector<bool>& autoPadding, const TensorShape& lowerPad, const TensorShape& upperPad,
+                           size_t blockSize, bool inputBlocked, FusedActivation activation = FusedActivation::None)
+        : Base(deviceId, name, kernelShape, mapCount, strideShape, sharing, autoPadding, lowerPad, upperPad, PoolKind::None, false, ImageLayoutKind::CHW, 0),
+          m_blockSize(blockSize), m_inputBlocked(inputBlocked), m_activation(activation)
+    {
+    }
+
+    void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        fstream << m_blockSize << m_inputBlocked << (int32_t)m_activation;
+    }
+
+    void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        int32_t activation;
+        fstream >> m_blockSize >> m_inputBlocked >> activation;
+        m_activation = (FusedActivation)activation;
+    }
+
+    void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<BlockedConvolutionNode<ElemType>>(nodeP);
+            node->m_blockSize = m_blockSize;
+            node->m_inputBlocked = m_inputBlocked;
+            node->m_activation = m_activation;
+        }
+    }
+
+    void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        if (Value().GetDeviceId() != CPUDEVICE)
+            LogicError("%ls %ls operation: The channel-blocked layout is only implemented on the CPU.", NodeName().c_str(), OperationName().c_str());
+
+        auto input = InputRef(1).ValueFor(fr);
+        auto result = ValueFor(fr);
+        if (input.GetMatrixType() != MatrixType::DENSE)
+            RuntimeError("%ls %ls operation: The channel-blocked layout requires a dense input.", NodeName().c_str(), OperationName().c_str());
+        ConvolutionEpilogue<ElemType> epilogue(HasBias() ? InputRef(2).Value().Data() : nullptr, m_activation);
+        CPUConvolution::BlockedForward(m_shape, m_blockSize, m_inputBlocked, input.Data(), InputRef(0).Value().Data(), result.Data(), input.GetNumCols(), epilogue);
+    }
+
+    void /*ComputationNode::*/ BackpropTo(const size_t /*inputIndex*/, const FrameRange& /*fr*/) override
+    {
+        LogicError("%ls %ls operation: Channel-blocked nodes can only be used for evaluation.", NodeName().c_str(), OperationName().c_str());
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+
+    void Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase(isFinalValidationPass);
+
+        if (!CPUConvolution::IsChannelBlockSupported(m_blockSize))
+            InvalidArgument("%ls %ls operation: Unsupported channel block size %d, expected 8 or 16.", NodeName().c_str(), OperationName().c_str(), (int)m_blockSize);
+
+        if (GetNumInputs() != 2 && GetNumInputs() != 3)
+            InvalidArgument("%ls %ls operation: Expected 2 or 3 inputs (weights, input and optional bias).", NodeName().c_str(), OperationName().c_str());
+
+        // the geometry is that of the convolution in plain CHW layout
+        TensorShape inputShape = GetInputSampleLayout(1);
+        if (m_inputBlocked)
+            inputShape = ChannelBlockReorderNode<ElemType>::UnblockedShape(inputShape, m_blockSize);
+        auto outputShape = ConvolveGeometry::ComputeOutputShape(inputShape, m_kernelShape, m_mapCount, m_stride,
+                                                               m_sharing, m_autoPad, m_lowerPad, m_upperPad);
+        auto blockedOutputShape = ChannelBlockReorderNode<ElemType>::BlockedShape(outputShape, m_blockSize);
+        if (outputShape.GetRank() != 3 || blockedOutputShape.GetRank() == 0)
+            InvalidArgument("%ls %ls operation: The output [%s] is not a 2D image whose channels can be blocked by %d.",
+                            NodeName().c_str(), OperationName().c_str(), string(outputShape).c_str(), (int)m_blockSize);
+        SetDims(blockedOutputShape, HasMBLayout());
+
+        if (isFinalValidationPass)
+        {
+            ConvolveGeometry geometry(inputShape, m_kernelShape, m_mapCount, m_stride, m_sharing, m_autoPad, m_lowerPad, m_upperPad);
+            if (!Convolution2DShape::TryCreate(geometry, m_shape))
+                InvalidArgument("%ls %ls operation: The convolution geometry is not supported in channel-blocked layout.", NodeName().c_str(), OperationName().c_str());
+            if (Input(0)->GetSampleLayout().GetNumElements() != m_shape.KernelSize() * m_shape.m_mapCount)
+                InvalidArgument("%ls %ls operation: The kernel [%s] doesn't match the convolution geometry.",
+                                NodeName().c_str(), OperationName().c_str(), string(Input(0)->GetSampleLayout()).c_str());
+            if (HasBias() && (Input(2)->HasMBLayout() || Input(2)->GetSampleLayout().GetNumElements() != m_shape.m_mapCount))
+                InvalidArgument("%ls %ls operation: The bias [%s] must hold one value per output map.",
+                                NodeName().c_str(), OperationName().c_str(), string(Input(2)->GetSampleLayout()).c_str());
+        }
+    }
+
+    size_t BlockSize() const { return m_blockSize; }
+    bool IsInputBlocked() const { return m_inputBlocked; }
+    bool HasBias() const { return GetNumInputs() > 2; }
+    FusedActivation Activation() const { return m_activation; }
+
+private:
+    size_t m_blockSize;
+    bool m_inputBlocked;
+    FusedActivation m_activation;
+    Convolution2DShape m_shape;
+};
+
+template class BlockedConvolutionNode<float>;
+template class BlockedConvolutionNode<double>;
+
+}}}
@@ -19,6 +19,8 @@
 #include "PreComputeNodes.h"
 #include "EvaluationNodes.h"
 #include "SpecialPurposeNodes.h"
+#include "QuantizedNodes.h"
+#include "BlockedLayoutNodes.h"
 #include "DeprecatedNodes.h" // (for SaveToDbnFile(), which is also deprecated)
 #include "MPIWrapper.h" // TODO: does not belong here
 #include <string>
@@ -108,11 +110,20 @@ void ComputationNetwork::SaveToFileImpl(const wstring& fileName, const FileOptio
     File fstream(fileName, fileFormat | FileOptions::fileOptionsWrite);
     // Buffer writes in memory then flush to filesystem, which reduces number of small writes
     fstream.Setvbuf();
+    Save(fstream);
+}
+
+void ComputationNetwork::Save(File& fstream) const
+{
+    VerifyIsCompiled("Save");
     fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCN");
 
     // model version
+    // Models without aligned matrices are written as version 15, so that they remain readable by older versions.
+    // If a node writes an aligned matrix, the version is patched to 16 at the end (aligned files are seekable).
     fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion");
-    fstream << (size_t) CURRENT_CNTK_MODEL_VERSION;
+    uint64_t versionPosition = fstream.AlignsData() ? fstream.GetPosition() : 0;
+    fstream << (size_t) CNTK_MODEL_VERSION_15;
     fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
 
     fstream << (size_t) m_nameToNodeMap.size();
@@ -193,6 +204,14 @@ void ComputationNetwork::SaveToFileImpl(const wstring& fileName, const FileOptio
 
     fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECN");
 
+    if (fstream.AlignsData() && fstream.HasWrittenAlignedData())
+    {
+        uint64_t endPosition = fstream.GetPosition();
+        fstream.SetPosition(versionPosition);
+        fstream << (size_t) CNTK_MODEL_VERSION_16;
+        fstream.SetPosition(endPosition);
+    }
+
     fstream.Flush();
 }
 
@@ -246,6 +265,7 @@ void ComputationNetwork::ReadPersistableParameters(File& fstream, bool create)
             AddNodeToNet(node);
         else                      // reloaded existing
         {
+            node->BumpEvalTimeStamp(); // the value changed, e.g. invalidates kernel transforms cached by convolution engines
             let old = node->GetSampleLayout();
             let changed = ValidateNode(node, /*isFinalValidationPass=*/true);
             if (changed)
@@ -264,11 +284,11 @@ void ComputationNetwork::ReadPersistableParameters(File& fstream, bool create)
 // deserialize the model
 // This does not post-process the model (CompileNetwork()). Use Load() instead.
 template <class ElemType> // for ReadPersistableParameters()
-void ComputationNetwork::Read(const wstring& fileName)
+void ComputationNetwork::Read(const wstring& fileName, bool memoryMapped)
 {
     ClearNetwork();
 
-    File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+    File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead | (memoryMapped ? FileOptions::fileOptionsMemoryMapped : 0));
 
     ReadPersistableParameters<ElemType>(fstream, true);
 
@@ -1139,6 +1159,620 @@ void ComputationNetwork::PerformSVDecomposition(const map<wstring, float>& SVDCo
     CompileNetwork();
 }
 
+// ========================================
+// Inference-only compilation
+// This rewrites the network for evaluating the given output nodes:
+//  - nodes not needed for the outputs are removed (criteria, evaluation nodes, unused inputs)
+//  - precomputed statistics (e.g. Mean, InvStdDev) are frozen into constants
+//  - subgraphs that only depend on parameters are evaluated once and replaced by a constant
+//  - dropout nodes are bypassed (they are the identity in inference)
+//  - BatchNormalization is folded into the preceding Times or Convolution (and its bias, if any)
+//  - no parameter needs a gradient
+// The network must have been compiled, and must not be used for training afterwards.
+// ========================================
+
+// copy of a Matrix in host memory, in column-major order
+template <class ElemType>
+static vector<ElemType> CopyToHost(const Matrix<ElemType>& matrix)
+{
+    vector<ElemType> result(matrix.GetNumElements());
+    ElemType* data = result.data();
+    size_t size = result.size();
+    if (size > 0)
+        matrix.CopyToArray(data, size);
+    return result;
+}
+
+template <class ElemType>
+static void CopyFromHost(Matrix<ElemType>& matrix, vector<ElemType>& data)
+{
+    if (data.size() != matrix.GetNumElements())
+        LogicError("CopyFromHost: Expected %d elements, got %d.", (int)matrix.GetNumElements(), (int)data.size());
+    matrix.SetValue(matrix.GetNumRows(), matrix.GetNumCols(), matrix.GetDeviceId(), data.data());
+}
+
+// rough cost of running a network for inference, for reporting what OptimizeForInference() saved
+struct InferenceCost
+{
+    size_t m_numNodes;
+    double m_modelBytes;               // values that do not depend on the input: parameters, precomputed and constant nodes
+    double m_activationBytesPerSample; // values of all computed nodes, without memory sharing
+    double m_flopsPerSample;           // nodes without MBLayout are only computed once, and not counted
+};
+
+template <class ElemType>
+static InferenceCost EstimateInferenceCost(const vector<ComputationNodeBasePtr>& nodes)
+{
+    InferenceCost cost = { nodes.size(), 0, 0, 0 };
+    for (const auto& node : nodes)
+    {
+        double numElements = (double)node->GetSampleLayout().GetNumElements();
+        if (!node->HasMBLayout())
+        {
+            cost.m_modelBytes += numElements * sizeof(ElemType);
+            continue;
+        }
+        if (node->IsLeaf()) // input
+            continue;
+
+        cost.m_activationBytesPerSample += numElements * sizeof(ElemType);
+
+        const auto& op = node->OperationName();
+        auto convolution = dynamic_pointer_cast<ConvolutionNode<ElemType>>(node);
+        if ((op == OperationNameOf(TimesNode) || op == OperationNameOf(TransposeTimesNode)) && !node->Input(0)->HasMBLayout())
+            cost.m_flopsPerSample += 2.0 * node->Input(0)->GetSampleLayout().GetNumElements(); // one multiply-add per weight
+        else if (convolution)
+            cost.m_flopsPerSample += 2.0 * convolution->KernelShape().GetNumElements() *
+                                     (convolution->Transpose() ? node->Input(1)->GetSampleLayout().GetNumElements() : numElements);
+        else if (auto fusedConvolution = dynamic_pointer_cast<FusedConvolutionNode<ElemType>>(node))
+            cost.m_flopsPerSample += (2.0 * fusedConvolution->KernelShape().GetNumElements() + 2.0) * numElements; // plus bias and activation
+        else if (op == OperationNameOf(BatchNormalizationNode))
+            cost.m_flopsPerSample += 4.0 * numElements; // subtract mean, divide by standard deviation, scale, shift
+        else
+            cost.m_flopsPerSample += numElements;
+    }
+    return cost;
+}
+
+// can this node be replaced by its value when all its inputs are constant?
+// Only side-effect-free operations that do not need temporary memory.
+static bool IsConstantFoldable(const ComputationNodeBasePtr& node)
+{
+    static const set<wstring> foldableOperations =
+    {
+        OperationNameOf(PlusNode), OperationNameOf(MinusNode), OperationNameOf(ElementTimesNode),
+        OperationNameOf(TimesNode), OperationNameOf(TransposeTimesNode),
+        OperationNameOf(NegateNode), OperationNameOf(SqrtNode), OperationNameOf(ExpNode), OperationNameOf(LogNode),
+        OperationNameOf(ReciprocalNode), OperationNameOf(AbsNode),
+        OperationNameOf(SigmoidNode), OperationNameOf(TanhNode), OperationNameOf(RectifiedLinearNode),
+        OperationNameOf(ReshapeNode), OperationNameOf(SliceNode), OperationNameOf(TransposeDimensionsNode)
+    };
+    if (node->IsLeaf() || node->HasMBLayout() || foldableOperations.find(node->OperationName()) == foldableOperations.end())
+        return false;
+
+    // don't fold if the result is larger than its inputs, e.g. the product of a low-rank factorization
+    size_t numInputElements = 0;
+    for (const auto& input : node->GetInputs())
+    {
+        if (input->OperationName() != OperationNameOf(LearnableParameter))
+            return false;
+        numInputElements += input->GetSampleLayout().GetNumElements();
+    }
+    return node->GetSampleLayout().GetNumElements() <= numInputElements;
+}
+
+template <class ElemType>
+void ComputationNetwork::OptimizeForInference(const vector<ComputationNodeBasePtr>& outputNodes)
+{
+    VerifyIsCompiled("OptimizeForInference");
+
+    InferenceCost before = EstimateInferenceCost<ElemType>(GetAllNodes());
+    set<ComputationNodeBasePtr> outputs(outputNodes.begin(), outputNodes.end());
+    size_t numFrozen = 0, numConstantFolded = 0, numDropoutRemoved = 0, numBatchNormFolded = 0, numConvolutionsFused = 0;
+
+    // removes everything the outputs don't depend on
+    auto prune = [&]()
+    {
+        auto nodesForOutputs = ComputationNodeBase::EnumerateNodes(outputNodes);
+        set<ComputationNodeBasePtr> needed(nodesForOutputs.begin(), nodesForOutputs.end());
+        for (const auto& node : GetAllNodes())
+        {
+            if (needed.find(node) == needed.end())
+                DeleteNode(node->NodeName());
+        }
+    };
+
+    // replaces a node by a constant LearnableParameter of the same name and shape
+    auto replaceByConstant = [&](const ComputationNodeBasePtr& node, vector<ElemType>& value)
+    {
+        auto constant = New<LearnableParameter<ElemType>>(m_deviceId, node->NodeName(), node->GetSampleLayout());
+        CopyFromHost(constant->Value(), value);
+        SubstituteNode(node, constant);
+    };
+
+    auto uniqueName = [&](wstring name)
+    {
+        while (NodeNameExists(name))
+            name += L"_";
+        return name;
+    };
+
+    prune();
+
+    // Step 1. Freeze precomputed nodes, and fold parameter-only subgraphs. Inputs come before the nodes that use them,
+    // so that chains of such nodes are folded from the bottom up.
+    for (const auto& node : ComputationNodeBase::EnumerateNodes(outputNodes))
+    {
+        auto computationNode = dynamic_pointer_cast<ComputationNode<ElemType>>(node);
+        if (!computationNode || outputs.find(node) != outputs.end())
+            continue;
+
+        auto preComputeNode = dynamic_pointer_cast<IPreComputeNode>(node);
+        if (preComputeNode && preComputeNode->HasComputed())
+        {
+            auto value = CopyToHost(computationNode->Value());
+            replaceByConstant(node, value);
+            numFrozen++;
+        }
+        else if (IsConstantFoldable(node))
+        {
+            computationNode->CreateValueMatrixIfNull();
+            computationNode->BeginForwardProp();
+            computationNode->ForwardProp(FrameRange(nullptr));
+            computationNode->EndForwardProp();
+            auto value = CopyToHost(computationNode->Value());
+            replaceByConstant(node, value);
+            numConstantFolded++;
+        }
+    }
+
+    // Step 2. Bypass dropout.
+    for (const auto& node : GetAllNodes())
+    {
+        if (node->OperationName() == OperationNameOf(DropoutNode) && outputs.find(node) == outputs.end())
+        {
+            SubstituteNode(node, node->Input(0));
+            numDropoutRemoved++;
+        }
+    }
+
+    // Step 3. Fold batch normalization.
+    // In inference, BN computes y = scale .* (x - runMean) ./ sqrt(runVariance + epsilon) + bias = a .* x + c per feature.
+    // If x = W * z (+ b), then the factor a can be applied to the rows of W (the output maps of a convolution kernel),
+    // and the BN is replaced by a Plus with c (or by the existing Plus, whose bias becomes a .* b + c).
+    for (const auto& node : GetAllNodes())
+    {
+        auto batchNorm = dynamic_pointer_cast<BatchNormalizationNode<ElemType>>(node);
+        if (!batchNorm)
+            continue;
+
+        auto parents = CreateParentsMap();
+        auto isExclusiveInputOf = [&](const ComputationNodeBasePtr& input, const ComputationNodeBasePtr& parent)
+        {
+            return outputs.find(input) == outputs.end() && parents[input].size() == 1 && *parents[input].begin() == parent;
+        };
+
+        // optional bias: x = Plus(linear, b)
+        ComputationNodeBasePtr linear = node->Input(0);
+        ComputationNodeBasePtr plus, bias;
+        if (linear->OperationName() == OperationNameOf(PlusNode) && isExclusiveInputOf(linear, batchNorm) &&
+            linear->Input(1)->OperationName() == OperationNameOf(LearnableParameter) && isExclusiveInputOf(linear->Input(1), linear))
+        {
+            plus = linear;
+            bias = linear->Input(1);
+            linear = plus->Input(0);
+        }
+
+        size_t numFeatures = node->Input(1)->GetSampleLayout().GetNumElements();
+        if (!isExclusiveInputOf(linear, plus ? plus : batchNorm) || linear->GetNumInputs() != 2 ||
+            linear->Input(0)->OperationName() != OperationNameOf(LearnableParameter) || !isExclusiveInputOf(linear->Input(0), linear) ||
+            (bias && bias->GetSampleLayout().GetNumElements() != numFeatures))
+            continue;
+
+        // which feature each weight contributes to
+        auto weights = dynamic_pointer_cast<ComputationNode<ElemType>>(linear->Input(0));
+        const auto& weightShape = weights->GetSampleLayout();
+        size_t numWeights = weightShape.GetNumElements();
+        bool featureIsRow; // weight matrix [numFeatures x N], or else a kernel [(filter shape) x numFeatures]
+        auto convolution = dynamic_pointer_cast<ConvolutionNode<ElemType>>(linear);
+        if (linear->OperationName() == OperationNameOf(TimesNode) && !batchNorm->Spatial() &&
+            weightShape.GetRank() == 2 && weightShape[0] == numFeatures && linear->GetSampleLayout().GetNumElements() == numFeatures)
+            featureIsRow = true;
+        else if (convolution && !convolution->Transpose() && batchNorm->Spatial() &&
+                 linear->GetSampleLayout().GetRank() > 0 && linear->GetSampleLayout().GetDims().back() == numFeatures)
+        {
+            if (weightShape.GetRank() == 2 && weightShape[0] == numFeatures) // legacy [outputChannels, kernelWidth * kernelHeight * inputChannels]
+                featureIsRow = true;
+            else if (weightShape.GetRank() > 0 && weightShape.GetDims().back() == numFeatures)
+                featureIsRow = false;
+            else
+                continue;
+        }
+        else
+            continue;
+
+        // the affine transform that BN applies per feature
+        auto scale    = CopyToHost(dynamic_pointer_cast<ComputationNode<ElemType>>(node->Input(1))->Value());
+        auto bnBias   = CopyToHost(dynamic_pointer_cast<ComputationNode<ElemType>>(node->Input(2))->Value());
+        auto mean     = CopyToHost(dynamic_pointer_cast<ComputationNode<ElemType>>(node->Input(3))->Value());
+        auto variance = CopyToHost(dynamic_pointer_cast<ComputationNode<ElemType>>(node->Input(4))->Value());
+        vector<ElemType> factor(numFeatures), offset(numFeatures);
+        for (size_t k = 0; k < numFeatures; k++)
+        {
+            factor[k] = scale[k] / sqrt(variance[k] + (ElemType)batchNorm->Epsilon());
+            offset[k] = bnBias[k] - mean[k] * factor[k];
+        }
+
+        auto weightValues = CopyToHost(weights->Value());
+        size_t featureStride = numWeights / numFeatures;
+        for (size_t i = 0; i < numWeights; i++)
+            weightValues[i] *= factor[featureIsRow ? i % numFeatures : i / featureStride];
+        CopyFromHost(weights->Value(), weightValues);
+
+        wstring name = batchNorm->NodeName();
+        if (plus)
+        {
+            auto biasNode = dynamic_pointer_cast<ComputationNode<ElemType>>(bias);
+            auto biasValues = CopyToHost(biasNode->Value());
+            for (size_t k = 0; k < numFeatures; k++)
+                biasValues[k] = factor[k] * biasValues[k] + offset[k];
+            CopyFromHost(biasNode->Value(), biasValues);
+
+            SubstituteNode(batchNorm, plus);
+            RenameNode(plus, name);
+        }
+        else
+        {
+            // c broadcasts over all but the feature axis
+            SmallVector<size_t> offsetDims(linear->GetSampleLayout().GetRank(), 1);
+            offsetDims.back() = numFeatures;
+            auto offsetNode = AddNodeToNetWithElemType(New<LearnableParameter<ElemType>>(m_deviceId, uniqueName(name + L".bias"), TensorShape(offsetDims)));
+            CopyFromHost(offsetNode->Value(), offset);
+
+            auto newPlus = New<PlusNode<ElemType>>(m_deviceId, name);
+            newPlus->AttachInputs({ linear, offsetNode });
+            SubstituteNode(batchNorm, newPlus);
+        }
+        numBatchNormFolded++;
+    }
+
+    // Step 4. Fuse convolutions with the per-map bias and the activation that follow them. The CPU convolution engines
+    // apply these to the output while it is still in the cache, which saves two passes over the activations.
+    static const map<wstring, FusedActivation> fusableActivations =
+    {
+        { OperationNameOf(RectifiedLinearNode), FusedActivation::ReLU },
+        { OperationNameOf(SigmoidNode),         FusedActivation::Sigmoid },
+        { OperationNameOf(TanhNode),            FusedActivation::Tanh },
+    };
+    for (const auto& node : GetAllNodes())
+    {
+        auto convolution = dynamic_pointer_cast<ConvolutionNode<ElemType>>(node);
+        if (!convolution || convolution->Transpose() || convolution->IsConvolution2D() || convolution->ImageLayout() != ImageLayoutKind::CHW ||
+            node->GetSampleLayout().GetRank() == 0)
+            continue;
+
+        auto parents = CreateParentsMap();
+        auto exclusiveParentOf = [&](const ComputationNodeBasePtr& input) -> ComputationNodeBasePtr
+        {
+            if (outputs.find(input) != outputs.end() || parents[input].size() != 1)
+                return nullptr;
+            return *parents[input].begin();
+        };
+
+        // optional bias: Plus(convolution, b) with b of shape [1 x ... x 1 x K]
+        const auto& outputShape = node->GetSampleLayout();
+        size_t numMaps = outputShape.GetDims().back();
+        ComputationNodeBasePtr last = convolution, bias;
+        auto parent = exclusiveParentOf(convolution);
+        if (parent && parent->OperationName() == OperationNameOf(PlusNode) && parent->Input(0) == convolution &&
+            parent->Input(1)->OperationName() == OperationNameOf(LearnableParameter) && !parent->Input(1)->HasMBLayout() &&
+            parent->Input(1)->GetSampleLayout().GetRank() == outputShape.GetRank() &&
+            parent->Input(1)->GetSampleLayout().GetNumElements() == numMaps && parent->Input(1)->GetSampleLayout().GetDims().back() == numMaps &&
+            parent->GetSampleLayout() == outputShape)
+        {
+            bias = parent->Input(1);
+            last = parent;
+            parent = exclusiveParentOf(parent);
+        }
+
+        // optional activation
+        auto activation = FusedActivation::None;
+        if (parent && fusableActivations.find(parent->OperationName()) != fusableActivations.end())
+        {
+            activation = fusableActivations.at(parent->OperationName());
+            last = parent;
+        }
+        if (last == convolution)
+            continue;
+
+        // the fused node takes over the name of the last node of the chain
+        auto fused = New<FusedConvolutionNode<ElemType>>(m_deviceId, last->NodeName(), convolution->KernelShape(), convolution->MapCount(), convolution->Strides(),
+                                                         convolution->Sharing(), convolution->AutoPad(), convolution->LowerPad(), convolution->UpperPad(),
+                                                         convolution->MaxTempMemSizeInSamples(), activation);
+        vector<ComputationNodeBasePtr> inputs = { node->Input(0), node->Input(1) };
+        if (bias)
+            inputs.push_back(bias);
+        fused->AttachInputs(inputs);
+        SubstituteNode(last, fused);
+        numConvolutionsFused++;
+    }
+
+    // Step 5. The inputs of folded nodes are no longer needed. Nothing needs a gradient.
+    prune();
+    SetLearnableNodesBelowLearningRateMultiplier(0);
+
+    CompileNetwork();
+
+    InferenceCost after = EstimateInferenceCost<ElemType>(GetAllNodes());
+    fprintf(stderr, "OptimizeForInference: froze %d precomputed nodes, folded %d constant subgraphs and %d batch normalizations, removed %d dropout nodes, fused %d convolutions.\n",
+            (int)numFrozen, (int)numConstantFolded, (int)numBatchNormFolded, (int)numDropoutRemoved, (int)numConvolutionsFused);
+    fprintf(stderr, "OptimizeForInference: %d -> %d nodes, model %.2f -> %.2f MB, activations %.2f -> %.2f KB/sample, %.3f -> %.3f MFLOP/sample.\n",
+            (int)before.m_numNodes, (int)after.m_numNodes,
+            before.m_modelBytes / (1024 * 1024), after.m_modelBytes / (1024 * 1024),
+            before.m_activationBytesPerSample / 1024, after.m_activationBytesPerSample / 1024,
+            before.m_flopsPerSample * 1e-6, after.m_flopsPerSample * 1e-6);
+}
+
+// Store the weights of Times nodes in 16-bit floating point, for CPU evaluation. Each TimesNode (W, x) with a
+// LearnableParameter W that reduces over the entire sample of a dense x is replaced by a HalfPrecisionTimesNode of the
+// same name. All other parameters, e.g. biases and convolution kernels, keep their precision.
+template <class ElemType>
+void ComputationNetwork::ReduceParameterPrecision(HalfPrecisionFormat format)
+{
+    VerifyIsCompiled("ReduceParameterPrecision");
+
+    vector<ComputationNodeBasePtr> candidates;
+    for (const auto& node : GetAllNodes())
+    {
+        if (!dynamic_pointer_cast<TimesNode<ElemType>>(node))
+            continue;
+        const auto& weights = node->Input(0);
+        const auto& input = node->Input(1);
+        if (!dynamic_pointer_cast<LearnableParameter<ElemType>>(weights) || weights->HasMBLayout() ||
+            input->OperationName() == OperationNameOf(SparseInputValue))
+            continue;
+        if (weights->GetSampleLayout().GetNumElements() == node->GetSampleLayout().GetNumElements() * input->GetSampleLayout().GetNumElements())
+            candidates.push_back(node);
+    }
+
+    size_t fullBytes = 0, reducedBytes = 0;
+    set<ComputationNodeBasePtr> replacedWeights;
+    for (const auto& node : candidates)
+    {
+        auto weights = dynamic_pointer_cast<ComputationNode<ElemType>>(node->Input(0));
+        auto weightValues = CopyToHost(weights->Value());
+        size_t numRows = node->GetSampleLayout().GetNumElements();
+        auto halfWeights = make_shared<HalfPrecisionWeights>(weightValues.data(), numRows, weightValues.size() / numRows, format);
+
+        auto halfNode = New<HalfPrecisionTimesNode<ElemType>>(m_deviceId, node->NodeName(), node->GetSampleLayout());
+        halfNode->SetWeights(halfWeights);
+        halfNode->AttachInputs({ node->Input(1) });
+        SubstituteNode(node, halfNode);
+
+        replacedWeights.insert(weights);
+        fullBytes += weightValues.size() * sizeof(ElemType);
+        reducedBytes += halfWeights->SizeInBytes();
+    }
+
+    // delete the original weights unless other nodes still use them
+    for (const auto& weights : replacedWeights)
+    {
+        bool used = false;
+        for (const auto& node : GetAllNodes())
+        {
+            for (const auto& input : node->GetInputs())
+                used |= input == weights;
+        }
+        if (!used)
+            DeleteNode(weights->NodeName());
+    }
+
+    CompileNetwork();
+
+    fprintf(stderr, "ReduceParameterPrecision: stored the weights of %d Times nodes in %s, %.2f MB instead of %.2f MB.\n",
+            (int)candidates.size(), format == HalfPrecisionFormat::Float16 ? "float16" : "bfloat16",
+            reducedBytes / (1024.0 * 1024.0), fullBytes / (1024.0 * 1024.0));
+}
+
+// Evaluate the convolutional part of the network in channel-blocked layout on the CPU (see CPUConvolution). Each 2D
+// ConvolutionNode (or FusedConvolutionNode) in CHW layout whose output channels are a multiple of the block size is
+// replaced by a BlockedConvolutionNode of the same name. Pooling and element-wise nodes (activations, and per-channel biases or
+// scales) whose inputs are blocked are evaluated in blocked layout as well, by rewriting the pooling geometry and the
+// shapes of the parameters. Values are reordered back to CHW layout only where other nodes, or the outputs, use them.
+// Batch normalization is expected to have been folded by OptimizeForInference(); otherwise it ends the blocked part.
+template <class ElemType>
+void ComputationNetwork::ConvertToBlockedLayout(const vector<ComputationNodeBasePtr>& outputNodes, size_t blockSize)
+{
+    VerifyIsCompiled("ConvertToBlockedLayout");
+    if (!CPUConvolution::IsChannelBlockSupported(blockSize))
+        InvalidArgument("ConvertToBlockedLayout: Unsupported channel block size %d, expected 8 or 16.", (int)blockSize);
+
+    // the values of these nodes are used outside of the network, so they keep the CHW layout
+    set<ComputationNodeBasePtr> outputs(outputNodes.begin(), outputNodes.end());
+    outputs.insert(m_outputNodes.begin(), m_outputNodes.end());
+    outputs.insert(m_evaluationNodes.begin(), m_evaluationNodes.end());
+    outputs.insert(m_criterionNodes.begin(), m_criterionNodes.end());
+
+    auto uniqueName = [&](wstring name)
+    {
+        while (NodeNameExists(name))
+            name += L"_";
+        return name;
+    };
+
+    // the nodes that compute blocked values, with the shape of their values in CHW layout
+    map<ComputationNodeBasePtr, TensorShape> blocked;
+    set<ComputationNodeBasePtr> replacedParameters;
+    auto isBlocked = [&](const ComputationNodeBasePtr& node) { return blocked.find(node) != blocked.end(); };
+
+    // A parameter [1 x 1 x C] with one value per channel broadcasts over a blocked value as [B x 1 x 1 x C/B],
+    // with the same values in the same order. Returns the parameter to use in blocked layout, or nullptr.
+    auto blockChannelParameter = [&](const ComputationNodeBasePtr& node, const TensorShape& shape) -> ComputationNodeBasePtr
+    {
+        auto parameter = dynamic_pointer_cast<LearnableParameter<ElemType>>(node);
+        const auto& parameterShape = node->GetSampleLayout();
+        size_t numChannels = shape.GetDims().back();
+        if (!parameter || node->HasMBLayout())
+            return nullptr;
+        if (parameterShape.GetNumElements() == 1)
+            return node;
+        if (parameterShape.GetRank() != shape.GetRank() || parameterShape.GetDims().back() != numChannels || parameterShape.GetNumElements() != numChannels)
+            return nullptr;
+        auto blockedParameter = AddNodeToNetWithElemType(New<LearnableParameter<ElemType>>(m_deviceId, uniqueName(node->NodeName() + L".blocked"),
+                                                                                           ChannelBlockReorderNode<ElemType>::BlockedShape(parameterShape, blockSize)));
+        auto values = CopyToHost(parameter->Value());
+        CopyFromHost(blockedParameter->Value(), values);
+        replacedParameters.insert(node);
+        return blockedParameter;
+    };
+
+    static const set<wstring> unaryElementWise = { OperationNameOf(AbsNode), OperationNameOf(ExpNode), OperationNameOf(NegateNode),
+                                                   OperationNameOf(PassNode), OperationNameOf(RectifiedLinearNode), OperationNameOf(SigmoidNode),
+                                                   OperationNameOf(SqrtNode), OperationNameOf(TanhNode) };
+    static const set<wstring> binaryElementWise = { OperationNameOf(PlusNode), OperationNameOf(MinusNode), OperationNameOf(ElementTimesNode) };
+
+    size_t numConvolutions = 0, numPoolings = 0, numElementWise = 0;
+    // Inputs come before the nodes that use them, so whether an input is blocked is known. Replaced nodes are
+    // substituted right away, so that the inputs of later nodes are the replacements.
+    for (const auto& node : ComputationNodeBase::EnumerateNodes(outputNodes))
+    {
+        if (outputs.find(node) != outputs.end())
+            continue;
+        const auto& shape = node->GetSampleLayout();
+        bool canBeBlocked = shape.GetRank() == 3 && shape[2] % blockSize == 0;
+        if (!canBeBlocked)
+            continue;
+
+        auto convolution = dynamic_pointer_cast<ConvolutionNodeBase<ElemType>>(node);
+        auto fusedConvolution = dynamic_pointer_cast<FusedConvolutionNode<ElemType>>(node);
+        if (convolution && (node->OperationName() == OperationNameOf(ConvolutionNode) || fusedConvolution))
+        {
+            auto weights = dynamic_pointer_cast<LearnableParameter<ElemType>>(node->Input(0));
+            const auto& input = node->Input(1);
+            bool inputBlocked = isBlocked(input);
+            if (!weights || convolution->Transpose() || convolution->ImageLayout() != ImageLayoutKind::CHW ||
+                input->OperationName() == OperationNameOf(SparseInputValue))
+                continue;
+            ConvolveGeometry geometry(inputBlocked ? blocked[input] : input->GetSampleLayout(), convolution->KernelShape(), convolution->MapCount(), convolution->Strides(),
+                                      convolution->Sharing(), convolution->AutoPad(), convolution->LowerPad(), convolution->UpperPad());
+            Convolution2DShape convolutionShape;
+            if (!Convolution2DShape::TryCreate(geometry, convolutionShape))
+                continue;
+
+            auto kernel = CopyToHost(weights->Value());
+            vector<ElemType> blockedKernel(kernel.size());
+            CPUConvolution::BlockKernel(convolutionShape, blockSize, kernel.data(), blockedKernel.data());
+            auto blockedWeights = AddNodeToNetWithElemType(New<LearnableParameter<ElemType>>(m_deviceId, uniqueName(weights->NodeName() + L".blocked"),
+                TensorShape(SmallVector<size_t>{ blockSize, convolutionShape.m_kernelW, convolutionShape.m_kernelH, convolutionShape.m_inC, convolutionShape.m_mapCount / blockSize })));
+            CopyFromHost(blockedWeights->Value(), blockedKernel);
+
+            auto blockedConvolution = New<BlockedConvolutionNode<ElemType>>(m_deviceId, node->NodeName(), convolution->KernelShape(), convolution->MapCount(), convolution->Strides(),
+                                                                             convolution->Sharing(), convolution->AutoPad(), convolution->LowerPad(), convolution->UpperPad(),
+                                                                             blockSize, inputBlocked, fusedConvolution ? fusedConvolution->Activation() : FusedActivation::None);
+            // the bias keeps one value per output map, in the original order
+            vector<ComputationNodeBasePtr> inputs = { blockedWeights, input };
+            if (fusedConvolution && fusedConvolution->HasBias())
+                inputs.push_back(node->Input(2));
+            blockedConvolution->AttachInputs(inputs);
+            SubstituteNode(node, blockedConvolution);
+            blocked[blockedConvolution] = shape;
+            replacedParameters.insert(weights);
+            numConvolutions++;
+        }
+        else if (auto pooling = dynamic_pointer_cast<PoolingNode<ElemType>>(node))
+        {
+            // pool over W and H only; the B axis gets a kernel of 1
+            const auto& input = node->Input(0);
+            auto kernelShape = pooling->KernelShape();
+            auto strides = pooling->Strides();
+            auto autoPad = pooling->AutoPad();
+            auto lowerPad = pooling->LowerPad();
+            auto upperPad = pooling->UpperPad();
+            auto get = [](const TensorShape& v, size_t i) { return v.GetRank() == 0 ? 0 : v[v.GetRank() == 1 ? 0 : i]; };
+            auto getPad = [](const vector<bool>& v, size_t i) { return !v.empty() && v[v.size() == 1 ? 0 : i]; };
+            if (!isBlocked(input) || pooling->ImageLayout() != ImageLayoutKind::CHW || kernelShape.GetRank() != 3 ||
+                kernelShape[2] != 1 || get(strides, 2) != 1 || get(lowerPad, 2) != 0 || get(upperPad, 2) != 0)
+                continue;
+
+            auto blockedPooling = New<PoolingNode<ElemType>>(m_deviceId, node->NodeName(), pooling->PoolingKind(),
+                                                             TensorShape(1, kernelShape[0], kernelShape[1], 1),
+                                                             TensorShape(1, get(strides, 0), get(strides, 1), 1),
+                                                             vector<bool>{ false, getPad(autoPad, 0), getPad(autoPad, 1), false },
+                                                             TensorShape(0, get(lowerPad, 0), get(lowerPad, 1), 0),
+                                                             TensorShape(0, get(upperPad, 0), get(upperPad, 1), 0),
+                                                             ImageLayoutKind::CHW);
+            blockedPooling->AttachInputs({ input });
+            SubstituteNode(node, blockedPooling);
+            blocked[blockedPooling] = shape;
+            numPoolings++;
+        }
+        else if (unaryElementWise.find(node->OperationName()) != unaryElementWise.end() && isBlocked(node->Input(0)))
+        {
+            blocked[node] = shape;
+            numElementWise++;
+        }
+        else if (binaryElementWise.find(node->OperationName()) != binaryElementWise.end() &&
+                 (isBlocked(node->Input(0)) || isBlocked(node->Input(1))))
+        {
+            // both inputs blocked with the same shape, or one of them a per-channel parameter
+            size_t i = isBlocked(node->Input(0)) ? 0 : 1;
+            const auto& other = node->Input(1 - i);
+            if (blocked[node->Input(i)] != shape)
+                continue;
+            if (isBlocked(other))
+            {
+                if (blocked[other] != shape)
+                    continue;
+            }
+            else
+            {
+                auto blockedParameter = blockChannelParameter(other, shape);
+                if (!blockedParameter)
+                    continue;
+                node->SetInput(1 - i, blockedParameter);
+            }
+            blocked[node] = shape;
+            numElementWise++;
+        }
+    }
+
+    // reorder the blocked values that other nodes use, once per value
+    map<ComputationNodeBasePtr, ComputationNodeBasePtr> unblocked;
+    size_t numReorders = 0;
+    for (const auto& node : GetAllNodes())
+    {
+        if (isBlocked(node))
+            continue;
+        for (size_t i = 0; i < node->GetNumInputs(); i++)
+        {
+            const auto& input = node->Input(i);
+            if (!isBlocked(input))
+                continue;
+            auto& reorder = unblocked[input];
+            if (!reorder)
+            {
+                reorder = AddNodeToNetAndAttachInputs(New<ChannelBlockReorderNode<ElemType>>(m_deviceId, uniqueName(input->NodeName() + L".unblocked"), blockSize, false), { input });
+                numReorders++;
+            }
+            node->SetInput(i, reorder);
+        }
+    }
+
+    // delete the original parameters unless other nodes still use them
+    for (const auto& node : GetAllNodes())
+    {
+        for (const auto& input : node->GetInputs())
+            replacedParameters.erase(input);
+    }
+    for (const auto& parameter : replacedParameters)
+        DeleteNode(parameter->NodeName());
+
+    CompileNetwork();
+
+    fprintf(stderr, "ConvertToBlockedLayout: %d convolutions, %d poolings and %d element-wise nodes in channel blocks of %d, with %d reorders.\n",
+            (int)numConvolutions, (int)numPoolings, (int)numElementWise, (int)blockSize, (int)numReorders);
+}
+
 // Helper class to form a logical DBN layer while exporting the network (used by SaveToDbnFile)
 class DbnLayer
 {
@@ -1503,9 +2137,12 @@ void ComputationNetwork::SaveToDbnFile(ComputationNetworkPtr net, const std::wst
 }
 
 template void ComputationNetwork::InitLearnableParametersWithBilinearFill<float>(const ComputationNodeBasePtr& node, size_t kernelWidth, size_t kernelHeight);
-template void ComputationNetwork::Read<float>(const wstring& fileName);
+template void ComputationNetwork::Read<float>(const wstring& fileName, bool memoryMapped);
 template void ComputationNetwork::ReadPersistableParameters<float>(File& fstream, bool create);
 template void ComputationNetwork::PerformSVDecomposition<float>(const map<wstring, float>& SVDConfig, size_t alignedsize);
+template void ComputationNetwork::OptimizeForInference<float>(const vector<ComputationNodeBasePtr>& outputNodes);
+template void ComputationNetwork::ReduceParameterPrecision<float>(HalfPrecisionFormat format);
+template void ComputationNetwork::ConvertToBlockedLayout<float>(const vector<ComputationNodeBasePtr>& outputNodes, size_t blockSize);
 template /*static*/ void ComputationNetwork::SetDropoutRate<float>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, const double dropoutRate, double& prevDropoutRate);
 template /*static*/ void ComputationNetwork::SetIRngUserSeed<float>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, size_t randSeedBase);
 template /*static*/ void ComputationNetwork::SetBatchNormalizationTimeConstants<float>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, const double normalizationTimeConstant, double& prevNormalizationTimeConstant, double blendTimeConstant, double& prevBlendTimeConstant);
@@ -1514,9 +2151,12 @@ template void ComputationNetwork::SetSeqParam<float>(ComputationNetworkPtr net,
 template void ComputationNetwork::SaveToDbnFile<float>(ComputationNetworkPtr net, const std::wstring& fileName) const;
 
 template void ComputationNetwork::InitLearnableParametersWithBilinearFill<double>(const ComputationNodeBasePtr& node, size_t kernelWidth, size_t kernelHeight);
-template void ComputationNetwork::Read<double>(const wstring& fileName);
+template void ComputationNetwork::Read<double>(const wstring& fileName, bool memoryMapped);
 template void ComputationNetwork::ReadPersistableParameters<double>(File& fstream, bool create);
 template void ComputationNetwork::PerformSVDecomposition<double>(const map<wstring, float>& SVDConfig, size_t alignedsize);
+template void ComputationNetwork::OptimizeForInference<double>(const vector<ComputationNodeBasePtr>& outputNodes);
+template void ComputationNetwork::ReduceParameterPrecision<double>(HalfPrecisionFormat format);
+template void ComputationNetwork::ConvertToBlockedLayout<double>(const vector<ComputationNodeBasePtr>& outputNodes, size_t blockSize);
 template /*static*/ void ComputationNetwork::SetDropoutRate<double>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, const double dropoutRate, double& prevDropoutRate);
 template /*static*/ void ComputationNetwork::SetIRngUserSeed<double>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, size_t randSeedBase);
 template /*static*/ void ComputationNetwork::SetBatchNormalizationTimeConstants<double>(ComputationNetworkPtr net, const ComputationNodeBasePtr& criterionNode, const double normalizationTimeConstant, double& prevNormalizationTimeConstant, double blendTimeConstant, double& prevBlendTimeConstant);
@@ -8,6 +8,7 @@
 #include "Basics.h"
 #include "File.h"
 #include "Matrix.h"
+#include "HalfGemm.h"
 #include "Config.h"
 
 #include "ComputationNode.h"
@@ -100,10 +101,12 @@ public:
     }
     // design BUGBUG: binary files do not know whether they are float or double.
     // TODO: modify file format to know this; then eliminate the <ElemType> dependency (and in some future, allow nodes to be different)
-    template <class ElemType> void Read(const std::wstring& fileName);
-    template <class ElemType> void Load(const std::wstring& fileName)
+    // With memoryMapped, the file is mapped into memory, and CPU parameters that were saved with fileOptionsAlignedData are used
+    // in place instead of being copied. Processes that load the same model this way share one physical copy of these parameters.
+    template <class ElemType> void Read(const std::wstring& fileName, bool memoryMapped = false);
+    template <class ElemType> void Load(const std::wstring& fileName, bool memoryMapped = false)
     {
-        Read<ElemType>(fileName);
+        Read<ElemType>(fileName, memoryMapped);
         // perform all further post-processing, caching, etc.
         CompileNetwork();
     }
@@ -119,6 +122,8 @@ public:
 
     void Save(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary) const;
     void SaveEdited(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary);
+    // serialize the model into an already opened File, e.g. an in-memory snapshot (File::CreateMemoryWriter())
+    void Save(File& fstream) const;
 
 private:
 
@@ -143,6 +148,9 @@ public:
             ForwardProp(node);
     }
 
+    // version that takes multiple nodes and visits the union of their dependencies in a single traversal
+    void ForwardProp(const std::vector<ComputationNodeBasePtr>& rootNodes);
+
     static void BumpEvalTimeStamp(const std::vector<ComputationNodeBasePtr>& nodes);
     void ResetEvalTimeStamps();
 
@@ -174,6 +182,7 @@ public:
     void CompileNetwork(); // call this after creation, Load(), and any modification
 
 private:
+    void CompileNetworkFrom(const ComputationNetwork& compiledNet);
     void ValidateNetwork();
     size_t ValidateNodes(list<ComputationNodeBasePtr> nodes, bool isFirstPass, bool isFinalValidationPass);
     bool ValidateNode(ComputationNodeBasePtr node, bool isFinalValidationPass) const;
@@ -206,6 +215,7 @@ public:
 
     void FormNestedNetwork(const ComputationNodeBasePtr& rootNode);
     ComputationNodeBasePtr GetNestedNetwork(const ComputationNodeBasePtr& rootNode);
+    ComputationNodeBasePtr GetCombinedNestedNetwork(const std::vector<ComputationNodeBasePtr>& rootNodes);
 
     // The methods below determine evaluation order, which is tricky in presence of recurrent loops.
     // TODO: Can this be moved to a separate class?
@@ -375,6 +385,7 @@ public:
     ComputationNodeBasePtr CopyNode(const ComputationNetwork& fromNet, const std::wstring fromName, std::wstring toName, const CopyNodeFlags flags);
     void CopySubTree(const ComputationNetwork& fromNet, const std::wstring fromName, std::wstring toNamePrefix, const CopyNodeFlags flags);
     void CopyInputs(const std::wstring fromName, std::wstring toName);
+    ComputationNetworkPtr CloneSharingParameters() const;
     void RenameNode(const std::wstring& nodeNameOrig, const std::wstring& nodeNameNew);
     void RenameNode(ComputationNodeBasePtr node, const std::wstring& newNodeName);
     void DeleteNode(const std::wstring& nodeName);
@@ -382,6 +393,7 @@ public:
     void InsertNode(wstring nodeName, ComputationNodeBasePtr newNode, const std::set<std::wstring>& newNodeTags);
     void ReplaceLeafNode(wstring oldNodeName, ComputationNodeBasePtr newNode);
     void ReplaceFinalCriterionNode(wstring oldNodeName, ComputationNodeBasePtr newNode);
+    void SubstituteNode(const ComputationNodeBasePtr& oldNode, const ComputationNodeBasePtr& newNode);
     void AddFeatureNode(ComputationNodeBasePtr featureNode);
     //ComputationNodeBasePtr RemoveFeatureNode(ComputationNodeBasePtr featureNode);
     void SetLearnableNodesBelowLearningRateMultiplier(const float learningRateMultiplier, const ComputationNodeBasePtr& rootNode = nullptr);
@@ -746,6 +758,15 @@ public:
     template <class ElemType>
     void PerformSVDecomposition(const map<wstring, float>& SVDConfig, size_t AlignedSize);
 
+    template <class ElemType>
+    void OptimizeForInference(const std::vector<ComputationNodeBasePtr>& outputNodes);
+
+    template <class ElemType>
+    void ReduceParameterPrecision(HalfPrecisionFormat format);
+
+    template <class ElemType>
+    void ConvertToBlockedLayout(const std::vector<ComputationNodeBasePtr>& outputNodes, size_t blockSize);
+
     template <class ElemType>
     void SaveToDbnFile(ComputationNetworkPtr net, const std::wstring& fileName) const;
 
@@ -1164,6 +1185,7 @@ private:
     // cached network iterations
     std::map<const ComputationNodeBasePtr, std::list<ComputationNodeBasePtr>> m_evalOrders; // [out node] flat depth-first traversal starting from out node
     std::map<const ComputationNodeBasePtr, ComputationNodeBasePtr> m_nestedNetworks;        // [out node] network rewritten as recursive traveral, potentially optimized; execution plan
+    std::map<std::vector<ComputationNodeBasePtr>, ComputationNodeBasePtr> m_combinedNestedNetworks; // [out nodes] execution plan for the union of several out nodes, formed on first use
 
     // cached quick-access list for inputs and parameters
     std::map<const ComputationNodeBasePtr, std::list<ComputationNodeBasePtr>> m_inputValues;         // [out node] -> all input nodes feeding into out node
@@ -103,6 +103,47 @@ void ComputationNetwork::CopyInputs(const std::wstring fromName, std::wstring to
     CopyNode(*this, fromName, toName, CopyNodeFlags::copyNodeInputLinks);
 }
 
+// create a compiled copy of this network that shares (rather than copies) the values of all LearnableParameters
+// Used for evaluating one model from several threads: every copy has its own activations (and MatrixPool), while the
+// parameters exist only once. The parameters must not be modified while any of the copies is in use.
+// If this network is compiled, the copy takes over its evaluation orders and recurrent loops instead of analyzing the graph again.
+ComputationNetworkPtr ComputationNetwork::CloneSharingParameters() const
+{
+    auto net = make_shared<ComputationNetwork>(GetDeviceId());
+    net->SetTraceLevel(TraceLevel());
+
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        const auto& node = iter.second;
+        int flags = CopyNodeFlags::copyNodeAll;
+        if (node->OperationName() == OperationNameOf(LearnableParameter))
+            flags |= CopyNodeFlags::copyNodeShareValue;
+        net->AddNodeToNet(node->Duplicate(node->NodeName(), (CopyNodeFlags)flags));
+    }
+
+    // the duplicates still point to our nodes: relink them to their counterparts in the new network
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        const auto& inputs = iter.second->GetInputs();
+        auto newNode = net->GetNodeFromName(iter.first);
+        for (size_t i = 0; i < inputs.size(); i++)
+            newNode->SetInput(i, net->GetNodeFromName(inputs[i]->NodeName()));
+    }
+
+    for (const auto& groupTag : { L"feature", L"label", L"criterion", L"evaluation", L"output" })
+    {
+        for (const auto& node : const_cast<ComputationNetwork*>(this)->GetNodeGroup(groupTag))
+            net->AddToNodeGroup(groupTag, net->GetNodeFromName(node->NodeName()));
+    }
+
+    if (IsCompiled())
+        net->CompileNetworkFrom(*this);
+    else
+        net->CompileNetwork();
+
+    return net;
+}
+
 // RenameNode - Rename a node to another name
 // nodeNameOrig - original node name
 // nodeNameNew - new node name
@@ -240,6 +281,30 @@ void ComputationNetwork::ChangeNodeInputs(ComputationNodeBasePtr fromNode, Compu
     }
 }
 
+// replace oldNode by newNode in all links and node groups, and take oldNode out of the network
+// Unlike ReplaceNode(), newNode may be of a different type and keeps its own inputs; it may also be a node of the network already.
+// If newNode has the same name as oldNode, it takes oldNode's place in the network.
+void ComputationNetwork::SubstituteNode(const ComputationNodeBasePtr& oldNode, const ComputationNodeBasePtr& newNode)
+{
+    InvalidateCompiledNetwork();
+
+    ChangeNodeInputs(oldNode, newNode);
+
+    for (auto groupIter : GetAllNodeGroups())
+    {
+        auto& group = *groupIter;
+        for (int i = 0; i < group.size(); i++)
+            if (group[i] == oldNode)
+                group[i] = newNode;
+    }
+    for (const auto& tag : oldNode->GetTags())
+        newNode->SetTag(tag);
+
+    oldNode->DetachInputs();
+    RemoveNodeFromNet(oldNode);
+    AddNodeToNetIfNotYet(newNode);
+}
+
 // replace the old node with the current node, assuming the old node is a leaf node
 // need to update those nodes who use oldNode as their child
 // TODO: Can this be called with a node that's already part of the network? This is currently allowed, but should it?
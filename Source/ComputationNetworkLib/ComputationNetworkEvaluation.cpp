@@ -44,6 +44,19 @@ void ComputationNetwork::ForwardProp(const ComputationNodeBasePtr rootNode)
     GetNestedNetwork(rootNode)->ForwardProp(FrameRange(nullptr));
 }
 
+// Same for several root nodes, e.g. all outputs requested from an evaluator.
+// Instead of one traversal per root, which re-checks the shared part of the network for every root,
+// this runs a single traversal over the union of the roots' eval orders.
+void ComputationNetwork::ForwardProp(const std::vector<ComputationNodeBasePtr>& rootNodes)
+{
+    VerifyIsCompiled("ForwardProp");
+
+    if (rootNodes.size() == 1)
+        GetNestedNetwork(rootNodes.front())->ForwardProp(FrameRange(nullptr));
+    else if (!rootNodes.empty())
+        GetCombinedNestedNetwork(rootNodes)->ForwardProp(FrameRange(nullptr));
+}
+
 // set the gradient matrix of a (root) node 1.0
 // Returns false if the node is not a ComputationNode<ElemType>; see Backprop() below for intended use.
 template <class ElemType>
@@ -95,6 +108,33 @@ ComputationNodeBasePtr ComputationNetwork::GetNestedNetwork(const ComputationNod
     return m_nestedNetworks[rootNode];
 }
 
+// execution plan for the union of several roots, in the relative order in which the nodes appear in the global eval order
+// These are formed lazily since the sets of roots are only known to the caller; CompileNetwork() invalidates them.
+ComputationNodeBasePtr ComputationNetwork::GetCombinedNestedNetwork(const std::vector<ComputationNodeBasePtr>& rootNodes)
+{
+    auto iter = m_combinedNestedNetworks.find(rootNodes);
+    if (iter != m_combinedNestedNetworks.end())
+        return iter->second;
+
+    set<ComputationNodeBasePtr> nodesForRoots;
+    for (const auto& rootNode : rootNodes)
+    {
+        const auto& evalOrder = GetEvalOrder(rootNode); // fails for nodes that are not roots, like ForwardProp(rootNode) does
+        nodesForRoots.insert(evalOrder.begin(), evalOrder.end());
+    }
+
+    std::list<ComputationNodeBasePtr> combinedEvalOrder;
+    for (const auto& node : GetEvalOrder(nullptr))
+    {
+        if (nodesForRoots.find(node) != nodesForRoots.end())
+            combinedEvalOrder.push_back(node);
+    }
+
+    auto combinedNetwork = make_shared<PARTraversalFlowControlNode>(m_allSEQNodes, combinedEvalOrder);
+    m_combinedNestedNetworks[rootNodes] = combinedNetwork;
+    return combinedNetwork;
+}
+
 // -----------------------------------------------------------------------
 // PARTraversalFlowControlNode methods -- implements PAR traversal
 //
@@ -430,6 +470,7 @@ void ComputationNetwork::InvalidateCompiledNetwork()
     m_allSEQNodes.clear();
     m_evalOrders.clear();
     m_nestedNetworks.clear();
+    m_combinedNestedNetworks.clear();
     m_inputValues.clear();
     m_learnableParameters.clear();
 }
@@ -511,6 +552,67 @@ void ComputationNetwork::CompileNetwork()
     m_isCompiled = true;
 }
 
+// CompileNetworkFrom() -- bring a structural copy of a compiled network into executable state
+// The nodes of this network must be copies, with the same names and connections, of the nodes of 'compiledNet'. Instead of
+// analyzing the graph again, the roots, evaluation orders and recurrent loops of 'compiledNet' are translated to our nodes.
+// Validation is still run, since it sets up our MBLayouts and the per-node state of each node; the node dimensions have been
+// copied already, so it does not need to infer them again.
+void ComputationNetwork::CompileNetworkFrom(const ComputationNetwork& compiledNet)
+{
+    compiledNet.VerifyIsCompiled("CompileNetworkFrom");
+
+    InvalidateCompiledNetwork();
+
+    let translate = [this](const ComputationNodeBasePtr& node) -> ComputationNodeBasePtr
+    {
+        return node ? GetNodeFromName(node->NodeName()) : nullptr; // (nullptr is the key of the global eval order)
+    };
+    let translateList = [&translate](const std::list<ComputationNodeBasePtr>& nodes)
+    {
+        std::list<ComputationNodeBasePtr> translatedNodes;
+        for (const auto& node : nodes)
+            translatedNodes.push_back(translate(node));
+        return translatedNodes;
+    };
+
+    for (const auto& root : compiledNet.m_allRoots)
+        m_allRoots.push_back(translate(root));
+
+    for (const auto& iter : compiledNet.m_evalOrders)
+        m_evalOrders[translate(iter.first)] = translateList(iter.second);
+
+    for (const auto& iter : compiledNet.m_inputValues)
+        m_inputValues[translate(iter.first)] = translateList(iter.second);
+
+    for (const auto& iter : compiledNet.m_learnableParameters)
+        m_learnableParameters[translate(iter.first)] = translateList(iter.second);
+
+    for (const auto& loop : compiledNet.m_allSEQNodes)
+    {
+        auto translatedLoop = make_shared<SEQTraversalFlowControlNode>(loop->m_loopId, translate(loop->m_sourceNode));
+        for (const auto& node : loop->m_nestedNodes)
+        {
+            let translatedNode = translate(node);
+            translatedNode->m_isPartOfLoop = true; // (the one flag that FormRecurrentLoops() leaves in the nodes)
+            translatedNode->m_loopId = loop->m_loopId;
+            translatedLoop->m_nestedNodes.push_back(translatedNode);
+        }
+        translatedLoop->m_steppingDirection = loop->m_steppingDirection;
+        m_allSEQNodes.push_back(translatedLoop);
+    }
+
+    ResetMBLayouts();
+
+    for (auto& node : m_allRoots)
+        FormNestedNetwork(node);
+
+    ValidateNetwork();
+
+    ResetEvalTimeStamps();
+
+    m_isCompiled = true;
+}
+
 // determine the set of all root nodes
 // Roots are nodes that ForwardProp() may be called for.
 //  - training criterion, eval criteria
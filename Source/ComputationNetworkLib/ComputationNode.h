@@ -45,7 +45,8 @@
 #define CNTK_MODEL_VERSION_13 13 // batch norm: switch running inverse std deviation -> variance, MB count -> samplesSeen; CuDNN v5
 #define CNTK_MODEL_VERSION_14 14 // axis parameter in OptimizedRNNStackNode
 #define CNTK_MODEL_VERSION_15 15 // add new nodes: LambdaRankNode and NDCG1Eval
-#define CURRENT_CNTK_MODEL_VERSION CNTK_MODEL_VERSION_15
+#define CNTK_MODEL_VERSION_16 16 // aligned dense matrices for memory-mapped loading (matrix type 'a'); only written if the model contains them
+#define CURRENT_CNTK_MODEL_VERSION CNTK_MODEL_VERSION_16
 
 // helper mode for debugging
 // If TRACK_GAP_NANS is defined then initialize layout gaps to NaN and do NaN checks. Also do detailed logging of node computations.
@@ -59,7 +60,8 @@ enum CopyNodeFlags // flags to be passed to the CopyTo() function
     copyNodeValue          = 1, // copy everything except for the input links
     copyNodeInputLinks     = 2, // copy over input links
     copyNodeAll            = 3, // copy everything
-    copyNodeAcrossNetworks = 4  // allow a cross network child copy
+    copyNodeAcrossNetworks = 4, // allow a cross network child copy
+    copyNodeShareValue     = 8  // with copyNodeValue: share the value matrix instead of copying it, and drop the gradient (read-only parameters)
 };
 
 #pragma region base computation class
@@ -137,6 +139,12 @@ struct /*interface*/ IStatefulNode
     typedef std::shared_ptr<INodeState> NodeStatePtr;
     virtual NodeStatePtr ExportState() = 0;
     virtual void ImportState(const NodeStatePtr& state) = 0;
+
+    // per-stream state for streaming evaluation, where parallel sequence s of a minibatch is the next chunk of stream s:
+    //  - ImportStreamStates() makes every parallel sequence of the next minibatch continue from states[s] (nullptr: no history)
+    //  - ExportStreamState() returns the state of stream s after the last minibatch; previousState is what was imported for it
+    virtual void ImportStreamStates(const std::vector<NodeStatePtr>& states) = 0;
+    virtual NodeStatePtr ExportStreamState(size_t s, const NodeStatePtr& previousState) = 0;
 };
 typedef IStatefulNode::NodeStatePtr NodeStatePtr;
 
@@ -1197,14 +1205,16 @@ public:
         if (flags & CopyNodeFlags::copyNodeValue)
         {
             auto node = DownCast(nodeP);
-            if (m_value)
+            if (flags & CopyNodeFlags::copyNodeShareValue)
+                node->m_value = m_value;
+            else if (m_value)
             {
                 node->CreateValueMatrixIfNull();
                 node->m_value->SetValue(*m_value);
             }
             else
                 node->m_value = nullptr;
-            if (m_gradient)
+            if (m_gradient && !(flags & CopyNodeFlags::copyNodeShareValue))
             {
                 node->CreateGradientMatrixIfNull();
                 node->m_gradient->SetValue(*m_gradient);
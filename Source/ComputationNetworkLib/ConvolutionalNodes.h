@@ -148,6 +148,7 @@ public:
     TensorShape LowerPad() const { return m_lowerPad; }
     TensorShape UpperPad() const { return m_upperPad; }
     bool Transpose() const { return m_transpose; }
+    ImageLayoutKind ImageLayout() const { return m_imageLayout; }
     size_t MaxTempMemSizeInSamples() const { return m_maxTempMemSizeInSamples; }
     PoolKind PoolingKind() const { return m_poolKind; }
 
@@ -187,6 +188,24 @@ protected:
         FixVectorShape(filterRank, inputShape.size(), m_sharing,     true);
     }
 
+    // The direct and Winograd CPU engines are not part of ConvolutionEngineKind::All, since their numerics differ from GEMM's.
+    // They are picked automatically for evaluation-only nodes, and for all others if enabled through the 'enableDirectConvolutionEngines' option.
+    static ConvolutionEngineKind EnabledConvolutionEngines(bool evaluationOnly = false)
+    {
+        int kinds = (int)ConvolutionEngineKind::All;
+        if (evaluationOnly || Globals::ShouldEnableDirectConvolutionEngines())
+            kinds |= (int)ConvolutionEngineKind::Direct | (int)ConvolutionEngineKind::Winograd;
+        return (ConvolutionEngineKind)kinds;
+    }
+
+    // The version of the kernel (input 0) to pass to ConvolutionEngine::SetKernelVersion(). While training, model averaging
+    // (MASGD, BMUF) and parameter-server pulls update parameters in place without bumping their time stamps, so the kernel
+    // is never considered unchanged then.
+    int64_t KernelVersion() const
+    {
+        return Environment().IsTraining() ? -1 : InputRef(0).GetEvalTimeStamp();
+    }
+
     // Derived classes implement transforms calculation. Since all derived classes are filter based we consolidate common
     // filter transform calculation here to be reused by derived classes. For example convolution and de-convolution
     // have same transform but inversed, hence both of them may reuse this method and one will call inverse in addition
@@ -242,6 +261,8 @@ protected:                                  \
     using Base::m_tempMatrix;               \
     using Base::m_convEng;                  \
     using Base::InferReductionDims;         \
+    using Base::EnabledConvolutionEngines;  \
+    using Base::KernelVersion;              \
 public:
 
 // -----------------------------------------------------------------------
@@ -342,7 +363,10 @@ public:
         const Matrix<ElemType>& input0 = InputRef(0).ValueAsMatrix();
         Matrix<ElemType> sliceInput1Value = InputRef(1).ValueFor(fr);
         if (!m_transpose)
+        {
+            m_convEng->SetKernelVersion(KernelVersion());
             m_convEng->Forward(sliceInput1Value, input0, sliceOutputValue, *m_tempMatrix);
+        }
         else
         {
             // BackwardData adds results to the output so need to zero them out first.
@@ -475,7 +499,7 @@ public:
                                                                    m_sharing, m_autoPad, m_lowerPad, m_upperPad);
                 m_convEng = ConvolutionEngine<ElemType>::Create(geometry, m_deviceId, m_imageLayout,
                                                                 m_maxTempMemSizeInSamples, m_poolKind,
-                                                                ConvolutionEngineKind::All, NodeName(), Globals::ShouldForceDeterministicAlgorithms());
+                                                                EnabledConvolutionEngines(), NodeName(), Globals::ShouldForceDeterministicAlgorithms());
             }
 
             if (Input(0)->GetSampleLayout().GetNumElements() != m_kernelShape.GetNumElements() * m_convEng->Geometry()->KernelCount())
@@ -539,6 +563,150 @@ protected:
     bool m_convolution2D;
 };
 
+// -----------------------------------------------------------------------
+// FusedConvolutionNode (convolutionWeights, inputFeature[, bias])
+// Evaluation-only replacement of a chain Convolution -> Plus (per-map bias) -> ReLU/Sigmoid/Tanh, created by
+// ComputationNetwork::OptimizeForInference(). The bias has the rank of the output with all dimensions 1 but the
+// last one (the maps). The CPU convolution engines add the bias and apply the activation while the output tile is
+// still in the cache; other engines fall back to separate element-wise operations.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class FusedConvolutionNode : public ConvolutionNodeBase<ElemType>
+{
+    typedef ConvolutionNodeBase<ElemType> Base; UsingConvolutionNodeBaseMembers;
+    static const std::wstring TypeName() { return L"FusedConvolution"; }
+
+public:
+    DeclareConstructorFromConfig(FusedConvolutionNode);
+    FusedConvolutionNode(DEVICEID_TYPE deviceId, const wstring& name)
+        : Base(deviceId, name), m_activation(FusedActivation::None)
+    {
+    }
+    FusedConvolutionNode(DEVICEID_TYPE deviceId, const wstring& name, const TensorShape& kernelShape, const TensorShape& mapCount, const TensorShape& strideShape,
+                         const std::vector<bool>& sharing, const std::vector<bool>& autoPadding, const TensorShape& lowerPad, const TensorShape& upperPad,
+                         size_t maxTempMemSizeInSamples, FusedActivation activation)
+        : Base(deviceId, name, kernelShape, mapCount, strideShape, sharing, autoPadding, lowerPad, upperPad, PoolKind::None, false, ImageLayoutKind::CHW, maxTempMemSizeInSamples),
+          m_activation(activation)
+    {
+    }
+
+    void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        fstream << (int32_t)m_activation;
+    }
+
+    void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        int32_t activation;
+        fstream >> activation;
+        m_activation = (FusedActivation)activation;
+    }
+
+    void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<FusedConvolutionNode<ElemType>>(nodeP);
+            node->m_activation = m_activation;
+        }
+    }
+
+    void ForwardProp(const FrameRange& fr) override
+    {
+        Matrix<ElemType> sliceOutputValue = ValueFor(fr);
+        const Matrix<ElemType>& input0 = InputRef(0).ValueAsMatrix();
+        Matrix<ElemType> sliceInput1Value = InputRef(1).ValueFor(fr);
+        const Matrix<ElemType>* bias = HasBias() ? &InputRef(2).Value() : nullptr;
+        m_convEng->SetKernelVersion(KernelVersion());
+        if (m_convEng->ForwardFused(sliceInput1Value, input0, bias, m_activation, sliceOutputValue, *m_tempMatrix))
+            return;
+
+        size_t rank = GetSampleLayout().GetRank(); // the bias has the same rank
+        auto result = ValueTensorFor(rank, fr);
+        if (bias)
+            result.AddCopyOf(InputRef(2).ValueTensorFor(rank, fr.AllowBroadcast()));
+        switch (m_activation)
+        {
+        case FusedActivation::None:    break;
+        case FusedActivation::ReLU:    result.AssignLinearRectifierOf(result); break;
+        case FusedActivation::Sigmoid: result.AssignSigmoidOf(result);         break;
+        case FusedActivation::Tanh:    result.AssignTanhOf(result);            break;
+        }
+    }
+
+    void BackpropTo(const size_t /*inputIndex*/, const FrameRange& /*fr*/) override
+    {
+        LogicError("%ls %ls operation: Fused convolutions can only be used for evaluation.", NodeName().c_str(), OperationName().c_str());
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+
+    void Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase(isFinalValidationPass);
+
+        if (GetNumInputs() != 2 && GetNumInputs() != 3)
+            InvalidArgument("%ls %ls operation: Expected 2 or 3 inputs (weights, input and optional bias).", NodeName().c_str(), OperationName().c_str());
+        if (m_imageLayout != ImageLayoutKind::CHW || m_transpose)
+            InvalidArgument("%ls %ls operation: Only non-transposed convolutions in \"cudnn\" layout can be fused.", NodeName().c_str(), OperationName().c_str());
+
+        TensorShape inputShape = GetInputSampleLayout(1);
+        InferReductionDims(inputShape, inputShape);
+        auto outputShape = ConvolveGeometry::ComputeOutputShape(inputShape, m_kernelShape, m_mapCount, m_stride,
+                                                               m_sharing, m_autoPad, m_lowerPad, m_upperPad);
+        SetDims(outputShape, HasMBLayout());
+
+        if (isFinalValidationPass)
+        {
+            if (HasBias())
+            {
+                const auto& biasShape = Input(2)->GetSampleLayout();
+                if (Input(2)->HasMBLayout() || biasShape.GetRank() != outputShape.GetRank() ||
+                    biasShape.GetNumElements() != outputShape.GetDims().back() || biasShape.GetDims().back() != outputShape.GetDims().back())
+                    InvalidArgument("%ls %ls operation: The bias [%s] must hold one value per output map of [%s].",
+                                    NodeName().c_str(), OperationName().c_str(), string(biasShape).c_str(), string(outputShape).c_str());
+            }
+
+            if (m_convEng == nullptr)
+            {
+                auto geometry = std::make_shared<ConvolveGeometry>(inputShape, m_kernelShape, m_mapCount, m_stride,
+                                                                   m_sharing, m_autoPad, m_lowerPad, m_upperPad);
+                m_convEng = ConvolutionEngine<ElemType>::Create(geometry, m_deviceId, m_imageLayout,
+                                                                m_maxTempMemSizeInSamples, m_poolKind,
+                                                                EnabledConvolutionEngines(/*evaluationOnly=*/true), NodeName(), Globals::ShouldForceDeterministicAlgorithms());
+            }
+
+            if (Input(0)->GetSampleLayout().GetNumElements() != m_kernelShape.GetNumElements() * m_convEng->Geometry()->KernelCount())
+                LogicError("Convolution weight matrix %ls should have dimension [(filter shape) x (input channels) x (output channels)]",
+                           Input(0)->NodeName().c_str());
+        }
+    }
+
+    void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) override
+    {
+        Base::RequestMatricesBeforeForwardProp(matrixPool);
+        RequestMatrixFromPool(m_tempMatrix, matrixPool);
+    }
+
+    void ReleaseMatricesAfterForwardProp(MatrixPool& matrixPool) override
+    {
+        Base::ReleaseMatricesAfterForwardProp(matrixPool);
+        ReleaseMatrixToPool(m_tempMatrix, matrixPool);
+    }
+
+    bool HasBias() const { return GetNumInputs() > 2; }
+    FusedActivation Activation() const { return m_activation; }
+
+private:
+    FusedActivation m_activation;
+};
+
 // -----------------------------------------------------------------------
 // ROIPoolingNode (inputFeatures, inputROIs)--pooling for object detection.
 //
@@ -748,6 +916,7 @@ public:
     {
         Matrix<ElemType> sliceOutputValue = ValueFor(fr);
         const Matrix<ElemType>& input0 = InputRef(0).ValueFor(fr);
+        m_convEng->SetPoolingBackwardNeeded(Environment().IsTraining());
         m_convEng->ForwardPooling(input0, sliceOutputValue);
     }
 
@@ -1022,6 +1191,7 @@ public:
         Matrix<ElemType> sliceInput0Value = InputRef(0).ValueFor(fr);
         Matrix<ElemType> sliceOutputValue = ValueFor(fr);
 
+        m_convEng->SetPoolingBackwardNeeded(Environment().IsTraining());
         m_convEng->ForwardPooling(sliceInput0Value, sliceOutputValue);
     }
 
@@ -0,0 +1,511 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// QuantizedNodes.h -- nodes that evaluate post-training int8 quantized Times and Convolution operations, and Times
+// operations with 16-bit floating point weights, on the CPU
+//
+#pragma once
+
+#include "Basics.h"
+#include "Matrix.h"
+#include "ComputationNode.h"
+#include "ConvolutionalNodes.h"
+#include "Int8Gemm.h"
+#include "HalfGemm.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// Int8Weights -- quantized weight matrix of a quantized node, together with the calibrated quantization of its input
+// Weights are stored per output channel (row); see Int8Gemm for the layout and the quantization scheme.
+// -----------------------------------------------------------------------
+
+struct Int8Weights
+{
+    size_t m_rows;              // output channels
+    size_t m_depth;             // reduction dimension, i.e. input elements per output element
+    std::vector<int8_t> m_values; // m_rows x Int8Gemm::PaddedDepth(m_depth)
+    std::vector<float> m_scales;  // per output channel
+    std::vector<int32_t> m_rowSums; // derived from m_values, not saved
+    float m_activationScale;
+    int32_t m_activationZeroPoint;
+
+    Int8Weights()
+        : m_rows(0), m_depth(0), m_activationScale(1), m_activationZeroPoint(0)
+    {
+    }
+
+    // Element (i, p) of the float weights is read from weights[i * rowStride + p * depthStride].
+    template <class ElemType>
+    Int8Weights(const ElemType* weights, size_t rows, size_t depth, size_t rowStride, size_t depthStride, float inputMin, float inputMax)
+        : m_rows(rows), m_depth(depth)
+    {
+        Int8Gemm::QuantizeWeights(weights, rows, depth, rowStride, depthStride, m_values, m_scales, m_rowSums);
+        Int8Gemm::ComputeActivationQuantization(inputMin, inputMax, m_activationScale, m_activationZeroPoint);
+    }
+
+    size_t SizeInBytes() const { return m_values.size() * sizeof(int8_t) + m_scales.size() * sizeof(float); }
+
+    void Save(File& fstream) const
+    {
+        fstream << m_rows << m_depth << m_activationScale << m_activationZeroPoint;
+        fstream << m_scales;
+        if (!m_values.empty())
+            fwriteOrDie(m_values.data(), sizeof(int8_t), m_values.size(), fstream);
+    }
+
+    void Load(File& fstream)
+    {
+        fstream >> m_rows >> m_depth >> m_activationScale >> m_activationZeroPoint;
+        fstream >> m_scales;
+        if (m_scales.size() != m_rows)
+            RuntimeError("Int8Weights: Expected %d scales but found %d.", (int)m_rows, (int)m_scales.size());
+        m_values.resize(m_rows * Int8Gemm::PaddedDepth(m_depth));
+        if (!m_values.empty())
+            freadOrDie(m_values.data(), sizeof(int8_t), m_values.size(), fstream);
+        Int8Gemm::ComputeRowSums(m_values.data(), m_rows, m_depth, m_rowSums);
+    }
+
+    // quantize n columns of 'depth' input values each into 'buffer', which receives Int8Gemm::PaddedDepth(depth) bytes per column
+    template <class ElemType>
+    uint8_t* QuantizeInput(const ElemType* x, size_t depth, size_t n, std::vector<uint8_t>& buffer) const
+    {
+        buffer.resize(Int8Gemm::PaddedDepth(depth) * n);
+        Int8Gemm::QuantizeActivations(x, depth, n, m_activationScale, m_activationZeroPoint, buffer.data());
+        return buffer.data();
+    }
+
+    // y = W * x for n columns of m_depth values each; column j of the result is written to y[j * colStride] with
+    // consecutive channels rowStride apart
+    template <class ElemType>
+    void Multiply(const uint8_t* quantizedInput, size_t n, ElemType* y, size_t rowStride, size_t colStride) const
+    {
+        Int8Gemm::Multiply(m_values.data(), m_scales.data(), m_rowSums.data(), m_rows, m_depth,
+                           quantizedInput, n, m_activationScale, m_activationZeroPoint, y, rowStride, colStride);
+    }
+};
+
+// -----------------------------------------------------------------------
+// QuantizedTimesNode (input)
+// Quantized replacement of TimesNode (W, input) for a parameter W that reduces over the entire sample of the input.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class QuantizedTimesNode : public ComputationNode<ElemType>, public NumInputs<1>
+{
+    typedef ComputationNode<ElemType> Base; UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName() { return L"QuantizedTimes"; }
+
+public:
+    DeclareConstructorFromConfigWithNumInputs(QuantizedTimesNode);
+    QuantizedTimesNode(DEVICEID_TYPE deviceId, const wstring& name, const TensorShape& outputShape = TensorShape())
+        : Base(deviceId, name), m_outputShape(outputShape)
+    {
+    }
+
+    void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        m_outputShape.Save(fstream);
+        m_weights->Save(fstream);
+    }
+
+    void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        m_outputShape.Load(fstream);
+        auto weights = make_shared<Int8Weights>();
+        weights->Load(fstream);
+        m_weights = weights;
+    }
+
+    // the weights are shared between clones, e.g. between the evaluators of a shared model
+    void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<QuantizedTimesNode<ElemType>>(nodeP);
+            node->m_outputShape = m_outputShape;
+            node->m_weights = m_weights;
+        }
+    }
+
+    void SetWeights(const shared_ptr<const Int8Weights>& weights) { m_weights = weights; }
+    const Int8Weights& Weights() const { return *m_weights; }
+
+    void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        if (Value().GetDeviceId() != CPUDEVICE)
+            LogicError("%ls %ls operation: Quantized evaluation is only implemented on the CPU.", NodeName().c_str(), OperationName().c_str());
+
+        auto input = InputRef(0).ValueFor(fr);
+        auto result = ValueFor(fr);
+        if (input.GetMatrixType() != MatrixType::DENSE)
+            InvalidArgument("%ls %ls operation: Quantized evaluation requires a dense input.", NodeName().c_str(), OperationName().c_str());
+        size_t numSamples = input.GetNumCols();
+        const uint8_t* quantizedInput = m_weights->QuantizeInput(input.Data(), input.GetNumRows(), numSamples, m_quantizedInput);
+        m_weights->Multiply(quantizedInput, numSamples, result.Data(), 1, result.GetNumRows());
+    }
+
+    void /*ComputationNode::*/ BackpropTo(const size_t /*inputIndex*/, const FrameRange& /*fr*/) override
+    {
+        LogicError("%ls %ls operation: Quantized nodes can only be used for evaluation.", NodeName().c_str(), OperationName().c_str());
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+
+    void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase(isFinalValidationPass);
+        SetDims(m_outputShape, HasMBLayout());
+
+        if (isFinalValidationPass)
+        {
+            if (!m_weights)
+                InvalidArgument("%ls %ls operation: No quantized weights. This node is created by quantizing a trained model.", NodeName().c_str(), OperationName().c_str());
+            if (m_weights->m_rows != m_outputShape.GetNumElements() || m_weights->m_depth != Input(0)->GetSampleLayout().GetNumElements())
+                InvalidArgument("%ls %ls operation: The quantized weights [%d x %d] don't match the output [%s] and input [%s] shapes.",
+                                NodeName().c_str(), OperationName().c_str(), (int)m_weights->m_rows, (int)m_weights->m_depth,
+                                string(m_outputShape).c_str(), string(Input(0)->GetSampleLayout()).c_str());
+        }
+    }
+
+private:
+    TensorShape m_outputShape;
+    shared_ptr<const Int8Weights> m_weights;
+    std::vector<uint8_t> m_quantizedInput;
+};
+
+template class QuantizedTimesNode<float>;
+template class QuantizedTimesNode<double>;
+
+// -----------------------------------------------------------------------
+// QuantizedConvolutionNode (input)
+// Quantized replacement of ConvolutionNode (W, input) for ND convolutions in "cudnn" (CHW) layout with full weight sharing.
+// Each sample is evaluated as one product of the [K x kernelSize] weights with the [kernelSize x positions] matrix
+// of quantized input patches, where K is the number of output channels.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class QuantizedConvolutionNode : public ConvolutionNodeBase<ElemType>, public NumInputs<1>
+{
+    typedef ConvolutionNodeBase<ElemType> Base; UsingConvolutionNodeBaseMembers;
+    static const std::wstring TypeName() { return L"QuantizedConvolution"; }
+
+public:
+    DeclareConstructorFromConfigWithNumInputs(QuantizedConvolutionNode);
+    QuantizedConvolutionNode(DEVICEID_TYPE deviceId, const wstring& name)
+        : Base(deviceId, name), m_numPositions(0)
+    {
+    }
+    QuantizedConvolutionNode(DEVICEID_TYPE deviceId, const wstring& name, const TensorShape& kernelShape, const TensorShape& mapCount, const TensorShape& strideShape,
+                             const std::vector<bool>& sharing, const std::vector<bool>& autoPadding, const TensorShape& lowerPad, const TensorShape& upperPad)
+        : Base(deviceId, name, kernelShape, mapCount, strideShape, sharing, autoPadding, lowerPad, upperPad, PoolKind::None, false, ImageLayoutKind::CHW, 0),
+          m_numPositions(0)
+    {
+    }
+
+    void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        m_weights->Save(fstream);
+    }
+
+    void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        auto weights = make_shared<Int8Weights>();
+        weights->Load(fstream);
+        m_weights = weights;
+    }
+
+    // the weights are shared between clones, e.g. between the evaluators of a shared model
+    void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<QuantizedConvolutionNode<ElemType>>(nodeP);
+            node->m_weights = m_weights;
+        }
+    }
+
+    void SetWeights(const shared_ptr<const Int8Weights>& weights) { m_weights = weights; }
+    const Int8Weights& Weights() const { return *m_weights; }
+
+    // Determine for each output position which input element each kernel element reads, or -1 where it falls into
+    // the padding. Returns false if the geometry is not a plain convolution whose output channels all apply their
+    // kernel at the same positions, which is what the quantized node supports.
+    static bool TryGetPatchOffsets(const ConvolveGeometry& geometry, std::vector<int>& offsets, size_t& numPositions)
+    {
+        size_t outputSize = geometry.OutputShape().GetNumElements();
+        size_t kernelSize = geometry.KernelShape().GetNumElements();
+        size_t kernelCount = geometry.KernelCount();
+        if (kernelCount == 0 || outputSize % kernelCount != 0)
+            return false;
+        numPositions = outputSize / kernelCount;
+
+        const auto& mpRowCol = geometry.MpRowCol();
+        const auto& mpRowIwht = geometry.MpRowIwht();
+        const auto& mpRowRun = geometry.MpRowRun();
+        const auto& runs = geometry.Runs();
+        for (size_t row = 0; row < outputSize; row++)
+        {
+            size_t position = row % numPositions;
+            if (mpRowIwht[row] != (int)((row / numPositions) * kernelSize) ||
+                mpRowCol[row] != mpRowCol[position] ||
+                (!mpRowRun.empty() && mpRowRun[row] != mpRowRun[position]))
+                return false;
+        }
+
+        offsets.assign(numPositions * kernelSize, -1);
+        for (size_t position = 0; position < numPositions; position++)
+        {
+            int i0 = mpRowRun.empty() ? 0 : mpRowRun[position];
+            int skip = runs[i0++];
+            int size = runs[i0++];
+            int imask = i0 + size;
+            for (int i = 0; i < size; i++)
+            {
+                if (runs[imask + i] != 0)
+                    offsets[position * kernelSize + skip + i] = mpRowCol[position] + runs[i0 + i];
+            }
+        }
+        return true;
+    }
+
+    void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        if (Value().GetDeviceId() != CPUDEVICE)
+            LogicError("%ls %ls operation: Quantized evaluation is only implemented on the CPU.", NodeName().c_str(), OperationName().c_str());
+
+        auto input = InputRef(0).ValueFor(fr);
+        auto result = ValueFor(fr);
+        if (input.GetMatrixType() != MatrixType::DENSE)
+            InvalidArgument("%ls %ls operation: Quantized evaluation requires a dense input.", NodeName().c_str(), OperationName().c_str());
+        size_t inputSize = input.GetNumRows();
+        size_t outputSize = result.GetNumRows();
+        size_t numSamples = input.GetNumCols();
+        size_t kernelSize = m_weights->m_depth;
+        size_t inputStride = Int8Gemm::PaddedDepth(inputSize);
+        size_t patchStride = Int8Gemm::PaddedDepth(kernelSize);
+        uint8_t zeroPoint = (uint8_t)m_weights->m_activationZeroPoint;
+
+        const uint8_t* quantizedInput = m_weights->QuantizeInput(input.Data(), inputSize, numSamples, m_quantizedInput);
+
+        // gather the input patches; the padding reads the zero point, i.e. a quantized 0
+        m_patches.resize(patchStride * m_numPositions * numSamples);
+#pragma omp parallel for
+        for (long long sample = 0; sample < (long long)numSamples; sample++)
+        {
+            const uint8_t* x = quantizedInput + sample * inputStride;
+            uint8_t* patches = m_patches.data() + sample * patchStride * m_numPositions;
+            for (size_t position = 0; position < m_numPositions; position++)
+            {
+                const int* offsets = m_patchOffsets.data() + position * kernelSize;
+                uint8_t* patch = patches + position * patchStride;
+                for (size_t i = 0; i < kernelSize; i++)
+                    patch[i] = offsets[i] >= 0 ? x[offsets[i]] : zeroPoint;
+                std::fill(patch + kernelSize, patch + patchStride, zeroPoint);
+            }
+        }
+
+        // output element (channel k, position l) is row k * positions + l of its sample
+        for (size_t sample = 0; sample < numSamples; sample++)
+            m_weights->Multiply(m_patches.data() + sample * patchStride * m_numPositions, m_numPositions,
+                                result.Data() + sample * outputSize, m_numPositions, 1);
+    }
+
+    void /*ComputationNode::*/ BackpropTo(const size_t /*inputIndex*/, const FrameRange& /*fr*/) override
+    {
+        LogicError("%ls %ls operation: Quantized nodes can only be used for evaluation.", NodeName().c_str(), OperationName().c_str());
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+
+    void Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase(isFinalValidationPass);
+
+        if (m_imageLayout != ImageLayoutKind::CHW || m_transpose)
+            InvalidArgument("%ls %ls operation: Only non-transposed convolutions in CHW layout can be quantized.", NodeName().c_str(), OperationName().c_str());
+
+        TensorShape inputShape = GetInputSampleLayout(0);
+        auto outputShape = ConvolveGeometry::ComputeOutputShape(inputShape, m_kernelShape, m_mapCount, m_stride,
+                                                               m_sharing, m_autoPad, m_lowerPad, m_upperPad);
+        SetDims(outputShape, HasMBLayout());
+
+        if (isFinalValidationPass)
+        {
+            if (!m_weights)
+                InvalidArgument("%ls %ls operation: No quantized weights. This node is created by quantizing a trained model.", NodeName().c_str(), OperationName().c_str());
+
+            ConvolveGeometry geometry(inputShape, m_kernelShape, m_mapCount, m_stride, m_sharing, m_autoPad, m_lowerPad, m_upperPad);
+            if (!TryGetPatchOffsets(geometry, m_patchOffsets, m_numPositions))
+                InvalidArgument("%ls %ls operation: The convolution geometry is not supported by quantized evaluation.", NodeName().c_str(), OperationName().c_str());
+            if (m_weights->m_rows != geometry.KernelCount() || m_weights->m_depth != m_kernelShape.GetNumElements())
+                InvalidArgument("%ls %ls operation: The quantized weights [%d x %d] don't match the convolution geometry.",
+                                NodeName().c_str(), OperationName().c_str(), (int)m_weights->m_rows, (int)m_weights->m_depth);
+        }
+    }
+
+private:
+    shared_ptr<const Int8Weights> m_weights;
+    std::vector<int> m_patchOffsets; // [kernelSize x positions], input element read by each kernel element, or -1
+    size_t m_numPositions;
+    std::vector<uint8_t> m_quantizedInput;
+    std::vector<uint8_t> m_patches;
+};
+
+template class QuantizedConvolutionNode<float>;
+template class QuantizedConvolutionNode<double>;
+
+// -----------------------------------------------------------------------
+// HalfPrecisionWeights -- weight matrix of a HalfPrecisionTimesNode, stored column-major in Float16 or BFloat16
+// -----------------------------------------------------------------------
+
+struct HalfPrecisionWeights
+{
+    size_t m_rows;
+    size_t m_cols;
+    HalfPrecisionFormat m_format;
+    std::vector<uint16_t> m_values;
+
+    HalfPrecisionWeights()
+        : m_rows(0), m_cols(0), m_format(HalfPrecisionFormat::Float16)
+    {
+    }
+
+    template <class ElemType>
+    HalfPrecisionWeights(const ElemType* weights, size_t rows, size_t cols, HalfPrecisionFormat format)
+        : m_rows(rows), m_cols(cols), m_format(format), m_values(rows * cols)
+    {
+        HalfGemm::FromFloat(weights, m_values.size(), format, m_values.data());
+    }
+
+    size_t SizeInBytes() const { return m_values.size() * sizeof(uint16_t); }
+
+    void Save(File& fstream) const
+    {
+        fstream << m_rows << m_cols << (int)m_format;
+        if (!m_values.empty())
+            fwriteOrDie(m_values.data(), sizeof(uint16_t), m_values.size(), fstream);
+    }
+
+    void Load(File& fstream)
+    {
+        int format;
+        fstream >> m_rows >> m_cols >> format;
+        if (format != (int)HalfPrecisionFormat::Float16 && format != (int)HalfPrecisionFormat::BFloat16)
+            RuntimeError("HalfPrecisionWeights: Unknown format %d.", format);
+        m_format = (HalfPrecisionFormat)format;
+        m_values.resize(m_rows * m_cols);
+        if (!m_values.empty())
+            freadOrDie(m_values.data(), sizeof(uint16_t), m_values.size(), fstream);
+    }
+};
+
+// -----------------------------------------------------------------------
+// HalfPrecisionTimesNode (input)
+// Replacement of TimesNode (W, input) for a parameter W that reduces over the entire sample of the input, where W is
+// stored in 16 bits. The product is computed in single precision; only the memory traffic for W is halved, which is
+// what bounds the speed of small-minibatch evaluation, e.g. of recurrent networks.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class HalfPrecisionTimesNode : public ComputationNode<ElemType>, public NumInputs<1>
+{
+    typedef ComputationNode<ElemType> Base; UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName() { return L"HalfPrecisionTimes"; }
+
+public:
+    DeclareConstructorFromConfigWithNumInputs(HalfPrecisionTimesNode);
+    HalfPrecisionTimesNode(DEVICEID_TYPE deviceId, const wstring& name, const TensorShape& outputShape = TensorShape())
+        : Base(deviceId, name), m_outputShape(outputShape)
+    {
+    }
+
+    void Save(File& fstream) const override
+    {
+        Base::Save(fstream);
+        m_outputShape.Save(fstream);
+        m_weights->Save(fstream);
+    }
+
+    void Load(File& fstream, size_t modelVersion) override
+    {
+        Base::Load(fstream, modelVersion);
+        m_outputShape.Load(fstream);
+        auto weights = make_shared<HalfPrecisionWeights>();
+        weights->Load(fstream);
+        m_weights = weights;
+    }
+
+    // the weights are shared between clones, e.g. between the evaluators of a shared model
+    void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<HalfPrecisionTimesNode<ElemType>>(nodeP);
+            node->m_outputShape = m_outputShape;
+            node->m_weights = m_weights;
+        }
+    }
+
+    void SetWeights(const shared_ptr<const HalfPrecisionWeights>& weights) { m_weights = weights; }
+    const HalfPrecisionWeights& Weights() const { return *m_weights; }
+
+    void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
+    {
+        if (Value().GetDeviceId() != CPUDEVICE)
+            LogicError("%ls %ls operation: Half-precision weights are only implemented on the CPU.", NodeName().c_str(), OperationName().c_str());
+
+        auto input = InputRef(0).ValueFor(fr);
+        auto result = ValueFor(fr);
+        if (input.GetMatrixType() != MatrixType::DENSE)
+            InvalidArgument("%ls %ls operation: Half-precision weights require a dense input.", NodeName().c_str(), OperationName().c_str());
+        HalfGemm::Multiply(m_weights->m_values.data(), m_weights->m_format, m_weights->m_rows, m_weights->m_cols,
+                           input.Data(), input.GetNumCols(), result.Data());
+    }
+
+    void /*ComputationNode::*/ BackpropTo(const size_t /*inputIndex*/, const FrameRange& /*fr*/) override
+    {
+        LogicError("%ls %ls operation: Half-precision nodes can only be used for evaluation.", NodeName().c_str(), OperationName().c_str());
+    }
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+
+    void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
+    {
+        Base::Validate(isFinalValidationPass);
+        InferMBLayoutFromInputsForStandardCase(isFinalValidationPass);
+        SetDims(m_outputShape, HasMBLayout());
+
+        if (isFinalValidationPass)
+        {
+            if (!m_weights)
+                InvalidArgument("%ls %ls operation: No weights. This node is created by reducing the parameter precision of a trained model.", NodeName().c_str(), OperationName().c_str());
+            if (m_weights->m_rows != m_outputShape.GetNumElements() || m_weights->m_cols != Input(0)->GetSampleLayout().GetNumElements())
+                InvalidArgument("%ls %ls operation: The weights [%d x %d] don't match the output [%s] and input [%s] shapes.",
+                                NodeName().c_str(), OperationName().c_str(), (int)m_weights->m_rows, (int)m_weights->m_cols,
+                                string(m_outputShape).c_str(), string(Input(0)->GetSampleLayout()).c_str());
+        }
+    }
+
+private:
+    TensorShape m_outputShape;
+    shared_ptr<const HalfPrecisionWeights> m_weights;
+};
+
+template class HalfPrecisionTimesNode<float>;
+template class HalfPrecisionTimesNode<double>;
+
+}}}
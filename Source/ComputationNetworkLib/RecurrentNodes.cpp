@@ -494,6 +494,100 @@ template<class ElemType, int direction>
         LogicError("Unrecognized direction in DelayedValueNodeBase");
 }
 
+// Streaming evaluation: the state of a stream is its last m_timeStep frames (fewer if it is shorter). For the next minibatch,
+// they are laid out as if they were the last m_timeStep frames of the previous minibatch, with each stream right-aligned, so
+// that ForwardProp() finds them the same way as in truncated BPTT. The minibatch layout has to tell by the begin of each
+// sequence (negative: continued from the past) how many of these frames are valid.
+template<class ElemType, int direction>
+/*virtual*/ void DelayedValueNodeBase<ElemType, direction>::/*IStatefulNode::*/ ImportStreamStates(const std::vector<NodeStatePtr>& states) /*override*/
+{
+    int dir = direction;
+    if (dir != -1)
+        RuntimeError("%ls %ls operation: Streaming evaluation is only possible for delays into the past.", NodeName().c_str(), OperationName().c_str());
+
+    size_t numStreams = states.size();
+    size_t numTimeSteps = m_timeStep;
+    size_t numRows = GetSampleLayout().GetNumElements();
+    m_delayedValue->Resize(numRows, numTimeSteps * numStreams);
+    m_delayedValue->SetValue(0);
+    if (!m_delayedActivationMBLayout)
+        m_delayedActivationMBLayout = make_shared<MBLayout>();
+    m_delayedActivationMBLayout->Init(numStreams, numTimeSteps);
+
+    for (size_t s = 0; s < numStreams; s++)
+    {
+        size_t numFrames = 0;
+        if (states[s])
+        {
+            DelayedNodeStatePtr pState = dynamic_pointer_cast<DelayedValueNodeState<ElemType>>(states[s]);
+            if (!pState)
+                LogicError("Expecting DelayValueNodeState after downcasting");
+            if (!pState->IsEmpty())
+            {
+                const Matrix<ElemType>& frames = pState->ExportCachedActivity();
+                numFrames = frames.GetNumCols();
+                if (frames.GetNumRows() != numRows || numFrames > numTimeSteps)
+                    LogicError("%ls %ls operation: Imported stream state has dimensions [%d x %d], expected [%d x <= %d].", NodeName().c_str(), OperationName().c_str(),
+                               (int)frames.GetNumRows(), (int)numFrames, (int)numRows, (int)numTimeSteps);
+                for (size_t j = 0; j < numFrames; j++)
+                    m_delayedValue->SetColumnSlice(frames.ColumnSlice(j, 1), (numTimeSteps - numFrames + j) * numStreams + s, 1);
+            }
+        }
+        m_delayedActivationMBLayout->AddGap(s, 0, numTimeSteps - numFrames);
+        if (numFrames > 0)
+            m_delayedActivationMBLayout->AddSequence(s, s, numTimeSteps - numFrames, numTimeSteps);
+    }
+}
+
+template<class ElemType, int direction>
+/*virtual*/ NodeStatePtr DelayedValueNodeBase<ElemType, direction>::/*IStatefulNode::*/ ExportStreamState(size_t s, const NodeStatePtr& previousState) /*override*/
+{
+    // EndForwardProp() has kept the input of the last minibatch in m_delayedValue, m_delayedActivationMBLayout
+    if (!m_delayedActivationMBLayout || s >= m_delayedActivationMBLayout->GetNumParallelSequences())
+        LogicError("%ls %ls operation: No stream %d in the last minibatch.", NodeName().c_str(), OperationName().c_str(), (int)s);
+
+    size_t numStreams = m_delayedActivationMBLayout->GetNumParallelSequences();
+    size_t numTimeSteps = m_delayedActivationMBLayout->GetNumTimeSteps();
+
+    // the stream's frames are those of its last sequence
+    const MBLayout::SequenceInfo* sequence = nullptr;
+    for (const auto& seq : m_delayedActivationMBLayout->GetAllSequences())
+    {
+        if (seq.seqId != GAP_SEQUENCE_ID && seq.s == s && (!sequence || seq.tBegin > sequence->tBegin))
+            sequence = &seq;
+    }
+
+    size_t numNewFrames = 0, tEnd = 0;
+    bool continuesPrevious = false;
+    if (sequence)
+    {
+        tEnd = min(sequence->tEnd, numTimeSteps);
+        numNewFrames = min(tEnd - (size_t)max(sequence->tBegin, (ptrdiff_t)0), (size_t)m_timeStep);
+        continuesPrevious = sequence->tBegin < 0;
+    }
+
+    // too short to fill the history: the rest comes from the previous state
+    size_t numPreviousFrames = 0;
+    DelayedNodeStatePtr pPrevious = dynamic_pointer_cast<DelayedValueNodeState<ElemType>>(previousState);
+    if (continuesPrevious && numNewFrames < (size_t)m_timeStep && pPrevious && !pPrevious->IsEmpty())
+        numPreviousFrames = min(pPrevious->ExportCachedActivity().GetNumCols(), m_timeStep - numNewFrames);
+
+    auto pState = make_shared<DelayedValueNodeState<ElemType>>(m_deviceId);
+    if (numPreviousFrames + numNewFrames == 0)
+        return pState;
+
+    Matrix<ElemType> frames(m_delayedValue->GetNumRows(), numPreviousFrames + numNewFrames, m_deviceId);
+    if (numPreviousFrames > 0)
+    {
+        const auto& previousFrames = pPrevious->ExportCachedActivity();
+        frames.SetColumnSlice(previousFrames.ColumnSlice(previousFrames.GetNumCols() - numPreviousFrames, numPreviousFrames), 0, numPreviousFrames);
+    }
+    for (size_t j = 0; j < numNewFrames; j++)
+        frames.SetColumnSlice(m_delayedValue->ColumnSlice((tEnd - numNewFrames + j) * numStreams + s, 1), numPreviousFrames + j, 1);
+    pState->CacheState(frames);
+    return pState;
+}
+
 // instantiate the classes that derive from the above
 template class PastValueNode<float>;
 template class PastValueNode<double>;
@@ -73,6 +73,8 @@ public:
     virtual int /*IRecurrentNode::*/ GetRecurrenceSteppingDirection() const override { return -direction; }
     virtual NodeStatePtr /*IStatefulNode::*/ ExportState() override;
     virtual void /*IStatefulNode::*/ ImportState(const NodeStatePtr& pImportedState) override;
+    virtual void /*IStatefulNode::*/ ImportStreamStates(const std::vector<NodeStatePtr>& states) override;
+    virtual NodeStatePtr /*IStatefulNode::*/ ExportStreamState(size_t s, const NodeStatePtr& previousState) override;
     int TimeStep() const { return m_timeStep; }
     ElemType InitialActivationValue() const { return m_initialStateValue; }
 
@@ -61,6 +61,22 @@ void CNTKEvalBase<ElemType>::CreateNetwork(const std::string& networkDescription
     {
         LogicError("Unable to construct network from description");
     }
+
+    // strip everything that is only needed for training; outputs not in outputNodeNames (or the model's output nodes) are lost
+    if (config(L"optimizeForInference", m_config(L"optimizeForInference", false)))
+        this->m_net->template OptimizeForInference<ElemType>(this->m_net->OutputNodesByName(outputNodeNames));
+
+    // store the weights of Times nodes in 16 bits, halving the memory traffic of small-minibatch evaluation
+    wstring parameterPrecision = config(L"parameterPrecision", m_config(L"parameterPrecision", L""));
+    if (parameterPrecision == L"float16" || parameterPrecision == L"bfloat16")
+        this->m_net->template ReduceParameterPrecision<ElemType>(parameterPrecision == L"float16" ? HalfPrecisionFormat::Float16 : HalfPrecisionFormat::BFloat16);
+    else if (!parameterPrecision.empty())
+        InvalidArgument("CreateNetwork: Unknown parameterPrecision '%ls', expected 'float16' or 'bfloat16'.", parameterPrecision.c_str());
+
+    // evaluate convolutions, pooling and element-wise operations in channel blocks of 8 or 16 (CPU only)
+    size_t channelBlockSize = config(L"channelBlockSize", m_config(L"channelBlockSize", (size_t)0));
+    if (channelBlockSize != 0)
+        this->m_net->template ConvertToBlockedLayout<ElemType>(this->m_net->OutputNodesByName(outputNodeNames), channelBlockSize);
 }
 
 
@@ -266,6 +282,17 @@ void CNTKEvalExtended<ElemType>::StartForwardEvaluation(const std::vector<wstrin
     this->m_net->StartEvaluateMinibatchLoop(m_outputNodes);
     m_inputMatrices = DataReaderHelpers::RetrieveInputMatrices(m_inputNodes);
 
+    // stateful (recurrent) nodes, whose state a streaming session carries from chunk to chunk
+    m_statefulNodes.clear();
+    for (const auto& outputNode : m_outputNodes)
+    {
+        for (const auto& node : this->m_net->GetAllNodesForRoot(outputNode))
+        {
+            if (dynamic_pointer_cast<IStatefulNode>(node) && std::find(m_statefulNodes.begin(), m_statefulNodes.end(), node) == m_statefulNodes.end())
+                m_statefulNodes.push_back(node);
+        }
+    }
+
     for (const auto& node : m_outputNodes)
     {
         shared_ptr<Matrix<ElemType>> outputMatrix = dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr());
@@ -306,6 +333,86 @@ VariableSchema CNTKEvalExtended<ElemType>::GetInputSchema() const
     return inputLayouts;
 }
 
+// Checks an input buffer against the layout of input node 'i' and returns the number of samples in it.
+template<typename ElemType>
+template<template<typename> class ValueContainer>
+size_t CNTKEvalExtended<ElemType>::CheckInputBuffer(size_t i, const ValueBuffer<ElemType, ValueContainer>& buffer) const
+{
+    auto matrix = dynamic_pointer_cast<Matrix<ElemType>>(m_inputNodes[i]->ValuePtr());
+    auto type = matrix->GetMatrixType();
+    size_t numRows = m_inputNodes[i]->GetSampleLayout().GetNumElements();
+
+    if (buffer.m_buffer.data() == nullptr)
+        RuntimeError("Input %ls: Buffer is not allocated.", m_inputNodes[i]->GetName().c_str());
+    if (type == MatrixType::DENSE)
+    {
+        if (buffer.m_buffer.size() % numRows != 0)
+            RuntimeError("Input %ls: Expected input data to be a multiple of %" PRIu64 ", but it is %" PRIu64 ".", 
+                         m_inputNodes[i]->GetName().c_str(), numRows, buffer.m_buffer.size());
+        if (buffer.m_buffer.size() == 0)
+            RuntimeError("Input %ls: Expected at least one element.", m_inputNodes[i]->GetName().c_str());
+    }
+    else if (type == MatrixType::SPARSE)
+    {
+        if (buffer.m_colIndices.data() == nullptr)
+            RuntimeError("Input %ls: Due to sparse input format, expected colIndices array, but was nullptr.", m_inputNodes[i]->GetName().c_str());
+        if (buffer.m_indices.data() == nullptr)
+            RuntimeError("Input %ls: Due to sparse input format, expected Indices array, but was nullptr.", m_inputNodes[i]->GetName().c_str());
+        if (buffer.m_colIndices.size() < 2)
+            RuntimeError("Input %ls: Expected at least one element (2 entries in colIndices array).", m_inputNodes[i]->GetName().c_str());
+        if (buffer.m_colIndices[0] != 0)
+            RuntimeError("Input %ls: First element of column indices must be 0", m_inputNodes[i]->GetName().c_str());
+        if (buffer.m_colIndices[buffer.m_colIndices.size() - 1] != buffer.m_indices.size())
+            RuntimeError("Input %ls: Last element of column indices must be equal to the size of indices (%ld), but was %d", 
+                         m_inputNodes[i]->GetName().c_str(), buffer.m_indices.size(), 
+                         buffer.m_colIndices[buffer.m_colIndices.size() - 1]);
+    }
+
+    size_t numCols = type == MatrixType::DENSE ? buffer.m_buffer.size() / numRows : buffer.m_colIndices.size() - 1;
+    assert(numCols >= 1);
+    return numCols;
+}
+
+// Lets dense CPU matrices of the network use caller memory for the duration of one ForwardPass(), instead of copying
+// the inputs in and the outputs out. Every bound matrix gets its own storage back when the bindings go out of scope.
+template <typename ElemType>
+class ExternalBufferBindings
+{
+public:
+    ~ExternalBufferBindings()
+    {
+        for (auto& binding : m_bindings)
+            *binding.first = std::move(*binding.second);
+    }
+
+    // Binds 'matrix' to 'data' if that is possible without changing the computation, otherwise returns false and the
+    // caller has to copy. Binding requires a dense matrix on the CPU and a buffer that is aligned for ElemType.
+    bool TryBind(const shared_ptr<Matrix<ElemType>>& matrix, size_t numRows, size_t numCols, ElemType* data)
+    {
+        if (matrix->GetMatrixType() != MatrixType::DENSE || matrix->GetDeviceId() != CPUDEVICE ||
+            data == nullptr || reinterpret_cast<uintptr_t>(data) % alignof(ElemType) != 0 || IsBound(matrix))
+            return false;
+
+        // the Matrix object itself stays in place, since nodes share it; only its storage is swapped (moves are shallow)
+        m_bindings.push_back(make_pair(matrix, make_shared<Matrix<ElemType>>(std::move(*matrix))));
+        *matrix = Matrix<ElemType>(numRows, numCols, data, CPUDEVICE, matrixFlagDontOwnBuffer);
+        return true;
+    }
+
+    bool IsBound(const shared_ptr<Matrix<ElemType>>& matrix) const
+    {
+        for (const auto& binding : m_bindings)
+        {
+            if (binding.first == matrix)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    std::vector<std::pair<shared_ptr<Matrix<ElemType>>, shared_ptr<Matrix<ElemType>>>> m_bindings; // (bound matrix, its own storage)
+};
+
 template<typename ElemType>
 template<template<typename> class ValueContainer>
 void CNTKEvalExtended<ElemType>::ForwardPassT(const std::vector<ValueBuffer<ElemType, ValueContainer> >& inputs, std::vector<ValueBuffer<ElemType, ValueContainer> >& outputs, bool resetRNN)
@@ -319,6 +426,10 @@ void CNTKEvalExtended<ElemType>::ForwardPassT(const std::vector<ValueBuffer<Elem
     if (outputs.size() != m_outputNodes.size())
         RuntimeError("Expected %d outputs, but got %d.", (int)m_outputNodes.size(), (int)outputs.size());
 
+    // Dense inputs and outputs on the CPU are bound to the caller's buffers directly; the network reads and writes
+    // them in place. Everything else is copied as before.
+    ExternalBufferBindings<ElemType> bindings;
+
     size_t i = 0;
     for (auto& inputNode : m_inputNodes)
     {
@@ -329,41 +440,17 @@ void CNTKEvalExtended<ElemType>::ForwardPassT(const std::vector<ValueBuffer<Elem
         auto type = matrix->GetMatrixType();
         size_t numRows = inputNode->GetSampleLayout().GetNumElements();
 
-        if (buffer.m_buffer.data() == nullptr)
-            RuntimeError("Input %ls: Buffer is not allocated.", m_inputNodes[i]->GetName().c_str());
-        if (type == MatrixType::DENSE)
-        {
-            if (buffer.m_buffer.size() % numRows != 0)
-                RuntimeError("Input %ls: Expected input data to be a multiple of %" PRIu64 ", but it is %" PRIu64 ".", 
-                             m_inputNodes[i]->GetName().c_str(), numRows, buffer.m_buffer.size());
-            if (buffer.m_buffer.size() == 0)
-                RuntimeError("Input %ls: Expected at least one element.", m_inputNodes[i]->GetName().c_str());
-        }
-        else if (type == MatrixType::SPARSE)
-        {
-            if (buffer.m_colIndices.data() == nullptr)
-                RuntimeError("Input %ls: Due to sparse input format, expected colIndices array, but was nullptr.", m_inputNodes[i]->GetName().c_str());
-            if (buffer.m_indices.data() == nullptr)
-                RuntimeError("Input %ls: Due to sparse input format, expected Indices array, but was nullptr.", m_inputNodes[i]->GetName().c_str());
-            if (buffer.m_colIndices.size() < 2)
-                RuntimeError("Input %ls: Expected at least one element (2 entries in colIndices array).", m_inputNodes[i]->GetName().c_str());
-            if (buffer.m_colIndices[0] != 0)
-                RuntimeError("Input %ls: First element of column indices must be 0", m_inputNodes[i]->GetName().c_str());
-            if (buffer.m_colIndices[buffer.m_colIndices.size() - 1] != buffer.m_indices.size())
-                RuntimeError("Input %ls: Last element of column indices must be equal to the size of indices (%ld), but was %d", 
-                             m_inputNodes[i]->GetName().c_str(), buffer.m_indices.size(), 
-                             buffer.m_colIndices[buffer.m_colIndices.size() - 1]);
-        }
-
-        int numCols = type == MatrixType::DENSE ? buffer.m_buffer.size() / numRows : buffer.m_colIndices.size() - 1;
-        assert(numCols >= 1);
+        size_t numCols = CheckInputBuffer(i, buffer);
         inputNode->GetMBLayout()->Init(1, numCols);
         
         // INT_MIN is used to specify the lower bound of look-back step of recurrent nodes
         inputNode->GetMBLayout()->AddSequence(0, 0, resetRNN ? 0 : INT_MIN, numCols);
 
         if (type == MatrixType::DENSE)
-            matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), buffer.m_buffer.data(), matrixFlagNormal);
+        {
+            if (!bindings.TryBind(matrix, numRows, numCols, buffer.m_buffer.data()))
+                matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), buffer.m_buffer.data(), matrixFlagNormal);
+        }
         else if (type == MatrixType::SPARSE)
         {
             // In the sparse case the m_data layout is identical to CUDA's CSC layout
@@ -375,12 +462,35 @@ void CNTKEvalExtended<ElemType>::ForwardPassT(const std::vector<ValueBuffer<Elem
         ++i;
     }
 
+    // An output can be computed into the caller's buffer if its size is known up front, i.e. if it has the dynamic
+    // axis of one of the inputs, and the buffer is large enough. Input nodes that are also outputs stay bound to the input.
+    for (size_t i = 0; i < m_outputNodes.size(); ++i)
+    {
+        auto node = m_outputNodes[i];
+        auto pMBLayout = node->GetMBLayout();
+        bool hasInputLayout = false;
+        for (const auto& inputNode : m_inputNodes)
+            hasInputLayout |= pMBLayout && inputNode->GetMBLayout() == pMBLayout;
+        if (!hasInputLayout)
+            continue;
+
+        size_t numRows = node->GetSampleLayout().GetNumElements();
+        size_t numCols = pMBLayout->GetNumCols();
+        ValueContainer<ElemType>& vec = outputs[i].m_buffer;
+        if (vec.capacity() < numRows * numCols)
+            continue; // reported below
+
+        // resize first: for std::vector this value-initializes, which must not happen after the forward pass
+        vec.resize(numRows * numCols);
+        bindings.TryBind(dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr()), numRows, numCols, const_cast<ElemType*>(vec.data()));
+    }
+
     ComputationNetwork::BumpEvalTimeStamp(m_inputNodes);
+    this->m_net->ForwardProp(m_outputNodes); // one traversal for all outputs
 
     for (size_t i = 0; i < m_outputNodes.size(); ++i)
     {
         auto node = m_outputNodes[i];
-        this->m_net->ForwardProp(node);
         shared_ptr<Matrix<ElemType>> outputMatrix = dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr());
         auto pMBLayout = node->GetMBLayout();
         if (!pMBLayout)
@@ -403,12 +513,317 @@ void CNTKEvalExtended<ElemType>::ForwardPassT(const std::vector<ValueBuffer<Elem
             RuntimeError("Not enough space in output buffer for output '%ls'.", node->GetName().c_str());
         }
 
+        // nothing to copy if the node has computed its value in place
+        if (outputMatrix->GetMatrixType() == MatrixType::DENSE && outputMatrix->GetDeviceId() == CPUDEVICE &&
+            outputMatrix->Data() == vec.data() && vec.size() == numElements)
+            continue;
+
         vec.resize(numElements);
         ElemType* data = const_cast<ElemType*>(vec.data());
         outputMatrix->CopyToArray(data, numElements);
     }
 }
 
+template<typename ElemType>
+template<template<typename> class ValueContainer>
+void CNTKEvalExtended<ElemType>::CheckBatchBuffers(const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& inputs,
+                                                   const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& outputs) const
+{
+    if (!m_started)
+        RuntimeError("ForwardPass() called before StartForwardEvaluation()");
+
+    size_t numSequences = inputs.size();
+    if (numSequences == 0)
+        RuntimeError("Expected at least one sequence.");
+    if (outputs.size() != numSequences)
+        RuntimeError("Expected outputs for %d sequences, but got %d.", (int)numSequences, (int)outputs.size());
+    for (size_t seq = 0; seq < numSequences; ++seq)
+    {
+        if (inputs[seq].size() != m_inputNodes.size())
+            RuntimeError("Sequence %d: Expected %d inputs, but got %d.", (int)seq, (int)m_inputNodes.size(), (int)inputs[seq].size());
+        if (outputs[seq].size() != m_outputNodes.size())
+            RuntimeError("Sequence %d: Expected %d outputs, but got %d.", (int)seq, (int)m_outputNodes.size(), (int)outputs[seq].size());
+    }
+}
+
+// Copies input 'i' of all sequences into the input matrix, whose MBLayout has already been set up.
+// placement - for every sequence, the parallel sequence and time step it begins at
+template<typename ElemType>
+template<template<typename> class ValueContainer>
+void CNTKEvalExtended<ElemType>::PackBatchInput(size_t i, const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& inputs,
+                                                const std::vector<size_t>& lengths, const std::vector<std::pair<size_t, size_t>>& placement)
+{
+    const auto& inputNode = m_inputNodes[i];
+    auto matrix = dynamic_pointer_cast<Matrix<ElemType>>(inputNode->ValuePtr());
+    auto type = matrix->GetMatrixType();
+    size_t numRows = inputNode->GetSampleLayout().GetNumElements();
+    auto pMBLayout = inputNode->GetMBLayout();
+    size_t numSequences = inputs.size();
+    size_t numParallelSequences = pMBLayout->GetNumParallelSequences();
+    size_t numCols = numParallelSequences * pMBLayout->GetNumTimeSteps();
+
+    // sample t of sequence seq goes to column (tBegin + t) * numParallelSequences + s; gaps stay zero / empty
+    if (type == MatrixType::DENSE)
+    {
+        m_packedValues.assign(numRows * numCols, 0);
+        for (size_t seq = 0; seq < numSequences; ++seq)
+        {
+            const ElemType* data = inputs[seq][i].m_buffer.data();
+            for (size_t t = 0; t < lengths[seq]; ++t)
+            {
+                size_t col = (placement[seq].second + t) * numParallelSequences + placement[seq].first;
+                memcpy(m_packedValues.data() + col * numRows, data + t * numRows, numRows * sizeof(ElemType));
+            }
+        }
+        matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), m_packedValues.data(), matrixFlagNormal);
+    }
+    else if (type == MatrixType::SPARSE)
+    {
+        // first the number of non-zeros per column, then their start offsets
+        m_packedColIndices.assign(numCols + 1, 0);
+        for (size_t seq = 0; seq < numSequences; ++seq)
+        {
+            const auto& colIndices = inputs[seq][i].m_colIndices;
+            for (size_t t = 0; t < lengths[seq]; ++t)
+            {
+                size_t col = (placement[seq].second + t) * numParallelSequences + placement[seq].first;
+                m_packedColIndices[col + 1] = colIndices[t + 1] - colIndices[t];
+            }
+        }
+        for (size_t col = 0; col < numCols; ++col)
+            m_packedColIndices[col + 1] += m_packedColIndices[col];
+
+        size_t nz = m_packedColIndices[numCols];
+        m_packedValues.resize(nz);
+        m_packedIndices.resize(nz);
+        for (size_t seq = 0; seq < numSequences; ++seq)
+        {
+            const auto& buffer = inputs[seq][i];
+            for (size_t t = 0; t < lengths[seq]; ++t)
+            {
+                size_t col = (placement[seq].second + t) * numParallelSequences + placement[seq].first;
+                size_t begin = buffer.m_colIndices[t];
+                size_t count = buffer.m_colIndices[t + 1] - begin;
+                memcpy(m_packedValues.data() + m_packedColIndices[col], buffer.m_buffer.data() + begin, count * sizeof(ElemType));
+                memcpy(m_packedIndices.data() + m_packedColIndices[col], buffer.m_indices.data() + begin, count * sizeof(int));
+            }
+        }
+        matrix->SetMatrixFromCSCFormat(m_packedColIndices.data(), m_packedIndices.data(), m_packedValues.data(),
+                                       nz, numRows, numCols);
+    }
+}
+
+// Computes the outputs and copies them out per sequence; sequence seq is the one with seqId seq in the MBLayout.
+template<typename ElemType>
+template<template<typename> class ValueContainer>
+void CNTKEvalExtended<ElemType>::ForwardPropBatchOutputs(std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& outputs)
+{
+    size_t numSequences = outputs.size();
+    this->m_net->ForwardProp(m_outputNodes); // one traversal for all outputs
+
+    for (size_t i = 0; i < m_outputNodes.size(); ++i)
+    {
+        auto node = m_outputNodes[i];
+        shared_ptr<Matrix<ElemType>> outputMatrix = dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr());
+        size_t numRows = outputMatrix->GetNumRows();
+        size_t numElements = outputMatrix->GetNumElements();
+        m_packedValues.resize(numElements);
+        ElemType* packedOutput = m_packedValues.data();
+        outputMatrix->CopyToArray(packedOutput, numElements);
+
+        auto pMBLayout = node->GetMBLayout();
+        if (!pMBLayout)
+        {
+            // not a function of the sequences: every sequence gets the same output
+            for (size_t seq = 0; seq < numSequences; ++seq)
+            {
+                ValueContainer<ElemType>& vec = outputs[seq][i].m_buffer;
+                if (vec.capacity() < numElements)
+                    RuntimeError("Not enough space in output buffer for output '%ls' of sequence %d.", node->GetName().c_str(), (int)seq);
+                vec.resize(numElements);
+                memcpy(const_cast<ElemType*>(vec.data()), packedOutput, numElements * sizeof(ElemType));
+            }
+            continue;
+        }
+
+        // find every sequence in the output layout; usually that is the input layout
+        std::vector<const MBLayout::SequenceInfo*> sequences(numSequences, nullptr);
+        for (const auto& sequence : pMBLayout->GetAllSequences())
+        {
+            if (sequence.seqId != GAP_SEQUENCE_ID && sequence.seqId < numSequences)
+                sequences[sequence.seqId] = &sequence;
+        }
+
+        size_t numParallelSequences = pMBLayout->GetNumParallelSequences();
+        for (size_t seq = 0; seq < numSequences; ++seq)
+        {
+            if (!sequences[seq])
+                RuntimeError("Output '%ls' has no result for sequence %d.", node->GetName().c_str(), (int)seq);
+            const auto& sequence = *sequences[seq];
+            size_t tBegin = (size_t)max(sequence.tBegin, (ptrdiff_t)0);
+            size_t tEnd = min(sequence.tEnd, pMBLayout->GetNumTimeSteps());
+
+            ValueContainer<ElemType>& vec = outputs[seq][i].m_buffer;
+            size_t numSequenceElements = numRows * (tEnd - tBegin);
+            if (vec.capacity() < numSequenceElements)
+                RuntimeError("Not enough space in output buffer for output '%ls' of sequence %d.", node->GetName().c_str(), (int)seq);
+            vec.resize(numSequenceElements);
+            ElemType* data = const_cast<ElemType*>(vec.data());
+            for (size_t t = tBegin; t < tEnd; ++t)
+                memcpy(data + (t - tBegin) * numRows, packedOutput + (t * numParallelSequences + sequence.s) * numRows, numRows * sizeof(ElemType));
+        }
+    }
+}
+
+// Evaluates a batch of independent sequences in one minibatch. The sequences of every input are packed into
+// parallel streams the same way the readers' SequencePacker does, several short sequences sharing a stream where
+// they fit, so that the network runs over numParallelSequences x maxLength columns instead of N separate minibatches.
+template<typename ElemType>
+template<template<typename> class ValueContainer>
+void CNTKEvalExtended<ElemType>::ForwardPassBatchT(const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& inputs,
+                                                   std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& outputs)
+{
+    CheckBatchBuffers(inputs, outputs);
+    size_t numSequences = inputs.size();
+
+    // Inputs sharing a dynamic axis share the MBLayout, which is packed once; their sequences must be of the same lengths.
+    // [layout] -> (sequence lengths, placement (parallel sequence, begin time) of each sequence)
+    std::map<MBLayoutPtr, std::pair<std::vector<size_t>, std::vector<std::pair<size_t, size_t>>>> packedLayouts;
+    std::vector<size_t> lengths(numSequences);
+    for (size_t i = 0; i < m_inputNodes.size(); ++i)
+    {
+        const auto& inputNode = m_inputNodes[i];
+        auto pMBLayout = inputNode->GetMBLayout();
+
+        for (size_t seq = 0; seq < numSequences; ++seq)
+            lengths[seq] = CheckInputBuffer(i, inputs[seq][i]);
+
+        auto packed = packedLayouts.find(pMBLayout);
+        if (packed == packedLayouts.end())
+        {
+            std::vector<MBLayout::SequenceInfo> infos(numSequences);
+            for (size_t seq = 0; seq < numSequences; ++seq)
+            {
+                infos[seq].seqId = seq;
+                infos[seq].tBegin = 0;
+                infos[seq].tEnd = lengths[seq];
+            }
+            std::vector<std::pair<size_t, size_t>> placement;
+            std::vector<size_t> rowAllocations;
+            pMBLayout->InitAsPackedSequences(infos, placement, rowAllocations);
+            packed = packedLayouts.insert(std::make_pair(pMBLayout, std::make_pair(lengths, placement))).first;
+        }
+        else if (packed->second.first != lengths)
+            RuntimeError("Input %ls: Sequence lengths differ from those of another input with the same dynamic axis.", inputNode->GetName().c_str());
+
+        PackBatchInput(i, inputs, lengths, packed->second.second);
+    }
+
+    ComputationNetwork::BumpEvalTimeStamp(m_inputNodes);
+
+    ForwardPropBatchOutputs(outputs);
+}
+
+template<typename ElemType>
+IEvaluateSession* CNTKEvalExtended<ElemType>::CreateSession()
+{
+    if (!m_started)
+        RuntimeError("CreateSession() called before StartForwardEvaluation()");
+
+    for (const auto& node : m_statefulNodes)
+    {
+        auto recurrentNode = dynamic_pointer_cast<IRecurrentNode>(node);
+        if (recurrentNode && recurrentNode->GetRecurrenceSteppingDirection() < 0)
+            RuntimeError("CreateSession: Node '%ls' looks into the future, which is not possible for streaming evaluation.", node->GetName().c_str());
+    }
+
+    return new CNTKEvalSession(this);
+}
+
+// Evaluates the next chunk of several streaming sessions in one minibatch. Unlike ForwardPassBatchT(), every session gets
+// a parallel sequence of its own, so that the stateful nodes can carry each session's history into its sequence.
+// A session that has seen frames before continues its sequence from the past (negative begin time).
+template<typename ElemType>
+template<template<typename> class ValueContainer>
+void CNTKEvalExtended<ElemType>::ForwardPassSessionsT(const std::vector<IEvaluateSession*>& sessions,
+                                                      const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& inputs,
+                                                      std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& outputs)
+{
+    CheckBatchBuffers(inputs, outputs);
+    size_t numSequences = inputs.size();
+    if (sessions.size() != numSequences)
+        RuntimeError("Expected %d sessions, but got %d.", (int)numSequences, (int)sessions.size());
+
+    std::vector<CNTKEvalSession*> evalSessions(numSequences);
+    for (size_t seq = 0; seq < numSequences; ++seq)
+    {
+        evalSessions[seq] = dynamic_cast<CNTKEvalSession*>(sessions[seq]);
+        if (!evalSessions[seq] || evalSessions[seq]->m_evaluator != this)
+            RuntimeError("Session %d was not created by this evaluator.", (int)seq);
+        if (std::find(evalSessions.begin(), evalSessions.begin() + seq, evalSessions[seq]) != evalSessions.begin() + seq)
+            RuntimeError("Session %d appears more than once.", (int)seq);
+    }
+
+    MBLayoutPtr pMBLayout;
+    std::vector<size_t> lengths(numSequences);
+    std::vector<std::pair<size_t, size_t>> placement(numSequences);
+    for (size_t i = 0; i < m_inputNodes.size(); ++i)
+    {
+        const auto& inputNode = m_inputNodes[i];
+        for (size_t seq = 0; seq < numSequences; ++seq)
+            lengths[seq] = CheckInputBuffer(i, inputs[seq][i]);
+
+        if (!pMBLayout)
+        {
+            pMBLayout = inputNode->GetMBLayout();
+            size_t numTimeSteps = *std::max_element(lengths.begin(), lengths.end());
+            pMBLayout->Init(numSequences, numTimeSteps);
+            for (size_t seq = 0; seq < numSequences; ++seq)
+            {
+                size_t numFramesSeen = min(evalSessions[seq]->m_numFrames, (size_t)INT_MAX);
+                pMBLayout->AddSequence(seq, seq, -(ptrdiff_t)numFramesSeen, lengths[seq]);
+                pMBLayout->AddGap(seq, lengths[seq], numTimeSteps);
+                placement[seq] = std::make_pair(seq, (size_t)0);
+            }
+        }
+        else if (inputNode->GetMBLayout() != pMBLayout)
+            RuntimeError("Input %ls: Streaming evaluation requires all inputs to have the same dynamic axis.", inputNode->GetName().c_str());
+        else
+        {
+            for (size_t seq = 0; seq < numSequences; ++seq)
+            {
+                if (pMBLayout->FindSequence(seq).tEnd != lengths[seq])
+                    RuntimeError("Input %ls: Sequence lengths differ from those of another input.", inputNode->GetName().c_str());
+            }
+        }
+
+        PackBatchInput(i, inputs, lengths, placement);
+    }
+
+    // scatter the sessions' states into the stateful nodes
+    std::vector<NodeStatePtr> states(numSequences);
+    for (size_t k = 0; k < m_statefulNodes.size(); ++k)
+    {
+        for (size_t seq = 0; seq < numSequences; ++seq)
+            states[seq] = k < evalSessions[seq]->m_states.size() ? evalSessions[seq]->m_states[k] : nullptr;
+        dynamic_pointer_cast<IStatefulNode>(m_statefulNodes[k])->ImportStreamStates(states);
+    }
+
+    ComputationNetwork::BumpEvalTimeStamp(m_inputNodes);
+
+    ForwardPropBatchOutputs(outputs);
+
+    // gather the states at the end of the chunks back into the sessions
+    for (size_t seq = 0; seq < numSequences; ++seq)
+    {
+        auto& sessionStates = evalSessions[seq]->m_states;
+        sessionStates.resize(m_statefulNodes.size());
+        for (size_t k = 0; k < m_statefulNodes.size(); ++k)
+            sessionStates[k] = dynamic_pointer_cast<IStatefulNode>(m_statefulNodes[k])->ExportStreamState(seq, sessionStates[k]);
+        evalSessions[seq]->m_numFrames += lengths[seq];
+    }
+}
+
 template<typename ElemType>
 void CNTKEvalExtended<ElemType>::ForwardPass(const Values<ElemType>& inputs, Values<ElemType>& outputs)
 {
@@ -433,6 +848,30 @@ void CNTKEvalExtended<ElemType>::ForwardPass(const ValueRefs<ElemType>& inputs,
     ForwardPassT(inputs, outputs, resetRNN);
 }
 
+template<typename ElemType>
+void CNTKEvalExtended<ElemType>::ForwardPass(const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs)
+{
+    ForwardPassBatchT(inputs, outputs);
+}
+
+template<typename ElemType>
+void CNTKEvalExtended<ElemType>::ForwardPass(const std::vector<ValueRefs<ElemType>>& inputs, std::vector<ValueRefs<ElemType>>& outputs)
+{
+    ForwardPassBatchT(inputs, outputs);
+}
+
+template<typename ElemType>
+void CNTKEvalExtended<ElemType>::ForwardPass(const std::vector<IEvaluateSession*>& sessions, const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs)
+{
+    ForwardPassSessionsT(sessions, inputs, outputs);
+}
+
+template<typename ElemType>
+void CNTKEvalExtended<ElemType>::ForwardPass(const std::vector<IEvaluateSession*>& sessions, const std::vector<ValueRefs<ElemType>>& inputs, std::vector<ValueRefs<ElemType>>& outputs)
+{
+    ForwardPassSessionsT(sessions, inputs, outputs);
+}
+
 template <typename ElemType>
 void CNTKEvalExtended<ElemType>::Destroy()
 {
@@ -459,4 +898,44 @@ extern "C" EVAL_API void GetEvalExtendedD(IEvaluateModelExtended<double>** peval
 
 template class CNTKEvalExtended<double>;
 template class CNTKEvalExtended<float>;
+
+// ----------------------------------------------------------------------------
+// Shared model
+// ----------------------------------------------------------------------------
+
+template <typename ElemType>
+IEvaluateModelExtended<ElemType>* CNTKEvalShared<ElemType>::CreateEvaluator()
+{
+    if (this->m_net == nullptr)
+        RuntimeError("CreateEvaluator() called before CreateNetwork()");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return new CNTKEvalExtended<ElemType>(this->m_net->CloneSharingParameters(), this->m_config);
+}
+
+template <typename ElemType>
+void CNTKEvalShared<ElemType>::Destroy()
+{
+    // evaluators created from this model hold on to the parameters themselves
+    CNTKEvalBase<ElemType>::Destroy();
+    delete this;
+}
+
+template <typename ElemType>
+void EVAL_API GetEvalShared(IEvaluateModelShared<ElemType>** peval)
+{
+    *peval = new CNTKEvalShared<ElemType>();
+}
+
+extern "C" EVAL_API void GetEvalSharedF(IEvaluateModelShared<float>** peval)
+{
+    GetEvalShared(peval);
+}
+extern "C" EVAL_API void GetEvalSharedD(IEvaluateModelShared<double>** peval)
+{
+    GetEvalShared(peval);
+}
+
+template class CNTKEvalShared<double>;
+template class CNTKEvalShared<float>;
 } } }
@@ -13,6 +13,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <mutex>
 
 #include "Eval.h"
 #include "EvalReader.h"
@@ -86,6 +87,29 @@ public:
 // ------------------------------------------------------------------------
 // Extended interface
 // ------------------------------------------------------------------------
+
+// State of the stateful nodes of an evaluator for one input stream
+class CNTKEvalSession : public IEvaluateSession
+{
+public:
+    CNTKEvalSession(const void* evaluator) : m_evaluator(evaluator), m_numFrames(0) {}
+
+    virtual void Reset() override
+    {
+        m_states.clear();
+        m_numFrames = 0;
+    }
+
+    virtual void Destroy() override
+    {
+        delete this;
+    }
+
+    const void* m_evaluator;             // the evaluator that created the session
+    std::vector<NodeStatePtr> m_states;  // [i] state of the evaluator's i-th stateful node; empty if no history
+    size_t m_numFrames;                  // frames seen since the last reset
+};
+
 template <typename ElemType>
 class CNTKEvalExtended : public CNTKEvalBase<ElemType>, public IEvaluateModelExtended<ElemType>
 {
@@ -93,6 +117,13 @@ public:
     CNTKEvalExtended() : CNTKEvalBase<ElemType>(), 
         m_started(false){}
 
+    // evaluator over an existing network, e.g. one that shares its parameters with other evaluators
+    CNTKEvalExtended(const ComputationNetworkPtr& net, const ConfigParameters& config) : CNTKEvalExtended()
+    {
+        this->m_net = net;
+        this->m_config = config;
+    }
+
     virtual VariableSchema GetOutputSchema() const override;
 
     virtual void StartForwardEvaluation(const std::vector<wstring>& outputs) override;
@@ -107,6 +138,16 @@ public:
 
     virtual void ForwardPass(const ValueRefs<ElemType>& inputs, ValueRefs<ElemType>& output, bool resetRNN) override;
 
+    virtual void ForwardPass(const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs) override;
+
+    virtual void ForwardPass(const std::vector<ValueRefs<ElemType>>& inputs, std::vector<ValueRefs<ElemType>>& outputs) override;
+
+    virtual IEvaluateSession* CreateSession() override;
+
+    virtual void ForwardPass(const std::vector<IEvaluateSession*>& sessions, const std::vector<Values<ElemType>>& inputs, std::vector<Values<ElemType>>& outputs) override;
+
+    virtual void ForwardPass(const std::vector<IEvaluateSession*>& sessions, const std::vector<ValueRefs<ElemType>>& inputs, std::vector<ValueRefs<ElemType>>& outputs) override;
+
     virtual void Destroy() override;
 
     virtual void CreateNetwork(const std::string& networkDescription) override
@@ -125,11 +166,67 @@ private:
     std::shared_ptr<ScopedNetworkOperationMode> m_scopedNetworkOperationMode;
     std::vector<ComputationNodeBasePtr> m_inputNodes;
     StreamMinibatchInputs m_inputMatrices;
+    std::vector<ComputationNodeBasePtr> m_statefulNodes; // nodes whose state is kept per session
     bool m_started;
 
+    // host staging buffers for packing batched inputs and unpacking batched outputs
+    std::vector<ElemType> m_packedValues;
+    std::vector<int> m_packedIndices;
+    std::vector<int> m_packedColIndices;
+
+    template<template<typename> class ValueContainer> 
+    size_t CheckInputBuffer(size_t i, const ValueBuffer<ElemType, ValueContainer>& buffer) const;
+
     template<template<typename> class ValueContainer> 
     void ForwardPassT(const std::vector < ValueBuffer<ElemType, ValueContainer> >& inputs,
                       std::vector < ValueBuffer<ElemType, ValueContainer> >& outputs, bool resetRNN);
 
+    template<template<typename> class ValueContainer> 
+    void CheckBatchBuffers(const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& inputs,
+                           const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& outputs) const;
+
+    template<template<typename> class ValueContainer> 
+    void PackBatchInput(size_t i, const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& inputs,
+                        const std::vector<size_t>& lengths, const std::vector<std::pair<size_t, size_t>>& placement);
+
+    template<template<typename> class ValueContainer> 
+    void ForwardPropBatchOutputs(std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& outputs);
+
+    template<template<typename> class ValueContainer> 
+    void ForwardPassBatchT(const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& inputs,
+                           std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& outputs);
+
+    template<template<typename> class ValueContainer> 
+    void ForwardPassSessionsT(const std::vector<IEvaluateSession*>& sessions,
+                              const std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& inputs,
+                              std::vector<std::vector<ValueBuffer<ElemType, ValueContainer>>>& outputs);
+
+};
+
+// ------------------------------------------------------------------------
+// Shared model: one copy of the parameters, one light-weight evaluator per thread
+// ------------------------------------------------------------------------
+template <typename ElemType>
+class CNTKEvalShared : public CNTKEvalBase<ElemType>, public IEvaluateModelShared<ElemType>
+{
+public:
+    CNTKEvalShared() : CNTKEvalBase<ElemType>() {}
+
+    virtual IEvaluateModelExtended<ElemType>* CreateEvaluator() override;
+
+    virtual void Destroy() override;
+
+    virtual void CreateNetwork(const std::string& networkDescription) override
+    {
+        CNTKEvalBase<ElemType>::CreateNetwork(networkDescription);
+    }
+
+    virtual void Init(const std::string& config) override
+    {
+        CNTKEvalBase<ElemType>::Init(config);
+    }
+
+private:
+    std::mutex m_mutex; // cloning reads (and may cache) state of the shared network
 };
 } } }
@@ -0,0 +1,1100 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "CPUConvolution.h"
+#include <algorithm>
+#include <vector>
+#include <limits>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+/*static*/ bool Convolution2DShape::TryCreate(const ConvolveGeometry& geometry, Convolution2DShape& shape)
+{
+    const auto& inputShape = geometry.InputShape();
+    const auto& kernelShape = geometry.KernelShape();
+    const auto& outputShape = geometry.OutputShape();
+    if (inputShape.GetRank() != 3 || kernelShape.GetRank() != 3 || kernelShape[2] != inputShape[2])
+        return false;
+    for (size_t i = 0; i < 3; i++)
+    {
+        if (!geometry.GetSharing(i))
+            return false;
+    }
+    if (geometry.GetMapCount(0) != 1 || geometry.GetMapCount(1) != 1 || outputShape[2] != geometry.GetMapCount(2))
+        return false;
+
+    shape.m_inW = inputShape[0];
+    shape.m_inH = inputShape[1];
+    shape.m_inC = inputShape[2];
+    shape.m_kernelW = kernelShape[0];
+    shape.m_kernelH = kernelShape[1];
+    shape.m_mapCount = outputShape[2];
+    shape.m_strideW = geometry.GetStride(0);
+    shape.m_strideH = geometry.GetStride(1);
+    shape.m_outW = outputShape[0];
+    shape.m_outH = outputShape[1];
+
+    // The kernel is centered at the input cell given by MpRowCol. Derive the padding from the center of the first
+    // output cell, and verify it against the last one; the kernel must span all channels.
+    const auto& mpRowCol = geometry.MpRowCol();
+    int inW = (int)shape.m_inW, inH = (int)shape.m_inH;
+    int col = mpRowCol[0];
+    int centerW = col % inW, centerH = (col / inW) % inH, centerC = col / (inW * inH);
+    if (centerC != ((int)shape.m_inC - 1) / 2)
+        return false;
+    shape.m_padW = ((int)shape.m_kernelW - 1) / 2 - centerW;
+    shape.m_padH = ((int)shape.m_kernelH - 1) / 2 - centerH;
+
+    size_t lastRow = shape.m_outW * shape.m_outH - 1;
+    int lastCol = col + (int)((shape.m_outW - 1) * shape.m_strideW) + inW * (int)((shape.m_outH - 1) * shape.m_strideH);
+    return mpRowCol[lastRow] == lastCol;
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::DirectForward(const Convolution2DShape& shape, const ElemType* in, const ElemType* kernel, ElemType* out, size_t numSamples,
+                                              const ConvolutionEpilogue<ElemType>& epilogue)
+{
+    const size_t mapBlock = 4;
+    size_t numBlocks = (shape.m_mapCount + mapBlock - 1) / mapBlock;
+    size_t inW = shape.m_inW, inH = shape.m_inH;
+    size_t outW = shape.m_outW, outH = shape.m_outH;
+    size_t kernelSize = shape.KernelSize();
+    int padW = shape.m_padW, padH = shape.m_padH;
+    int strideW = (int)shape.m_strideW, strideH = (int)shape.m_strideH;
+
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * numBlocks); task++)
+    {
+        size_t sample = (size_t)task / numBlocks;
+        size_t map0 = ((size_t)task % numBlocks) * mapBlock;
+        size_t numMaps = std::min(mapBlock, shape.m_mapCount - map0);
+        const ElemType* x = in + sample * shape.InputSize();
+        ElemType* y = out + sample * shape.OutputSize();
+
+        // partial sums of one output row of the four maps; missing maps of the last block use zero weights
+        std::vector<ElemType> sums(mapBlock * outW);
+        ElemType* sum0 = sums.data();
+        ElemType* sum1 = sum0 + outW;
+        ElemType* sum2 = sum1 + outW;
+        ElemType* sum3 = sum2 + outW;
+        const ElemType* w[mapBlock];
+        for (size_t j = 0; j < mapBlock; j++)
+            w[j] = j < numMaps ? kernel + (map0 + j) * kernelSize : nullptr;
+
+        for (size_t outY = 0; outY < outH; outY++)
+        {
+            std::fill(sums.begin(), sums.end(), (ElemType)0);
+            for (size_t c = 0; c < shape.m_inC; c++)
+            {
+                for (size_t j = 0; j < shape.m_kernelH; j++)
+                {
+                    int inY = (int)outY * strideH - padH + (int)j;
+                    if (inY < 0 || inY >= (int)inH)
+                        continue;
+                    const ElemType* row = x + (c * inH + inY) * inW;
+                    for (size_t i = 0; i < shape.m_kernelW; i++)
+                    {
+                        size_t iw = i + shape.m_kernelW * (j + shape.m_kernelH * c);
+                        ElemType w0 = w[0][iw];
+                        ElemType w1 = w[1] ? w[1][iw] : 0;
+                        ElemType w2 = w[2] ? w[2][iw] : 0;
+                        ElemType w3 = w[3] ? w[3][iw] : 0;
+
+                        // the output columns whose input column x' * stride - pad + i falls into the input
+                        int offset = (int)i - padW;
+                        int begin = offset >= 0 ? 0 : (-offset + strideW - 1) / strideW;
+                        int last = (int)inW - 1 - offset;
+                        if (last < 0)
+                            continue;
+                        int end = std::min((int)outW, last / strideW + 1);
+                        if (strideW == 1)
+                        {
+                            const ElemType* src = row + offset;
+                            for (int outX = begin; outX < end; outX++)
+                            {
+                                ElemType v = src[outX];
+                                sum0[outX] += w0 * v;
+                                sum1[outX] += w1 * v;
+                                sum2[outX] += w2 * v;
+                                sum3[outX] += w3 * v;
+                            }
+                        }
+                        else
+                        {
+                            for (int outX = begin; outX < end; outX++)
+                            {
+                                ElemType v = row[outX * strideW + offset];
+                                sum0[outX] += w0 * v;
+                                sum1[outX] += w1 * v;
+                                sum2[outX] += w2 * v;
+                                sum3[outX] += w3 * v;
+                            }
+                        }
+                    }
+                }
+            }
+            for (size_t j = 0; j < numMaps; j++)
+            {
+                ElemType* row = sums.data() + j * outW;
+                epilogue.Apply(row, outW, map0 + j);
+                std::copy(row, row + outW, y + ((map0 + j) * outH + outY) * outW);
+            }
+        }
+    }
+}
+
+/*static*/ bool GroupedConvolution2DShape::TryCreate(const ConvolveGeometry& geometry, GroupedConvolution2DShape& shape)
+{
+    const auto& inputShape = geometry.InputShape();
+    const auto& kernelShape = geometry.KernelShape();
+    const auto& outputShape = geometry.OutputShape();
+    if (inputShape.GetRank() != 3 || kernelShape.GetRank() != 3 || !geometry.GetSharing(0) || !geometry.GetSharing(1))
+        return false;
+    if (geometry.GetMapCount(0) != 1 || geometry.GetMapCount(1) != 1)
+        return false;
+    size_t groupC = kernelShape[2];
+    size_t groupMaps = geometry.GetMapCount(2);
+    if (inputShape[2] % groupC != 0 || inputShape[2] / groupC < 2 || outputShape[2] != inputShape[2] / groupC * groupMaps)
+        return false;
+
+    shape.m_inW = inputShape[0];
+    shape.m_inH = inputShape[1];
+    shape.m_inC = inputShape[2];
+    shape.m_kernelW = kernelShape[0];
+    shape.m_kernelH = kernelShape[1];
+    shape.m_groups = inputShape[2] / groupC;
+    shape.m_groupC = groupC;
+    shape.m_groupMaps = groupMaps;
+    shape.m_sharedKernels = geometry.GetSharing(2);
+    shape.m_strideW = geometry.GetStride(0);
+    shape.m_strideH = geometry.GetStride(1);
+    shape.m_outW = outputShape[0];
+    shape.m_outH = outputShape[1];
+
+    // As for Convolution2DShape, derive the padding from the center of the first output cell, and verify it against
+    // the last one. The first cell of the map of group g must be centered in the channels of that group.
+    const auto& mpRowCol = geometry.MpRowCol();
+    int inW = (int)shape.m_inW, inH = (int)shape.m_inH;
+    int col = mpRowCol[0];
+    int centerW = col % inW, centerH = (col / inW) % inH, centerC = col / (inW * inH);
+    if (centerC != ((int)groupC - 1) / 2)
+        return false;
+    shape.m_padW = ((int)shape.m_kernelW - 1) / 2 - centerW;
+    shape.m_padH = ((int)shape.m_kernelH - 1) / 2 - centerH;
+
+    size_t mapSize = shape.m_outW * shape.m_outH;
+    for (size_t g = 1; g < shape.m_groups; g++)
+    {
+        if (mpRowCol[g * mapSize] != col + (int)(g * groupC) * inW * inH)
+            return false;
+    }
+    int lastCol = col + (int)((shape.m_outW - 1) * shape.m_strideW) + inW * (int)((shape.m_outH - 1) * shape.m_strideH);
+    return mpRowCol[mapSize - 1] == lastCol;
+}
+
+// the range [begin, end) of output columns x' whose input column x' * stride + offset falls into the input row
+static inline bool OutputColumnRange(int offset, int inW, int outW, int stride, int& begin, int& end)
+{
+    begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+    int last = inW - 1 - offset;
+    if (last < 0)
+        return false;
+    end = std::min(outW, last / stride + 1);
+    return begin < end;
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::GroupedForward(const GroupedConvolution2DShape& shape, const ElemType* in, const ElemType* kernel, ElemType* out, size_t numSamples,
+                                               const ConvolutionEpilogue<ElemType>& epilogue)
+{
+    size_t numMaps = shape.MapCount();
+    size_t inW = shape.m_inW, inH = shape.m_inH;
+    size_t outW = shape.m_outW, outH = shape.m_outH;
+    int padW = shape.m_padW, padH = shape.m_padH;
+    int strideW = (int)shape.m_strideW, strideH = (int)shape.m_strideH;
+
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * numMaps); task++)
+    {
+        size_t sample = (size_t)task / numMaps;
+        size_t map = (size_t)task % numMaps;
+        size_t group = map % shape.m_groups;
+        const ElemType* x = in + sample * shape.InputSize() + group * shape.m_groupC * inW * inH;
+        const ElemType* w = kernel + shape.KernelIndex(map) * shape.KernelSize();
+        ElemType* y = out + sample * shape.OutputSize() + map * outW * outH;
+
+        for (size_t outY = 0; outY < outH; outY++)
+        {
+            ElemType* row = y + outY * outW;
+            std::fill(row, row + outW, (ElemType)0);
+            for (size_t c = 0; c < shape.m_groupC; c++)
+            {
+                for (size_t j = 0; j < shape.m_kernelH; j++)
+                {
+                    int inY = (int)outY * strideH - padH + (int)j;
+                    if (inY < 0 || inY >= (int)inH)
+                        continue;
+                    const ElemType* src = x + (c * inH + inY) * inW;
+                    for (size_t i = 0; i < shape.m_kernelW; i++)
+                    {
+                        ElemType weight = w[i + shape.m_kernelW * (j + shape.m_kernelH * c)];
+                        int offset = (int)i - padW, begin, end;
+                        if (!OutputColumnRange(offset, (int)inW, (int)outW, strideW, begin, end))
+                            continue;
+                        if (strideW == 1)
+                        {
+                            const ElemType* srcRow = src + offset;
+                            for (int outX = begin; outX < end; outX++)
+                                row[outX] += weight * srcRow[outX];
+                        }
+                        else
+                        {
+                            for (int outX = begin; outX < end; outX++)
+                                row[outX] += weight * src[outX * strideW + offset];
+                        }
+                    }
+                }
+            }
+            epilogue.Apply(row, outW, map);
+        }
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::GroupedBackwardData(const GroupedConvolution2DShape& shape, const ElemType* srcGrad, const ElemType* kernel, ElemType* grad, size_t numSamples)
+{
+    size_t inW = shape.m_inW, inH = shape.m_inH;
+    size_t outW = shape.m_outW, outH = shape.m_outH;
+    int padW = shape.m_padW, padH = shape.m_padH;
+    int strideW = (int)shape.m_strideW, strideH = (int)shape.m_strideH;
+
+    // each task writes the input channels of one group, which only the maps of that group read
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * shape.m_groups); task++)
+    {
+        size_t sample = (size_t)task / shape.m_groups;
+        size_t group = (size_t)task % shape.m_groups;
+        ElemType* dx = grad + sample * shape.InputSize() + group * shape.m_groupC * inW * inH;
+        for (size_t m = 0; m < shape.m_groupMaps; m++)
+        {
+            size_t map = group + shape.m_groups * m;
+            const ElemType* w = kernel + shape.KernelIndex(map) * shape.KernelSize();
+            const ElemType* dy = srcGrad + sample * shape.OutputSize() + map * outW * outH;
+            for (size_t c = 0; c < shape.m_groupC; c++)
+            {
+                for (size_t outY = 0; outY < outH; outY++)
+                {
+                    const ElemType* srcRow = dy + outY * outW;
+                    for (size_t j = 0; j < shape.m_kernelH; j++)
+                    {
+                        int inY = (int)outY * strideH - padH + (int)j;
+                        if (inY < 0 || inY >= (int)inH)
+                            continue;
+                        ElemType* dst = dx + (c * inH + inY) * inW;
+                        for (size_t i = 0; i < shape.m_kernelW; i++)
+                        {
+                            ElemType weight = w[i + shape.m_kernelW * (j + shape.m_kernelH * c)];
+                            int offset = (int)i - padW, begin, end;
+                            if (!OutputColumnRange(offset, (int)inW, (int)outW, strideW, begin, end))
+                                continue;
+                            if (strideW == 1)
+                            {
+                                ElemType* dstRow = dst + offset;
+                                for (int outX = begin; outX < end; outX++)
+                                    dstRow[outX] += weight * srcRow[outX];
+                            }
+                            else
+                            {
+                                for (int outX = begin; outX < end; outX++)
+                                    dst[outX * strideW + offset] += weight * srcRow[outX];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::GroupedBackwardKernel(const GroupedConvolution2DShape& shape, const ElemType* srcGrad, const ElemType* in, ElemType* kernelGrad, size_t numSamples)
+{
+    size_t inW = shape.m_inW, inH = shape.m_inH;
+    size_t outW = shape.m_outW, outH = shape.m_outH;
+    int padW = shape.m_padW, padH = shape.m_padH;
+    int strideW = (int)shape.m_strideW, strideH = (int)shape.m_strideH;
+    size_t kernelSize = shape.KernelSize();
+    size_t mapsPerKernel = shape.m_sharedKernels ? shape.m_groups : 1;
+
+    // each task computes one kernel, from all maps that use it, so the sums over the samples need no synchronization
+#pragma omp parallel for
+    for (long long n = 0; n < (long long)shape.KernelCount(); n++)
+    {
+        ElemType* dw = kernelGrad + n * kernelSize;
+        for (size_t k = 0; k < mapsPerKernel; k++)
+        {
+            size_t map = shape.m_sharedKernels ? k + shape.m_groups * n : n;
+            size_t group = map % shape.m_groups;
+            for (size_t sample = 0; sample < numSamples; sample++)
+            {
+                const ElemType* x = in + sample * shape.InputSize() + group * shape.m_groupC * inW * inH;
+                const ElemType* dy = srcGrad + sample * shape.OutputSize() + map * outW * outH;
+                for (size_t c = 0; c < shape.m_groupC; c++)
+                {
+                    for (size_t j = 0; j < shape.m_kernelH; j++)
+                    {
+                        for (size_t i = 0; i < shape.m_kernelW; i++)
+                        {
+                            int offset = (int)i - padW, begin, end;
+                            if (!OutputColumnRange(offset, (int)inW, (int)outW, strideW, begin, end))
+                                continue;
+                            ElemType sum = 0;
+                            for (size_t outY = 0; outY < outH; outY++)
+                            {
+                                int inY = (int)outY * strideH - padH + (int)j;
+                                if (inY < 0 || inY >= (int)inH)
+                                    continue;
+                                const ElemType* src = x + (c * inH + inY) * inW;
+                                const ElemType* srcRow = dy + outY * outW;
+                                if (strideW == 1)
+                                {
+                                    const ElemType* inRow = src + offset;
+                                    for (int outX = begin; outX < end; outX++)
+                                        sum += srcRow[outX] * inRow[outX];
+                                }
+                                else
+                                {
+                                    for (int outX = begin; outX < end; outX++)
+                                        sum += srcRow[outX] * src[outX * strideW + offset];
+                                }
+                            }
+                            dw[i + shape.m_kernelW * (j + shape.m_kernelH * c)] += sum;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Winograd transforms, row-major. F(2x2, 3x3) and F(4x4, 3x3) as given by Lavin and Gray.
+static const double winogradBT2[4 * 4] =
+{
+    1,  0, -1,  0,
+    0,  1,  1,  0,
+    0, -1,  1,  0,
+    0,  1,  0, -1,
+};
+static const double winogradG2[4 * 3] =
+{
+    1,    0,   0,
+    0.5,  0.5, 0.5,
+    0.5, -0.5, 0.5,
+    0,    0,   1,
+};
+static const double winogradAT2[2 * 4] =
+{
+    1, 1,  1,  0,
+    0, 1, -1, -1,
+};
+static const double winogradBT4[6 * 6] =
+{
+    4,  0, -5,  0, 1, 0,
+    0, -4, -4,  1, 1, 0,
+    0,  4, -4, -1, 1, 0,
+    0, -2, -1,  2, 1, 0,
+    0,  2, -1, -2, 1, 0,
+    0,  4,  0, -5, 0, 1,
+};
+static const double winogradG4[6 * 3] =
+{
+    1.0 / 4,         0,        0,
+    -1.0 / 6,  -1.0 / 6, -1.0 / 6,
+    -1.0 / 6,   1.0 / 6, -1.0 / 6,
+    1.0 / 24,  1.0 / 12,  1.0 / 6,
+    1.0 / 24, -1.0 / 12,  1.0 / 6,
+    0,                0,        1,
+};
+static const double winogradAT4[4 * 6] =
+{
+    1, 1,  1, 1,  1, 0,
+    0, 1, -1, 2, -2, 0,
+    0, 1,  1, 4,  4, 0,
+    0, 1, -1, 8, -8, 1,
+};
+
+static const size_t winogradMaxAlpha = 6;
+
+// out = L x L^T for a [rows x n] matrix L and an [n x n] matrix x, all row-major
+template <class ElemType>
+static inline void WinogradSandwich(const double* l, size_t rows, size_t n, const ElemType* x, ElemType* out)
+{
+    ElemType temp[winogradMaxAlpha * winogradMaxAlpha];
+    for (size_t i = 0; i < rows; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            ElemType sum = 0;
+            for (size_t r = 0; r < n; r++)
+            {
+                if (l[i * n + r] != 0)
+                    sum += (ElemType)l[i * n + r] * x[r * n + j];
+            }
+            temp[i * n + j] = sum;
+        }
+    }
+    for (size_t i = 0; i < rows; i++)
+    {
+        for (size_t j = 0; j < rows; j++)
+        {
+            ElemType sum = 0;
+            for (size_t s = 0; s < n; s++)
+            {
+                if (l[j * n + s] != 0)
+                    sum += temp[i * n + s] * (ElemType)l[j * n + s];
+            }
+            out[i * rows + j] = sum;
+        }
+    }
+}
+
+// G g G^T is not square on the inside, G is [alpha x 3] and g [3 x 3]
+template <class ElemType>
+static inline void WinogradKernelSandwich(const double* g, size_t alpha, const ElemType* x, ElemType* out)
+{
+    ElemType temp[winogradMaxAlpha * 3];
+    for (size_t i = 0; i < alpha; i++)
+    {
+        for (size_t j = 0; j < 3; j++)
+            temp[i * 3 + j] = (ElemType)(g[i * 3] * x[j] + g[i * 3 + 1] * x[3 + j] + g[i * 3 + 2] * x[6 + j]);
+    }
+    for (size_t i = 0; i < alpha; i++)
+    {
+        for (size_t j = 0; j < alpha; j++)
+            out[i * alpha + j] = (ElemType)(temp[i * 3] * g[j * 3] + temp[i * 3 + 1] * g[j * 3 + 1] + temp[i * 3 + 2] * g[j * 3 + 2]);
+    }
+}
+
+/*static*/ bool CPUConvolution::IsWinogradSupported(const Convolution2DShape& shape)
+{
+    return shape.m_kernelW == 3 && shape.m_kernelH == 3 && shape.m_strideW == 1 && shape.m_strideH == 1;
+}
+
+/*static*/ size_t CPUConvolution::WinogradTileSize(const Convolution2DShape& shape)
+{
+    return shape.m_outW >= 8 && shape.m_outH >= 8 ? 4 : 2;
+}
+
+/*static*/ size_t CPUConvolution::WinogradNumTiles(const Convolution2DShape& shape, size_t tileSize, size_t numSamples)
+{
+    return numSamples * ((shape.m_outW + tileSize - 1) / tileSize) * ((shape.m_outH + tileSize - 1) / tileSize);
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::WinogradTransformKernel(const Convolution2DShape& shape, size_t tileSize, const ElemType* kernel, ElemType* u)
+{
+    const double* g = tileSize == 4 ? winogradG4 : winogradG2;
+    size_t alpha = tileSize + 2;
+    size_t numMaps = shape.m_mapCount;
+    size_t numChannels = shape.m_inC;
+
+#pragma omp parallel for
+    for (long long map = 0; map < (long long)numMaps; map++)
+    {
+        ElemType transformed[winogradMaxAlpha * winogradMaxAlpha];
+        for (size_t c = 0; c < numChannels; c++)
+        {
+            // the 3 x 3 kernel of channel c, row-major (y, x)
+            WinogradKernelSandwich(g, alpha, kernel + map * shape.KernelSize() + c * 9, transformed);
+            for (size_t xi = 0; xi < alpha * alpha; xi++)
+                u[(xi * numChannels + c) * numMaps + map] = transformed[xi];
+        }
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::WinogradTransformInput(const Convolution2DShape& shape, size_t tileSize, const ElemType* in, size_t numSamples, ElemType* v)
+{
+    const double* bt = tileSize == 4 ? winogradBT4 : winogradBT2;
+    size_t alpha = tileSize + 2;
+    size_t tilesW = (shape.m_outW + tileSize - 1) / tileSize;
+    size_t tilesH = (shape.m_outH + tileSize - 1) / tileSize;
+    size_t numTiles = numSamples * tilesW * tilesH;
+    size_t numChannels = shape.m_inC;
+    int inW = (int)shape.m_inW, inH = (int)shape.m_inH;
+
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * numChannels); task++)
+    {
+        size_t sample = (size_t)task / numChannels;
+        size_t c = (size_t)task % numChannels;
+        const ElemType* x = in + sample * shape.InputSize() + c * shape.m_inW * shape.m_inH;
+        ElemType d[winogradMaxAlpha * winogradMaxAlpha];
+        ElemType transformed[winogradMaxAlpha * winogradMaxAlpha];
+        for (size_t tileY = 0; tileY < tilesH; tileY++)
+        {
+            for (size_t tileX = 0; tileX < tilesW; tileX++)
+            {
+                // input tile, zero outside of the input
+                int y0 = (int)(tileY * tileSize) - shape.m_padH;
+                int x0 = (int)(tileX * tileSize) - shape.m_padW;
+                for (size_t r = 0; r < alpha; r++)
+                {
+                    int inY = y0 + (int)r;
+                    for (size_t s = 0; s < alpha; s++)
+                    {
+                        int inX = x0 + (int)s;
+                        d[r * alpha + s] = inY >= 0 && inY < inH && inX >= 0 && inX < inW ? x[inY * inW + inX] : 0;
+                    }
+                }
+                WinogradSandwich(bt, alpha, alpha, d, transformed);
+
+                size_t t = (sample * tilesH + tileY) * tilesW + tileX;
+                for (size_t xi = 0; xi < alpha * alpha; xi++)
+                    v[(xi * numTiles + t) * numChannels + c] = transformed[xi];
+            }
+        }
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::WinogradTransformOutput(const Convolution2DShape& shape, size_t tileSize, const ElemType* m, size_t numSamples, ElemType* out,
+                                                        const ConvolutionEpilogue<ElemType>& epilogue)
+{
+    const double* at = tileSize == 4 ? winogradAT4 : winogradAT2;
+    size_t alpha = tileSize + 2;
+    size_t tilesW = (shape.m_outW + tileSize - 1) / tileSize;
+    size_t tilesH = (shape.m_outH + tileSize - 1) / tileSize;
+    size_t numTiles = numSamples * tilesW * tilesH;
+    size_t numMaps = shape.m_mapCount;
+    size_t outW = shape.m_outW, outH = shape.m_outH;
+
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * numMaps); task++)
+    {
+        size_t sample = (size_t)task / numMaps;
+        size_t map = (size_t)task % numMaps;
+        ElemType* y = out + sample * shape.OutputSize() + map * outW * outH;
+        ElemType products[winogradMaxAlpha * winogradMaxAlpha];
+        ElemType tile[winogradMaxAlpha * winogradMaxAlpha];
+        for (size_t tileY = 0; tileY < tilesH; tileY++)
+        {
+            for (size_t tileX = 0; tileX < tilesW; tileX++)
+            {
+                size_t t = (sample * tilesH + tileY) * tilesW + tileX;
+                for (size_t xi = 0; xi < alpha * alpha; xi++)
+                    products[xi] = m[(xi * numTiles + t) * numMaps + map];
+                WinogradSandwich(at, tileSize, alpha, products, tile);
+
+                // the last tiles may extend beyond the output
+                size_t rows = std::min(tileSize, outH - tileY * tileSize);
+                size_t cols = std::min(tileSize, outW - tileX * tileSize);
+                for (size_t i = 0; i < rows; i++)
+                {
+                    ElemType* row = y + (tileY * tileSize + i) * outW + tileX * tileSize;
+                    for (size_t j = 0; j < cols; j++)
+                        row[j] = tile[i * tileSize + j];
+                    epilogue.Apply(row, cols, map);
+                }
+            }
+        }
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::ApplyEpilogue(const ConvolutionEpilogue<ElemType>& epilogue, ElemType* out, size_t mapSize, size_t numMaps, size_t numSamples)
+{
+    if (epilogue.IsEmpty())
+        return;
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * numMaps); task++)
+        epilogue.Apply(out + (size_t)task * mapSize, mapSize, (size_t)task % numMaps);
+}
+
+/*static*/ bool Pooling2DShape::TryCreate(const ConvolveGeometry& geometry, Pooling2DShape& shape)
+{
+    const auto& inputShape = geometry.InputShape();
+    const auto& kernelShape = geometry.KernelShape();
+    const auto& outputShape = geometry.OutputShape();
+    if (inputShape.GetRank() != 3 || kernelShape.GetRank() != 3 || kernelShape[2] != 1 || geometry.GetStride(2) != 1 || outputShape[2] != inputShape[2])
+        return false;
+    for (size_t i = 0; i < 3; i++)
+    {
+        if (geometry.GetMapCount(i) != 1)
+            return false;
+    }
+
+    shape.m_inW = inputShape[0];
+    shape.m_inH = inputShape[1];
+    shape.m_channels = inputShape[2];
+    shape.m_kernelW = kernelShape[0];
+    shape.m_kernelH = kernelShape[1];
+    shape.m_strideW = geometry.GetStride(0);
+    shape.m_strideH = geometry.GetStride(1);
+    shape.m_outW = outputShape[0];
+    shape.m_outH = outputShape[1];
+
+    // As for Convolution2DShape, derive the padding from the center of the first output cell, and verify it against
+    // the last one of the first plane, and the first one of the last plane.
+    const auto& mpRowCol = geometry.MpRowCol();
+    int inW = (int)shape.m_inW, inH = (int)shape.m_inH;
+    int col = mpRowCol[0];
+    int centerW = col % inW, centerH = (col / inW) % inH, centerC = col / (inW * inH);
+    if (centerC != 0)
+        return false;
+    shape.m_padW = ((int)shape.m_kernelW - 1) / 2 - centerW;
+    shape.m_padH = ((int)shape.m_kernelH - 1) / 2 - centerH;
+
+    size_t planeSize = shape.m_outW * shape.m_outH;
+    int lastCol = col + (int)((shape.m_outW - 1) * shape.m_strideW) + inW * (int)((shape.m_outH - 1) * shape.m_strideH);
+    return mpRowCol[planeSize - 1] == lastCol && mpRowCol[planeSize * (shape.m_channels - 1)] == col + (int)(shape.m_channels - 1) * inW * inH;
+}
+
+/*static*/ bool CPUConvolution::IsPoolingSupported(const Pooling2DShape& shape)
+{
+    return shape.m_kernelW == shape.m_kernelH && (shape.m_kernelW == 2 || shape.m_kernelW == 3) &&
+           shape.m_strideW == shape.m_strideH && (shape.m_strideW == 1 || shape.m_strideW == 2);
+}
+
+// the outputs [begin, end) along one axis whose windows lie inside the input
+static inline void PoolingInteriorRange(int pad, int inSize, int outSize, int kernel, int stride, int& begin, int& end)
+{
+    begin = pad <= 0 ? 0 : std::min(outSize, (pad + stride - 1) / stride);
+    int last = inSize + pad - kernel; // the last output starts its window at last - pad
+    end = last < 0 ? 0 : std::min(outSize, last / stride + 1);
+    end = std::max(begin, end);
+}
+
+// the part [iBegin, iEnd) x [jBegin, jEnd) of a window of K x K starting at (x0, y0) that lies inside the plane
+template <int K>
+static inline void PoolingWindowBounds(int x0, int y0, int inW, int inH, int& iBegin, int& iEnd, int& jBegin, int& jEnd)
+{
+    iBegin = std::max(0, -x0);
+    iEnd = std::min(K, inW - x0);
+    jBegin = std::max(0, -y0);
+    jEnd = std::min(K, inH - y0);
+}
+
+template <class ElemType, int K, int S>
+static void MaxPoolingForwardImpl(const Pooling2DShape& shape, const ElemType* in, ElemType* out, int* argmax, size_t numSamples)
+{
+    int inW = (int)shape.m_inW, inH = (int)shape.m_inH;
+    int outW = (int)shape.m_outW, outH = (int)shape.m_outH;
+    int padW = shape.m_padW, padH = shape.m_padH;
+    int beginX, endX, beginY, endY;
+    PoolingInteriorRange(padW, inW, outW, K, S, beginX, endX);
+    PoolingInteriorRange(padH, inH, outH, K, S, beginY, endY);
+
+#pragma omp parallel for
+    for (long long plane = 0; plane < (long long)(numSamples * shape.m_channels); plane++)
+    {
+        const ElemType* x = in + (size_t)plane * inW * inH;
+        ElemType* y = out + (size_t)plane * outW * outH;
+        int* positions = argmax ? argmax + (size_t)plane * outW * outH : nullptr;
+        for (int outY = 0; outY < outH; outY++)
+        {
+            bool interiorRow = beginY <= outY && outY < endY;
+            int rowBase = (outY * S - padH) * inW - padW;
+            for (int outX = 0; outX < outW; outX++)
+            {
+                if (interiorRow && outX == beginX && beginX < endX) // the interior of the row, below
+                {
+                    outX = endX - 1;
+                    continue;
+                }
+                int x0 = outX * S - padW, y0 = outY * S - padH;
+                int iBegin, iEnd, jBegin, jEnd;
+                PoolingWindowBounds<K>(x0, y0, inW, inH, iBegin, iEnd, jBegin, jEnd);
+                ElemType best = -std::numeric_limits<ElemType>::infinity();
+                int bestPos = -1;
+                for (int j = jBegin; j < jEnd; j++)
+                {
+                    for (int i = iBegin; i < iEnd; i++)
+                    {
+                        int pos = (y0 + j) * inW + x0 + i;
+                        if (bestPos < 0 || x[pos] > best)
+                        {
+                            best = x[pos];
+                            bestPos = pos;
+                        }
+                    }
+                }
+                y[outY * outW + outX] = best;
+                if (positions)
+                    positions[outY * outW + outX] = bestPos;
+            }
+            if (!interiorRow)
+                continue;
+
+            ElemType* yRow = y + outY * outW;
+            if (positions)
+            {
+                int* positionRow = positions + outY * outW;
+                for (int outX = beginX; outX < endX; outX++)
+                {
+                    int base = rowBase + outX * S;
+                    ElemType best = x[base];
+                    int bestPos = base;
+                    for (int j = 0; j < K; j++)
+                    {
+                        for (int i = 0; i < K; i++)
+                        {
+                            int pos = base + j * inW + i;
+                            ElemType v = x[pos];
+                            bool greater = v > best;
+                            best = greater ? v : best;
+                            bestPos = greater ? pos : bestPos;
+                        }
+                    }
+                    yRow[outX] = best;
+                    positionRow[outX] = bestPos;
+                }
+            }
+            else
+            {
+                for (int outX = beginX; outX < endX; outX++)
+                {
+                    int base = rowBase + outX * S;
+                    ElemType best = x[base];
+                    for (int j = 0; j < K; j++)
+                    {
+                        for (int i = 0; i < K; i++)
+                            best = std::max(best, x[base + j * inW + i]);
+                    }
+                    yRow[outX] = best;
+                }
+            }
+        }
+    }
+}
+
+template <class ElemType, int K, int S>
+static void AveragePoolingForwardImpl(const Pooling2DShape& shape, const ElemType* in, ElemType* out, size_t numSamples)
+{
+    int inW = (int)shape.m_inW, inH = (int)shape.m_inH;
+    int outW = (int)shape.m_outW, outH = (int)shape.m_outH;
+    int padW = shape.m_padW, padH = shape.m_padH;
+    int beginX, endX, beginY, endY;
+    PoolingInteriorRange(padW, inW, outW, K, S, beginX, endX);
+    PoolingInteriorRange(padH, inH, outH, K, S, beginY, endY);
+
+#pragma omp parallel for
+    for (long long plane = 0; plane < (long long)(numSamples * shape.m_channels); plane++)
+    {
+        const ElemType* x = in + (size_t)plane * inW * inH;
+        ElemType* y = out + (size_t)plane * outW * outH;
+        for (int outY = 0; outY < outH; outY++)
+        {
+            bool interiorRow = beginY <= outY && outY < endY;
+            int rowBase = (outY * S - padH) * inW - padW;
+            for (int outX = 0; outX < outW; outX++)
+            {
+                if (interiorRow && outX == beginX && beginX < endX)
+                {
+                    outX = endX - 1;
+                    continue;
+                }
+                int x0 = outX * S - padW, y0 = outY * S - padH;
+                int iBegin, iEnd, jBegin, jEnd;
+                PoolingWindowBounds<K>(x0, y0, inW, inH, iBegin, iEnd, jBegin, jEnd);
+                ElemType sum = 0;
+                for (int j = jBegin; j < jEnd; j++)
+                {
+                    for (int i = iBegin; i < iEnd; i++)
+                        sum += x[(y0 + j) * inW + x0 + i];
+                }
+                y[outY * outW + outX] = sum / ((iEnd - iBegin) * (jEnd - jBegin));
+            }
+            if (!interiorRow)
+                continue;
+
+            ElemType* yRow = y + outY * outW;
+            for (int outX = beginX; outX < endX; outX++)
+            {
+                int base = rowBase + outX * S;
+                ElemType sum = 0;
+                for (int j = 0; j < K; j++)
+                {
+                    for (int i = 0; i < K; i++)
+                        sum += x[base + j * inW + i];
+                }
+                yRow[outX] = sum / (K * K);
+            }
+        }
+    }
+}
+
+template <class ElemType, int K, int S>
+static void AveragePoolingBackwardImpl(const Pooling2DShape& shape, const ElemType* srcGrad, ElemType* grad, size_t numSamples)
+{
+    int inW = (int)shape.m_inW, inH = (int)shape.m_inH;
+    int outW = (int)shape.m_outW, outH = (int)shape.m_outH;
+    int padW = shape.m_padW, padH = shape.m_padH;
+
+#pragma omp parallel for
+    for (long long plane = 0; plane < (long long)(numSamples * shape.m_channels); plane++)
+    {
+        const ElemType* dy = srcGrad + (size_t)plane * outW * outH;
+        ElemType* dx = grad + (size_t)plane * inW * inH;
+        for (int outY = 0; outY < outH; outY++)
+        {
+            for (int outX = 0; outX < outW; outX++)
+            {
+                int x0 = outX * S - padW, y0 = outY * S - padH;
+                int iBegin, iEnd, jBegin, jEnd;
+                PoolingWindowBounds<K>(x0, y0, inW, inH, iBegin, iEnd, jBegin, jEnd);
+                ElemType g = dy[outY * outW + outX] / ((iEnd - iBegin) * (jEnd - jBegin));
+                for (int j = jBegin; j < jEnd; j++)
+                {
+                    for (int i = iBegin; i < iEnd; i++)
+                        dx[(y0 + j) * inW + x0 + i] += g;
+                }
+            }
+        }
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::MaxPoolingForward(const Pooling2DShape& shape, const ElemType* in, ElemType* out, int* argmax, size_t numSamples)
+{
+    assert(IsPoolingSupported(shape));
+    if (shape.m_kernelW == 2)
+    {
+        if (shape.m_strideW == 1)
+            MaxPoolingForwardImpl<ElemType, 2, 1>(shape, in, out, argmax, numSamples);
+        else
+            MaxPoolingForwardImpl<ElemType, 2, 2>(shape, in, out, argmax, numSamples);
+    }
+    else
+    {
+        if (shape.m_strideW == 1)
+            MaxPoolingForwardImpl<ElemType, 3, 1>(shape, in, out, argmax, numSamples);
+        else
+            MaxPoolingForwardImpl<ElemType, 3, 2>(shape, in, out, argmax, numSamples);
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::MaxPoolingBackward(const Pooling2DShape& shape, const ElemType* srcGrad, const int* argmax, ElemType* grad, size_t numSamples)
+{
+    size_t inSize = shape.m_inW * shape.m_inH, outSize = shape.m_outW * shape.m_outH;
+#pragma omp parallel for
+    for (long long plane = 0; plane < (long long)(numSamples * shape.m_channels); plane++)
+    {
+        const ElemType* dy = srcGrad + (size_t)plane * outSize;
+        const int* positions = argmax + (size_t)plane * outSize;
+        ElemType* dx = grad + (size_t)plane * inSize;
+        for (size_t i = 0; i < outSize; i++)
+            dx[positions[i]] += dy[i];
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::AveragePoolingForward(const Pooling2DShape& shape, const ElemType* in, ElemType* out, size_t numSamples)
+{
+    assert(IsPoolingSupported(shape));
+    if (shape.m_kernelW == 2)
+    {
+        if (shape.m_strideW == 1)
+            AveragePoolingForwardImpl<ElemType, 2, 1>(shape, in, out, numSamples);
+        else
+            AveragePoolingForwardImpl<ElemType, 2, 2>(shape, in, out, numSamples);
+    }
+    else
+    {
+        if (shape.m_strideW == 1)
+            AveragePoolingForwardImpl<ElemType, 3, 1>(shape, in, out, numSamples);
+        else
+            AveragePoolingForwardImpl<ElemType, 3, 2>(shape, in, out, numSamples);
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::AveragePoolingBackward(const Pooling2DShape& shape, const ElemType* srcGrad, ElemType* grad, size_t numSamples)
+{
+    assert(IsPoolingSupported(shape));
+    if (shape.m_kernelW == 2)
+    {
+        if (shape.m_strideW == 1)
+            AveragePoolingBackwardImpl<ElemType, 2, 1>(shape, srcGrad, grad, numSamples);
+        else
+            AveragePoolingBackwardImpl<ElemType, 2, 2>(shape, srcGrad, grad, numSamples);
+    }
+    else
+    {
+        if (shape.m_strideW == 1)
+            AveragePoolingBackwardImpl<ElemType, 3, 1>(shape, srcGrad, grad, numSamples);
+        else
+            AveragePoolingBackwardImpl<ElemType, 3, 2>(shape, srcGrad, grad, numSamples);
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::ToChannelBlocked(const ElemType* in, size_t spatialSize, size_t channels, size_t blockSize, size_t numSamples, ElemType* out)
+{
+    assert(channels % blockSize == 0);
+    size_t sampleSize = spatialSize * channels;
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * channels); task++)
+    {
+        size_t sample = (size_t)task / channels;
+        size_t c = (size_t)task % channels;
+        const ElemType* x = in + sample * sampleSize + c * spatialSize;
+        ElemType* y = out + sample * sampleSize + (c / blockSize) * spatialSize * blockSize + c % blockSize;
+        for (size_t s = 0; s < spatialSize; s++)
+            y[s * blockSize] = x[s];
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::FromChannelBlocked(const ElemType* in, size_t spatialSize, size_t channels, size_t blockSize, size_t numSamples, ElemType* out)
+{
+    assert(channels % blockSize == 0);
+    size_t sampleSize = spatialSize * channels;
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * channels); task++)
+    {
+        size_t sample = (size_t)task / channels;
+        size_t c = (size_t)task % channels;
+        const ElemType* x = in + sample * sampleSize + (c / blockSize) * spatialSize * blockSize + c % blockSize;
+        ElemType* y = out + sample * sampleSize + c * spatialSize;
+        for (size_t s = 0; s < spatialSize; s++)
+            y[s] = x[s * blockSize];
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::BlockKernel(const Convolution2DShape& shape, size_t blockSize, const ElemType* kernel, ElemType* blockedKernel)
+{
+    assert(shape.m_mapCount % blockSize == 0);
+    size_t kernelSize = shape.KernelSize();
+    for (size_t k = 0; k < shape.m_mapCount; k++)
+    {
+        // kernel element p = i + X * (j + Y * c) of map k goes to ((k / B) * kernelSize + p) * B + k % B
+        for (size_t p = 0; p < kernelSize; p++)
+            blockedKernel[((k / blockSize) * kernelSize + p) * blockSize + k % blockSize] = kernel[k * kernelSize + p];
+    }
+}
+
+// BlockedForward() for a block size known at compile time, so that the loops over the block are vectorized
+template <class ElemType, size_t B>
+static void BlockedForwardImpl(const Convolution2DShape& shape, bool inputBlocked, const ElemType* in, const ElemType* blockedKernel, ElemType* out, size_t numSamples,
+                               const ConvolutionEpilogue<ElemType>& epilogue)
+{
+    size_t numBlocks = shape.m_mapCount / B;
+    size_t inW = shape.m_inW, inH = shape.m_inH;
+    size_t outW = shape.m_outW, outH = shape.m_outH;
+    size_t kernelSize = shape.KernelSize();
+    int padW = shape.m_padW, padH = shape.m_padH;
+    int strideW = (int)shape.m_strideW, strideH = (int)shape.m_strideH;
+    // distance between horizontally adjacent input values of the same channel
+    int step = inputBlocked ? (int)B : 1;
+
+#pragma omp parallel for
+    for (long long task = 0; task < (long long)(numSamples * numBlocks); task++)
+    {
+        size_t sample = (size_t)task / numBlocks;
+        size_t block = (size_t)task % numBlocks;
+        const ElemType* x = in + sample * shape.InputSize();
+        ElemType* y = out + sample * shape.OutputSize() + block * outH * outW * B;
+        const ElemType* w = blockedKernel + block * kernelSize * B;
+
+        // sums[outX * B + b] is output map block * B + b of column outX of the current row
+        std::vector<ElemType> sums(outW * B);
+        ElemType* sum = sums.data();
+        for (size_t outY = 0; outY < outH; outY++)
+        {
+            std::fill(sums.begin(), sums.end(), (ElemType)0);
+            for (size_t c = 0; c < shape.m_inC; c++)
+            {
+                for (size_t j = 0; j < shape.m_kernelH; j++)
+                {
+                    int inY = (int)outY * strideH - padH + (int)j;
+                    if (inY < 0 || inY >= (int)inH)
+                        continue;
+                    const ElemType* row = inputBlocked ? x + (((c / B) * inH + inY) * inW) * B + c % B : x + (c * inH + inY) * inW;
+                    for (size_t i = 0; i < shape.m_kernelW; i++)
+                    {
+                        const ElemType* weights = w + (i + shape.m_kernelW * (j + shape.m_kernelH * c)) * B;
+
+                        // the output columns whose input column x' * stride - pad + i falls into the input
+                        int offset = (int)i - padW;
+                        int begin = offset >= 0 ? 0 : (-offset + strideW - 1) / strideW;
+                        int last = (int)inW - 1 - offset;
+                        if (last < 0)
+                            continue;
+                        int end = std::min((int)outW, last / strideW + 1);
+                        for (int outX = begin; outX < end; outX++)
+                        {
+                            ElemType v = row[(outX * strideW + offset) * step];
+                            ElemType* s = sum + outX * B;
+                            for (size_t b = 0; b < B; b++)
+                                s[b] += weights[b] * v;
+                        }
+                    }
+                }
+            }
+            if (!epilogue.IsEmpty())
+            {
+                for (size_t outX = 0; outX < outW; outX++)
+                {
+                    for (size_t b = 0; b < B; b++)
+                        sum[outX * B + b] = epilogue.Apply(sum[outX * B + b], block * B + b);
+                }
+            }
+            std::copy(sums.begin(), sums.end(), y + outY * outW * B);
+        }
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUConvolution::BlockedForward(const Convolution2DShape& shape, size_t blockSize, bool inputBlocked, const ElemType* in, const ElemType* blockedKernel,
+                                               ElemType* out, size_t numSamples, const ConvolutionEpilogue<ElemType>& epilogue)
+{
+    assert(shape.m_mapCount % blockSize == 0 && (!inputBlocked || shape.m_inC % blockSize == 0));
+    if (blockSize == 8)
+        BlockedForwardImpl<ElemType, 8>(shape, inputBlocked, in, blockedKernel, out, numSamples, epilogue);
+    else if (blockSize == 16)
+        BlockedForwardImpl<ElemType, 16>(shape, inputBlocked, in, blockedKernel, out, numSamples, epilogue);
+    else
+        InvalidArgument("BlockedForward: Unsupported channel block size %d, expected 8 or 16.", (int)blockSize);
+}
+
+template void CPUConvolution::DirectForward<float>(const Convolution2DShape&, const float*, const float*, float*, size_t, const ConvolutionEpilogue<float>&);
+template void CPUConvolution::DirectForward<double>(const Convolution2DShape&, const double*, const double*, double*, size_t, const ConvolutionEpilogue<double>&);
+template void CPUConvolution::GroupedForward<float>(const GroupedConvolution2DShape&, const float*, const float*, float*, size_t, const ConvolutionEpilogue<float>&);
+template void CPUConvolution::GroupedForward<double>(const GroupedConvolution2DShape&, const double*, const double*, double*, size_t, const ConvolutionEpilogue<double>&);
+template void CPUConvolution::GroupedBackwardData<float>(const GroupedConvolution2DShape&, const float*, const float*, float*, size_t);
+template void CPUConvolution::GroupedBackwardData<double>(const GroupedConvolution2DShape&, const double*, const double*, double*, size_t);
+template void CPUConvolution::GroupedBackwardKernel<float>(const GroupedConvolution2DShape&, const float*, const float*, float*, size_t);
+template void CPUConvolution::GroupedBackwardKernel<double>(const GroupedConvolution2DShape&, const double*, const double*, double*, size_t);
+template void CPUConvolution::WinogradTransformKernel<float>(const Convolution2DShape&, size_t, const float*, float*);
+template void CPUConvolution::WinogradTransformKernel<double>(const Convolution2DShape&, size_t, const double*, double*);
+template void CPUConvolution::WinogradTransformInput<float>(const Convolution2DShape&, size_t, const float*, size_t, float*);
+template void CPUConvolution::WinogradTransformInput<double>(const Convolution2DShape&, size_t, const double*, size_t, double*);
+template void CPUConvolution::WinogradTransformOutput<float>(const Convolution2DShape&, size_t, const float*, size_t, float*, const ConvolutionEpilogue<float>&);
+template void CPUConvolution::WinogradTransformOutput<double>(const Convolution2DShape&, size_t, const double*, size_t, double*, const ConvolutionEpilogue<double>&);
+template void CPUConvolution::ApplyEpilogue<float>(const ConvolutionEpilogue<float>&, float*, size_t, size_t, size_t);
+template void CPUConvolution::ApplyEpilogue<double>(const ConvolutionEpilogue<double>&, double*, size_t, size_t, size_t);
+
+template void CPUConvolution::MaxPoolingForward<float>(const Pooling2DShape&, const float*, float*, int*, size_t);
+template void CPUConvolution::MaxPoolingForward<double>(const Pooling2DShape&, const double*, double*, int*, size_t);
+template void CPUConvolution::MaxPoolingBackward<float>(const Pooling2DShape&, const float*, const int*, float*, size_t);
+template void CPUConvolution::MaxPoolingBackward<double>(const Pooling2DShape&, const double*, const int*, double*, size_t);
+template void CPUConvolution::AveragePoolingForward<float>(const Pooling2DShape&, const float*, float*, size_t);
+template void CPUConvolution::AveragePoolingForward<double>(const Pooling2DShape&, const double*, double*, size_t);
+template void CPUConvolution::AveragePoolingBackward<float>(const Pooling2DShape&, const float*, float*, size_t);
+template void CPUConvolution::AveragePoolingBackward<double>(const Pooling2DShape&, const double*, double*, size_t);
+
+template void CPUConvolution::ToChannelBlocked<float>(const float*, size_t, size_t, size_t, size_t, float*);
+template void CPUConvolution::ToChannelBlocked<double>(const double*, size_t, size_t, size_t, size_t, double*);
+template void CPUConvolution::FromChannelBlocked<float>(const float*, size_t, size_t, size_t, size_t, float*);
+template void CPUConvolution::FromChannelBlocked<double>(const double*, size_t, size_t, size_t, size_t, double*);
+template void CPUConvolution::BlockKernel<float>(const Convolution2DShape&, size_t, const float*, float*);
+template void CPUConvolution::BlockKernel<double>(const Convolution2DShape&, size_t, const double*, double*);
+template void CPUConvolution::BlockedForward<float>(const Convolution2DShape&, size_t, bool, const float*, const float*, float*, size_t, const ConvolutionEpilogue<float>&);
+template void CPUConvolution::BlockedForward<double>(const Convolution2DShape&, size_t, bool, const double*, const double*, double*, size_t, const ConvolutionEpilogue<double>&);
+
+}}}
@@ -0,0 +1,225 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPUConvolution.h -- direct, grouped and Winograd kernels for 2D convolutions on the CPU, used by the Direct, Grouped and Winograd convolution engines
+//
+#pragma once
+
+#include "CommonMatrix.h"
+#include "ConvolveGeometry.h"
+#include "TensorOps.h"
+#include <cmath>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// A 2D convolution in CHW layout, i.e. input [W x H x C] and output [W' x H' x K] (W fastest), with K kernels of
+// [X x Y x C] that span all input channels, and zero padding. Output element (x', y') of map k reads the input at
+// (x' * strideX - padX + i, y' * strideY - padY + j) for kernel element (i, j).
+// Kernel weights are stored one map after the other: weight (i, j, c) of map k is kernel[k * X*Y*C + i + X * (j + Y * c)].
+struct Convolution2DShape
+{
+    size_t m_inW, m_inH, m_inC;
+    size_t m_kernelW, m_kernelH;
+    size_t m_mapCount;
+    size_t m_strideW, m_strideH;
+    int m_padW, m_padH;
+    size_t m_outW, m_outH;
+
+    size_t InputSize() const { return m_inW * m_inH * m_inC; }
+    size_t OutputSize() const { return m_outW * m_outH * m_mapCount; }
+    size_t KernelSize() const { return m_kernelW * m_kernelH * m_inC; }
+
+    // Returns false if the geometry is not such a 2D convolution with full sharing.
+    static bool TryCreate(const ConvolveGeometry& geometry, Convolution2DShape& shape);
+};
+
+// A 2D grouped convolution in CHW layout: the C input channels are split into G groups of C/G channels, and each
+// of the K = G * M output maps reads the channels of one group only. Depthwise convolution is the case C/G = 1.
+// ConvolveGeometry expresses this by a kernel of [X x Y x C/G] with a stride of C/G in the channel axis, which gives
+// G outputs per map along that axis, i.e. output map k = g + G * m belongs to group g = k % G. Without sharing in the
+// channel axis, each output map has its own kernel (kernel index k); with sharing, the groups share the M kernels
+// (kernel index m). Weight (i, j, c) of kernel n is kernel[n * X*Y*C/G + i + X * (j + Y * c)].
+struct GroupedConvolution2DShape
+{
+    size_t m_inW, m_inH, m_inC;
+    size_t m_kernelW, m_kernelH;
+    size_t m_groups, m_groupC, m_groupMaps;
+    bool m_sharedKernels;
+    size_t m_strideW, m_strideH;
+    int m_padW, m_padH;
+    size_t m_outW, m_outH;
+
+    size_t MapCount() const { return m_groups * m_groupMaps; }
+    size_t InputSize() const { return m_inW * m_inH * m_inC; }
+    size_t OutputSize() const { return m_outW * m_outH * MapCount(); }
+    size_t KernelSize() const { return m_kernelW * m_kernelH * m_groupC; }
+    size_t KernelCount() const { return m_sharedKernels ? m_groupMaps : MapCount(); }
+    size_t KernelIndex(size_t map) const { return m_sharedKernels ? map / m_groups : map; }
+
+    // Returns false if the geometry is not such a convolution with at least two groups.
+    static bool TryCreate(const ConvolveGeometry& geometry, GroupedConvolution2DShape& shape);
+};
+
+// 2D pooling in CHW layout: each of the C planes [W x H] of the input is pooled with a window of [X x Y] into the
+// plane [W' x H'] of the output. Output element (x', y') pools the input elements (x' * strideX - padX + i,
+// y' * strideY - padY + j) that fall into the plane; padding is not counted in averages.
+struct Pooling2DShape
+{
+    size_t m_inW, m_inH, m_channels;
+    size_t m_kernelW, m_kernelH;
+    size_t m_strideW, m_strideH;
+    int m_padW, m_padH;
+    size_t m_outW, m_outH;
+
+    size_t InputSize() const { return m_inW * m_inH * m_channels; }
+    size_t OutputSize() const { return m_outW * m_outH * m_channels; }
+
+    // Returns false if the geometry is not such a pooling.
+    static bool TryCreate(const ConvolveGeometry& geometry, Pooling2DShape& shape);
+};
+
+// Activation that a convolution applies to its output together with the bias ("fused convolution")
+enum class FusedActivation : int
+{
+    None = 0,
+    ReLU = 1,
+    Sigmoid = 2,
+    Tanh = 3
+};
+
+// Bias (one value per output map) and activation that the CPU kernels apply to their output while it is still in the
+// L1 cache, instead of in separate passes over the output. An empty epilogue leaves the output unchanged.
+template <class ElemType>
+struct ConvolutionEpilogue
+{
+    const ElemType* m_bias; // or nullptr
+    FusedActivation m_activation;
+
+    ConvolutionEpilogue(const ElemType* bias = nullptr, FusedActivation activation = FusedActivation::None)
+        : m_bias(bias), m_activation(activation)
+    {
+    }
+
+    bool IsEmpty() const { return !m_bias && m_activation == FusedActivation::None; }
+
+    ElemType Apply(ElemType value, size_t map) const
+    {
+        if (m_bias)
+            value += m_bias[map];
+        switch (m_activation)
+        {
+        case FusedActivation::ReLU:    return value > 0 ? value : 0;
+        case FusedActivation::Sigmoid: return Sigmoid(value);
+        case FusedActivation::Tanh:    return std::tanh(value);
+        default:                       return value;
+        }
+    }
+
+    // 'count' values of one map
+    void Apply(ElemType* values, size_t count, size_t map) const
+    {
+        if (IsEmpty())
+            return;
+        if (m_activation == FusedActivation::None) // bias only
+        {
+            ElemType bias = m_bias[map];
+            for (size_t i = 0; i < count; i++)
+                values[i] += bias;
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+                values[i] = Apply(values[i], map);
+        }
+    }
+};
+
+class MATH_API CPUConvolution
+{
+public:
+    // Direct convolution of numSamples samples, one after the other in 'in' and 'out'. The output maps are computed in
+    // blocks of four, one output row at a time, such that each input value that is loaded is used for four maps, and
+    // the partial sums of the row stay in the L1 cache. Nothing is unrolled, so no temporary memory is needed.
+    template <class ElemType>
+    static void DirectForward(const Convolution2DShape& shape, const ElemType* in, const ElemType* kernel, ElemType* out, size_t numSamples,
+                              const ConvolutionEpilogue<ElemType>& epilogue = ConvolutionEpilogue<ElemType>());
+
+    // Grouped and depthwise convolution (see GroupedConvolution2DShape), computed directly: the output maps are
+    // independent tasks that read the C/G channels of their group, and the inner loops run along the rows of the
+    // output (forward) or input (backward), where the values are contiguous. The backward functions add to their result.
+    template <class ElemType>
+    static void GroupedForward(const GroupedConvolution2DShape& shape, const ElemType* in, const ElemType* kernel, ElemType* out, size_t numSamples,
+                               const ConvolutionEpilogue<ElemType>& epilogue = ConvolutionEpilogue<ElemType>());
+    template <class ElemType>
+    static void GroupedBackwardData(const GroupedConvolution2DShape& shape, const ElemType* srcGrad, const ElemType* kernel, ElemType* grad, size_t numSamples);
+    template <class ElemType>
+    static void GroupedBackwardKernel(const GroupedConvolution2DShape& shape, const ElemType* srcGrad, const ElemType* in, ElemType* kernelGrad, size_t numSamples);
+
+    // Winograd convolution F(m x m, 3 x 3) for 3x3 kernels with stride 1 (Lavin and Gray, Fast Algorithms for Convolutional
+    // Neural Networks). The output is computed in tiles of m x m from input tiles of a x a, a = m + 2, as
+    //     Y = A^T [ sum_c (G g_kc G^T) .* (B^T d_c B) ] A
+    // The sum over channels is, for each of the a x a elements of the transformed tiles, one product of a [K x C] matrix
+    // of transformed kernels with a [C x T] matrix of transformed input tiles, where T is the number of tiles; the caller
+    // computes these with GEMM. The transformed values are stored element after element (xi = 0 .. a*a-1):
+    //     transformed kernels U:  U[(xi * C + c) * K + k]
+    //     transformed inputs V:   V[(xi * T + t) * C + c]
+    //     products M = U * V:     M[(xi * T + t) * K + k]
+    // Tiles are numbered t = (sample * tilesH + tileY) * tilesW + tileX.
+    static bool IsWinogradSupported(const Convolution2DShape& shape);
+    // m = 4 for outputs of at least 8 x 8, which saves more multiplications (4 instead of 2.25 times), otherwise 2
+    static size_t WinogradTileSize(const Convolution2DShape& shape);
+    static size_t WinogradNumTiles(const Convolution2DShape& shape, size_t tileSize, size_t numSamples);
+
+    template <class ElemType>
+    static void WinogradTransformKernel(const Convolution2DShape& shape, size_t tileSize, const ElemType* kernel, ElemType* u);
+    template <class ElemType>
+    static void WinogradTransformInput(const Convolution2DShape& shape, size_t tileSize, const ElemType* in, size_t numSamples, ElemType* v);
+    template <class ElemType>
+    static void WinogradTransformOutput(const Convolution2DShape& shape, size_t tileSize, const ElemType* m, size_t numSamples, ElemType* out,
+                                        const ConvolutionEpilogue<ElemType>& epilogue = ConvolutionEpilogue<ElemType>());
+
+    // Pooling with square windows of 2x2 or 3x3 and a stride of 1 or 2 (see Pooling2DShape), the common cases in image
+    // networks. The planes are independent tasks. The window size and stride are compile-time constants, so that
+    // the loop over the output columns whose windows lie inside the input is vectorized; only the border is checked.
+    // Max pooling stores the position of the maximum of each window in its plane (the first one in case of ties)
+    // in 'argmax', if not nullptr, which backpropagation then uses instead of searching the window again. The
+    // backward functions add to 'grad'.
+    static bool IsPoolingSupported(const Pooling2DShape& shape);
+    template <class ElemType>
+    static void MaxPoolingForward(const Pooling2DShape& shape, const ElemType* in, ElemType* out, int* argmax, size_t numSamples);
+    template <class ElemType>
+    static void MaxPoolingBackward(const Pooling2DShape& shape, const ElemType* srcGrad, const int* argmax, ElemType* grad, size_t numSamples);
+    template <class ElemType>
+    static void AveragePoolingForward(const Pooling2DShape& shape, const ElemType* in, ElemType* out, size_t numSamples);
+    template <class ElemType>
+    static void AveragePoolingBackward(const Pooling2DShape& shape, const ElemType* srcGrad, ElemType* grad, size_t numSamples);
+
+    // Applies the epilogue to samples of numMaps maps of mapSize values each, for engines that can't apply it on the fly.
+    template <class ElemType>
+    static void ApplyEpilogue(const ConvolutionEpilogue<ElemType>& epilogue, ElemType* out, size_t mapSize, size_t numMaps, size_t numSamples);
+
+    // Channel-blocked layout (NCHW8c, NCHW16c): a sample [W x H x C] is stored as [B x W x H x C/B], i.e. the channels
+    // are split into blocks of B, and the B channels of a block are contiguous for each position, so that they fill
+    // a vector register. Channel c of position s is at ((c / B) * W*H + s) * B + c % B. C must be a multiple of B.
+    static bool IsChannelBlockSupported(size_t blockSize) { return blockSize == 8 || blockSize == 16; }
+
+    template <class ElemType>
+    static void ToChannelBlocked(const ElemType* in, size_t spatialSize, size_t channels, size_t blockSize, size_t numSamples, ElemType* out);
+    template <class ElemType>
+    static void FromChannelBlocked(const ElemType* in, size_t spatialSize, size_t channels, size_t blockSize, size_t numSamples, ElemType* out);
+
+    // Reorders the kernel into [B x X x Y x C x K/B], such that the weights of the B maps of an output block are
+    // contiguous for each kernel element. K must be a multiple of B.
+    template <class ElemType>
+    static void BlockKernel(const Convolution2DShape& shape, size_t blockSize, const ElemType* kernel, ElemType* blockedKernel);
+
+    // Direct convolution with the output in channel-blocked layout, and the input either channel-blocked as well, or
+    // in plain CHW layout (the first convolution after a network input). Each input value is multiplied with the B
+    // weights of an output block at once, into a row of sums that is laid out like the output row.
+    template <class ElemType>
+    static void BlockedForward(const Convolution2DShape& shape, size_t blockSize, bool inputBlocked, const ElemType* in, const ElemType* blockedKernel,
+                               ElemType* out, size_t numSamples, const ConvolutionEpilogue<ElemType>& epilogue = ConvolutionEpilogue<ElemType>());
+};
+
+}}}
@@ -0,0 +1,298 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "CPUFusedUpdate.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Large enough that a chunk amortizes its scheduling, small enough that tensors of a few thousand values don't
+// leave the other threads idle.
+static const size_t s_fusedUpdateChunkSize = 1 << 14;
+
+// A contiguous range of values of one tensor, the unit of work of the parallel loops.
+struct FusedUpdateChunk
+{
+    size_t m_tensor;
+    size_t m_begin, m_end;
+};
+
+// FusedUpdateParameters in the element type of the tensors
+template <class ElemType>
+struct FusedStep
+{
+    FusedUpdateKind m_kind;
+    ElemType m_learningRate, m_momentum, m_varianceMomentum;
+    ElemType m_rmsGamma, m_rmsWeightInc, m_rmsWeightDec, m_rmsWeightMax, m_rmsWeightMin;
+    ElemType m_clipThreshold, m_l2Weight, m_l1Weight;
+    bool m_isRegularized; // whether PreProcess() or PostProcess() change anything
+
+    FusedStep(const FusedUpdateParameters& update)
+        : m_kind(update.m_kind),
+          m_learningRate((ElemType) update.m_learningRate), m_momentum((ElemType) update.m_momentum), m_varianceMomentum((ElemType) update.m_varianceMomentum),
+          m_rmsGamma((ElemType) update.m_rmsGamma), m_rmsWeightInc((ElemType) update.m_rmsWeightInc), m_rmsWeightDec((ElemType) update.m_rmsWeightDec),
+          m_rmsWeightMax((ElemType) update.m_rmsWeightMax), m_rmsWeightMin((ElemType) update.m_rmsWeightMin),
+          m_clipThreshold((ElemType) std::abs(update.m_clipThreshold)), m_l2Weight((ElemType) update.m_l2Weight), m_l1Weight((ElemType) update.m_l1Weight)
+    {
+        m_isRegularized = m_clipThreshold != std::numeric_limits<ElemType>::infinity() || m_l2Weight != 0 || m_l1Weight > 0;
+    }
+
+    // gradient clipping by truncation and L2 regularization (LearnerBase::PreProcess)
+    // The loops are compiled with and without regularization, such that the common case has no extra branches.
+    template <bool isRegularized>
+    ElemType PreProcess(ElemType g, ElemType value) const
+    {
+        if (!isRegularized)
+            return g;
+        if (g > m_clipThreshold)
+            g = m_clipThreshold;
+        else if (g < -m_clipThreshold)
+            g = -m_clipThreshold;
+        return g + m_l2Weight * value;
+    }
+
+    // L1 regularization (LearnerBase::PostProcess)
+    template <bool isRegularized>
+    ElemType PostProcess(ElemType value) const
+    {
+        if (!isRegularized || m_l1Weight <= 0)
+            return value;
+        if (value > m_l1Weight)
+            return value - m_l1Weight;
+        if (value < -m_l1Weight)
+            return value + m_l1Weight;
+        return 0;
+    }
+
+    // AdaGrad and RmsProp: updates the state of value i of a tensor of n values and returns the normalized gradient;
+    // 'multiplier' receives the factor by which g was multiplied, which is averaged for needAveMultiplier.
+    ElemType Normalize(ElemType g, ElemType* state, size_t i, size_t n, ElemType& multiplier) const
+    {
+        if (m_kind == FusedUpdateKind::AdaGrad) // CPUMatrix::Adagrad
+        {
+            const ElemType floor = 1e-16f;
+            ElemType sum = state[i] + g * g;
+            state[i] = sum;
+            multiplier = 1 / sqrt(sum + floor);
+            return g * multiplier;
+        }
+        else // CPUMatrix::RmsProp
+        {
+            const ElemType floor = 1e-6f;
+            ElemType* avars = state;
+            ElemType* signs = state + n;
+            ElemType* steps = state + 2 * n;
+            avars[i] = m_rmsGamma * avars[i] + (1 - m_rmsGamma) * (g * g);
+            const int gradSign = (ElemType(0) < g) - (g < ElemType(0));
+            if (signs[i] * gradSign > 0)
+                steps[i] = std::min(steps[i] * m_rmsWeightInc, m_rmsWeightMax);
+            else
+                steps[i] = std::max(steps[i] * m_rmsWeightDec, m_rmsWeightMin);
+            signs[i] = (ElemType) gradSign;
+            multiplier = steps[i] / sqrt(avars[i] + floor);
+            return g * multiplier;
+        }
+    }
+};
+
+// The complete step for values [begin, end) of a tensor. Returns whether a NaN came out; this is checked before the
+// L1 soft threshold, which would turn it into 0.
+template <class ElemType, bool isRegularized>
+static bool UpdateRange(const FusedStep<ElemType>& step, const FusedUpdateTensor<ElemType>& tensor, size_t begin, size_t end)
+{
+    ElemType* value = tensor.m_value;
+    const ElemType* gradient = tensor.m_gradient;
+    ElemType* state = tensor.m_state;
+    int hasNan = 0; // an int rather than a bool, such that the loops are vectorized
+
+    switch (step.m_kind)
+    {
+    case FusedUpdateKind::SGD:
+    case FusedUpdateKind::Nesterov:
+    {
+        const ElemType momentum = step.m_momentum;
+        const ElemType scaledRate = (1 - momentum) * step.m_learningRate;
+        if (step.m_kind == FusedUpdateKind::SGD)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                ElemType g = step.template PreProcess<isRegularized>(gradient[i], value[i]);
+                ElemType smoothed = scaledRate * g + momentum * state[i];
+                state[i] = smoothed;
+                ElemType v = value[i] - smoothed;
+                hasNan |= std::isnan(v) ? 1 : 0;
+                value[i] = step.template PostProcess<isRegularized>(v);
+            }
+        }
+        else
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                ElemType g = step.template PreProcess<isRegularized>(gradient[i], value[i]);
+                ElemType smoothed = scaledRate * g + momentum * state[i];
+                state[i] = smoothed;
+                ElemType v = value[i] - momentum * smoothed - scaledRate * g;
+                hasNan |= std::isnan(v) ? 1 : 0;
+                value[i] = step.template PostProcess<isRegularized>(v);
+            }
+        }
+        break;
+    }
+    case FusedUpdateKind::FSAdaGrad: // CPUMatrix::FSAdagrad
+    {
+        const size_t n = tensor.m_size;
+        const ElemType adaMul = (ElemType) tensor.m_adaMultiplier;
+        const ElemType adaWeight = step.m_varianceMomentum;
+        const ElemType momentum = step.m_momentum;
+        ElemType* smoothAda = state;
+        ElemType* smoothMom = state + n;
+        for (size_t i = begin; i < end; i++)
+        {
+            ElemType g = step.template PreProcess<isRegularized>(gradient[i], value[i]);
+            ElemType adaSqr = adaWeight * smoothAda[i] + (1 - adaWeight) * g * g;
+            smoothAda[i] = adaSqr;
+            if (adaSqr != 0)
+            {
+                ElemType w = adaMul * (1 / sqrt(adaSqr));
+                if (w > 10)
+                    w = 10;
+                g *= w;
+            }
+            if (momentum > 0)
+            {
+                g = momentum * smoothMom[i] + (1 - momentum) * g;
+                smoothMom[i] = g;
+            }
+            ElemType v = value[i] - step.m_learningRate * g;
+            hasNan |= std::isnan(v) ? 1 : 0;
+            value[i] = step.template PostProcess<isRegularized>(v);
+        }
+        break;
+    }
+    case FusedUpdateKind::AdaGrad:
+    case FusedUpdateKind::RmsProp: // without needAveMultiplier, i.e. with an average multiplier of 1
+    {
+        const size_t n = tensor.m_size;
+        ElemType multiplier;
+        for (size_t i = begin; i < end; i++)
+        {
+            ElemType g = step.Normalize(step.template PreProcess<isRegularized>(gradient[i], value[i]), state, i, n, multiplier);
+            ElemType v = value[i] - step.m_learningRate * g;
+            hasNan |= std::isnan(v) ? 1 : 0;
+            value[i] = step.template PostProcess<isRegularized>(v);
+        }
+        break;
+    }
+    default:
+        assert(false); // checked by CPUFusedUpdate::Update, this runs in a parallel region
+    }
+    return hasNan != 0;
+}
+
+// First pass of AdaGrad and RmsProp with needAveMultiplier: updates the state, stores the normalized gradient, and
+// returns the sum of the multipliers of values [begin, end).
+template <class ElemType, bool isRegularized>
+static double NormalizeRange(const FusedStep<ElemType>& step, const FusedUpdateTensor<ElemType>& tensor, size_t begin, size_t end)
+{
+    const ElemType* value = tensor.m_value;
+    ElemType* gradient = tensor.m_gradient;
+    ElemType* state = tensor.m_state;
+    const size_t n = tensor.m_size;
+    ElemType multiplier, sum = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        gradient[i] = step.Normalize(step.template PreProcess<isRegularized>(gradient[i], value[i]), state, i, n, multiplier);
+        sum += multiplier;
+    }
+    return sum;
+}
+
+// Second pass: value -= rate * g for the normalized gradient. Returns whether a NaN came out.
+template <class ElemType, bool isRegularized>
+static bool ApplyRange(const FusedStep<ElemType>& step, ElemType rate, const FusedUpdateTensor<ElemType>& tensor, size_t begin, size_t end)
+{
+    ElemType* value = tensor.m_value;
+    const ElemType* gradient = tensor.m_gradient;
+    int hasNan = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        ElemType v = value[i] - rate * gradient[i];
+        hasNan |= std::isnan(v) ? 1 : 0;
+        value[i] = step.template PostProcess<isRegularized>(v);
+    }
+    return hasNan != 0;
+}
+
+template <class ElemType>
+/*static*/ size_t CPUFusedUpdate::Update(const FusedUpdateParameters& update, const std::vector<FusedUpdateTensor<ElemType>>& tensors)
+{
+    if (update.m_kind < FusedUpdateKind::SGD || update.m_kind > FusedUpdateKind::RmsProp)
+        LogicError("CPUFusedUpdate: unknown update kind %d.", (int) update.m_kind);
+
+    std::vector<FusedUpdateChunk> chunks;
+    for (size_t t = 0; t < tensors.size(); t++)
+    {
+        for (size_t begin = 0; begin < tensors[t].m_size; begin += s_fusedUpdateChunkSize)
+            chunks.push_back({ t, begin, std::min(begin + s_fusedUpdateChunkSize, tensors[t].m_size) });
+    }
+
+    const FusedStep<ElemType> step(update);
+    const long numChunks = (long) chunks.size();
+    std::vector<char> chunkHasNan(chunks.size(), 0);
+
+    const bool needAveMultiplier = update.m_needAveMultiplier && (update.m_kind == FusedUpdateKind::AdaGrad || update.m_kind == FusedUpdateKind::RmsProp);
+    if (!needAveMultiplier)
+    {
+#pragma omp parallel for if (numChunks > 1)
+        for (long c = 0; c < numChunks; c++)
+        {
+            const auto& chunk = chunks[c];
+            chunkHasNan[c] = step.m_isRegularized ? UpdateRange<ElemType, true>(step, tensors[chunk.m_tensor], chunk.m_begin, chunk.m_end)
+                                                   : UpdateRange<ElemType, false>(step, tensors[chunk.m_tensor], chunk.m_begin, chunk.m_end);
+        }
+    }
+    else
+    {
+        std::vector<double> chunkSums(chunks.size());
+#pragma omp parallel for if (numChunks > 1)
+        for (long c = 0; c < numChunks; c++)
+        {
+            const auto& chunk = chunks[c];
+            chunkSums[c] = step.m_isRegularized ? NormalizeRange<ElemType, true>(step, tensors[chunk.m_tensor], chunk.m_begin, chunk.m_end)
+                                                 : NormalizeRange<ElemType, false>(step, tensors[chunk.m_tensor], chunk.m_begin, chunk.m_end);
+        }
+
+        // the step of each tensor is learningRate / aveMultiplier, summed in chunk order so the result doesn't depend on the threads
+        std::vector<double> sums(tensors.size(), 0);
+        for (size_t c = 0; c < chunks.size(); c++)
+            sums[chunks[c].m_tensor] += chunkSums[c];
+        std::vector<ElemType> rates(tensors.size());
+        for (size_t t = 0; t < tensors.size(); t++)
+            rates[t] = tensors[t].m_size > 0 ? (ElemType) (update.m_learningRate / (sums[t] / tensors[t].m_size)) : step.m_learningRate;
+
+#pragma omp parallel for if (numChunks > 1)
+        for (long c = 0; c < numChunks; c++)
+        {
+            const auto& chunk = chunks[c];
+            chunkHasNan[c] = step.m_isRegularized ? ApplyRange<ElemType, true>(step, rates[chunk.m_tensor], tensors[chunk.m_tensor], chunk.m_begin, chunk.m_end)
+                                                   : ApplyRange<ElemType, false>(step, rates[chunk.m_tensor], tensors[chunk.m_tensor], chunk.m_begin, chunk.m_end);
+        }
+    }
+
+    for (size_t c = 0; c < chunks.size(); c++)
+    {
+        if (chunkHasNan[c])
+            return chunks[c].m_tensor;
+    }
+    return SIZE_MAX;
+}
+
+template size_t CPUFusedUpdate::Update<float>(const FusedUpdateParameters&, const std::vector<FusedUpdateTensor<float>>&);
+template size_t CPUFusedUpdate::Update<double>(const FusedUpdateParameters&, const std::vector<FusedUpdateTensor<double>>&);
+
+}}}
@@ -0,0 +1,76 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPUFusedUpdate.h -- optimizer steps of the learners applied to many dense CPU tensors in one parallel pass
+//
+#pragma once
+
+#include "CommonMatrix.h"
+#include <limits>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+enum class FusedUpdateKind : int
+{
+    SGD,       // smoothed = (1 - momentum) * lr * g + momentum * smoothed; value -= smoothed (Matrix::NormalGrad)
+    Nesterov,  // as SGD, but value -= momentum * smoothed + (1 - momentum) * lr * g
+    AdaGrad,   // Matrix::Adagrad followed by value -= lr / aveMultiplier * g
+    FSAdaGrad, // Matrix::FSAdagradUpdate
+    RmsProp    // Matrix::RmsProp followed by value -= lr / aveMultiplier * g
+};
+
+// The step of one minibatch, including the gradient preprocessing and value postprocessing done by the learners.
+// The order is: truncate g to [-clipThreshold, clipThreshold], g += l2Weight * value, the update itself, and then
+// the soft threshold of value by l1Weight.
+struct FusedUpdateParameters
+{
+    FusedUpdateKind m_kind = FusedUpdateKind::SGD;
+    double m_learningRate = 0;
+    double m_momentum = 0;          // SGD, Nesterov and FSAdaGrad
+    double m_varianceMomentum = 0;  // FSAdaGrad
+    bool m_needAveMultiplier = false; // AdaGrad and RmsProp
+    double m_rmsGamma = 0, m_rmsWeightInc = 0, m_rmsWeightDec = 0, m_rmsWeightMax = 0, m_rmsWeightMin = 0; // RmsProp
+
+    double m_clipThreshold = std::numeric_limits<double>::infinity();
+    double m_l2Weight = 0;
+    double m_l1Weight = 0;
+
+    // number of state values per value: the smoothed gradient, resp. (FSAdaGrad) the smoothed squares and the momentum,
+    // resp. (RmsProp) the smoothed squares, the signs of the previous gradient and the step sizes, one after the other
+    size_t StateSize() const
+    {
+        switch (m_kind)
+        {
+        case FusedUpdateKind::FSAdaGrad: return 2;
+        case FusedUpdateKind::RmsProp:   return 3;
+        default:                         return 1;
+        }
+    }
+};
+
+// One dense tensor: its values, gradient and m_size * StateSize() values of learner state, laid out as the
+// smoothed gradient matrices of the corresponding Matrix functions. The gradient is modified, as by those functions.
+template <class ElemType>
+struct FusedUpdateTensor
+{
+    ElemType* m_value;
+    ElemType* m_gradient;
+    ElemType* m_state;
+    size_t m_size;
+    double m_adaMultiplier; // FSAdaGrad: targetAdagradAvDenom * sqrt(smoothedCount) of this tensor
+};
+
+class MATH_API CPUFusedUpdate
+{
+public:
+    // Applies the step to all tensors. The tensors are cut into chunks of equal size that are updated in parallel, each
+    // in one pass that reads the gradient and state once and checks the new values for NaNs. Only AdaGrad and RmsProp
+    // with needAveMultiplier need a second pass, since their step depends on an average over the whole tensor.
+    // Returns the index of the first tensor that has a NaN after the update, or SIZE_MAX.
+    template <class ElemType>
+    static size_t Update(const FusedUpdateParameters& update, const std::vector<FusedUpdateTensor<ElemType>>& tensors);
+};
+
+} } }
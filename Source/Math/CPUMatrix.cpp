@@ -21,6 +21,7 @@
 #include <thread>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #ifdef _WIN32
 #define NOMINMAX
 #include "Windows.h"
@@ -876,8 +877,9 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     // if it's externally managed, then populate the structure
     if (matrixFlags & matrixFlagDontOwnBuffer)
     {
-        // free previous array allocation if any before overwriting
-        delete[] Buffer();
+        // free previous array allocation if any before overwriting; a previous external buffer belongs to someone else
+        if (!HasExternalBuffer())
+            delete[] Buffer();
 
         m_numRows = numRows;
         m_numCols = numCols;
@@ -6077,6 +6079,21 @@ void CPUMatrix<ElemType>::SetCompatibleMode()
     #endif
 }
 
+// shared by all <ElemType>
+static std::atomic<bool> s_forceDeterministicAlgorithms(false);
+
+template <class ElemType>
+void CPUMatrix<ElemType>::ForceDeterministicAlgorithms()
+{
+    s_forceDeterministicAlgorithms = true;
+}
+
+template <class ElemType>
+bool CPUMatrix<ElemType>::ShouldForceDeterministicAlgorithms()
+{
+    return s_forceDeterministicAlgorithms;
+}
+
 // =======================================================================
 // TensorView support
 // =======================================================================
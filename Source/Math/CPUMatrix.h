@@ -390,6 +390,9 @@ public:
     // This functions do not depend on <ElemType>, i.e. you can call them on any <ElemType>
     static int SetNumThreads(int numThreads);
     static void SetCompatibleMode();
+    // Makes the parallel CPU kernels that may combine partial results in varying order use a fixed order instead.
+    static void ForceDeterministicAlgorithms();
+    static bool ShouldForceDeterministicAlgorithms();
 
     // static BLAS functions
     static void SVD(const CPUMatrix<ElemType>& A, CPUMatrix<ElemType>& SIGMA, CPUMatrix<ElemType>& U, CPUMatrix<ElemType>& VT, CPUMatrix<ElemType>& W);
@@ -231,8 +231,9 @@ void CPUSparseMatrix<ElemType>::SetValue(const size_t row, const size_t col, con
         SetColIdx((int) c);
     }
     // Note we don't have m_nz anymore. In order for the change from m_nz to
-    // NzCount to make sense, we need to propogate nz+1 to all col slices.
-    for (size_t max = c + 1; max < m_numCols + 1; max++)
+    // NzCount to make sense, we need to propogate nz+1 to all col slices (row slices for CSR).
+    size_t numSlices = (GetFormat() == matrixFormatSparseCSC) ? m_numCols : m_numRows;
+    for (size_t max = c + 1; max < numSlices + 1; max++)
     {
         SecondaryIndexLocation()[max] = CPUSPARSE_INDEX_TYPE(nz + 1);
     }
@@ -596,6 +597,38 @@ CPUMatrix<ElemType> CPUSparseMatrix<ElemType>::CopyColumnSliceToDense(size_t sta
     return slice;
 }
 
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::CopyCSCToArrays(std::vector<CPUSPARSE_INDEX_TYPE>& columnStarts, std::vector<CPUSPARSE_INDEX_TYPE>& rowIndices, std::vector<ElemType>& values) const
+{
+    if (GetFormat() != MatrixFormat::matrixFormatSparseCSC)
+        NOT_IMPLEMENTED;
+
+    // (rebased to 0, since this may be a column slice)
+    columnStarts.assign(m_numCols + 1, 0);
+    if (!IsEmpty())
+    {
+        const CPUSPARSE_INDEX_TYPE* cols = SecondaryIndexLocation();
+        for (size_t j = 0; j <= m_numCols; j++)
+            columnStarts[j] = cols[j] - cols[0];
+    }
+    size_t nz = columnStarts[m_numCols];
+    rowIndices.assign(MajorIndexLocation(), MajorIndexLocation() + nz);
+    values.assign(Data(), Data() + nz);
+}
+
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::CopyBlockColumnsToArray(std::vector<size_t>& columnIds, std::vector<ElemType>& values) const
+{
+    if (GetFormat() != MatrixFormat::matrixFormatSparseBlockCol)
+        NOT_IMPLEMENTED;
+
+    size_t numBlocks = IsEmpty() ? 0 : GetBlockSize();
+    columnIds.resize(numBlocks);
+    for (size_t j = 0; j < numBlocks; j++)
+        columnIds[j] = GetBlockIds()[j] - GetBlockIdShift();
+    values.assign(Buffer(), Buffer() + numBlocks * m_numRows);
+}
+
 template <class ElemType>
 CPUMatrix<ElemType> CPUSparseMatrix<ElemType>::DiagonalToDense() const
 {
@@ -814,18 +847,18 @@ public:
         if (k != l)
             InvalidArgument("CPUSparseMatrix::MultiplyAndWeightedAdd: The inner dimensions of a (= %lu) and b (= %lu) don't match.", k, l);
 
-        // Determine the dimension of the outer index of the dense matrix.
-        size_t outerDimensionDense;
-        if      ( denseTimesSparse && !transposeA) outerDimensionDense = dense.GetNumRows();
-        else if ( denseTimesSparse &&  transposeA) outerDimensionDense = dense.GetNumCols();
-        else if (!denseTimesSparse && !transposeB) outerDimensionDense = dense.GetNumCols();
-        else if (!denseTimesSparse &&  transposeB) outerDimensionDense = dense.GetNumRows();
-
         if (beta == 0)
             c.RequireSize(m, n);
         else
             c.VerifySize(m, n); // Can't resize if beta != 0
 
+        // Below condition is evaluated at compile time except for the format and beta.
+        if (denseTimesSparse && !transposeA && !transposeB && beta == 0 && sparse.GetFormat() == matrixFormatSparseCSC && !dense.IsEmpty())
+        {
+            Gather(alpha, sparse, dense, c);
+            return;
+        }
+
         if (beta == 0)
             memset(c.Data(), 0, sizeof(ElemType)* c.GetNumElements());
         else if (beta != 1)
@@ -843,8 +876,7 @@ public:
         if (sparse.IsEmpty() || dense.IsEmpty())
             return;
 
-        // TODO: Implement CSR as a transposition of b, like we do for GPU.
-        if (sparse.GetFormat() != matrixFormatSparseCSC)
+        if (sparse.GetFormat() != matrixFormatSparseCSC && sparse.GetFormat() != matrixFormatSparseCSR && sparse.GetFormat() != matrixFormatSparseBlockCol)
             NOT_IMPLEMENTED;
 
         // Up to here we have:
@@ -852,51 +884,296 @@ public:
         // * Initialized the output matrix c
 
         // Now do the actual multiplication.
-        ElemType* valueBuffer = sparse.Buffer() + *sparse.SecondaryIndexLocation(); // Points to the value buffer of the current view (i.e. buffer containing values of non-zero elements).
-        int* rowIndexBuffer = sparse.MajorIndexLocation();                          // Points to the index buffer of the current view (i.e. buffer containing indices of non-zero elements).
-        size_t iNonzero = 0;                                                           // Number of nonzero elements handled so far for curent slice view.
-        int numPreviosNonzero = sparse.SecondaryIndexLocation()[0];                 // Total number of nonzero values handled in previous slices.
+        Accumulate(alpha, sparse, dense, c.Data(), c.GetNumRows(), c.GetNumElements());
+    }
+
+    // Adds alpha times the product to the column-major matrix 'c' with 'ldc' rows and 'cSize' elements.
+    //
+    // The nonzero elements of the sparse matrix are visited in units: the columns of a CSC or block-column matrix, or
+    // the rows of a CSR matrix. Each nonzero element adds a scaled row or column of the dense matrix to a row or
+    // column of c; the index along that row or column is the "outer index of the dense matrix" below.
+    // * If the units update distinct rows or columns of c (e.g. the columns of a CSC matrix in dense x sparse),
+    //   they are processed in parallel.
+    // * Otherwise (e.g. dense x sparse^T for the gradient of an embedding) the units collide. Then the outer index of
+    //   the dense matrix is split into blocks that are processed in parallel, each visiting all nonzero elements;
+    //   the blocks of c and of the dense matrix stay in the cache.
+    // * If the outer dimension of the dense matrix is too small to split, and c is small, the threads add their
+    //   units to private copies of c, which are summed in the end. If deterministic algorithms are forced, the units
+    //   are assigned to the threads statically, so that every run sums the same units in the same order.
+    static void Accumulate(ElemType alpha, const CPUSparseMatrix<ElemType>& sparse, const CPUMatrix<ElemType>& dense,
+                           ElemType* c, size_t ldc, size_t cSize)
+    {
+        // Determine the dimension of the outer index of the dense matrix.
+        size_t outerDimensionDense;
+        if      ( denseTimesSparse && !transposeA) outerDimensionDense = dense.GetNumRows();
+        else if ( denseTimesSparse &&  transposeA) outerDimensionDense = dense.GetNumCols();
+        else if (!denseTimesSparse && !transposeB) outerDimensionDense = dense.GetNumCols();
+        else if (!denseTimesSparse &&  transposeB) outerDimensionDense = dense.GetNumRows();
+
+        // Strides along the outer index of the dense matrix, in the dense matrix and in c.
+        // Below conditions are evaluated at compile time.
+        const ElemType* denseData = dense.Data();
+        size_t ldDense = dense.GetNumRows();
+        bool denseIsContiguous = denseTimesSparse ? !transposeA : transposeB;
+        size_t denseStride = denseIsContiguous ? 1 : ldDense;
+        size_t cStride = denseTimesSparse ? 1 : ldc;
+
+        // Adds the product of the nonzero element (rowSparse, colSparse) to c (or to a private copy of it) for the outer indices [begin, end) of the dense matrix.
+        auto update = [&](ElemType* cBase, size_t rowSparse, size_t colSparse, ElemType sparseVal, size_t begin, size_t end)
+        {
+            // Determine the index of the 'outer' dimension of the sparse matrix and the common inner index.
+            size_t outerIndexSparse;
+            size_t innerIndex;
+            // Below if-statements are evaluated at compile time.
+            if      ( denseTimesSparse && !transposeB) { outerIndexSparse = colSparse; innerIndex = rowSparse; }
+            else if ( denseTimesSparse &&  transposeB) { outerIndexSparse = rowSparse; innerIndex = colSparse; }
+            else if (!denseTimesSparse && !transposeA) { outerIndexSparse = rowSparse; innerIndex = colSparse; }
+            else if (!denseTimesSparse &&  transposeA) { outerIndexSparse = colSparse; innerIndex = rowSparse; }
+
+            const ElemType* denseVals = denseData + (denseIsContiguous ? innerIndex * ldDense : innerIndex);
+            ElemType* cVals;
+            if (denseTimesSparse)
+                cVals = cBase + outerIndexSparse * ldc;
+            else
+                cVals = cBase + outerIndexSparse;
+
+            ElemType scale = alpha * sparseVal;
+            if (denseStride == 1 && cStride == 1)
+            {
+                for (size_t outerIndexDense = begin; outerIndexDense < end; outerIndexDense++)
+                    cVals[outerIndexDense] += scale * denseVals[outerIndexDense];
+            }
+            else
+            {
+                for (size_t outerIndexDense = begin; outerIndexDense < end; outerIndexDense++)
+                    cVals[outerIndexDense * cStride] += scale * denseVals[outerIndexDense * denseStride];
+            }
+        };
+
+        bool outerIndexSparseIsRow = denseTimesSparse ? transposeB : !transposeA;
+        bool unitsAreDisjoint = (sparse.GetFormat() == matrixFormatSparseCSR) == outerIndexSparseIsRow;
+        long long numUnits = (long long)NumUnits(sparse);
+        int numThreads = omp_get_max_threads();
 
-        // Loop over columns of the sparse matrix
-        for (size_t colSparse = 0; colSparse < sparse.GetNumCols(); colSparse++)
+        const size_t minBlockSize = 16; // elements of the outer dimension of the dense matrix per parallel task
+        const size_t maxPrivateSize = 1 << 20; // elements of a private copy of c
+        if (unitsAreDisjoint)
+        {
+#pragma omp parallel for schedule(dynamic, 16)
+            for (long long unit = 0; unit < numUnits; unit++)
+            {
+                ForEachNonzero(sparse, (size_t)unit, [&](size_t rowSparse, size_t colSparse, ElemType sparseVal)
+                {
+                    update(c, rowSparse, colSparse, sparseVal, 0, outerDimensionDense);
+                });
+            }
+        }
+        else if (numThreads == 1 || outerDimensionDense >= numThreads * minBlockSize || cSize > maxPrivateSize)
         {
-            size_t numNonzeroInSparseCol = sparse.SecondaryIndexLocation()[colSparse + 1] - numPreviosNonzero;
-            // Loop over the nonzero rows of the current column of the sparse matrix
-            for (; iNonzero < numNonzeroInSparseCol; iNonzero++)
+            size_t blockSize = std::max(minBlockSize, std::min((size_t)256, (outerDimensionDense + numThreads - 1) / numThreads));
+            long long numBlocks = (long long)((outerDimensionDense + blockSize - 1) / blockSize);
+#pragma omp parallel for schedule(dynamic)
+            for (long long block = 0; block < numBlocks; block++)
             {
-                size_t rowSparse = rowIndexBuffer[iNonzero]; // RowLocation
-                ElemType sparseVal = valueBuffer[iNonzero];
-
-                // Determine the index of the 'outer' dimension of the sparse matrix and the common inner index.
-                size_t outerIndexSparse;
-                size_t innerIndex;
-                // Below if-statements are evaluated at compile time.
-                if      ( denseTimesSparse && !transposeB) { outerIndexSparse = colSparse; innerIndex = rowSparse; }
-                else if ( denseTimesSparse &&  transposeB) { outerIndexSparse = rowSparse; innerIndex = colSparse; }
-                else if (!denseTimesSparse && !transposeA) { outerIndexSparse = rowSparse; innerIndex = colSparse; }
-                else if (!denseTimesSparse &&  transposeA) { outerIndexSparse = colSparse; innerIndex = rowSparse; }
-
-                // Loop over the outer index of the dense matrix
-                for (size_t outerIndexDense = 0; outerIndexDense < outerDimensionDense; outerIndexDense++)
+                size_t begin = block * blockSize;
+                size_t end = std::min(outerDimensionDense, begin + blockSize);
+                for (long long unit = 0; unit < numUnits; unit++)
+                {
+                    ForEachNonzero(sparse, (size_t)unit, [&](size_t rowSparse, size_t colSparse, ElemType sparseVal)
+                    {
+                        update(c, rowSparse, colSparse, sparseVal, begin, end);
+                    });
+                }
+            }
+        }
+        else
+        {
+            // The first thread adds to c itself, the others to their copies.
+            std::vector<ElemType> privateCopies((numThreads - 1) * cSize, 0);
+            bool deterministic = CPUMatrix<ElemType>::ShouldForceDeterministicAlgorithms();
+#pragma omp parallel num_threads(numThreads)
+            {
+                int thread = omp_get_thread_num();
+                ElemType* cBase = thread == 0 ? c : privateCopies.data() + (thread - 1) * cSize;
+                auto addUnit = [&](long long unit)
+                {
+                    ForEachNonzero(sparse, (size_t)unit, [&](size_t rowSparse, size_t colSparse, ElemType sparseVal)
+                    {
+                        update(cBase, rowSparse, colSparse, sparseVal, 0, outerDimensionDense);
+                    });
+                };
+                if (deterministic)
                 {
-                    // Determine the row index of the dense input matrix.
-                    // Below if-statements are evaluated at compile time.
-                    ElemType denseVal;
-                    if      ( denseTimesSparse && !transposeA) denseVal = dense(outerIndexDense,      innerIndex);
-                    else if ( denseTimesSparse &&  transposeA) denseVal = dense(     innerIndex, outerIndexDense);
-                    else if (!denseTimesSparse && !transposeB) denseVal = dense(     innerIndex, outerIndexDense);
-                    else if (!denseTimesSparse &&  transposeB) denseVal = dense(outerIndexDense,      innerIndex);
-                    
-
-                    // Update matrix c.
-                    if (denseTimesSparse)
-                        c(outerIndexDense, outerIndexSparse) += alpha * denseVal * sparseVal;
-                    else /*Sparse times dense */
-                        c(outerIndexSparse, outerIndexDense) += alpha * denseVal * sparseVal;
+#pragma omp for schedule(static)
+                    for (long long unit = 0; unit < numUnits; unit++)
+                        addUnit(unit);
                 }
+                else
+                {
+#pragma omp for schedule(dynamic, 16)
+                    for (long long unit = 0; unit < numUnits; unit++)
+                        addUnit(unit);
+                }
+            }
+#pragma omp parallel for
+            for (long long i = 0; i < (long long)cSize; i++)
+            {
+                for (int thread = 1; thread < numThreads; thread++)
+                    c[i] += privateCopies[(thread - 1) * cSize + i];
             }
         }
     }
+
+    // The product of a dense and a sparse matrix as a block-column matrix, whose blocks are the nonzero columns of the
+    // product (those of op(sparse)) in increasing order. For the gradient of an embedding (dense x sparse^T) these are
+    // the distinct ids in the minibatch. The nonzero elements are sorted by their column of the product, so that each
+    // block is the sum over a segment of them; the blocks are independent and computed in parallel. Nothing here is
+    // proportional to the number of columns (the size of the vocabulary).
+    static void MultiplyAndAssignBlockCol(ElemType alpha, const CPUMatrix<ElemType>& dense, const CPUSparseMatrix<ElemType>& sparse, size_t m, size_t n, CPUSparseMatrix<ElemType>& c)
+    {
+        static_assert(denseTimesSparse, "the block-column product is only implemented for dense times sparse");
+
+        struct Entry
+        {
+            size_t column;     // in the product
+            size_t innerIndex; // column of op(dense)
+            ElemType value;
+        };
+        std::vector<Entry> entries;
+        entries.reserve(sparse.NzCount());
+        size_t numUnits = NumUnits(sparse);
+        for (size_t unit = 0; unit < numUnits; unit++)
+        {
+            ForEachNonzero(sparse, unit, [&](size_t row, size_t col, ElemType value)
+            {
+                if (value != 0)
+                    entries.push_back(Entry{transposeB ? row : col, transposeB ? col : row, value});
+            });
+        }
+        // stable, so that the sums are in the same order in every run
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.column < b.column; });
+
+        std::vector<size_t> segmentBegin;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (i == 0 || entries[i].column != entries[i - 1].column)
+                segmentBegin.push_back(i);
+        }
+        size_t numBlocks = segmentBegin.size();
+        segmentBegin.push_back(entries.size());
+        if (numBlocks > 0 && entries.back().column >= n)
+            LogicError("Sparse matrix is unexpectedly out of range.");
+
+        // allocate enough memory; the capacity is kept for the next minibatches
+        c.SetFormat(matrixFormatSparseBlockCol);
+        c.RequireSizeAndAllocate(m, n, m * numBlocks, true, false);
+        for (size_t block = 0; block < numBlocks; block++)
+            c.GetBlockIds()[block] = entries[segmentBegin[block]].column;
+        c.SetBlockSize(numBlocks);
+
+        // Below conditions are evaluated at compile time.
+        const ElemType* denseData = dense.Data();
+        size_t ldDense = dense.GetNumRows();
+        size_t denseStride = transposeA ? ldDense : 1;
+#pragma omp parallel for schedule(dynamic, 4)
+        for (long long block = 0; block < (long long)numBlocks; block++)
+        {
+            ElemType* cVals = c.Buffer() + block * m;
+            for (size_t i = segmentBegin[block]; i < segmentBegin[block + 1]; i++)
+            {
+                const Entry& entry = entries[i];
+                const ElemType* denseVals = denseData + (transposeA ? entry.innerIndex : entry.innerIndex * ldDense);
+                ElemType scale = alpha * entry.value;
+                if (i == segmentBegin[block]) // the first element assigns
+                {
+                    for (size_t h = 0; h < m; h++)
+                        cVals[h] = scale * denseVals[h * denseStride];
+                }
+                else
+                {
+                    for (size_t h = 0; h < m; h++)
+                        cVals[h] += scale * denseVals[h * denseStride];
+                }
+            }
+        }
+    }
+
+    // Embedding lookup: the product of a dense matrix and a CSC matrix (usually one-hot) where each column of the
+    // product is gathered from the columns of the dense matrix selected by the nonzero elements, instead of adding
+    // them to a zeroed result. Only the selected columns of the dense matrix are read.
+    static void Gather(ElemType alpha, const CPUSparseMatrix<ElemType>& sparse, const CPUMatrix<ElemType>& dense, CPUMatrix<ElemType>& c)
+    {
+        assert(denseTimesSparse && !transposeA && !transposeB && sparse.GetFormat() == matrixFormatSparseCSC);
+
+        size_t m = c.GetNumRows();
+        const CPUSPARSE_INDEX_TYPE* secondaryIndex = sparse.SecondaryIndexLocation();
+        const CPUSPARSE_INDEX_TYPE* majorIndex = sparse.MajorIndexLocation();
+        const ElemType* values = sparse.Data();
+#pragma omp parallel for
+        for (long long col = 0; col < (long long)c.GetNumCols(); col++)
+        {
+            ElemType* cVals = c.Data() + col * m;
+            size_t begin = secondaryIndex[col] - secondaryIndex[0];
+            size_t end = secondaryIndex[col + 1] - secondaryIndex[0];
+            if (begin == end)
+            {
+                memset(cVals, 0, sizeof(ElemType) * m);
+                continue;
+            }
+            for (size_t p = begin; p < end; p++)
+            {
+                const ElemType* denseVals = dense.Data() + majorIndex[p] * dense.GetNumRows();
+                ElemType scale = alpha * values[p];
+                if (p == begin)
+                {
+                    for (size_t h = 0; h < m; h++)
+                        cVals[h] = scale * denseVals[h];
+                }
+                else
+                {
+                    for (size_t h = 0; h < m; h++)
+                        cVals[h] += scale * denseVals[h];
+                }
+            }
+        }
+    }
+
+    // The number of columns of a CSC or block-column matrix, or rows of a CSR matrix.
+    static size_t NumUnits(const CPUSparseMatrix<ElemType>& sparse)
+    {
+        if (sparse.GetFormat() == matrixFormatSparseBlockCol)
+            return sparse.GetBlockSize();
+        else if (sparse.GetFormat() == matrixFormatSparseCSR)
+            return sparse.GetNumRows();
+        else
+            return sparse.GetNumCols();
+    }
+
+    // Calls f(row, col, value) for the nonzero elements of a unit (see NumUnits()).
+    template <class F>
+    static void ForEachNonzero(const CPUSparseMatrix<ElemType>& sparse, size_t unit, const F& f)
+    {
+        if (sparse.GetFormat() == matrixFormatSparseBlockCol)
+        {
+            size_t col = sparse.GetBlockIds()[unit] - sparse.GetBlockIdShift();
+            const ElemType* values = sparse.Buffer() + unit * sparse.GetNumRows();
+            for (size_t row = 0; row < sparse.GetNumRows(); row++)
+                f(row, col, values[row]);
+            return;
+        }
+
+        const CPUSPARSE_INDEX_TYPE* secondaryIndex = sparse.SecondaryIndexLocation();
+        const CPUSPARSE_INDEX_TYPE* majorIndex = sparse.MajorIndexLocation(); // relative to the current view, like Data()
+        const ElemType* values = sparse.Data();
+        bool isCSR = sparse.GetFormat() == matrixFormatSparseCSR;
+        for (size_t p = secondaryIndex[unit] - secondaryIndex[0]; p < (size_t)(secondaryIndex[unit + 1] - secondaryIndex[0]); p++)
+        {
+            if (isCSR)
+                f(unit, (size_t)majorIndex[p], values[p]);
+            else
+                f((size_t)majorIndex[p], unit, values[p]);
+        }
+    }
 };
 
 // c = alpha * lhs * rhs + beta * c
@@ -959,72 +1236,20 @@ void CPUSparseMatrix<ElemType>::MultiplyAndAdd(ElemType alpha, const CPUMatrix<E
         InvalidArgument("CPUSparseMatrix::MultiplyAndAdd: The inner dimensions of a (= %lu) and b (= %lu) don't match.", k, l);
     }
 
-    c.Reset();
-
-    if (!transposeA && !transposeB)
-    {
+    if (rhs.GetFormat() != matrixFormatSparseCSC && rhs.GetFormat() != matrixFormatSparseCSR && rhs.GetFormat() != matrixFormatSparseBlockCol)
         NOT_IMPLEMENTED;
-    }
-    else if (!transposeA && transposeB)
-    {
-        if (rhs.GetFormat() != matrixFormatSparseCSC)
-            NOT_IMPLEMENTED;
 
-        // allocate enough memory
-        c.SetFormat(matrixFormatSparseBlockCol);
-        c.RequireSizeAndAllocate(m, n, m * min(n, rhs.NzCount()), true, false);
-
-        map<size_t, size_t> w2Id;
-        for (size_t j = 0; j < rhs.GetNumCols(); j++)
-        { // j ranges over batches
-            size_t start = rhs.SecondaryIndexLocation()[j];
-            size_t end = rhs.SecondaryIndexLocation()[j + 1];
-
-            for (size_t p = start; p < end; p++)
-            {
-                size_t i = rhs.MajorIndexLocation()[p]; // i ranges over words
-                ElemType val = rhs.Buffer()[p];  // 1 for(i, j)
+    c.Reset();
 
-                bool first = true;
-                if (w2Id.find(i) == w2Id.end())
-                {
-                    size_t id = w2Id.size();
-                    w2Id[i] = id;
-                    c.GetBlockIds()[c.GetBlockSize()] = i;
-                    c.SetBlockSize(c.GetBlockSize() + 1);
-                }
-                else
-                {
-                    first = false;
-                }
-                size_t pos = w2Id[i] * lhs.GetNumRows();
-                for (size_t h = 0; h < lhs.GetNumRows(); h++)
-                { // h range over hidden layer
-                    if (first == true)
-                    {
-                        c.Buffer()[pos] = alpha * lhs(h, j) * val;
-                    }
-                    else
-                    {
-                        c.Buffer()[pos] += alpha * lhs(h, j) * val;
-                    }
-                    pos++;
-                }
-            }
-        }
-        if (c.GetBlockSize() * m > c.GetSizeAllocated())
-        {
-            LogicError("Sparse matrix is unexpectedly out of range.");
-        }
-    }
+    // Mapping variables to compile time template parameters for efficiency
+    if (transposeA && transposeB)
+        MultiplyDenseAndSparse<ElemType, true /* dense times sparse */,  true /* transposeA */,  true /*transposeB*/>::MultiplyAndAssignBlockCol(alpha, lhs /* dense */, rhs /*sparse*/, m, n, c);
     else if (transposeA && !transposeB)
-    {
-        NOT_IMPLEMENTED;
-    }
+        MultiplyDenseAndSparse<ElemType, true /* dense times sparse */,  true /* transposeA */, false /*transposeB*/>::MultiplyAndAssignBlockCol(alpha, lhs /* dense */, rhs /*sparse*/, m, n, c);
+    else if (!transposeA && transposeB)
+        MultiplyDenseAndSparse<ElemType, true /* dense times sparse */, false /* transposeA */,  true /*transposeB*/>::MultiplyAndAssignBlockCol(alpha, lhs /* dense */, rhs /*sparse*/, m, n, c);
     else
-    {
-        NOT_IMPLEMENTED;
-    }
+        MultiplyDenseAndSparse<ElemType, true /* dense times sparse */, false /* transposeA */, false /*transposeB*/>::MultiplyAndAssignBlockCol(alpha, lhs /* dense */, rhs /*sparse*/, m, n, c);
 }
 
 // dense += sparse
@@ -10,6 +10,7 @@
 //#include "GPUSparseMatrix.h"
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #ifdef _WIN32
 #ifdef MATH_EXPORTS
@@ -21,10 +22,15 @@
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+template <class ElemType, bool denseTimesSparse, bool transposeA, bool transposeB>
+class MultiplyDenseAndSparse;
+
 template <class ElemType>
 class MATH_API CPUSparseMatrix : public BaseMatrix<ElemType>
 {
     typedef BaseMatrix<ElemType> Base;
+    template <class E, bool denseTimesSparse, bool transposeA, bool transposeB>
+    friend class MultiplyDenseAndSparse; // the sparse x dense products
     using Base::m_numRows;
     using Base::m_numCols;
     using Base::m_sliceViewOffset;
@@ -108,6 +114,11 @@ public:
     CPUMatrix<ElemType> CopyColumnSliceToDense(size_t startColumn, size_t numCols) const;
     void AssignColumnSliceToDense(CPUMatrix<ElemType>& slice, size_t startColumn, size_t numCols) const;
 
+    // CSC only: column starts (numCols + 1 entries, from 0), row indices and values of the non-zero elements
+    void CopyCSCToArrays(std::vector<CPUSPARSE_INDEX_TYPE>& columnStarts, std::vector<CPUSPARSE_INDEX_TYPE>& rowIndices, std::vector<ElemType>& values) const;
+    // SparseBlockCol only: indices of the non-zero columns, and their values as a dense column-major (numRows x columnIds.size()) array
+    void CopyBlockColumnsToArray(std::vector<size_t>& columnIds, std::vector<ElemType>& values) const;
+
     CPUMatrix<ElemType> DiagonalToDense() const;
 
     void SetGaussianRandomValue(const ElemType /*mean*/, const ElemType /*sigma*/, unsigned long /*seed*/)
@@ -457,7 +457,10 @@ protected:
     bool IsEmpty() const { return m_numRows == 0 || m_numCols == 0; }
 
     ElemType* Buffer() const { return m_pArray; }
-    void SetBuffer(ElemType* pArray, size_t alloc, bool external = false) { m_pArray = pArray; m_totalBufferSizeAllocated = alloc; m_externalBuffer = external; }
+    void SetBuffer(ElemType* pArray, size_t alloc, bool external = false) { m_pArray = pArray; m_totalBufferSizeAllocated = alloc; m_externalBuffer = external; m_externalBufferOwner.reset(); }
+
+    // keeps the owner of an external buffer (e.g. the mapping of a memory-mapped model file) alive while the buffer is in use; cleared by SetBuffer()
+    void SetExternalBufferOwner(const std::shared_ptr<void>& owner) { m_externalBufferOwner = owner; }
 
     size_t BufferSizeAllocated() const { return m_totalBufferSizeAllocated; }
     
@@ -506,6 +509,7 @@ protected:
     void ZeroInit(const MatrixFormat matrixFormat = matrixFormatDense, const DEVICEID_TYPE computeDevice = -1)
     {
         m_externalBuffer           = false;
+        m_externalBufferOwner.reset();
         m_format                   = matrixFormat;
         m_computeDevice            = computeDevice;
         m_numRows                  = 0;
@@ -534,6 +538,7 @@ protected:
     MatrixFormat m_format;
     mutable DEVICEID_TYPE m_computeDevice; // current GPU device Id or CPUDEVICE
     bool m_externalBuffer; // is the buffer used by this matrix,
+    std::shared_ptr<void> m_externalBufferOwner; // if set, holds the memory of the external buffer
 
     // m_numRows and m_numCols should be removed
     size_t m_numRows;
@@ -631,6 +636,9 @@ public:
 
     bool OwnBuffer() const { return !HasExternalBuffer(); }
 
+    // for an external buffer (matrixFlagDontOwnBuffer): 'owner' is held as long as this storage (shared by all views) uses the buffer
+    void SetExternalBufferOwner(const std::shared_ptr<void>& owner) { m_sob->SetExternalBufferOwner(owner); }
+
     bool IsEmpty() const { return m_numRows == 0 || m_numCols == 0; }
 
     size_t GetSizeAllocated() const { return m_sob->GetSizeAllocated(); }
@@ -6,6 +6,7 @@
 #include "stdafx.h"
 #include "ConvolutionEngine.h"
 #include "CuDnnFactories.h"
+#include "CPUConvolution.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -29,6 +30,24 @@ void ConvolutionEngine<ElemType>::Forward(const Mat& in, const Mat& kernel, Mat&
     ForwardCore(in, kernel, out, workspace);
 }
 
+template <class ElemType>
+bool ConvolutionEngine<ElemType>::ForwardFused(const Mat& in, const Mat& kernel, const Mat* bias, FusedActivation activation, Mat& out, Mat& workspace)
+{
+    const auto& g = *m_geometry;
+    assert(g.InputShape().GetNumElements() == in.GetNumRows());
+    assert(g.OutputShape().GetNumElements() == out.GetNumRows());
+    assert(in.GetNumCols() == out.GetNumCols());
+    assert(g.KernelShape().GetNumElements() * g.KernelCount() == kernel.GetNumElements());
+    assert(bias == nullptr || bias->GetNumElements() == g.OutputShape().GetDims().back());
+#ifdef NDEBUG
+    UNUSED(g);
+#endif
+
+    EnsureCompatible();
+    EnsureConvolutionInitialized();
+    return ForwardFusedCore(in, kernel, bias, activation, out, workspace);
+}
+
 template <class ElemType>
 void ConvolutionEngine<ElemType>::BackwardData(const Mat& srcGrad, const Mat& kernel, Mat& grad, Mat& workspace)
 {
@@ -667,6 +686,16 @@ protected:
         }
     }
     
+    // The GEMM writes the output; the bias and activation are then applied in one pass, map by map.
+    bool ForwardFusedCore(const Mat& in, const Mat& kernel, const Mat* bias, FusedActivation activation, Mat& out, Mat& workspace) override
+    {
+        ForwardCore(in, kernel, out, workspace);
+        size_t mapCount = m_geometry->OutputShape().GetDims().back();
+        ConvolutionEpilogue<ElemType> epilogue(bias ? bias->Data() : nullptr, activation);
+        CPUConvolution::ApplyEpilogue(epilogue, out.Data(), out.GetNumRows() / mapCount, mapCount, out.GetNumCols());
+        return true;
+    }
+
     // The backward data method works by representing this operation as a "reverse" convolution
     // in case kernel's last dimension is equal to input dimension. Gradients matrix (grad) becomes
     // an output of such reverse convolution.
@@ -848,6 +877,345 @@ public:
     }
 };
 
+//------------------------------------------------------------------
+// Direct convolution engine implementation.
+// Computes the forward convolution of 2D convolutions (see Convolution2DShape) directly from the input,
+// without unrolling it. The unrolled input of the GEMM engine is as large as the input times the kernel size,
+// and writing and reading it dominates when the product itself is cheap, i.e. when there are few input or
+// output channels (e.g. the first layer of an image network).
+// Uses GEMM engine for backpropagation and reference engine for pooling operations.
+//------------------------------------------------------------------
+template <class ElemType>
+class DirectConvolutionEngine : public GemmConvolutionEngine<ElemType>
+{
+public:
+    using Base = GemmConvolutionEngine<ElemType>;
+    using typename Base::Mat;
+
+public:
+    DirectConvolutionEngine(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId, ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind)
+        : Base(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind)
+    {
+        m_isConvolution2D = Convolution2DShape::TryCreate(*geometry, m_shape);
+    }
+
+protected:
+    void ForwardCore(const Mat& in, const Mat& kernel, Mat& out, Mat& workspace) override
+    {
+        if (!m_isConvolution2D || in.GetMatrixType() != MatrixType::DENSE)
+        {
+            Base::ForwardCore(in, kernel, out, workspace);
+            return;
+        }
+        CPUConvolution::DirectForward(m_shape, in.Data(), kernel.Data(), out.Data(), in.GetNumCols());
+    }
+
+    bool ForwardFusedCore(const Mat& in, const Mat& kernel, const Mat* bias, FusedActivation activation, Mat& out, Mat& workspace) override
+    {
+        if (!m_isConvolution2D || in.GetMatrixType() != MatrixType::DENSE)
+            return Base::ForwardFusedCore(in, kernel, bias, activation, out, workspace);
+        ConvolutionEpilogue<ElemType> epilogue(bias ? bias->Data() : nullptr, activation);
+        CPUConvolution::DirectForward(m_shape, in.Data(), kernel.Data(), out.Data(), in.GetNumCols(), epilogue);
+        return true;
+    }
+
+public:
+    static bool IsSupported(DEVICEID_TYPE deviceId, ConvolveGeometryPtr geometry)
+    {
+        Convolution2DShape shape;
+        return Base::IsSupported(deviceId, geometry) && Convolution2DShape::TryCreate(*geometry, shape);
+    }
+
+    // kernels up to 7x7 with at most 4 input or 16 output channels
+    static bool IsPreferred(ConvolveGeometryPtr geometry)
+    {
+        Convolution2DShape shape;
+        if (!Convolution2DShape::TryCreate(*geometry, shape))
+            return false;
+        return shape.m_kernelW * shape.m_kernelH <= 49 && (shape.m_inC <= 4 || shape.m_mapCount <= 16);
+    }
+
+private:
+    Convolution2DShape m_shape;
+    bool m_isConvolution2D;
+};
+
+//------------------------------------------------------------------
+// Winograd convolution engine implementation.
+// Computes the forward convolution of 2D 3x3 convolutions with stride 1 with the Winograd algorithm
+// F(2x2, 3x3) or F(4x4, 3x3), which needs 2.25 resp. 4 times fewer multiplications than the direct
+// computation (Fast Algorithms for Convolutional Neural Networks; Lavin, Gray). The products of the
+// transformed kernels and inputs are computed as one GEMM per element of the transformed tiles.
+// Uses GEMM engine for backpropagation and reference engine for pooling operations.
+//------------------------------------------------------------------
+template <class ElemType>
+class WinogradConvolutionEngine : public GemmConvolutionEngine<ElemType>
+{
+public:
+    using Base = GemmConvolutionEngine<ElemType>;
+    using typename Base::Mat;
+
+public:
+    WinogradConvolutionEngine(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId, ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind)
+        : Base(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind), m_transformedKernel(deviceId), m_transformedKernelVersion(-1), m_transformedKernelData(nullptr)
+    {
+        m_isSupported = Convolution2DShape::TryCreate(*geometry, m_shape) && CPUConvolution::IsWinogradSupported(m_shape);
+    }
+
+protected:
+    using Base::m_maxTempMemSizeInSamples;
+    using Base::m_kernelVersion;
+
+    // With T the number of tiles in a sub-batch and a x a the size of the transformed tiles:
+    // 1. Transform the kernels into a*a matrices [K x C], unless they are unchanged since the last call (see SetKernelVersion()).
+    // 2. Transform the input tiles into a*a matrices [C x T].
+    // 3. Multiply: a*a times [K x C] * [C x T] -> [K x T].
+    // 4. Transform the products into the output tiles.
+    void ForwardCore(const Mat& in, const Mat& kernel, Mat& out, Mat& workspace) override
+    {
+        if (!m_isSupported || in.GetMatrixType() != MatrixType::DENSE)
+            Base::ForwardCore(in, kernel, out, workspace);
+        else
+            WinogradForward(in, kernel, out, workspace, ConvolutionEpilogue<ElemType>());
+    }
+
+    // the bias and activation are applied to the output tiles
+    bool ForwardFusedCore(const Mat& in, const Mat& kernel, const Mat* bias, FusedActivation activation, Mat& out, Mat& workspace) override
+    {
+        if (!m_isSupported || in.GetMatrixType() != MatrixType::DENSE)
+            return Base::ForwardFusedCore(in, kernel, bias, activation, out, workspace);
+        WinogradForward(in, kernel, out, workspace, ConvolutionEpilogue<ElemType>(bias ? bias->Data() : nullptr, activation));
+        return true;
+    }
+
+    void WinogradForward(const Mat& in, const Mat& kernel, Mat& out, Mat& workspace, const ConvolutionEpilogue<ElemType>& epilogue)
+    {
+        size_t batchSize = in.GetNumCols();
+        size_t subBatchSize = m_maxTempMemSizeInSamples == 0 ? batchSize : min(batchSize, m_maxTempMemSizeInSamples);
+
+        size_t tileSize = CPUConvolution::WinogradTileSize(m_shape);
+        size_t tileElements = (tileSize + 2) * (tileSize + 2);
+        size_t mapInCount = m_shape.m_inC;
+        size_t mapOutCount = m_shape.m_mapCount;
+        size_t maxTiles = CPUConvolution::WinogradNumTiles(m_shape, tileSize, subBatchSize);
+
+        // The transformed kernels are kept across calls; reserve space for transformed inputs and their products.
+        size_t inputSize = tileElements * maxTiles * mapInCount;
+        workspace.Resize(1, inputSize + tileElements * maxTiles * mapOutCount);
+
+        Mat& transformedKernel = m_transformedKernel;
+        if (m_kernelVersion == -1 || m_kernelVersion != m_transformedKernelVersion || kernel.Data() != m_transformedKernelData ||
+            transformedKernel.GetNumRows() != mapOutCount || transformedKernel.GetNumCols() != tileElements * mapInCount)
+        {
+            transformedKernel.Resize(mapOutCount, tileElements * mapInCount);
+            CPUConvolution::WinogradTransformKernel(m_shape, tileSize, kernel.Data(), transformedKernel.Data());
+            m_transformedKernelVersion = m_kernelVersion;
+            m_transformedKernelData = kernel.Data();
+        }
+
+        for (size_t start = 0; start < batchSize; start += subBatchSize)
+        {
+            size_t curBatchSize = min(subBatchSize, batchSize - start);
+            size_t numTiles = CPUConvolution::WinogradNumTiles(m_shape, tileSize, curBatchSize);
+
+            auto transformedInput = workspace.ColumnSlice(0, tileElements * numTiles * mapInCount);
+            transformedInput.Reshape(mapInCount, tileElements * numTiles);
+            auto products = workspace.ColumnSlice(inputSize, tileElements * numTiles * mapOutCount);
+            products.Reshape(mapOutCount, tileElements * numTiles);
+
+            auto inputSlice = in.ColumnSlice(start, curBatchSize);
+            CPUConvolution::WinogradTransformInput(m_shape, tileSize, inputSlice.Data(), curBatchSize, transformedInput.Data());
+
+            for (size_t i = 0; i < tileElements; i++)
+            {
+                auto productSlice = products.ColumnSlice(i * numTiles, numTiles);
+                Mat::Multiply(transformedKernel.ColumnSlice(i * mapInCount, mapInCount), false,
+                              transformedInput.ColumnSlice(i * numTiles, numTiles), false, productSlice);
+            }
+
+            auto outSlice = out.ColumnSlice(start, curBatchSize);
+            CPUConvolution::WinogradTransformOutput(m_shape, tileSize, products.Data(), curBatchSize, outSlice.Data(), epilogue);
+        }
+    }
+
+public:
+    static bool IsSupported(DEVICEID_TYPE deviceId, ConvolveGeometryPtr geometry)
+    {
+        Convolution2DShape shape;
+        return Base::IsSupported(deviceId, geometry) && Convolution2DShape::TryCreate(*geometry, shape) && CPUConvolution::IsWinogradSupported(shape);
+    }
+
+    // the transforms are amortized over the channels
+    static bool IsPreferred(ConvolveGeometryPtr geometry)
+    {
+        Convolution2DShape shape;
+        if (!Convolution2DShape::TryCreate(*geometry, shape))
+            return false;
+        return shape.m_inC >= 8 && shape.m_mapCount >= 8;
+    }
+
+private:
+    Convolution2DShape m_shape;
+    bool m_isSupported;
+
+    Mat m_transformedKernel;                    // [K x a*a*C], from the kernel identified by the two below
+    int64_t m_transformedKernelVersion;
+    const ElemType* m_transformedKernelData;
+};
+
+//------------------------------------------------------------------
+// Grouped convolution engine implementation.
+// Computes 2D grouped and depthwise convolutions (see GroupedConvolution2DShape) directly, forward and backward.
+// GEMM does not apply to them without sharing, and with sharing only by multiplying with mostly zero kernels,
+// so they would otherwise use the reference engine, which gathers every input value through the index maps.
+// Uses reference engine for pooling operations.
+//------------------------------------------------------------------
+template <class ElemType>
+class GroupedConvolutionEngine : public ReferenceConvolutionEngine<ElemType>
+{
+public:
+    using Base = ReferenceConvolutionEngine<ElemType>;
+    using typename Base::Mat;
+
+public:
+    GroupedConvolutionEngine(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId, ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind)
+        : Base(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind)
+    {
+        m_isSupported = GroupedConvolution2DShape::TryCreate(*geometry, m_shape);
+    }
+
+protected:
+    void ForwardCore(const Mat& in, const Mat& kernel, Mat& out, Mat& workspace) override
+    {
+        if (!m_isSupported || in.GetMatrixType() != MatrixType::DENSE)
+        {
+            Base::ForwardCore(in, kernel, out, workspace);
+            return;
+        }
+        CPUConvolution::GroupedForward(m_shape, in.Data(), kernel.Data(), out.Data(), in.GetNumCols());
+    }
+
+    bool ForwardFusedCore(const Mat& in, const Mat& kernel, const Mat* bias, FusedActivation activation, Mat& out, Mat& workspace) override
+    {
+        if (!m_isSupported || in.GetMatrixType() != MatrixType::DENSE)
+            return Base::ForwardFusedCore(in, kernel, bias, activation, out, workspace);
+        ConvolutionEpilogue<ElemType> epilogue(bias ? bias->Data() : nullptr, activation);
+        CPUConvolution::GroupedForward(m_shape, in.Data(), kernel.Data(), out.Data(), in.GetNumCols(), epilogue);
+        return true;
+    }
+
+    void BackwardDataCore(const Mat& srcGrad, const Mat& kernel, Mat& grad, Mat& workspace) override
+    {
+        if (!m_isSupported || srcGrad.GetMatrixType() != MatrixType::DENSE || grad.GetMatrixType() != MatrixType::DENSE)
+        {
+            Base::BackwardDataCore(srcGrad, kernel, grad, workspace);
+            return;
+        }
+        CPUConvolution::GroupedBackwardData(m_shape, srcGrad.Data(), kernel.Data(), grad.Data(), srcGrad.GetNumCols());
+    }
+
+    void BackwardKernelCore(const Mat& srcGrad, const Mat& in, Mat& kernelGrad, bool allowReuse, Mat& workspace) override
+    {
+        if (!m_isSupported || srcGrad.GetMatrixType() != MatrixType::DENSE || in.GetMatrixType() != MatrixType::DENSE ||
+            kernelGrad.GetMatrixType() != MatrixType::DENSE)
+        {
+            Base::BackwardKernelCore(srcGrad, in, kernelGrad, allowReuse, workspace);
+            return;
+        }
+        CPUConvolution::GroupedBackwardKernel(m_shape, srcGrad.Data(), in.Data(), kernelGrad.Data(), srcGrad.GetNumCols());
+    }
+
+public:
+    static bool IsSupported(DEVICEID_TYPE deviceId, ConvolveGeometryPtr geometry)
+    {
+        GroupedConvolution2DShape shape;
+        return deviceId < 0 && GroupedConvolution2DShape::TryCreate(*geometry, shape);
+    }
+
+private:
+    GroupedConvolution2DShape m_shape;
+    bool m_isSupported;
+};
+
+//------------------------------------------------------------------
+// Pooling engine for 2D max and average pooling with windows of 2x2 and 3x3 on CPU (see CPUConvolution).
+// Other poolings, and sparse matrices, use the reference implementation.
+//------------------------------------------------------------------
+template <class ElemType>
+class PoolingEngine : public ReferenceConvolutionEngine<ElemType>
+{
+public:
+    using Base = ReferenceConvolutionEngine<ElemType>;
+    using typename Base::Mat;
+
+public:
+    PoolingEngine(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId, ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind)
+        : Base(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind), m_argmaxInput(nullptr), m_argmaxNumSamples(0)
+    {
+        m_isSupported = Pooling2DShape::TryCreate(*geometry, m_shape) && CPUConvolution::IsPoolingSupported(m_shape);
+    }
+
+protected:
+    void ForwardPoolingCore(const Mat& in, Mat& out) override
+    {
+        if (!m_isSupported || in.GetMatrixType() != MatrixType::DENSE)
+        {
+            Base::ForwardPoolingCore(in, out);
+            return;
+        }
+
+        size_t numSamples = in.GetNumCols();
+        if (this->m_poolKind == PoolKind::Max && !this->m_poolingBackwardNeeded)
+        {
+            CPUConvolution::MaxPoolingForward(m_shape, in.Data(), out.Data(), nullptr, numSamples);
+            m_argmaxInput = nullptr;
+        }
+        else if (this->m_poolKind == PoolKind::Max)
+        {
+            // Remember the position of each maximum for the backward pass, which then doesn't need to search the windows again.
+            m_argmax.resize(m_shape.OutputSize() * numSamples);
+            CPUConvolution::MaxPoolingForward(m_shape, in.Data(), out.Data(), m_argmax.data(), numSamples);
+            m_argmaxInput = in.Data();
+            m_argmaxNumSamples = numSamples;
+        }
+        else if (this->m_poolKind == PoolKind::Average)
+            CPUConvolution::AveragePoolingForward(m_shape, in.Data(), out.Data(), numSamples);
+        else
+            InvalidArgument("Pooling type %d is not supported.", (int)this->m_poolKind);
+    }
+
+    void BackwardPoolingCore(const Mat& out, const Mat& srcGrad, const Mat& in, Mat& grad) override
+    {
+        if (!m_isSupported || srcGrad.GetMatrixType() != MatrixType::DENSE || grad.GetMatrixType() != MatrixType::DENSE)
+        {
+            Base::BackwardPoolingCore(out, srcGrad, in, grad);
+            return;
+        }
+
+        size_t numSamples = srcGrad.GetNumCols();
+        if (this->m_poolKind == PoolKind::Max && in.GetMatrixType() == MatrixType::DENSE && in.Data() == m_argmaxInput && numSamples == m_argmaxNumSamples)
+            CPUConvolution::MaxPoolingBackward(m_shape, srcGrad.Data(), m_argmax.data(), grad.Data(), numSamples);
+        else if (this->m_poolKind == PoolKind::Average)
+            CPUConvolution::AveragePoolingBackward(m_shape, srcGrad.Data(), grad.Data(), numSamples);
+        else
+            Base::BackwardPoolingCore(out, srcGrad, in, grad); // no maximum positions of this input
+    }
+
+public:
+    static bool IsSupported(DEVICEID_TYPE deviceId, ConvolveGeometryPtr geometry)
+    {
+        Pooling2DShape shape;
+        return deviceId < 0 && Pooling2DShape::TryCreate(*geometry, shape) && CPUConvolution::IsPoolingSupported(shape);
+    }
+
+private:
+    Pooling2DShape m_shape;
+    bool m_isSupported;
+    std::vector<int> m_argmax;
+    const ElemType* m_argmaxInput;
+    size_t m_argmaxNumSamples;
+};
+
 template <class ElemType>
 std::unique_ptr<ConvolutionEngine<ElemType>> ConvolutionEngine<ElemType>::Create(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId,
                                                                                  ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind,
@@ -883,7 +1251,46 @@ std::unique_ptr<ConvolutionEngine<ElemType>> ConvolutionEngine<ElemType>::Create
         return CuDnnConvolutionEngineFactory<ElemType>::Create(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind, forceDeterministicAlgorithms);
     }
 
-    if (isEnabled(ConvolutionEngineKind::Gemm) && GemmConvolutionEngine<ElemType>::IsSupported(deviceId, geometry))
+    if (isEnabled(ConvolutionEngineKind::Pooling) && (poolKind == PoolKind::Max || poolKind == PoolKind::Average) &&
+        PoolingEngine<ElemType>::IsSupported(deviceId, geometry))
+    {
+        if (GetMathLibTraceLevel() > 0)
+            fprintf(stderr, "%lsusing pooling engine for geometry: %s.\n", logPrefix.c_str(), engStr.c_str());
+
+        return std::make_unique<PoolingEngine<ElemType>>(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind);
+    }
+
+    // Grouped and depthwise convolutions don't have a GEMM formulation without zeros. (Pooling geometries look like
+    // depthwise convolutions; they are left to the engines below.)
+    if (isEnabled(ConvolutionEngineKind::Grouped) && poolKind == PoolKind::None && GroupedConvolutionEngine<ElemType>::IsSupported(deviceId, geometry))
+    {
+        if (GetMathLibTraceLevel() > 0)
+            fprintf(stderr, "%lsusing grouped convolution engine for geometry: %s.\n", logPrefix.c_str(), engStr.c_str());
+
+        return std::make_unique<GroupedConvolutionEngine<ElemType>>(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind);
+    }
+
+    // Direct and Winograd engines are chosen over GEMM where they are faster, and wherever they apply when they are enabled but GEMM is not.
+    bool canUseGemm = isEnabled(ConvolutionEngineKind::Gemm) && GemmConvolutionEngine<ElemType>::IsSupported(deviceId, geometry);
+    if (isEnabled(ConvolutionEngineKind::Winograd) && WinogradConvolutionEngine<ElemType>::IsSupported(deviceId, geometry) &&
+        (!canUseGemm || WinogradConvolutionEngine<ElemType>::IsPreferred(geometry)))
+    {
+        if (GetMathLibTraceLevel() > 0)
+            fprintf(stderr, "%lsusing Winograd convolution engine for geometry: %s.\n", logPrefix.c_str(), engStr.c_str());
+
+        return std::make_unique<WinogradConvolutionEngine<ElemType>>(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind);
+    }
+
+    if (isEnabled(ConvolutionEngineKind::Direct) && DirectConvolutionEngine<ElemType>::IsSupported(deviceId, geometry) &&
+        (!canUseGemm || DirectConvolutionEngine<ElemType>::IsPreferred(geometry)))
+    {
+        if (GetMathLibTraceLevel() > 0)
+            fprintf(stderr, "%lsusing direct convolution engine for geometry: %s.\n", logPrefix.c_str(), engStr.c_str());
+
+        return std::make_unique<DirectConvolutionEngine<ElemType>>(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind);
+    }
+
+    if (canUseGemm)
     {
         if (GetMathLibTraceLevel() > 0)
             fprintf(stderr, "%lsusing GEMM convolution engine for geometry: %s.\n", logPrefix.c_str(), engStr.c_str());
@@ -8,6 +8,7 @@
 #include "Matrix.h"
 #include "TensorShape.h" // for ImageLayoutKind
 #include "ConvolveGeometry.h"
+#include "CPUConvolution.h" // for FusedActivation
 #include "StringUtil.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
@@ -22,8 +23,13 @@ enum class ConvolutionEngineKind
     CuDnn     = 1 << 1, // cuDNN, works only for 2D/3D convos with full sharing.
     Legacy    = 1 << 2, // Legacy, for backwards compatibility. REVIEW alexeyk: implement sparse version and remove Legacy altogether.
     Gemm      = 1 << 3, // Uses convolution unrolling+GEMM technique. Works only for convos with full sharing.
+    Direct    = 1 << 4, // Direct CPU convolution without unrolling, for 2D convos with full sharing. Chosen for small kernels with few input or output channels.
+    Winograd  = 1 << 5, // Winograd CPU convolution for 2D 3x3 convos with stride 1 and full sharing.
+    Grouped   = 1 << 6, // Direct CPU convolution for 2D grouped and depthwise convos (kernels that span a group of the input channels).
+    Pooling   = 1 << 7, // CPU max and average pooling for 2D windows of 2x2 and 3x3 with stride 1 or 2.
 
-    All       = Reference | CuDnn | Legacy | Gemm
+    // Direct and Winograd are not part of All; they have to be enabled explicitly.
+    All       = Reference | CuDnn | Legacy | Gemm | Grouped | Pooling
 };
 
 enum class PoolKind
@@ -47,6 +53,10 @@ public:
 
     void Forward(const Mat& in, const Mat& kernel, Mat& out, Mat& workspace);
 
+    // Forward() followed by adding 'bias' (one value per output map, i.e. per index of the last output dimension, or
+    // nullptr) and applying 'activation'. Returns false if the engine can't apply these; then only Forward() was done.
+    bool ForwardFused(const Mat& in, const Mat& kernel, const Mat* bias, FusedActivation activation, Mat& out, Mat& workspace);
+
     void BackwardData(const Mat& srcGrad, const Mat& kernel, Mat& grad, Mat& workspace);
 
     void BackwardKernel(const Mat& srcGrad, const Mat& in, Mat& kernelGrad, bool allowReuse, Mat& workspace);
@@ -66,6 +76,20 @@ public:
 
     DISABLE_COPY_AND_MOVE(ConvolutionEngine);
 
+    // Identifies the current values of the kernel passed to Forward(), e.g. the time stamp of the node holding it; it must change
+    // whenever the kernel does. Engines may then keep transforms of the kernel across calls. -1 (the default) means unknown.
+    void SetKernelVersion(int64_t kernelVersion)
+    {
+        m_kernelVersion = kernelVersion;
+    }
+
+    // Whether BackwardPooling() may follow ForwardPooling(); e.g. false during inference. Engines then don't keep the state
+    // for the backward pass, such as the positions of the maxima.
+    void SetPoolingBackwardNeeded(bool poolingBackwardNeeded)
+    {
+        m_poolingBackwardNeeded = poolingBackwardNeeded;
+    }
+
     // REVIEW alexeyk: This is not enough as there should be invalidation of auto-tuner state in cuDNN engine. Fine for now if it works.
     void SetmMaxTempMemSizeInSamples(const size_t maxTempMemSizeInSamples)
     {
@@ -85,6 +109,13 @@ protected:
 
     virtual void ForwardCore(const Mat& in, const Mat& kernel, Mat& out, Mat& workspace) = 0;
 
+    // The CPU engines apply the bias and activation while the output is still in the cache; by default they are not applied.
+    virtual bool ForwardFusedCore(const Mat& in, const Mat& kernel, const Mat* /*bias*/, FusedActivation /*activation*/, Mat& out, Mat& workspace)
+    {
+        ForwardCore(in, kernel, out, workspace);
+        return false;
+    }
+
     virtual void BackwardDataCore(const Mat& srcGrad, const Mat& kernel, Mat& grad, Mat& workspace) = 0;
 
     virtual void BackwardKernelCore(const Mat& srcGrad, const Mat& in, Mat& kernelGrad, bool allowReuse, Mat& workspace) = 0;
@@ -103,6 +134,8 @@ protected:
     ImageLayoutKind m_imageLayout;
     size_t m_maxTempMemSizeInSamples;
     PoolKind m_poolKind;
+    int64_t m_kernelVersion = -1;
+    bool m_poolingBackwardNeeded = true;
 };
 
 #pragma warning(pop)
@@ -0,0 +1,193 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "HalfGemm.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__AVX2__) || defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+// F16C conversions. GCC needs -mf16c for them (see SUPPORT_AVX2 in the Makefile); MSVC has no switch for them, but
+// every processor with AVX2 has them.
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define HALFGEMM_F16C
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+static uint16_t FloatToFloat16(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent == 0xff) // infinity or NaN (kept quiet)
+        return (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+
+    int halfExponent = (int)exponent - 127 + 15;
+    if (halfExponent >= 31) // overflow
+        return (uint16_t)(sign | 0x7c00);
+
+    if (halfExponent <= 0) // subnormal or zero
+    {
+        if (halfExponent < -10)
+            return (uint16_t)sign;
+        mantissa |= 0x800000;
+        int shift = 14 - halfExponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+            half++;
+        return (uint16_t)(sign | half);
+    }
+
+    uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        half++; // a carry into the exponent is correct, up to infinity
+    return (uint16_t)(sign | half);
+}
+
+static float Float16ToFloat(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else if (exponent != 0)
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    else if (mantissa == 0)
+        bits = sign;
+    else // subnormal: normalize
+    {
+        int shift = 0;
+        while (!(mantissa & 0x400))
+        {
+            mantissa <<= 1;
+            shift++;
+        }
+        bits = sign | ((uint32_t)(127 - 14 - shift) << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint16_t FloatToBFloat16(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffff) > 0x7f800000) // NaN: keep it a (quiet) NaN
+        return (uint16_t)((bits >> 16) | 0x40);
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return (uint16_t)(bits >> 16);
+}
+
+static float BFloat16ToFloat(uint16_t value)
+{
+    uint32_t bits = (uint32_t)value << 16;
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/*static*/ uint16_t HalfGemm::FromFloat(float value, HalfPrecisionFormat format)
+{
+    return format == HalfPrecisionFormat::Float16 ? FloatToFloat16(value) : FloatToBFloat16(value);
+}
+
+/*static*/ float HalfGemm::ToFloat(uint16_t value, HalfPrecisionFormat format)
+{
+    return format == HalfPrecisionFormat::Float16 ? Float16ToFloat(value) : BFloat16ToFloat(value);
+}
+
+template <class ElemType>
+/*static*/ void HalfGemm::FromFloat(const ElemType* values, size_t count, HalfPrecisionFormat format, uint16_t* result)
+{
+    for (size_t i = 0; i < count; i++)
+        result[i] = FromFloat((float)values[i], format);
+}
+
+/*static*/ void HalfGemm::ToFloat(const uint16_t* values, size_t count, HalfPrecisionFormat format, float* result)
+{
+    size_t i = 0;
+    if (format == HalfPrecisionFormat::Float16)
+    {
+#ifdef HALFGEMM_F16C
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(result + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(values + i))));
+#endif
+        for (; i < count; i++)
+            result[i] = Float16ToFloat(values[i]);
+    }
+    else
+    {
+#ifdef __AVX2__
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i widened = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(values + i)));
+            _mm256_storeu_ps(result + i, _mm256_castsi256_ps(_mm256_slli_epi32(widened, 16)));
+        }
+#endif
+        for (; i < count; i++)
+            result[i] = BFloat16ToFloat(values[i]);
+    }
+}
+
+template <class ElemType>
+/*static*/ void HalfGemm::Multiply(const uint16_t* a, HalfPrecisionFormat format, size_t m, size_t k, const ElemType* b, size_t n, ElemType* c)
+{
+    // Blocks of rows of A are distributed over the threads. For each column of A, the block is converted into a
+    // small float buffer that stays in L1, and applied to a tile of columns of B whose partial sums stay in L1 as well.
+    // A is streamed once per tile of B; for GEMV-like products that is once.
+    const size_t rowBlock = 64;
+    const size_t colTile = 8;
+    size_t numBlocks = (m + rowBlock - 1) / rowBlock;
+
+#pragma omp parallel for
+    for (long long block = 0; block < (long long)numBlocks; block++)
+    {
+        size_t i0 = (size_t)block * rowBlock;
+        size_t rows = std::min(rowBlock, m - i0);
+        float w[rowBlock];
+        ElemType sums[colTile][rowBlock];
+        for (size_t j0 = 0; j0 < n; j0 += colTile)
+        {
+            size_t cols = std::min(colTile, n - j0);
+            for (size_t j = 0; j < cols; j++)
+                std::fill(sums[j], sums[j] + rows, (ElemType)0);
+
+            for (size_t p = 0; p < k; p++)
+            {
+                ToFloat(a + p * m + i0, rows, format, w);
+                for (size_t j = 0; j < cols; j++)
+                {
+                    ElemType x = b[(j0 + j) * k + p];
+                    if (x == 0)
+                        continue;
+                    ElemType* sum = sums[j];
+                    for (size_t r = 0; r < rows; r++)
+                        sum[r] += w[r] * x;
+                }
+            }
+
+            for (size_t j = 0; j < cols; j++)
+                std::copy(sums[j], sums[j] + rows, c + (j0 + j) * m + i0);
+        }
+    }
+}
+
+template void HalfGemm::FromFloat<float>(const float*, size_t, HalfPrecisionFormat, uint16_t*);
+template void HalfGemm::FromFloat<double>(const double*, size_t, HalfPrecisionFormat, uint16_t*);
+template void HalfGemm::Multiply<float>(const uint16_t*, HalfPrecisionFormat, size_t, size_t, const float*, size_t, float*);
+template void HalfGemm::Multiply<double>(const uint16_t*, HalfPrecisionFormat, size_t, size_t, const double*, size_t, double*);
+
+}}}
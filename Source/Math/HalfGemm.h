@@ -0,0 +1,42 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// HalfGemm.h -- matrix product with weights stored in 16-bit floating point, for bandwidth-bound CPU inference
+//
+#pragma once
+
+#include "CommonMatrix.h"
+#include <cstdint>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+enum class HalfPrecisionFormat : int
+{
+    Float16 = 0,  // IEEE 754 binary16
+    BFloat16 = 1, // upper 16 bits of an IEEE 754 binary32
+};
+
+// HalfGemm computes C = A * B for a 16-bit A. The values of A are converted to float in blocks of rows inside the
+// kernel, so A is only read from memory in its 16-bit form, which halves the traffic of GEMV-like products with
+// few columns in B (e.g. small-batch recurrent networks).
+//
+// Conversion uses F16C for Float16 and AVX2 for BFloat16 when the Math library is compiled with them enabled;
+// otherwise portable code is used.
+class MATH_API HalfGemm
+{
+public:
+    // conversion with round-to-nearest-even; Float16 overflows to infinity
+    static uint16_t FromFloat(float value, HalfPrecisionFormat format);
+    static float ToFloat(uint16_t value, HalfPrecisionFormat format);
+
+    template <class ElemType>
+    static void FromFloat(const ElemType* values, size_t count, HalfPrecisionFormat format, uint16_t* result);
+    static void ToFloat(const uint16_t* values, size_t count, HalfPrecisionFormat format, float* result);
+
+    // C = A * B, all column-major and dense: A is m x k (16-bit), B is k x n, C is m x n (overwritten)
+    template <class ElemType>
+    static void Multiply(const uint16_t* a, HalfPrecisionFormat format, size_t m, size_t k, const ElemType* b, size_t n, ElemType* c);
+};
+
+}}}
@@ -0,0 +1,199 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "Int8Gemm.h"
+#include <algorithm>
+#include <cmath>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+const size_t Int8Gemm::DepthAlignment;
+const int Int8Gemm::ActivationMax;
+
+bool Int8Gemm::HasAVX2()
+{
+#ifdef __AVX2__
+    return true;
+#else
+    return false;
+#endif
+}
+
+template <class ElemType>
+/*static*/ void Int8Gemm::QuantizeWeights(const ElemType* weights, size_t m, size_t k, size_t rowStride, size_t depthStride,
+                                          std::vector<int8_t>& quantized, std::vector<float>& scales, std::vector<int32_t>& rowSums)
+{
+    size_t kPadded = PaddedDepth(k);
+    quantized.assign(m * kPadded, 0);
+    scales.resize(m);
+    for (size_t i = 0; i < m; i++)
+    {
+        const ElemType* row = weights + i * rowStride;
+        double absMax = 0;
+        for (size_t p = 0; p < k; p++)
+            absMax = std::max(absMax, (double)fabs(row[p * depthStride]));
+
+        // an all-zero row gets scale 1, all of its quantized values are 0 anyway
+        double scale = absMax > 0 ? absMax / 127 : 1;
+        int8_t* q = quantized.data() + i * kPadded;
+        for (size_t p = 0; p < k; p++)
+        {
+            double value = std::round(row[p * depthStride] / scale);
+            q[p] = (int8_t)std::max(-127.0, std::min(127.0, value));
+        }
+        scales[i] = (float)scale;
+    }
+    ComputeRowSums(quantized.data(), m, k, rowSums);
+}
+
+/*static*/ void Int8Gemm::ComputeRowSums(const int8_t* quantized, size_t m, size_t k, std::vector<int32_t>& rowSums)
+{
+    size_t kPadded = PaddedDepth(k);
+    rowSums.resize(m);
+    for (size_t i = 0; i < m; i++)
+    {
+        int32_t sum = 0;
+        for (size_t p = 0; p < k; p++)
+            sum += quantized[i * kPadded + p];
+        rowSums[i] = sum;
+    }
+}
+
+/*static*/ void Int8Gemm::ComputeActivationQuantization(float minValue, float maxValue, float& scale, int32_t& zeroPoint)
+{
+    minValue = std::min(minValue, 0.0f);
+    maxValue = std::max(maxValue, 0.0f);
+    if (maxValue == minValue)
+    {
+        scale = 1;
+        zeroPoint = 0;
+        return;
+    }
+    scale = (maxValue - minValue) / ActivationMax;
+    zeroPoint = (int32_t)std::round(-minValue / scale);
+}
+
+template <class ElemType>
+/*static*/ void Int8Gemm::QuantizeActivations(const ElemType* activations, size_t k, size_t n, float scale, int32_t zeroPoint, uint8_t* quantized)
+{
+    size_t kPadded = PaddedDepth(k);
+    float invScale = 1 / scale;
+#pragma omp parallel for
+    for (long long j = 0; j < (long long)n; j++)
+    {
+        const ElemType* a = activations + j * k;
+        uint8_t* u = quantized + j * kPadded;
+        for (size_t p = 0; p < k; p++)
+        {
+            int value = (int)std::lrint(a[p] * invScale) + zeroPoint;
+            u[p] = (uint8_t)std::max(0, std::min(ActivationMax, value));
+        }
+        // padding: the weights are 0 there, any value will do
+        std::fill(u + k, u + kPadded, (uint8_t)zeroPoint);
+    }
+}
+
+#ifdef __AVX2__
+
+// horizontal sum of the eight 32-bit lanes
+static inline int32_t HorizontalSum(__m256i v)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+// dot products of four weight rows with one activation column; u8*s8 pairs are summed to int16 by vpmaddubsw
+// (no saturation since u <= 127), and pairs of those are widened to int32 by vpmaddwd
+static inline void Dot4(const int8_t* w0, const int8_t* w1, const int8_t* w2, const int8_t* w3, const uint8_t* a, size_t kPadded, int32_t* result)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256();
+    __m256i acc3 = _mm256_setzero_si256();
+    for (size_t p = 0; p < kPadded; p += Int8Gemm::DepthAlignment)
+    {
+        __m256i av = _mm256_loadu_si256((const __m256i*)(a + p));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_maddubs_epi16(av, _mm256_loadu_si256((const __m256i*)(w0 + p))), ones));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_maddubs_epi16(av, _mm256_loadu_si256((const __m256i*)(w1 + p))), ones));
+        acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_maddubs_epi16(av, _mm256_loadu_si256((const __m256i*)(w2 + p))), ones));
+        acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_maddubs_epi16(av, _mm256_loadu_si256((const __m256i*)(w3 + p))), ones));
+    }
+    result[0] = HorizontalSum(acc0);
+    result[1] = HorizontalSum(acc1);
+    result[2] = HorizontalSum(acc2);
+    result[3] = HorizontalSum(acc3);
+}
+
+#else
+
+static inline void Dot4(const int8_t* w0, const int8_t* w1, const int8_t* w2, const int8_t* w3, const uint8_t* a, size_t kPadded, int32_t* result)
+{
+    int32_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    for (size_t p = 0; p < kPadded; p++)
+    {
+        int32_t av = a[p];
+        sum0 += av * w0[p];
+        sum1 += av * w1[p];
+        sum2 += av * w2[p];
+        sum3 += av * w3[p];
+    }
+    result[0] = sum0;
+    result[1] = sum1;
+    result[2] = sum2;
+    result[3] = sum3;
+}
+
+#endif
+
+template <class ElemType>
+/*static*/ void Int8Gemm::Multiply(const int8_t* weights, const float* weightScales, const int32_t* rowSums, size_t m, size_t k,
+                                   const uint8_t* activations, size_t n, float activationScale, int32_t zeroPoint,
+                                   ElemType* c, size_t rowStride, size_t colStride)
+{
+    size_t kPadded = PaddedDepth(k);
+    size_t numBlocks = (m + 3) / 4;
+
+    // Blocks of four weight rows are distributed over the threads. Each block is streamed against all activation
+    // columns, which stay in the cache; the last block repeats its last row where m is not a multiple of 4.
+#pragma omp parallel for
+    for (long long block = 0; block < (long long)numBlocks; block++)
+    {
+        size_t rows[4];
+        const int8_t* w[4];
+        for (size_t r = 0; r < 4; r++)
+        {
+            rows[r] = std::min((size_t)block * 4 + r, m - 1);
+            w[r] = weights + rows[r] * kPadded;
+        }
+        size_t numRows = std::min((size_t)4, m - (size_t)block * 4);
+
+        int32_t dots[4];
+        for (size_t j = 0; j < n; j++)
+        {
+            Dot4(w[0], w[1], w[2], w[3], activations + j * kPadded, kPadded, dots);
+            for (size_t r = 0; r < numRows; r++)
+            {
+                size_t i = rows[r];
+                int32_t acc = dots[r] - zeroPoint * rowSums[i];
+                c[i * rowStride + j * colStride] = (ElemType)(weightScales[i] * activationScale * acc);
+            }
+        }
+    }
+}
+
+template void Int8Gemm::QuantizeWeights<float>(const float*, size_t, size_t, size_t, size_t, std::vector<int8_t>&, std::vector<float>&, std::vector<int32_t>&);
+template void Int8Gemm::QuantizeWeights<double>(const double*, size_t, size_t, size_t, size_t, std::vector<int8_t>&, std::vector<float>&, std::vector<int32_t>&);
+template void Int8Gemm::QuantizeActivations<float>(const float*, size_t, size_t, float, int32_t, uint8_t*);
+template void Int8Gemm::QuantizeActivations<double>(const double*, size_t, size_t, float, int32_t, uint8_t*);
+template void Int8Gemm::Multiply<float>(const int8_t*, const float*, const int32_t*, size_t, size_t, const uint8_t*, size_t, float, int32_t, float*, size_t, size_t);
+template void Int8Gemm::Multiply<double>(const int8_t*, const float*, const int32_t*, size_t, size_t, const uint8_t*, size_t, float, int32_t, double*, size_t, size_t);
+
+}}}
@@ -0,0 +1,65 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// Int8Gemm.h -- 8-bit integer matrix product for the evaluation of post-training quantized models on the CPU
+//
+#pragma once
+
+#include "CommonMatrix.h"
+#include <cstdint>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Int8Gemm computes C = W * A for int8 weights W and uint8 activations A with 32-bit accumulation.
+//
+// Weights are quantized symmetrically per output row (channel): w[i][p] ~= scale[i] * q[i][p], q in [-127, 127].
+// Activations are quantized asymmetrically with one scale and zero point per tensor: a ~= scale * (u - zeroPoint).
+// Activations use 7 bits only (u in [0, 127]), such that the pairwise u8*s8 products summed by the AVX2 instruction
+// vpmaddubsw cannot saturate the 16-bit intermediate results.
+//
+// Both operands are stored "row-major": one row of W, resp. one column of A (one sample), occupies PaddedDepth(k)
+// consecutive bytes. The padding is zero for W, so padded activation values don't contribute to the product.
+//
+// The AVX2 kernels are compiled in when the Math library is built with AVX2 enabled (SUPPORT_AVX2=1 in the
+// Makefile); otherwise a portable implementation is used.
+class MATH_API Int8Gemm
+{
+public:
+    static const size_t DepthAlignment = 32;
+    static const int ActivationMax = 127;
+
+    static size_t PaddedDepth(size_t k) { return (k + DepthAlignment - 1) / DepthAlignment * DepthAlignment; }
+
+    // whether the AVX2 kernels were compiled in
+    static bool HasAVX2();
+
+    // Quantize an m x k weight matrix with per-row scales. Element (i, p) is read from weights[i * rowStride + p * depthStride],
+    // i.e. (1, m) for a column-major TimesNode weight matrix and (k, 1) for a convolution kernel.
+    // quantized receives m x PaddedDepth(k) values, scales and rowSums (sum over q[i][*], for the zero point correction) m values each.
+    template <class ElemType>
+    static void QuantizeWeights(const ElemType* weights, size_t m, size_t k, size_t rowStride, size_t depthStride,
+                                std::vector<int8_t>& quantized, std::vector<float>& scales, std::vector<int32_t>& rowSums);
+
+    // recompute the row sums of quantized weights, e.g. after loading them
+    static void ComputeRowSums(const int8_t* quantized, size_t m, size_t k, std::vector<int32_t>& rowSums);
+
+    // Determine scale and zero point for activations observed in [minValue, maxValue]. The range is extended to include 0,
+    // such that zero (e.g. convolution padding) is represented exactly.
+    static void ComputeActivationQuantization(float minValue, float maxValue, float& scale, int32_t& zeroPoint);
+
+    // Quantize n columns of k activations each (column j starts at activations[j * k]) into n x PaddedDepth(k) bytes.
+    // Values outside the calibrated range are clipped.
+    template <class ElemType>
+    static void QuantizeActivations(const ElemType* activations, size_t k, size_t n, float scale, int32_t zeroPoint, uint8_t* quantized);
+
+    // C(i, j) = weightScales[i] * activationScale * sum_p q[i][p] * (u[j][p] - zeroPoint), for i < m, j < n,
+    // written to c[i * rowStride + j * colStride]. weights and activations are as produced by the functions above.
+    template <class ElemType>
+    static void Multiply(const int8_t* weights, const float* weightScales, const int32_t* rowSums, size_t m, size_t k,
+                         const uint8_t* activations, size_t n, float activationScale, int32_t zeroPoint,
+                         ElemType* c, size_t rowStride, size_t colStride);
+};
+
+}}}
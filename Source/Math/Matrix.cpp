@@ -654,15 +654,77 @@ void Matrix<ElemType>::Read(File& stream)
             M.SetDataLocation(GPU, SPARSE);
         }
     }
+    else if (type == 'a') // dense, with the data aligned (fileOptionsAlignedData)
+    {
+        size_t elsize, numRows, numCols, padding;
+        stream >> elsize >> numRows >> numCols >> padding;
+        if (elsize != sizeof(ElemType))
+            RuntimeError("Read: Element size %d of the matrix in the file does not match the template argument (%d).", (int)elsize, (int)sizeof(ElemType));
+        for (size_t i = 0; i < padding; i++)
+        {
+            char zero;
+            stream >> zero;
+        }
+
+        // From a memory-mapped file, a CPU matrix can use the data in place. Otherwise, it is read or copied from the mapping.
+        size_t numElements = numRows * numCols;
+        ElemType* data = (ElemType*)stream.ReadMapped(numElements * sizeof(ElemType));
+        bool inPlace = data && M.GetDeviceId() < 0 && (uintptr_t)data % sizeof(ElemType) == 0;
+        vector<ElemType> buffer;
+        if (!data)
+        {
+            buffer.resize(numElements);
+            if (numElements > 0)
+                freadOrDie(buffer.data(), sizeof(ElemType), numElements, stream);
+            data = buffer.data();
+        }
+
+        if (M.GetDeviceId() < 0)
+        {
+            if (!M.m_CPUMatrix)
+                M.m_CPUMatrix = make_shared<CPUMatrix<ElemType>>();
+            M.SetDataLocation(CPU, DENSE);
+        }
+        else
+        {
+            if (!M.m_GPUMatrix)
+                M.m_GPUMatrix = make_shared<GPUMatrix<ElemType>>(M.GetDeviceId());
+            M.SetDataLocation(GPU, DENSE);
+        }
+        M.SetValue(numRows, numCols, M.GetDeviceId(), data, inPlace ? matrixFlagDontOwnBuffer : matrixFlagNormal);
+        if (inPlace) // the matrix keeps the mapping alive, also when it outlives the File or the network it was read for
+            M.m_CPUMatrix->SetExternalBufferOwner(stream.GetMemoryMapping());
+    }
     else
-        LogicError("Read: Input file corrupt (invalid matrix type field 0x%02d, should be 'f' or 'd').", type);
+        LogicError("Read: Input file corrupt (invalid matrix type field 0x%02d, should be 'd', 's', or 'a').", type);
 }
 
 template <class ElemType>
 void Matrix<ElemType>::Write(File& stream) const
 {
     const Matrix<ElemType>& M = *this;
-    if (M.GetMatrixType() == MatrixType::DENSE)
+    if (M.GetMatrixType() == MatrixType::DENSE && stream.AlignsData())
+    {
+        // 'a': the data is written in one block, aligned relative to the start of the file, such that Read() can use it in place from a memory-mapped file
+        stream << 'a';
+        stream << sizeof(ElemType) << M.GetNumRows() << M.GetNumCols();
+        size_t padding = stream.PaddingToAlignment(sizeof(padding));
+        stream << padding;
+        for (size_t i = 0; i < padding; i++)
+            stream << (char)0;
+
+        size_t numElements = M.GetNumElements();
+        if (numElements == 0)
+            return;
+        if (M.GetDeviceId() < 0)
+            fwriteOrDie(M.m_CPUMatrix->Data(), sizeof(ElemType), numElements, stream);
+        else
+        {
+            unique_ptr<ElemType[]> data(M.CopyToArray());
+            fwriteOrDie(data.get(), sizeof(ElemType), numElements, stream);
+        }
+    }
+    else if (M.GetMatrixType() == MatrixType::DENSE)
     {
         stream << 'd';
         if (M.GetDeviceId() < 0)
@@ -743,6 +805,36 @@ void Matrix<ElemType>::CopySection(size_t numRows, size_t numCols, ElemType* dst
                             NOT_IMPLEMENTED);
 }
 
+template <class ElemType>
+void Matrix<ElemType>::CopySparseCSCToArrays(std::vector<CPUSPARSE_INDEX_TYPE>& columnStarts, std::vector<CPUSPARSE_INDEX_TYPE>& rowIndices, std::vector<ElemType>& values) const
+{
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            nullptr,
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED,
+                            m_CPUSparseMatrix->CopyCSCToArrays(columnStarts, rowIndices, values),
+                            {
+                                CPUSparseMatrix<ElemType> cpuCopy(m_GPUSparseMatrix->GetFormat());
+                                m_GPUSparseMatrix->CopyToCPUSparseMatrix(cpuCopy);
+                                cpuCopy.CopyCSCToArrays(columnStarts, rowIndices, values);
+                            });
+}
+
+template <class ElemType>
+void Matrix<ElemType>::CopySparseBlockColumnsToArray(std::vector<size_t>& columnIds, std::vector<ElemType>& values) const
+{
+    DISPATCH_MATRIX_ON_FLAG(this,
+                            nullptr,
+                            NOT_IMPLEMENTED,
+                            NOT_IMPLEMENTED,
+                            m_CPUSparseMatrix->CopyBlockColumnsToArray(columnIds, values),
+                            {
+                                CPUSparseMatrix<ElemType> cpuCopy(m_GPUSparseMatrix->GetFormat());
+                                m_GPUSparseMatrix->CopyToCPUSparseMatrix(cpuCopy);
+                                cpuCopy.CopyBlockColumnsToArray(columnIds, values);
+                            });
+}
+
 // BUGBUG: Some code checks before calling here whether one of the dimensions is 0.
 //         This function must handle that case properly, that is, preserving the non-zero dimension.
 template <class ElemType>
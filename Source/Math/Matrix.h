@@ -180,6 +180,9 @@ public:
     // colStride specifies leading dimension of dst.
     // REVIEW alexeyk: GPU version copies from device to host only, implement all versions (device <-> host).
     void CopySection(size_t numRows, size_t numCols, ElemType* dst, size_t colStride) const;
+    // sparse-structure accessors that copy to the host; see CPUSparseMatrix for the semantics
+    void CopySparseCSCToArrays(std::vector<CPUSPARSE_INDEX_TYPE>& columnStarts, std::vector<CPUSPARSE_INDEX_TYPE>& rowIndices, std::vector<ElemType>& values) const; // SparseCSC
+    void CopySparseBlockColumnsToArray(std::vector<size_t>& columnIds, std::vector<ElemType>& values) const;                                                          // SparseBlockCol
 
     Matrix<ElemType> ColumnSlice(size_t startColumn, size_t numCols) const; // note: 'const' is misleading here, as the returned matrix is a mutable reference
 
@@ -91,7 +91,7 @@ public:
 
     virtual size_t GetCurrentSamplePosition() override;
 
-    void SetCurrentSamplePosition(size_t currentSamplePosition);
+    virtual void SetCurrentSamplePosition(size_t currentSamplePosition) override;
 
     void SetConfiguration(const ReaderConfiguration& config, const std::map<std::wstring, int>& inputDescriptions);
 
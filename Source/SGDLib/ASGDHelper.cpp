@@ -2,7 +2,7 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
 //
-// ASGDHelper.cpp : Implements ASGDHelper interface. The implementation is based on Multiverso.
+// ASGDHelper.cpp : Implements ASGDHelper interface, based on Multiverso or, without it, on MPI-3 one-sided communication.
 //
 
 #define _CRT_SECURE_NO_WARNINGS // "secure" CRT not available on all platforms  --add this at the top of all CPP files that give "function or variable may be unsafe" warnings
@@ -17,6 +17,8 @@
 #include <unordered_map>
 #include <numeric>
 #include <algorithm>
+#include <chrono>
+#include <climits>
 
 #ifdef ASGD_PARALLEL_SUPPORT
 
@@ -594,34 +596,426 @@ private:
 
 #endif 
 
-// A None implementation of ASGDHelper interface which does nothing
-// This is used when CNTK_ENABLE_ASGD = false
+// MPIParameterServerHelper is the implementation of ASGDHelper interface without Multiverso.
+// It is used when CNTK is not built with CNTK_ENABLE_ASGD=true.
+//
+// The flattened model is sharded across the workers: every rank exposes a contiguous slice of it in an
+// MPI-3 RMA window, and thereby is the parameter server for that slice. Workers push their (scaled) model
+// deltas with MPI_Accumulate and pull the latest model with MPI_Get_accumulate(MPI_NO_OP), both inside a
+// passive-target epoch, so the servers never have to take part actively and no server thread is needed.
+//
+// With useAsyncBuffer, push and pull are issued as request-based operations that complete while the next
+// block of minibatches is being trained; the model pulled at one sync is then used from the next sync on,
+// together with the worker's own progress since. maxStaleness > 0 bounds by how many syncs a worker may run
+// ahead of the slowest one.
+//
+// With SimModelAverage, the workers instead average their models synchronously: every sync is a single
+// allreduce of the model deltas, which also counts the workers that still have data. Workers that run out
+// of data keep joining the rounds from WaitAll() with a zero delta until no worker is left, so the workers
+// may reach a different number of syncs per epoch.
 template<class ElemType = float>
-class NoneASGDHelper : public ASGDHelper<ElemType>
+class MPIParameterServerHelper : public ASGDHelper<ElemType>
 {
 public:
-    NoneASGDHelper(const std::list<ComputationNodeBasePtr> & learnableNodes,
-        int nodeNumRanks,
+    typedef shared_ptr<ComputationNode<ElemType>> ComputationNodePtr;
+
+    MPIParameterServerHelper(const std::list<ComputationNodeBasePtr> & learnableNodes,
+        size_t nodeNumRanks,
         bool useAsyncBuffer = true,
-        bool isSimModelAveragingSGD = false,
+        bool isSimulatedModelAveragingSGD = false,
         AdjustLearningRateAtBeginning adjusttype = AdjustLearningRateAtBeginning::None,
-        double adjustcoef = 0.2,
-        size_t adjustnbmb = 600,
+        double adjustCoef = 0.2,
+        size_t adjustPerMinibatches = 600,
         int traceLevel = 0,
         int syncPerfStats = 0,
-        const MPIWrapperPtr& pMPI = nullptr) { }
+        size_t maxStaleness = 0) :
+        m_mpi(MPIWrapper::GetInstance()), m_totalClientNumber(nodeNumRanks),
+        m_useAsyncBuffer(useAsyncBuffer && !isSimulatedModelAveragingSGD), m_ModelAveragingSGDSimulating(isSimulatedModelAveragingSGD),
+        m_adjustLearningRateAtBeginningType(adjusttype), m_adjustCoefficient(adjustCoef), m_adjustMBNumber(adjustPerMinibatches),
+        m_traceLevel(traceLevel), m_syncPerfStats(syncPerfStats), m_maxStaleness(maxStaleness),
+        m_parameterSyncCounter(0), m_clock(0), m_initialized(false), m_pulledModelPending(false),
+        m_secondsBlockedOnStaleness(0), m_secondsInCommunication(0)
+    {
+        if (!m_mpi)
+            LogicError("MPIParameterServerHelper: DataParallelASGD requires MPI.");
+
+        // a communicator of our own, so that our traffic cannot be confused with other collectives
+        MPI_Comm_dup(m_mpi->Communicator(), &m_comm) || MpiFail("MPIParameterServerHelper: MPI_Comm_dup");
+
+        for (const auto& node : learnableNodes)
+        {
+            m_tableOffsets.push_back(m_totalModelSize);
+            m_tableLength.push_back(dynamic_pointer_cast<ComputationNode<ElemType>>(node)->Value().GetNumElements());
+            m_totalModelSize += m_tableLength.back();
+        }
 
-    ~NoneASGDHelper() { }
+        size_t numRanks = m_mpi->NumNodesInUse();
+        size_t myRank = m_mpi->CurrentNodeRank();
+        m_shardBegin.resize(numRanks + 1);
+        for (size_t r = 0; r <= numRanks; r++)
+            m_shardBegin[r] = r * m_totalModelSize / numRanks;
+        if (m_shardBegin[1] > INT_MAX)
+            RuntimeError("MPIParameterServerHelper: the model is too large (%d elements) for %d workers.", (int)m_totalModelSize, (int)numRanks);
+
+        MPI_Win_allocate((MPI_Aint)((m_shardBegin[myRank + 1] - m_shardBegin[myRank]) * sizeof(ElemType)), sizeof(ElemType),
+                         MPI_INFO_NULL, m_comm, &m_shard, &m_modelWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_allocate");
+        // the clocks of all workers live on rank 0
+        MPI_Win_allocate((MPI_Aint)(myRank == 0 ? numRanks * sizeof(int) : 0), sizeof(int),
+                         MPI_INFO_NULL, m_comm, &m_clocks, &m_clockWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_allocate");
+        if (myRank == 0)
+            std::fill(m_clocks, m_clocks + numRanks, 0);
+
+        m_baseModel.resize(m_totalModelSize);
+        m_delta.resize(m_totalModelSize + 1); // the last element counts the active workers in simulated model averaging
+        m_pulledModel.resize(m_totalModelSize);
+        m_allClocks.resize(numRanks);
+    }
+
+    ~MPIParameterServerHelper()
+    {
+        if (m_initialized)
+        {
+            if (!m_requests.empty())
+                MPI_Waitall((int)m_requests.size(), m_requests.data(), MPI_STATUSES_IGNORE);
+            MPI_Win_unlock_all(m_modelWindow);
+            MPI_Win_unlock_all(m_clockWindow);
+        }
+        MPI_Win_free(&m_modelWindow);
+        MPI_Win_free(&m_clockWindow);
+        MPI_Comm_free(&m_comm);
+    }
+
+    void InitModel(const std::list<ComputationNodeBasePtr> & learnableNodes) override
+    {
+        // All workers start from the same model, so each one can initialize its own shard locally.
+        m_learnableNodes = learnableNodes;
+        CopyModelToHost(m_baseModel);
+        size_t myRank = m_mpi->CurrentNodeRank();
+        std::copy(m_baseModel.begin() + m_shardBegin[myRank], m_baseModel.begin() + m_shardBegin[myRank + 1], m_shard);
+        MPI_Barrier(m_comm) || MpiFail("MPIParameterServerHelper: MPI_Barrier");
+
+        MPI_Win_lock_all(0, m_modelWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_lock_all");
+        MPI_Win_lock_all(0, m_clockWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_lock_all");
+        m_initialized = true;
+        m_reportTimer.Start();
+        if (m_traceLevel > 0)
+            fprintf(stderr, "MPIParameterServerHelper: %d parameters sharded across %d workers%s, maxStaleness = %d.\n",
+                    (int)m_totalModelSize, (int)m_mpi->NumNodesInUse(), m_useAsyncBuffer ? " (pipelined)" : "", (int)m_maxStaleness);
+    }
+
+    bool PushAndPullModel(const std::list<ComputationNodeBasePtr> & learnableNodes, size_t sampleSinceLastSynced) override
+    {
+        m_parameterSyncCounter++;
+        m_sampleSinceLastReport += sampleSinceLastSynced;
+
+        Timer commTimer;
+        commTimer.Start();
+        WaitAsyncBuffer();
+
+        // delta = (current model - model we started from) * factor
+        CopyModelToHost(m_delta);
+        ElemType factor = m_ModelAveragingSGDSimulating ? (ElemType)1 : (ElemType)DecayCoefficient();
+        for (size_t i = 0; i < m_totalModelSize; i++)
+            m_delta[i] = (m_delta[i] - m_baseModel[i]) * factor;
+
+        if (m_ModelAveragingSGDSimulating)
+        {
+            AverageModels(/*active=*/true);
+        }
+        else if (m_useAsyncBuffer)
+        {
+            // continue from the model pulled at the previous sync, plus our own progress since, which it does not contain yet
+            if (m_pulledModelPending)
+            {
+                for (size_t i = 0; i < m_totalModelSize; i++)
+                    m_baseModel[i] = m_pulledModel[i] + m_delta[i];
+            }
+            else
+                std::transform(m_baseModel.begin(), m_baseModel.end(), m_delta.begin(), m_baseModel.begin(), std::plus<ElemType>());
+            CopyHostToModel(m_baseModel);
+
+            // push and pull in the background; completed at the next sync
+            Push(/*async=*/true);
+            Pull(/*async=*/true);
+            m_pulledModelPending = true;
+        }
+        else
+        {
+            Push(/*async=*/false);
+            Pull(/*async=*/false);
+            m_baseModel.swap(m_pulledModel);
+            CopyHostToModel(m_baseModel);
+        }
+        commTimer.Stop();
+        m_secondsInCommunication += commTimer.ElapsedSeconds();
 
-    void InitModel(const std::list<ComputationNodeBasePtr> & learnableNode) override { }
+        // simulated model averaging runs in lockstep anyway; its workers must not wait for each other's clocks,
+        // as a worker that ran out of data only joins the averaging rounds from WaitAll()
+        if (!m_ModelAveragingSGDSimulating)
+        {
+            m_numSyncsInEpoch++;
+            m_clock++;
+            PublishClock();
+            WaitForSlowestWorker();
+        }
 
-    bool PushAndPullModel(const std::list<ComputationNodeBasePtr> & learnableNodes, size_t sampleSinceLastSynced) override { 
+        if (m_syncPerfStats > 0 && m_parameterSyncCounter % m_syncPerfStats == 0)
+            ReportPerfStats();
         return true;
     }
 
-    void WaitAll() override { }
+    // Note: all workers must reach this; a worker that has finished its share of an epoch
+    // must not hold up the others, so it leaves the staleness accounting before the barrier.
+    // With simulated model averaging, it instead keeps joining the averaging rounds of the
+    // workers that still have data until there are none left.
+    void WaitAll() override
+    {
+        if (!m_initialized)
+        {
+            MPI_Barrier(m_comm) || MpiFail("MPIParameterServerHelper: MPI_Barrier");
+            return;
+        }
+
+        if (m_ModelAveragingSGDSimulating)
+        {
+            size_t numExtraRounds = 0;
+            for (;;)
+            {
+                std::fill(m_delta.begin(), m_delta.end(), (ElemType)0);
+                if (AverageModels(/*active=*/false) == 0)
+                    break;
+                numExtraRounds++;
+            }
+            if (m_traceLevel > 0 && numExtraRounds > 0)
+                fprintf(stderr, "MPIParameterServerHelper: joined %d model averaging rounds of other workers after running out of data.\n", (int)numExtraRounds);
+            return;
+        }
+
+        // the pipelined pushes are only complete locally; complete them at the servers before telling the others
+        WaitAsyncBuffer();
+        MPI_Win_flush_all(m_modelWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_flush_all");
+        m_clock = s_finishedClock;
+        PublishClock();
+        MPI_Barrier(m_comm) || MpiFail("MPIParameterServerHelper: MPI_Barrier");
+
+        // everybody's deltas are in: continue from the latest model
+        Pull(/*async=*/false);
+        m_baseModel.swap(m_pulledModel);
+        CopyHostToModel(m_baseModel);
+        m_pulledModelPending = false;
+        if (m_traceLevel > 0)
+        {
+            // the same on all workers; the checksum lets the logs be compared
+            double checksum = 0;
+            for (auto value : m_baseModel)
+                checksum += (double)value;
+            fprintf(stderr, "MPIParameterServerHelper: all workers continue from the model with checksum %.9g; waited for slower workers at %d of %d syncs.\n",
+                    checksum, (int)m_numSyncsBlockedOnStaleness, (int)m_numSyncsInEpoch);
+        }
+        m_numSyncsBlockedOnStaleness = 0;
+        m_numSyncsInEpoch = 0;
+
+        m_clock = 0;
+        PublishClock();
+    }
+
+    void WaitAsyncBuffer() override
+    {
+        if (!m_requests.empty())
+        {
+            MPI_Waitall((int)m_requests.size(), m_requests.data(), MPI_STATUSES_IGNORE) || MpiFail("MPIParameterServerHelper: MPI_Waitall");
+            m_requests.clear();
+        }
+    }
+
+private:
+    void CopyModelToHost(std::vector<ElemType>& buffer)
+    {
+        size_t i = 0;
+        for (auto nodeIter = m_learnableNodes.begin(); nodeIter != m_learnableNodes.end(); nodeIter++, i++)
+        {
+            ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(*nodeIter);
+            ElemType* px = buffer.data() + m_tableOffsets[i];
+            size_t length = m_tableLength[i];
+            node->Value().CopyToArray(px, length);
+        }
+    }
+
+    void CopyHostToModel(std::vector<ElemType>& buffer)
+    {
+        size_t i = 0;
+        for (auto nodeIter = m_learnableNodes.begin(); nodeIter != m_learnableNodes.end(); nodeIter++, i++)
+        {
+            ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(*nodeIter);
+            Matrix<ElemType>& mat = node->Value();
+            mat.SetValue(mat.GetNumRows(), mat.GetNumCols(), mat.GetDeviceId(), buffer.data() + m_tableOffsets[i]);
+        }
+    }
 
-    void WaitAsyncBuffer() override { }
+    // simulated model averaging: sum the deltas of all workers together with the number of workers that
+    // contributed one, and continue from the average; returns the number of contributing workers
+    size_t AverageModels(bool active)
+    {
+        m_delta[m_totalModelSize] = active ? (ElemType)1 : (ElemType)0;
+        MPI_Allreduce(MPI_IN_PLACE, m_delta.data(), (int)m_delta.size(), MPIWrapper::GetDataType(m_delta.data()), MPI_SUM, m_comm) || MpiFail("MPIParameterServerHelper: MPI_Allreduce");
+
+        size_t numActiveWorkers = (size_t)(m_delta[m_totalModelSize] + 0.5);
+        if (numActiveWorkers > 0)
+        {
+            for (size_t i = 0; i < m_totalModelSize; i++)
+                m_baseModel[i] += m_delta[i] / numActiveWorkers;
+            CopyHostToModel(m_baseModel);
+        }
+        return numActiveWorkers;
+    }
+
+    // add m_delta to the servers' shards
+    void Push(bool async)
+    {
+        MPI_Datatype dataType = MPIWrapper::GetDataType(m_delta.data());
+        for (int r = 0; r < (int)m_mpi->NumNodesInUse(); r++)
+        {
+            int count = (int)(m_shardBegin[r + 1] - m_shardBegin[r]);
+            if (count == 0)
+                continue;
+            if (async)
+            {
+                m_requests.push_back(MPI_REQUEST_NULL);
+                MPI_Raccumulate(m_delta.data() + m_shardBegin[r], count, dataType, r, 0, count, dataType, MPI_SUM, m_modelWindow, &m_requests.back()) || MpiFail("MPIParameterServerHelper: MPI_Raccumulate");
+            }
+            else
+                MPI_Accumulate(m_delta.data() + m_shardBegin[r], count, dataType, r, 0, count, dataType, MPI_SUM, m_modelWindow) || MpiFail("MPIParameterServerHelper: MPI_Accumulate");
+        }
+        if (!async)
+            MPI_Win_flush_all(m_modelWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_flush_all");
+    }
+
+    // read the servers' shards into m_pulledModel; atomic w.r.t. concurrent pushes of other workers
+    void Pull(bool async)
+    {
+        MPI_Datatype dataType = MPIWrapper::GetDataType(m_pulledModel.data());
+        for (int r = 0; r < (int)m_mpi->NumNodesInUse(); r++)
+        {
+            int count = (int)(m_shardBegin[r + 1] - m_shardBegin[r]);
+            if (count == 0)
+                continue;
+            if (async)
+            {
+                m_requests.push_back(MPI_REQUEST_NULL);
+                MPI_Rget_accumulate(nullptr, 0, dataType, m_pulledModel.data() + m_shardBegin[r], count, dataType, r, 0, count, dataType, MPI_NO_OP, m_modelWindow, &m_requests.back()) || MpiFail("MPIParameterServerHelper: MPI_Rget_accumulate");
+            }
+            else
+                MPI_Get_accumulate(nullptr, 0, dataType, m_pulledModel.data() + m_shardBegin[r], count, dataType, r, 0, count, dataType, MPI_NO_OP, m_modelWindow) || MpiFail("MPIParameterServerHelper: MPI_Get_accumulate");
+        }
+        if (!async)
+            MPI_Win_flush_all(m_modelWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_flush_all");
+    }
+
+    void PublishClock()
+    {
+        MPI_Accumulate(&m_clock, 1, MPI_INT, 0, (MPI_Aint)m_mpi->CurrentNodeRank(), 1, MPI_INT, MPI_REPLACE, m_clockWindow) || MpiFail("MPIParameterServerHelper: MPI_Accumulate");
+        MPI_Win_flush(0, m_clockWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_flush");
+    }
+
+    // bounded staleness: do not get more than m_maxStaleness syncs ahead of the slowest worker
+    void WaitForSlowestWorker()
+    {
+        if (m_maxStaleness == 0)
+            return;
+
+        Timer waitTimer;
+        waitTimer.Start();
+        for (bool blocked = false;; blocked = true)
+        {
+            MPI_Get_accumulate(nullptr, 0, MPI_INT, m_allClocks.data(), (int)m_allClocks.size(), MPI_INT, 0, 0, (int)m_allClocks.size(), MPI_INT, MPI_NO_OP, m_clockWindow) || MpiFail("MPIParameterServerHelper: MPI_Get_accumulate");
+            MPI_Win_flush(0, m_clockWindow) || MpiFail("MPIParameterServerHelper: MPI_Win_flush");
+            int slowest = *std::min_element(m_allClocks.begin(), m_allClocks.end());
+            if (m_clock - slowest <= (int)m_maxStaleness)
+            {
+                if (blocked)
+                    m_numSyncsBlockedOnStaleness++;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        waitTimer.Stop();
+        m_secondsBlockedOnStaleness += waitTimer.ElapsedSeconds();
+    }
+
+    float DecayCoefficient()
+    {
+        float f = 1.f;
+        switch (m_adjustLearningRateAtBeginningType)
+        {
+        case AdjustLearningRateAtBeginning::None:
+            break;
+        case AdjustLearningRateAtBeginning::Linearly:
+            f = min(f, max(0.f, (float)(m_adjustCoefficient + (1 - m_adjustCoefficient) / m_adjustMBNumber * m_parameterSyncCounter)));
+            break;
+        case AdjustLearningRateAtBeginning::Staircase:
+            f = min(f, max(0.f, (float)(m_adjustCoefficient * (m_parameterSyncCounter / m_adjustMBNumber + 1))));
+            break;
+        default:
+            break;
+        }
+        return f;
+    }
+
+    void ReportPerfStats()
+    {
+        m_reportTimer.Stop();
+        double secondsSinceLastReport = m_reportTimer.ElapsedSeconds();
+        m_reportTimer.Restart();
+
+        fprintf(stderr, "\t\t(parameter server stats) %d-th sync: %8.2f seconds since last report ; %d samples processed by me ; %.2f seconds in communication, %.2f seconds waiting for slower workers\n",
+                (int)m_parameterSyncCounter, secondsSinceLastReport, (int)m_sampleSinceLastReport, m_secondsInCommunication, m_secondsBlockedOnStaleness);
+        m_sampleSinceLastReport = 0;
+        m_secondsInCommunication = 0;
+        m_secondsBlockedOnStaleness = 0;
+    }
+
+    static const int s_finishedClock = INT_MAX / 2; // a worker done with its epoch must never be waited for
+
+    MPIWrapperPtr m_mpi;
+    MPI_Comm m_comm;
+    size_t m_totalClientNumber;
+    bool m_useAsyncBuffer;
+    bool m_ModelAveragingSGDSimulating;
+    AdjustLearningRateAtBeginning m_adjustLearningRateAtBeginningType;
+    double m_adjustCoefficient;
+    size_t m_adjustMBNumber;
+    int m_traceLevel;
+    int m_syncPerfStats;
+    size_t m_maxStaleness;
+
+    std::list<ComputationNodeBasePtr> m_learnableNodes;
+    vector<size_t> m_tableLength;
+    vector<size_t> m_tableOffsets;
+    size_t m_totalModelSize = 0;
+    vector<size_t> m_shardBegin;           // rank r serves elements [m_shardBegin[r], m_shardBegin[r+1]) of the flattened model
+
+    MPI_Win m_modelWindow;
+    ElemType* m_shard;                     // this worker's shard of the model (window memory)
+    MPI_Win m_clockWindow;
+    int* m_clocks;                         // on rank 0: number of syncs of every worker (window memory)
+    std::vector<int> m_allClocks;
+    std::vector<MPI_Request> m_requests;   // outstanding pipelined push/pull
+
+    std::vector<ElemType> m_baseModel;     // the model this worker continued from at the last sync
+    std::vector<ElemType> m_delta;
+    std::vector<ElemType> m_pulledModel;
+
+    size_t m_parameterSyncCounter;
+    int m_clock;
+    bool m_initialized;
+    bool m_pulledModelPending;
+
+    Timer m_reportTimer;
+    size_t m_sampleSinceLastReport = 0;
+    double m_secondsBlockedOnStaleness;
+    double m_secondsInCommunication;
+    size_t m_numSyncsBlockedOnStaleness = 0; // in the current epoch
+    size_t m_numSyncsInEpoch = 0;
 };
 
 template<class ElemType>
@@ -634,14 +1028,17 @@ ASGDHelper<ElemType>* NewASGDHelper(
     double adjustCoef,
     size_t adjustPerMinibatches,
     int traceLevel,
-    int syncPerfStats) 
+    int syncPerfStats,
+    size_t maxStaleness) 
 {
 #ifdef ASGD_PARALLEL_SUPPORT
+    if (maxStaleness > 0)
+        fprintf(stderr, "NewASGDHelper: maxStaleness is ignored by the Multiverso parameter server.\n");
     return new MultiversoHelper<ElemType>(learnableNodes, nodeNumRanks, useAsyncBuffer, isSimulatedModelAveragingSGD, 
                                       adjusttype, adjustCoef, adjustPerMinibatches, traceLevel, syncPerfStats);
 #else
-    return new NoneASGDHelper<ElemType>(learnableNodes, nodeNumRanks, useAsyncBuffer, isSimulatedModelAveragingSGD, 
-                                      adjusttype, adjustCoef, adjustPerMinibatches, traceLevel, syncPerfStats); 
+    return new MPIParameterServerHelper<ElemType>(learnableNodes, nodeNumRanks, useAsyncBuffer, isSimulatedModelAveragingSGD, 
+                                      adjusttype, adjustCoef, adjustPerMinibatches, traceLevel, syncPerfStats, maxStaleness); 
 #endif
 }
 
@@ -654,7 +1051,8 @@ template ASGDHelper<float>* NewASGDHelper<float>(
     double adjustCoef,
     size_t adjustPerMinibatches,
     int traceLevel,
-    int syncPerfStats); 
+    int syncPerfStats,
+    size_t maxStaleness); 
 
 template ASGDHelper<double>* NewASGDHelper<double>(
     const std::list<ComputationNodeBasePtr> & learnableNodes,
@@ -665,6 +1063,7 @@ template ASGDHelper<double>* NewASGDHelper<double>(
     double adjustCoef,
     size_t adjustPerMinibatches,
     int traceLevel,
-    int syncPerfStats); 
+    int syncPerfStats,
+    size_t maxStaleness); 
 
 }}} 
@@ -0,0 +1,176 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// AsyncCheckpointWriter.h -- persists model and checkpoint snapshots on a background thread
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "File.h"
+#include "fileutil.h"
+#include "TimerUtility.h"
+#include <memory>
+#include <string>
+#include <thread>
+#include <exception>
+#include <utility>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// CheckpointSnapshot -- a set of files serialized into host memory on the training thread,
+// together with the files that become obsolete once the snapshot is safely on disk
+// -----------------------------------------------------------------------
+
+class CheckpointSnapshot
+{
+public:
+    // returns an in-memory File; its content will be written to 'path' when the snapshot is persisted
+    File& AddFile(const std::wstring& path, int fileOptions = FileOptions::fileOptionsBinary)
+    {
+        m_files.push_back(std::make_pair(path, File::CreateMemoryWriter(fileOptions | FileOptions::fileOptionsWrite)));
+        return *m_files.back().second;
+    }
+
+    // 'path' is deleted after all files of this snapshot have been written
+    void DeleteAfterWriting(const std::wstring& path)
+    {
+        m_obsoleteFiles.push_back(path);
+    }
+
+    // 'path' is deleted before any file of this snapshot is written
+    void DeleteBeforeWriting(const std::wstring& path)
+    {
+        m_invalidatedFiles.push_back(path);
+    }
+
+    size_t SizeInBytes()
+    {
+        size_t total = 0;
+        for (auto& file : m_files)
+        {
+            size_t size;
+            file.second->GetMemoryBuffer(size);
+            total += size;
+        }
+        return total;
+    }
+
+private:
+    friend class AsyncCheckpointWriter;
+
+    std::vector<std::pair<std::wstring, std::unique_ptr<File>>> m_files;
+    std::vector<std::wstring> m_obsoleteFiles;
+    std::vector<std::wstring> m_invalidatedFiles;
+};
+
+// -----------------------------------------------------------------------
+// AsyncCheckpointWriter -- writes CheckpointSnapshots to disk on a background thread
+// Each file is written to a temporary file, fsync'ed, and then atomically renamed to its final name.
+// At most one snapshot is being written while the next one is taken, i.e. snapshots are double-buffered
+// in host memory; Write() blocks if the previous snapshot is still being written.
+// -----------------------------------------------------------------------
+
+class AsyncCheckpointWriter
+{
+public:
+    AsyncCheckpointWriter(int traceLevel)
+        : m_traceLevel(traceLevel)
+    {
+    }
+
+    ~AsyncCheckpointWriter()
+    {
+        // must not throw from the destructor; errors have been reported by the background thread already
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    // hand over a snapshot to be persisted in the background
+    void Write(std::unique_ptr<CheckpointSnapshot>&& snapshot)
+    {
+        Timer waitTimer;
+        waitTimer.Start();
+        Wait();
+        waitTimer.Stop();
+        if (m_traceLevel > 0 && waitTimer.ElapsedSeconds() > 0.01)
+            fprintf(stderr, "AsyncCheckpointWriter: waited %.2f seconds for the previous checkpoint to be written.\n", waitTimer.ElapsedSeconds());
+
+        m_pending = std::move(snapshot);
+        m_thread = std::thread([this]()
+        {
+            try
+            {
+                Persist(*m_pending);
+            }
+            catch (const std::exception& e)
+            {
+                fprintf(stderr, "AsyncCheckpointWriter: writing checkpoint failed: %s\n", e.what());
+                m_error = std::current_exception();
+            }
+        });
+    }
+
+    // wait until the pending snapshot (if any) is on disk; rethrows errors from the background thread
+    void Wait()
+    {
+        if (m_thread.joinable())
+            m_thread.join();
+        m_pending.reset();
+        if (m_error)
+        {
+            auto error = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void Persist(CheckpointSnapshot& snapshot)
+    {
+        Timer writeTimer;
+        writeTimer.Start();
+        size_t totalBytes = 0;
+        for (const auto& path : snapshot.m_invalidatedFiles)
+            _wunlink(path.c_str());
+        for (auto& file : snapshot.m_files)
+        {
+            const std::wstring& path = file.first;
+            size_t size;
+            const char* data = file.second->GetMemoryBuffer(size);
+
+            // Saving into temporary file and then renaming it to the requested name
+            // This is a standard trick to avoid having corrupted files if the process dies during writing
+            std::wstring tempFileName = path + L".tmp";
+            msra::files::make_intermediate_dirs(path);
+            FILE* f = fopenOrDie(tempFileName, L"wb");
+            if (size > 0)
+                fwriteOrDie(data, 1, size, f);
+            fflushOrDie(f);
+            fsyncOrDie(f);
+            fcloseOrDie(f);
+            _wunlink(path.c_str());
+            renameOrDie(tempFileName, path);
+            totalBytes += size;
+
+            file.second.reset(); // release the host memory as early as possible
+        }
+        for (const auto& path : snapshot.m_obsoleteFiles)
+            _wunlink(path.c_str());
+        writeTimer.Stop();
+
+        if (m_traceLevel > 0)
+            fprintf(stderr, "AsyncCheckpointWriter: wrote %d files (%.1f MB) in %.2f seconds in the background.\n",
+                    (int)snapshot.m_files.size(), totalBytes / (1024.0 * 1024.0), writeTimer.ElapsedSeconds());
+    }
+
+    int m_traceLevel;
+    std::thread m_thread;
+    std::unique_ptr<CheckpointSnapshot> m_pending;
+    std::exception_ptr m_error;
+};
+
+}}}
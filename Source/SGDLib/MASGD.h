@@ -39,6 +39,9 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         size_t m_localSamplesProcessedSinceLastReport; 
         double m_accumulatedSecondsOnSyncPointInOneEpoch;
         size_t m_syncPointHitCounterInOneEpoch;
+        double m_accumulatedSecondsInFlightInOneEpoch;     // async MA only: wall time between starting and completing an aggregation
+        double m_accumulatedSecondsBlockedInOneEpoch;      // async MA only: part of the above the worker spent waiting for completion
+        size_t m_asyncSyncCompletedInOneEpoch;
         Timer  m_Timer; 
 
     public:
@@ -60,6 +63,9 @@ namespace Microsoft { namespace MSR { namespace CNTK {
             m_numSyncPerformedInCurrentEpoch = 0; 
             m_accumulatedSecondsOnSyncPointInOneEpoch = 0;
             m_syncPointHitCounterInOneEpoch = 0;
+            m_accumulatedSecondsInFlightInOneEpoch = 0;
+            m_accumulatedSecondsBlockedInOneEpoch = 0;
+            m_asyncSyncCompletedInOneEpoch = 0;
         }
         void OnEpochEnd()
         {
@@ -100,6 +106,30 @@ namespace Microsoft { namespace MSR { namespace CNTK {
             }
         }
 
+        // called by the non-blocking model averaging when an aggregation started at an earlier sync point completes
+        // overlap efficiency is the fraction of the aggregation's lifetime during which the worker kept training
+        void OnAsyncMACompleted(double secondsInFlight, double secondsBlocked)
+        {
+            m_accumulatedSecondsInFlightInOneEpoch += secondsInFlight;
+            m_accumulatedSecondsBlockedInOneEpoch += secondsBlocked;
+            m_asyncSyncCompletedInOneEpoch++;
+            if (m_reportFrequency > 0 &&
+                (m_asyncSyncCompletedInOneEpoch % m_reportFrequency == 0 || m_asyncSyncCompletedInOneEpoch <= 5))
+            {
+                fprintf(stderr, "\t\t(model aggregation stats): %d-th async sync completed after %.2f seconds in flight, blocking for %.2f seconds; sync overlap efficiency = %.2f%% (%.2f%% in this epoch)\n",
+                        (int)m_asyncSyncCompletedInOneEpoch,
+                        secondsInFlight,
+                        secondsBlocked,
+                        100.0 * OverlapEfficiency(secondsInFlight, secondsBlocked),
+                        100.0 * OverlapEfficiency(m_accumulatedSecondsInFlightInOneEpoch, m_accumulatedSecondsBlockedInOneEpoch));
+            }
+        }
+
+        static double OverlapEfficiency(double secondsInFlight, double secondsBlocked)
+        {
+            return secondsInFlight > 0 ? std::max(0.0, 1.0 - secondsBlocked / secondsInFlight) : 1.0;
+        }
+
         void ReportMAPerfStats( size_t totalSamplesProcessedSinceLastReport, 
                                 size_t localSamplesProcessedSinceLastReport, 
                                 float secondOnCommunication)
@@ -404,4 +434,224 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         }
     };
 
+    // Implementation of non-blocking model averaging
+    // At every sync point, a worker snapshots its parameters and starts an asynchronous allreduce of them;
+    // it then keeps training on local data. At the next sync point the averaged model is received and
+    // the local progress made in the meantime is re-applied on top of it:
+    //     w <- avg(snapshot) + (w - snapshot)
+    // Worker status is piggybacked on the same allreduce, so no blocking handshake is needed at a sync point.
+    // Workers that run out of data keep joining aggregation rounds from OnEpochEnd() until every worker has
+    // reached the end of its data; the last round is completed synchronously so all models end up identical.
+    template<typename ElemType>
+    class AsyncModelAveragingSGD : public IMASGD<ElemType>
+    {
+        typedef IMASGD<ElemType> Base;
+        using Base::m_pMPI;
+        using Base::m_perfReporter;
+        using Base::m_numSyncPerformed;
+        using Base::DownCast;
+
+        // layout of the aggregation header, stored behind the (weighted) parameters in the communication buffer
+        enum
+        {
+            HeaderSamples = 0,   // number of samples this worker processed since its last snapshot
+            HeaderActive = 1,    // 1 if this worker has not reached the end of its data yet
+            HeaderSize = 2
+        };
+
+    public:
+        AsyncModelAveragingSGD(const MPIWrapperPtr& pMPI, size_t reportFreq, DEVICEID_TYPE devID)
+            : Base(pMPI, reportFreq, devID), m_aggregationPending(false)
+        {
+            fprintf(stderr, "Parallel training (%d workers) using ModelAveraging with non-blocking aggregation\n", (int)m_pMPI->NumNodesInUse());
+        }
+
+        ~AsyncModelAveragingSGD()
+        {
+            // an aggregation can only be pending here if training was aborted; the buffer must outlive the request
+            if (m_aggregationPending)
+                m_pMPI->Wait(&m_aggregationRequest);
+        }
+
+        void OnEpochStart(const std::list<ComputationNodeBasePtr>& learnableNodes) override
+        {
+            if (m_aggregationPending)
+                LogicError("AsyncModelAveragingSGD: an aggregation is still pending at the start of an epoch.");
+            Base::OnEpochStart(learnableNodes);
+        }
+
+        bool OnArrivingAtSyncPoint(
+            const std::list<ComputationNodeBasePtr>& learnableNodes,        /* input/output: */
+            std::list<Matrix<ElemType>>& /*smoothedGradient*/,              /* input/output: untouched by model averaging */
+            size_t samplesSinceLastSync                                     /* input:  samples processed since last sync on this worker only */
+            ) override
+        {
+            Timer syncPointTimer;
+            syncPointTimer.Start();
+
+            // 1. finish the aggregation started at the previous sync point; ideally it has completed in the background by now
+            if (m_aggregationPending)
+                CompleteAggregation(learnableNodes);
+
+            // 2. snapshot the model and start the next aggregation
+            StartAggregation(learnableNodes, samplesSinceLastSync, /*isActive=*/true);
+
+            syncPointTimer.Stop();
+            m_perfReporter.OnArriveAtSyncPoint(syncPointTimer.ElapsedSeconds(), true);
+            return true;
+        }
+
+        void OnEpochEnd(const std::list<ComputationNodeBasePtr>& learnableNodes,
+                        std::list<Matrix<ElemType>>&             /*smoothedGradient*/,
+                        size_t                                   samplesSinceLastSync) override
+        {
+            if (m_aggregationPending)
+                CompleteAggregation(learnableNodes);
+
+            // keep joining rounds until no worker reports itself active any more; the last round leaves all models identical
+            Timer syncPointTimer;
+            syncPointTimer.Start();
+            for (;;)
+            {
+                StartAggregation(learnableNodes, samplesSinceLastSync, /*isActive=*/false);
+                samplesSinceLastSync = 0;
+                size_t numActiveWorkers = CompleteAggregation(learnableNodes);
+                if (numActiveWorkers == 0)
+                    break;
+            }
+            syncPointTimer.Stop();
+            m_perfReporter.OnArriveAtSyncPoint(syncPointTimer.ElapsedSeconds(), true);
+
+            m_pMPI->WaitAll();
+            m_perfReporter.OnEpochEnd();
+        }
+
+        // synchronous aggregation, for callers that go through the generic interface
+        void ModelAggregationProcessing(
+            size_t samplesSinceLastSync,                                       /* in */
+            const std::list<ComputationNodeBasePtr>&  learnableNodes,          /* in/out */
+            std::list<Matrix<ElemType>>&              /*smoothedGradient*/,    /* in/out */
+            size_t&                                   totalSamplesProcessed,   /* out */
+            float&                                    secondsOnCommunication   /* out */) override
+        {
+            if (m_aggregationPending)
+                CompleteAggregation(learnableNodes);
+            Timer commTimer;
+            commTimer.Start();
+            StartAggregation(learnableNodes, samplesSinceLastSync, /*isActive=*/true);
+            CompleteAggregation(learnableNodes);
+            commTimer.Stop();
+            totalSamplesProcessed = m_lastTotalSamples;
+            secondsOnCommunication = (float)commTimer.ElapsedSeconds();
+        }
+
+    private:
+        void StartAggregation(const std::list<ComputationNodeBasePtr>& learnableNodes, size_t samplesSinceLastSync, bool isActive)
+        {
+            assert(!m_aggregationPending);
+
+            // 1. (re-)create the snapshots and the communication buffer on first use
+            size_t numElements = 0;
+            size_t numNodes = 0;
+            for (auto& pBaseNode : learnableNodes)
+            {
+                if (!pBaseNode->IsParameterUpdateRequired())
+                    continue;
+                numElements += DownCast(pBaseNode)->Value().GetNumElements();
+                numNodes++;
+            }
+            if (m_snapshots.size() != numNodes)
+            {
+                m_snapshots.clear();
+                for (auto& pBaseNode : learnableNodes)
+                {
+                    if (pBaseNode->IsParameterUpdateRequired())
+                        m_snapshots.push_back(DownCast(pBaseNode)->Value().DeepClone());
+                }
+            }
+            m_buffer.resize(numElements + HeaderSize);
+
+            // 2. snapshot the current model; the buffer holds the parameters weighted by the local sample count,
+            //    since the global sample count is only known once the aggregation has completed
+            ElemType weight = (ElemType)samplesSinceLastSync;
+            size_t offset = 0;
+            auto snapshot = m_snapshots.begin();
+            for (auto& pBaseNode : learnableNodes)
+            {
+                if (!pBaseNode->IsParameterUpdateRequired())
+                    continue;
+                auto pNode = DownCast(pBaseNode);
+                snapshot->SetValue(pNode->Value());
+                ElemType* dst = m_buffer.data() + offset;
+                size_t nx = snapshot->GetNumElements();
+                snapshot->CopyToArray(dst, nx);
+                offset += nx;
+                snapshot++;
+            }
+#pragma omp parallel for
+            for (long i = 0; i < (long)numElements; i++)
+                m_buffer[i] *= weight;
+            m_buffer[numElements + HeaderSamples] = weight;
+            m_buffer[numElements + HeaderActive] = isActive ? 1 : 0;
+
+            // 3. start the in-place allreduce and return to training
+            m_pMPI->AllReduceAsync(m_buffer.data(), m_buffer.size(), &m_aggregationRequest);
+            m_aggregationPending = true;
+            m_localSamplesInAggregation = samplesSinceLastSync;
+            m_inFlightTimer.Restart();
+        }
+
+        // returns the number of workers that were still active when the aggregation was started
+        size_t CompleteAggregation(const std::list<ComputationNodeBasePtr>& learnableNodes)
+        {
+            assert(m_aggregationPending);
+
+            Timer waitTimer;
+            waitTimer.Start();
+            m_pMPI->Wait(&m_aggregationRequest);
+            waitTimer.Stop();
+            m_inFlightTimer.Stop();
+            m_aggregationPending = false;
+            m_numSyncPerformed++;
+
+            size_t numElements = m_buffer.size() - HeaderSize;
+            double totalSamples = m_buffer[numElements + HeaderSamples];
+            size_t numActiveWorkers = (size_t)(m_buffer[numElements + HeaderActive] + 0.5);
+            m_lastTotalSamples = (size_t)(totalSamples + 0.5);
+
+            // if no worker has seen data since the last round, all snapshots equal the previous average; nothing to apply
+            if (totalSamples > 0)
+            {
+                // w <- w - snapshot + sum(weighted snapshots) / totalSamples
+                ElemType factor = (ElemType)(1.0 / totalSamples);
+                size_t offset = 0;
+                auto snapshot = m_snapshots.begin();
+                for (auto& pBaseNode : learnableNodes)
+                {
+                    if (!pBaseNode->IsParameterUpdateRequired())
+                        continue;
+                    auto pNode = DownCast(pBaseNode);
+                    Matrix<ElemType>& value = pNode->Value();
+                    Matrix<ElemType>::ScaleAndAdd((ElemType)-1, *snapshot, value);
+                    snapshot->SetValue(snapshot->GetNumRows(), snapshot->GetNumCols(), snapshot->GetDeviceId(), m_buffer.data() + offset);
+                    Matrix<ElemType>::ScaleAndAdd(factor, *snapshot, value);
+                    offset += snapshot->GetNumElements();
+                    snapshot++;
+                }
+            }
+
+            m_perfReporter.OnAsyncMACompleted(m_inFlightTimer.ElapsedSeconds(), waitTimer.ElapsedSeconds());
+            m_perfReporter.OnMAPerformed(m_localSamplesInAggregation, m_lastTotalSamples, (float)waitTimer.ElapsedSeconds());
+            return numActiveWorkers;
+        }
+
+        std::vector<Matrix<ElemType>> m_snapshots;      // per parameter: the model as sent in the pending aggregation
+        std::vector<ElemType>         m_buffer;         // host-side weighted parameters + header; in-place allreduce target
+        MPI_Request                   m_aggregationRequest;
+        bool                          m_aggregationPending;
+        size_t                        m_localSamplesInAggregation;
+        size_t                        m_lastTotalSamples;
+        Timer                         m_inFlightTimer;
+    };
+
 } } }
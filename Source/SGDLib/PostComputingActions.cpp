@@ -6,11 +6,17 @@
 #include "PostComputingActions.h"
 
 #include "TrainingNodes.h"
+#include "LinearAlgebraNodes.h"
+#include "ConvolutionalNodes.h"
+#include "InputAndParamNodes.h"
+#include "QuantizedNodes.h"
 #include "ProgressTracing.h"
 #include "DataReaderHelpers.h"
 #include "SimpleDistGradAggregator.h"
 
 #include <vector>
+#include <set>
+#include <limits>
 
 namespace Microsoft { namespace MSR{ namespace CNTK {
 
@@ -153,6 +159,238 @@ void PostComputingActions<ElemType>::BatchNormalizationStatistics(IDataReader *
     return;
 }
 
+// whether the quantized convolution supports a ConvolutionNode with the given input shape
+template <class ElemType>
+static bool IsQuantizableConvolution(const ConvolutionNode<ElemType>& node, const TensorShape& inputShape)
+{
+    if (node.IsConvolution2D() || node.Transpose() || node.ImageLayout() != ImageLayoutKind::CHW)
+        return false;
+    ConvolveGeometry geometry(inputShape, node.KernelShape(), node.MapCount(), node.Strides(),
+                              node.Sharing(), node.AutoPad(), node.LowerPad(), node.UpperPad());
+    std::vector<int> offsets;
+    size_t numPositions;
+    return QuantizedConvolutionNode<ElemType>::TryGetPatchOffsets(geometry, offsets, numPositions);
+}
+
+template <class ElemType>
+void PostComputingActions<ElemType>::QuantizeModel(IDataReader* dataReader, const vector<wstring>& evalNodeNames,
+    const wstring newModelPath, const size_t mbSize, const int iters)
+{
+    ScopedNetworkOperationMode modeGuard(m_net, NetworkOperationMode::inferring);
+
+    let evalNodes = m_net->GetEvalNodesWithName(evalNodeNames);
+
+    // find the nodes to quantize: Times and Convolution with a parameter as weights
+    struct Candidate
+    {
+        ComputationNodeBasePtr node;
+        ComputationNodeBasePtr weights;
+        ComputationNodeBasePtr input;
+        float minValue;
+        float maxValue;
+        bool supported;
+    };
+    std::vector<Candidate> candidates;
+    std::set<ComputationNodeBasePtr> visited;
+    for (auto& evalNode : evalNodes)
+    {
+        for (auto& node : m_net->GetEvalOrder(evalNode))
+        {
+            if (!visited.insert(node).second || node->GetNumInputs() != 2)
+                continue;
+            let weights = node->Input(0);
+            let input = node->Input(1);
+            if (!dynamic_pointer_cast<LearnableParameter<ElemType>>(weights) || weights->HasMBLayout())
+                continue;
+
+            bool supported = false;
+            if (dynamic_pointer_cast<TimesNode<ElemType>>(node))
+            {
+                // the weights must reduce over the entire input sample
+                supported = weights->GetSampleLayout().GetNumElements() == node->GetSampleLayout().GetNumElements() * input->GetSampleLayout().GetNumElements();
+            }
+            else if (let convNode = dynamic_pointer_cast<ConvolutionNode<ElemType>>(node))
+                supported = IsQuantizableConvolution(*convNode, input->GetSampleLayout());
+
+            if (supported)
+                candidates.push_back(Candidate{ node, weights, input, std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), true });
+        }
+    }
+
+    // Calibration needs the values of the data inputs of these nodes after forward prop. Make them roots, such that
+    // their matrices are not reused for other nodes.
+    std::vector<ComputationNodeBasePtr> calibrationNodes;
+    std::vector<ComputationNodeBasePtr> addedNodes;
+    for (auto& candidate : candidates)
+    {
+        let& input = candidate.input;
+        if (input->IsLeaf() || std::find(calibrationNodes.begin(), calibrationNodes.end(), input) != calibrationNodes.end())
+            continue;
+        calibrationNodes.push_back(input);
+        let& evaluationNodes = m_net->EvaluationNodes();
+        if (std::find(evaluationNodes.begin(), evaluationNodes.end(), input) == evaluationNodes.end())
+        {
+            m_net->AddToNodeGroup(L"evaluation", input);
+            addedNodes.push_back(input);
+        }
+    }
+
+    m_net->CompileNetwork();
+    m_net->AllocateAllMatrices(calibrationNodes, std::vector<ComputationNodeBasePtr>(), nullptr);
+
+    auto& featureNodes = m_net->FeatureNodes();
+
+    StreamMinibatchInputs inputMatrices;
+    for (auto& node : featureNodes)
+        inputMatrices.AddInput(node->NodeName(), node->ValuePtr(), node->GetMBLayout(), node->GetSampleLayout());
+
+    bool useParallelTrain = (m_mpi != nullptr);
+    bool useDistributedMBReading = useParallelTrain && m_enableDistributedMBReading && dataReader->SupportsDistributedMBRead();
+    size_t totalEpochSize = mbSize * iters;
+
+    m_net->StartEvaluateMinibatchLoop(calibrationNodes);
+
+    if (useDistributedMBReading)
+        dataReader->StartDistributedMinibatchLoop(mbSize, 0, m_mpi->CurrentNodeRank(), m_mpi->NumNodesInUse(), inputMatrices.GetStreamDescriptions(), totalEpochSize);
+    else
+        dataReader->StartMinibatchLoop(mbSize, 0, inputMatrices.GetStreamDescriptions(), totalEpochSize);
+
+    LOGPRINTF(stderr, "Calibrating the inputs of %d nodes for quantization.\n", (int)candidates.size());
+
+    int numMinibatches = 0;
+    for (; numMinibatches < iters; numMinibatches++)
+    {
+        size_t actualMBSize = 0;
+        bool wasDataRead = DataReaderHelpers::GetMinibatchIntoNetwork<ElemType>(*dataReader, m_net,
+            nullptr, useDistributedMBReading, useParallelTrain, inputMatrices, actualMBSize, m_mpi);
+        if (!wasDataRead)
+            break;
+
+        ComputationNetwork::BumpEvalTimeStamp(featureNodes);
+        m_net->ForwardProp(calibrationNodes);
+
+        for (auto& candidate : candidates)
+        {
+            let input = static_pointer_cast<ComputationNode<ElemType>>(candidate.input);
+            if (input->Value().GetMatrixType() != MatrixType::DENSE)
+            {
+                candidate.supported = false; // e.g. a sparse one-hot input
+                continue;
+            }
+
+            // gaps are set to 0, which is always in the quantized range
+            if (input->HasMBLayout())
+                input->MaskMissingValueColumnsToZero(FrameRange(input->GetMBLayout()));
+            std::unique_ptr<ElemType[]> values(input->Value().CopyToArray());
+            size_t numValues = input->Value().GetNumElements();
+            for (size_t i = 0; i < numValues; i++)
+            {
+                candidate.minValue = std::min(candidate.minValue, (float)values[i]);
+                candidate.maxValue = std::max(candidate.maxValue, (float)values[i]);
+            }
+        }
+    }
+
+    dataReader->DataEnd();
+
+    for (auto& node : addedNodes)
+        m_net->RemoveFromNodeGroup(L"evaluation", node);
+
+    if (numMinibatches == 0)
+        RuntimeError("QuantizeModel: The reader did not provide any data for calibration.");
+
+    // merge the ranges of all workers
+    if (useParallelTrain)
+    {
+        std::vector<float> minValues, maxValues;
+        for (auto& candidate : candidates)
+        {
+            minValues.push_back(candidate.minValue);
+            maxValues.push_back(candidate.maxValue);
+        }
+        if (!candidates.empty())
+        {
+            m_mpi->AllReduce(minValues.data(), minValues.size(), MPI_MIN);
+            m_mpi->AllReduce(maxValues.data(), maxValues.size(), MPI_MAX);
+        }
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            candidates[i].minValue = minValues[i];
+            candidates[i].maxValue = maxValues[i];
+        }
+    }
+
+    // replace the nodes by their quantized versions
+    size_t numQuantized = 0;
+    size_t floatBytes = 0;
+    size_t quantizedBytes = 0;
+    std::set<ComputationNodeBasePtr> replacedWeights;
+    for (auto& candidate : candidates)
+    {
+        if (!candidate.supported)
+            continue;
+
+        let& node = candidate.node;
+        let weights = static_pointer_cast<ComputationNode<ElemType>>(candidate.weights);
+        std::unique_ptr<ElemType[]> weightValues(weights->Value().CopyToArray());
+        size_t numWeights = weights->Value().GetNumElements();
+
+        shared_ptr<const Int8Weights> quantizedWeights;
+        ComputationNodeBasePtr quantizedNode;
+        if (let convNode = dynamic_pointer_cast<ConvolutionNode<ElemType>>(node))
+        {
+            // kernels are stored one output channel after the other
+            size_t kernelSize = convNode->KernelShape().GetNumElements();
+            quantizedWeights = make_shared<Int8Weights>(weightValues.get(), numWeights / kernelSize, kernelSize, kernelSize, 1, candidate.minValue, candidate.maxValue);
+            let quantizedConvNode = New<QuantizedConvolutionNode<ElemType>>(node->GetDeviceId(), node->NodeName(),
+                convNode->KernelShape(), convNode->MapCount(), convNode->Strides(), convNode->Sharing(), convNode->AutoPad(), convNode->LowerPad(), convNode->UpperPad());
+            quantizedConvNode->SetWeights(quantizedWeights);
+            quantizedNode = quantizedConvNode;
+        }
+        else
+        {
+            // column-major [output x input] matrix
+            size_t numRows = node->GetSampleLayout().GetNumElements();
+            quantizedWeights = make_shared<Int8Weights>(weightValues.get(), numRows, numWeights / numRows, 1, numRows, candidate.minValue, candidate.maxValue);
+            let quantizedTimesNode = New<QuantizedTimesNode<ElemType>>(node->GetDeviceId(), node->NodeName(), node->GetSampleLayout());
+            quantizedTimesNode->SetWeights(quantizedWeights);
+            quantizedNode = quantizedTimesNode;
+        }
+
+        if (m_traceLevel > 0)
+            LOGPRINTF(stderr, "Quantizing %ls %ls operation: input range [%g, %g].\n",
+                      node->NodeName().c_str(), node->OperationName().c_str(), candidate.minValue, candidate.maxValue);
+
+        quantizedNode->AttachInputs({ node->Input(1) }); // (not candidate.input, which may have been replaced already)
+        m_net->SubstituteNode(node, quantizedNode);
+        replacedWeights.insert(candidate.weights);
+        floatBytes += numWeights * sizeof(ElemType);
+        quantizedBytes += quantizedWeights->SizeInBytes();
+        numQuantized++;
+    }
+
+    // delete the float weights unless other nodes still use them
+    for (auto& weights : replacedWeights)
+    {
+        bool used = false;
+        for (auto& node : m_net->GetAllNodes())
+        {
+            for (size_t i = 0; i < node->GetNumInputs(); i++)
+                used |= node->GetInputs()[i] == weights;
+        }
+        if (!used)
+            m_net->DeleteNode(weights->NodeName());
+    }
+
+    m_net->CompileNetwork();
+
+    LOGPRINTF(stderr, "Quantized %d of %d Times and Convolution nodes to int8; their weights take %.1f MB instead of %.1f MB.\n",
+              (int)numQuantized, (int)candidates.size(), quantizedBytes / (1024.0 * 1024.0), floatBytes / (1024.0 * 1024.0));
+
+    if (!useParallelTrain || m_mpi->CurrentNodeRank() == m_mpi->MainNodeRank())
+        m_net->Save(newModelPath);
+}
+
 template class PostComputingActions<float>;
 template class PostComputingActions<double>;
 
@@ -52,6 +52,15 @@ public:
     void BatchNormalizationStatistics(IDataReader* dataReader, const vector<wstring>& evalNodeNames, const wstring newModelPath, 
         const size_t mbSize, const int iters = 30);
 
+    // Post-training int8 quantization for CPU evaluation:
+    // 1. Find the TimesNodes and ConvolutionNodes with a parameter as weights that the quantized nodes support.
+    // 2. Calibrate: run 'iters' minibatches of the reader through the network and record the value range of the
+    //    data input of each of them (merged across workers).
+    // 3. Replace them by QuantizedTimesNode resp. QuantizedConvolutionNode, which hold the weights as int8 with
+    //    per-output-channel scales, and the calibrated input quantization; weights no longer used are deleted.
+    void QuantizeModel(IDataReader* dataReader, const vector<wstring>& evalNodeNames, const wstring newModelPath,
+        const size_t mbSize, const int iters = 30);
+
 private:
     ComputationNetworkPtr m_net;
     MPIWrapperPtr m_mpi;
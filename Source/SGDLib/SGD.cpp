@@ -96,7 +96,7 @@ void SGD<ElemType>::Adapt(wstring origModelFileName, wstring refNodeName,
     bool networkLoadedFromCheckpoint = false;
     if (startEpoch >= 0)
     {
-        wstring modelFileName = GetModelNameForEpoch(int(startEpoch) - 1);
+        wstring modelFileName = GetModelNameForStartEpoch(startEpoch);
         LOGPRINTF(stderr, "Starting from checkpoint. Loading network from '%ls'.\n", modelFileName.c_str());
         net = ComputationNetwork::CreateFromFile<ElemType>(deviceId, modelFileName);
         networkLoadedFromCheckpoint = true;
@@ -177,6 +177,10 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         m_enableDistributedMBReading = true;
     }
 
+    // intermediate checkpoints record the reader position to continue the epoch at, which only the new (V2) readers can be set to
+    if (m_checkpointFrequencyInSamples > 0 && trainSetDataReader->IsLegacyReader())
+        InvalidArgument("TrainOrAdaptModel: \"checkpointFrequencyInSamples\" is not supported with legacy readers.");
+
     // determine evaluationNodes from GetEvalCriterionNodes(), ensuring each criterion is only logged once
     std::vector<ComputationNodeBasePtr> evaluationNodes;
     {
@@ -266,6 +270,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     // initializing weights and gradient holder
     // only one criterion so far TODO: support multiple ones?
     auto& learnableNodes = net->LearnableParameterNodes(criterionNodes[0]);
+    InitShardedParameters(net, learnableNodes);
     list<Matrix<ElemType>> smoothedGradients;
     vector<double> smoothedCounts; // currently used by FSAdaGradUpdate()
     size_t numParameters = 0;
@@ -277,8 +282,10 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         // Note: We don't actually need the smoothedGradients if !IsParameterUpdateRequired().
         // However, this is hard to fix since lots of code assumes smoothedGradients to be in the same order as learnableNodes.
         // V2 API fixes this.
+        // A sharded parameter only keeps the optimizer state of its own columns.
+        auto shardedParameter = GetShardedParameter(node);
         smoothedGradients.push_back(Matrix<ElemType>(node->Value().GetNumRows(),
-                                                     node->Value().GetNumCols(),
+                                                     shardedParameter ? shardedParameter->NumOwnedColumns() : node->Value().GetNumCols(),
                                                      net->GetDeviceId()));
         smoothedCounts.push_back(0);
         if (node->IsParameterUpdateRequired())
@@ -363,7 +370,24 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
 
     bool learnRateInitialized = false;
     double prevCriterion = numeric_limits<double>::infinity();
-    if (startEpoch > 0)
+    if (m_resumeFromIntermediateCheckPoint)
+    {
+        // continue the start epoch where its last intermediate checkpoint left off
+        // This restores the state of the previous epoch's checkpoint, updated up to the intermediate checkpoint, and the reader position.
+        LoadCheckPointInfo(GetIntermediateCheckPointFileNameForEpoch(startEpoch), startEpoch,
+                           /*out*/ totalTrainingSamplesSeen,
+                           /*out*/ learnRatePerSample,
+                           smoothedGradients,
+                           smoothedCounts,
+                           /*out*/ prevCriterion,
+                           /*out*/ m_prevChosenMinibatchSize);
+        if (m_resumeReaderSamplePosition == SIZE_MAX)
+            RuntimeError("Intermediate checkpoint '%ls' does not contain the reader position.", GetIntermediateCheckPointFileNameForEpoch(startEpoch).c_str());
+        m_resumeFromIntermediateCheckPoint = false;
+        learnRateInitialized = true;
+        prevLearnRates[startEpoch % m_numPrevLearnRates] = learnRatePerSample;
+    }
+    else if (startEpoch > 0)
     {
         learnRateInitialized = TryLoadCheckPointInfo(startEpoch - 1,
                                                      /*out*/ totalTrainingSamplesSeen,
@@ -416,7 +440,8 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                                          m_adjustCoefficient,
                                          m_adjustPerMinibatches,
                                          m_traceLevel,
-                                         m_syncStatsTrace));
+                                         m_syncStatsTrace,
+                                         m_maxStaleness));
         m_pASGDHelper->InitModel(learnableNodes);
     }
 
@@ -448,8 +473,15 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                                                                          m_batchNormalizationTimeConstant[i], prevNormalizationTimeConstant,
                                                                          m_batchNormalizationBlendTimeConstant[i], prevNormalizationBlendTimeConstant);
         
+        // an epoch resumed from an intermediate checkpoint continues with the learning rate and minibatch size it was started with
+        bool resumingEpoch = (m_resumeReaderSamplePosition != SIZE_MAX);
+
         // learning rate adjustment
-        if (m_autoLearnRateSearchType == LearningRateSearchAlgorithm::None || i < m_learningRatesParam.size())
+        if (resumingEpoch)
+        {
+            LOGPRINTF(stderr, "Resuming Epoch %d from intermediate checkpoint at sample position %d.\n", i + 1, (int)m_resumeReaderSamplePosition);
+        }
+        else if (m_autoLearnRateSearchType == LearningRateSearchAlgorithm::None || i < m_learningRatesParam.size())
         {
             // BUGBUG: GetNumParallelSequences() returns 1 under certain situations; it seems when restarting from checkpoint
             learnRatePerSample = GetLearningRatePerSample(i /*BUGBUG workaround:*/, trainSetDataReader->GetNumParallelSequencesForFixingBPTTMode());
@@ -498,7 +530,11 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         // basis for a set number of epochs.  For epochs after that point, m_mbSize.size(), either
         // we just keep using
         // the last minibatch size, or we use tuning to try and find a better one.
-        if (m_autoAdjustMinibatch && i >= m_mbSize.size())
+        if (resumingEpoch)
+        {
+            chosenMinibatchSize = m_prevChosenMinibatchSize;
+        }
+        else if (m_autoAdjustMinibatch && i >= m_mbSize.size())
         {
             size_t numFramesToUseInSearch = m_numSamples4Search[i];
             if (m_epochSize != requestDataSize)
@@ -543,6 +579,8 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
 
         EpochCriterion epochCriterion; // criterion values are returned in this
         std::vector<EpochCriterion> epochEvalErrors(evaluationNodes.size());
+        m_epochStartTotalSamplesSeen = totalTrainingSamplesSeen;
+        m_epochStartPrevCriterion = prevCriterion;
         TrainOneEpoch(net,
                       refNet,
                       refNode,
@@ -560,6 +598,14 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                       epochCriterion, epochEvalErrors);
         totalTrainingSamplesSeen += epochCriterion.second; // aggregate #training samples, for logging purposes only
 
+        // complete the sharded parameters on every worker for cross-validation and saving the model, and their optimizer state for the checkpoint
+        GatherShardedParameters();
+        GatherShardedSmoothedGradients(smoothedGradients);
+        if (m_traceLevel > 0)
+            for (const auto& shardedParameter : m_shardedParameters)
+                LOGPRINTF(stderr, "Sharded parameter %ls gathered: checksum = %016llx\n",
+                          shardedParameter.second->Node()->NodeName().c_str(), (unsigned long long)shardedParameter.second->ValueChecksum());
+
         timer.Stop();
         double epochTime = timer.ElapsedSeconds();
 
@@ -654,7 +700,14 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     // roll back
                     auto bestModelPath = GetModelNameForEpoch(i - m_learnRateAdjustInterval);
                     LOGPRINTF(stderr, "Loading (rolling back to) previous model with best training-criterion value: %ls.\n", bestModelPath.c_str());
+                    if (m_asyncCheckpointing)
+                    {
+                        // the model may still be being written by the main node
+                        WaitForPendingCheckPoints();
+                        SynchronizeWorkers();
+                    }
                     net->RereadPersistableParameters<ElemType>(bestModelPath);
+                    ResetShardedParameters();
                     LoadCheckPointInfo(i - m_learnRateAdjustInterval,
                                        /*out*/ totalTrainingSamplesSeen,
                                        /*out*/ learnRatePerSample,
@@ -735,6 +788,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         {
             if (loadedPrevModel)
             {
+                WaitForPendingCheckPoints();
                 // If previous best model is loaded, we will first remove epochs that lead to worse results
                 for (int j = 1; j < m_learnRateAdjustInterval; j++)
                 {
@@ -747,15 +801,17 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                 // Set i back to the loaded model
                 i -= m_learnRateAdjustInterval;
                 LOGPRINTF(stderr, "SGD: revoke back to and update checkpoint file for epoch %d\n", i+1); // report 1 based epoch number
-                SaveCheckPointInfo(i, totalTrainingSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, chosenMinibatchSize);
+                SaveCheckPointInfo(GetCheckPointFileNameForEpoch(i), totalTrainingSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, chosenMinibatchSize);
             }
             else
             {
-                SaveCheckPointInfo(i, totalTrainingSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, chosenMinibatchSize);
-                auto modelName = GetModelNameForEpoch(i);
-                if (m_traceLevel > 0)
-                    LOGPRINTF(stderr, "SGD: Saving checkpoint model '%ls'\n", modelName.c_str());
-                net->Save(modelName);
+                std::vector<wstring> obsoleteFiles;
+                if (m_checkpointFrequencyInSamples > 0)
+                {
+                    // the epoch's checkpoint supersedes the intermediate ones
+                    obsoleteFiles.push_back(GetIntermediateModelNameForEpoch(i));
+                    obsoleteFiles.push_back(GetIntermediateCheckPointFileNameForEpoch(i));
+                }
                 if (!m_keepCheckPointFiles)
                 {
                     // delete previous checkpoint file to save space
@@ -763,18 +819,21 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     {
                         if (epochsSinceLastLearnRateAdjust != 1)
                         {
-                            _wunlink(GetCheckPointFileNameForEpoch(i - 1).c_str());
+                            obsoleteFiles.push_back(GetCheckPointFileNameForEpoch(i - 1));
                         }
                         if (epochsSinceLastLearnRateAdjust == m_learnRateAdjustInterval)
                         {
-                            _wunlink(GetCheckPointFileNameForEpoch(i - m_learnRateAdjustInterval).c_str());
+                            obsoleteFiles.push_back(GetCheckPointFileNameForEpoch(i - m_learnRateAdjustInterval));
                         }
                     }
                     else
                     {
-                        _wunlink(GetCheckPointFileNameForEpoch(i - 1).c_str());
+                        obsoleteFiles.push_back(GetCheckPointFileNameForEpoch(i - 1));
                     }
                 }
+                SaveModelAndCheckPoint(net, GetModelNameForEpoch(i), GetCheckPointFileNameForEpoch(i),
+                                       totalTrainingSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, chosenMinibatchSize,
+                                       /*readerSamplePosition=*/SIZE_MAX, obsoleteFiles);
             }
         }
         else
@@ -796,6 +855,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
 
     // Synchronize all ranks before proceeding to ensure that
     // rank 0 has finished writing the model file
+    WaitForPendingCheckPoints();
     // TODO[DataASGD]: should othet other rank waiting in async-mode
     SynchronizeWorkers();
 
@@ -897,6 +957,14 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         trainSetDataReader->StartMinibatchLoop(tunedMBSize, epochNumber, inputMatrices->GetStreamDescriptions(), epochSize);
     }
 
+    // continue an epoch that was interrupted after an intermediate checkpoint where that checkpoint left off
+    // (not while searching learning rate or minibatch size, which does not happen for a resumed epoch)
+    if (m_resumeReaderSamplePosition != SIZE_MAX && maxNumberOfSamples == SIZE_MAX)
+    {
+        trainSetDataReader->SetCurrentSamplePosition(m_resumeReaderSamplePosition);
+        m_resumeReaderSamplePosition = SIZE_MAX;
+    }
+
     net->StartEvaluateMinibatchLoop(evaluationNodes);
     net->StartEvaluateMinibatchLoop(criterionNodes);
     if (m_needAdaptRegularization && m_adaptationRegType == AdaptationRegType::KL && refNode)
@@ -1024,6 +1092,10 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         if (!wasDataRead)
             actualMBSize = 0; // (undefined if !wasDataRead)
 
+        // bring the columns of sharded parameters referenced by this minibatch up to date (collective)
+        for (const auto& shardedParameter : m_shardedParameters)
+            shardedParameter.second->FetchColumns(actualMBSize > 0);
+
         nSamplesSinceLastModelSync += actualMBSize;
 
         // Dropout nodes have an implicit input in the form of the random mask that is applied to its explicit input
@@ -1154,7 +1226,7 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                 for (auto nodeIter = learnableNodes.begin(); nodeIter != learnableNodes.end(); nodeIter++)
                 {
                     ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(*nodeIter);
-                    if (node->IsParameterUpdateRequired())
+                    if (node->IsParameterUpdateRequired() && !GetShardedParameter(node)) // sharded parameters exchange their gradients themselves
                     {
                         Matrix<ElemType>* currParamsGradient = &(node->Gradient()); // TODO: we can use shared_ptrs now
 
@@ -1238,6 +1310,17 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                     double nodeDependentLearningRatePerSample = learnRatePerSample * node->GetLearningRateMultiplier();
                     double nodeDependentRegMultiplier = dynamic_pointer_cast<LearnableParameter<ElemType>>(node)->GetRegMultiplier();
                     double momentumPerSample = GetMomentumPerSample(epochNumber /*BUGBUG workaround:*/, net->GetMBLayoutPtrOfNetwork()->GetNumParallelSequences());
+                    auto shardedParameter = GetShardedParameter(node);
+                    if (shardedParameter)
+                    {
+                        UpdateShardedWeights(*shardedParameter, actualMBSize > 0,
+                                             *smoothedGradientIter, *smoothedCountIter,
+                                             nodeDependentLearningRatePerSample, momentumPerSample,
+                                             numSamplesInMinibatch,
+                                             m_L2RegWeight * nodeDependentRegMultiplier, m_L1RegWeight * nodeDependentRegMultiplier);
+                        node->BumpEvalTimeStamp();
+                        continue;
+                    }
                     // TODO: Check why l2Factor is not applied to L1. Bug?
                     // BUGBUG (Issue #95): Access to net MBLayout can no longer be done if we have multiple input layouts
                     UpdateWeights(dynamic_pointer_cast<ComputationNode<ElemType>>(node)->Value(),
@@ -1256,6 +1339,10 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
             }
         }
 
+        // give the sparse inputs of sharded parameters back to the reader
+        for (const auto& shardedParameter : m_shardedParameters)
+            shardedParameter.second->ReleaseColumns();
+
 
         if (m_perfTraceLevel > 0)
         {
@@ -1421,6 +1508,26 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         timer.Restart();
         totalEpochSamples += aggregateNumSamplesWithLabel;
 
+        // intermediate checkpoint every checkpointFrequencyInSamples samples (not while searching learning rate or minibatch size)
+        // In case of parallel training only the main node writes, and with asyncCheckpointing it does not hold up the others.
+        bool writeIntermediateCheckPoint = m_checkpointFrequencyInSamples > 0 && !shouldCheckEarlyExit &&
+            totalEpochSamples / m_checkpointFrequencyInSamples != (totalEpochSamples - aggregateNumSamplesWithLabel) / m_checkpointFrequencyInSamples;
+        if (writeIntermediateCheckPoint)
+        {
+            // collective; all workers see the same aggregated sample count
+            GatherShardedParameters();
+            GatherShardedSmoothedGradients(smoothedGradients);
+        }
+        if (writeIntermediateCheckPoint && ((m_mpi == nullptr) || m_mpi->IsMainNode()))
+        {
+            // Note: the check-point info is that of the previous epoch, updated to the samples seen so far, plus the reader
+            // position to continue this epoch at.
+            SaveModelAndCheckPoint(net, GetIntermediateModelNameForEpoch(epochNumber), GetIntermediateCheckPointFileNameForEpoch(epochNumber),
+                                   m_epochStartTotalSamplesSeen + totalEpochSamples, learnRatePerSample, smoothedGradients, smoothedCounts,
+                                   m_epochStartPrevCriterion, tunedMBSize,
+                                   trainSetDataReader->GetCurrentSamplePosition(), std::vector<wstring>());
+        }
+
         // call DataEnd function
         // This signals something from SGD to the reader.
         // DataEnd does reader specific process if sentence ending is reached
@@ -1633,6 +1740,7 @@ double SGD<ElemType>::SearchForBestLearnRate(ComputationNetworkPtr net,
 
     int baseModelEpoch = epochNumber - 1;
     net->RereadPersistableParameters<ElemType>(GetModelNameForEpoch(baseModelEpoch));
+    ResetShardedParameters();
 
     double learnRate = learnRatePerSample;
     size_t dummyMinibatchSize;            // (not used)
@@ -2012,6 +2120,7 @@ void SGD<ElemType>::TrainOneMiniEpochAndReloadModel(ComputationNetworkPtr net,
     let path = GetModelNameForEpoch(baseModelEpoch);
     //fprintf(stderr, "Reverting parameters back to %ls\n", path.c_str());
     net->RereadPersistableParameters<ElemType>(path);
+    ResetShardedParameters();
 
     double dummyLearnRate;
     double dummyPrevCriterion;
@@ -2063,6 +2172,9 @@ void SGD<ElemType>::InitDistGradAgg(int numEvalNodes, int numGradientBits, int d
 {
     assert(GetParallelizationMethod() == ParallelizationMethod::dataParallelSGD);
 
+    if (m_numBackupWorkers > 0 && (numGradientBits != (8 * sizeof(ElemType)) || Globals::UseV2Aggregator()))
+        InvalidArgument("backupWorkers is only supported with FP%d aggregation by the V1 aggregator.", (int)(8 * sizeof(ElemType)));
+
     if (numGradientBits != (8 * sizeof(ElemType)))
     {
         if (traceLevel > 0)
@@ -2086,12 +2198,134 @@ void SGD<ElemType>::InitDistGradAgg(int numEvalNodes, int numGradientBits, int d
         if (Globals::UseV2Aggregator()) // Currently used to check V2 against baselines.
             m_distGradAgg = std::make_shared<V2SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, m_syncStatsTrace, ::CNTK::MPICommunicator());
         else
-            m_distGradAgg = std::make_shared<SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, deviceId, m_syncStatsTrace);
+        {
+            if (traceLevel > 0 && m_numBackupWorkers > 0)
+                fprintf(stderr, "Aggregating gradients of the first %d of %d workers; late gradients are %s.\n",
+                        (int)(m_mpi->NumNodesInUse() - m_numBackupWorkers), (int)m_mpi->NumNodesInUse(), m_dropLateGradients ? "dropped" : "folded into the next round");
+            m_distGradAgg = std::make_shared<SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, deviceId, m_syncStatsTrace, m_numBackupWorkers, m_dropLateGradients);
+        }
     }
 
     m_gradHeader.reset(DistGradHeader::Create(numEvalNodes), [](DistGradHeader* ptr) { DistGradHeader::Destroy(ptr); });
 }
 
+template <class ElemType>
+void SGD<ElemType>::InitShardedParameters(const ComputationNetworkPtr& net, const std::list<ComputationNodeBasePtr>& learnableNodes)
+{
+    m_shardedParameters.clear();
+    if (m_shardedParameterNames.empty())
+        return;
+
+    if (GetParallelizationMethod() != ParallelizationMethod::dataParallelSGD || m_mpi == nullptr)
+        InvalidArgument("shardedParameters requires DataParallelSGD.");
+    if (m_parallelizationStartEpochNum > 0)
+        InvalidArgument("shardedParameters requires parallelizationStartEpoch = 1.");
+    if (m_gradType.type != GradientsUpdateType::None && m_gradType.type != GradientsUpdateType::AdaGrad)
+        InvalidArgument("shardedParameters supports only the plain SGD/momentum and AdaGrad update rules.");
+    if (m_maxSamplesInRAM < SIZE_MAX || m_numSubminiBatches > 1)
+        InvalidArgument("shardedParameters cannot be combined with sub-minibatches (maxSamplesInRAM, numSubminibatches).");
+
+    for (const auto& name : m_shardedParameterNames)
+    {
+        auto node = net->GetNodeFromName(name);
+        auto nodeIter = std::find(learnableNodes.begin(), learnableNodes.end(), node);
+        if (nodeIter == learnableNodes.end())
+            InvalidArgument("shardedParameters: '%ls' is not a learnable parameter of the training criterion.", name.c_str());
+
+        auto shardedParameter = make_shared<ShardedParameter<ElemType>>(m_mpi, node, net->GetAllNodes());
+        m_shardedParameters.push_back(make_pair((size_t)std::distance(learnableNodes.begin(), nodeIter), shardedParameter));
+        if (m_traceLevel > 0)
+            LOGPRINTF(stderr, "Sharding parameter %ls [%d x %d] across %d workers; this worker owns columns [%d, %d).\n",
+                      name.c_str(), (int)node->GetAsMatrixNumRows(), (int)node->GetAsMatrixNumCols(), (int)m_mpi->NumNodesInUse(),
+                      (int)shardedParameter->FirstOwnedColumn(), (int)(shardedParameter->FirstOwnedColumn() + shardedParameter->NumOwnedColumns()));
+    }
+}
+
+template <class ElemType>
+std::shared_ptr<ShardedParameter<ElemType>> SGD<ElemType>::GetShardedParameter(const ComputationNodeBasePtr& node) const
+{
+    for (const auto& shardedParameter : m_shardedParameters)
+        if (shardedParameter.second->Node() == node)
+            return shardedParameter.second;
+    return nullptr;
+}
+
+// collective: every worker receives all columns of all sharded parameters
+template <class ElemType>
+void SGD<ElemType>::GatherShardedParameters()
+{
+    for (const auto& shardedParameter : m_shardedParameters)
+        shardedParameter.second->AllGatherColumns();
+}
+
+// after the full parameters were (re)loaded into the network
+template <class ElemType>
+void SGD<ElemType>::ResetShardedParameters()
+{
+    for (const auto& shardedParameter : m_shardedParameters)
+        shardedParameter.second->ResetShard();
+}
+
+// collective: the main node receives the complete optimizer state of the sharded parameters, to write it into checkpoints
+template <class ElemType>
+void SGD<ElemType>::GatherShardedSmoothedGradients(const std::list<Matrix<ElemType>>& smoothedGradients)
+{
+    for (const auto& shardedParameter : m_shardedParameters)
+        shardedParameter.second->GatherState(*std::next(smoothedGradients.begin(), shardedParameter.first));
+}
+
+// after reading a checkpoint, which holds the complete optimizer state of the sharded parameters: keep the owned columns
+template <class ElemType>
+void SGD<ElemType>::SetShardedSmoothedGradients(std::list<Matrix<ElemType>>& smoothedGradients) const
+{
+    for (const auto& shardedParameter : m_shardedParameters)
+    {
+        auto& smoothedGradient = *std::next(smoothedGradients.begin(), shardedParameter.first);
+        if (smoothedGradient.GetNumCols() == shardedParameter.second->NumColumns())
+        {
+            Matrix<ElemType> state = smoothedGradient.DeepClone();
+            shardedParameter.second->SetState(state, smoothedGradient);
+        }
+        else
+        {
+            // checkpoints written before the state was gathered only hold the main node's columns
+            LOGPRINTF(stderr, "Warning: Checkpoint has no complete optimizer state for sharded parameter %ls. Its parameter-learning state will be reset.\n",
+                      shardedParameter.second->Node()->NodeName().c_str());
+            smoothedGradient.Resize(smoothedGradient.GetNumRows(), shardedParameter.second->NumOwnedColumns());
+            smoothedGradient.SetValue(0);
+        }
+    }
+}
+
+// update of a sharded parameter: exchanges the gradients (collective), then updates the touched columns of the local shard.
+// Momentum, regularization and AdaGrad state are applied lazily, i.e. only to columns that received a gradient.
+template <class ElemType>
+void SGD<ElemType>::UpdateShardedWeights(ShardedParameter<ElemType>& parameter, bool hasGradient,
+                                         Matrix<ElemType>& smoothedGradient, double& smoothedCount,
+                                         const double learnRatePerSample, const double momentumPerSample,
+                                         size_t actualMBSize,
+                                         const double L2RegWeight, const double L1RegWeight)
+{
+    DEVICEID_TYPE deviceId = parameter.Node()->GetDeviceId();
+    std::vector<size_t> columns;
+    Matrix<ElemType> gradient(deviceId);
+    if (parameter.ExchangeGradients(hasGradient, columns, gradient) == 0)
+        return;
+
+    Matrix<ElemType> idx(deviceId);
+    parameter.SetIndexMatrix(idx, columns, 0);
+    Matrix<ElemType> values(deviceId);
+    Matrix<ElemType> smoothedValues(deviceId);
+    values.DoGatherColumnsOf(0, idx, parameter.Shard(), 1);
+    smoothedValues.DoGatherColumnsOf(0, idx, smoothedGradient, 1);
+    UpdateWeights(values, gradient, smoothedValues, smoothedCount,
+                  learnRatePerSample, momentumPerSample, actualMBSize,
+                  L2RegWeight, L1RegWeight,
+                  m_needAveMultiplier, m_useNesterovMomentum);
+    ShardedParameter<ElemType>::AssignColumns(parameter.Shard(), columns, values);
+    ShardedParameter<ElemType>::AssignColumns(smoothedGradient, columns, smoothedValues);
+}
+
 template <class ElemType>
 void SGD<ElemType>::InitModelAggregationHandler(int traceLevel, DEVICEID_TYPE devID)
 {
@@ -2101,7 +2335,10 @@ void SGD<ElemType>::InitModelAggregationHandler(int traceLevel, DEVICEID_TYPE de
     }
     if (GetParallelizationMethod() == ParallelizationMethod::modelAveragingSGD)
     {
-        m_pMASGDHelper = make_shared<BasicModelAveragingSGD<ElemType>>(m_mpi, traceLevel, devID);
+        if (m_useAsyncModelAggregation)
+            m_pMASGDHelper = make_shared<AsyncModelAveragingSGD<ElemType>>(m_mpi, traceLevel, devID);
+        else
+            m_pMASGDHelper = make_shared<BasicModelAveragingSGD<ElemType>>(m_mpi, traceLevel, devID);
     }
     else if (GetParallelizationMethod() == ParallelizationMethod::blockMomentumSGD)
     {
@@ -2252,66 +2489,139 @@ void SGD<ElemType>::ClipGradient(Matrix<ElemType>& gradient, const size_t actual
 }
 
 template <class ElemType>
-void SGD<ElemType>::SaveCheckPointInfo(const size_t epoch, const size_t totalSamplesSeen,
+void SGD<ElemType>::SaveCheckPointInfo(const wstring& checkPointFileName, const size_t totalSamplesSeen,
                                        const double learnRatePerSample,
                                        const std::list<Matrix<ElemType>>& smoothedGradients,
                                        const std::vector<double>& smoothedCounts,
                                        const double prevCriterion,
-                                       const size_t minibatchSize)
+                                       const size_t minibatchSize,
+                                       const size_t readerSamplePosition)
 {
     // In case of parallel training only the main node should we saving the checkpoint to prevent
     // the parallel training nodes from colliding to write the same file
     if ((m_mpi == nullptr) || m_mpi->IsMainNode())
     {
-        wstring checkPointFileName = GetCheckPointFileNameForEpoch(int(epoch));
         // Saving into temporary file and then renaming it to the checkPointFileName
-        // This is a standard trick to avoid havign corrupted checkpoints files if process dies during writing
+        // This is a standard trick to avoid having corrupted checkpoints files if process dies during writing
         wstring tempFileName = checkPointFileName + L".tmp";
 
         {
             File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
             // Buffer writes in memory then flush to filesystem, which reduces number of small writes
             fstream.Setvbuf();
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
-            fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
+            WriteCheckPointInfo(fstream, totalSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, minibatchSize, readerSamplePosition);
+        }
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
-            fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
+        _wunlink(checkPointFileName.c_str());
+        renameOrDie(tempFileName, checkPointFileName);
+    }
+}
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
-            fstream << minibatchSize;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
+template <class ElemType>
+void SGD<ElemType>::WriteCheckPointInfo(File& fstream, const size_t totalSamplesSeen,
+                                        const double learnRatePerSample,
+                                        const std::list<Matrix<ElemType>>& smoothedGradients,
+                                        const std::vector<double>& smoothedCounts,
+                                        const double prevCriterion,
+                                        const size_t minibatchSize,
+                                        const size_t readerSamplePosition)
+{
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
+    fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
+    fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
 
-            for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
-            {
-                const Matrix<ElemType>& smoothedGradient = *smoothedGradientIter;
-                fstream << smoothedGradient;
-            }
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
+    fstream << minibatchSize;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"BCount");
+    // sharded parameters only keep their own columns in smoothedGradients; the checkpoint holds the complete state
+    size_t index = 0;
+    for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++, index++)
+    {
+        auto shardedParameter = std::find_if(m_shardedParameters.begin(), m_shardedParameters.end(), [index](const std::pair<size_t, std::shared_ptr<ShardedParameter<ElemType>>>& p) { return p.first == index; });
+        const Matrix<ElemType>& smoothedGradient = (shardedParameter != m_shardedParameters.end()) ? shardedParameter->second->GatheredState() : *smoothedGradientIter;
+        fstream << smoothedGradient;
+    }
 
-            for (auto sc : smoothedCounts)
-                fstream << sc;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECount");
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"BCount");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
-            if (m_pMASGDHelper)
-                m_pMASGDHelper->SaveToCheckPoint(fstream);
-            // Ensuring that data is written
-            fstream.Flush();
-        }
+    for (auto sc : smoothedCounts)
+        fstream << sc;
+
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECount");
+
+    if (readerSamplePosition != SIZE_MAX)
+    {
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BSamplePosition");
+        fstream << readerSamplePosition;
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ESamplePosition");
+    }
+
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
+    if (m_pMASGDHelper)
+        m_pMASGDHelper->SaveToCheckPoint(fstream);
+    // Ensuring that data is written
+    fstream.Flush();
+}
 
+template <class ElemType>
+void SGD<ElemType>::SaveModelAndCheckPoint(ComputationNetworkPtr net, const wstring& modelName, const wstring& checkPointFileName,
+                                           const size_t totalSamplesSeen,
+                                           const double learnRatePerSample,
+                                           const std::list<Matrix<ElemType>>& smoothedGradients,
+                                           const std::vector<double>& smoothedCounts,
+                                           const double prevCriterion,
+                                           const size_t minibatchSize,
+                                           const size_t readerSamplePosition,
+                                           const std::vector<wstring>& obsoleteFiles)
+{
+    if (m_traceLevel > 0)
+        LOGPRINTF(stderr, "SGD: Saving checkpoint model '%ls'%s\n", modelName.c_str(), m_asyncCheckpointing ? " in the background" : "");
+
+    if (!m_asyncCheckpointing)
+    {
         _wunlink(checkPointFileName.c_str());
-        renameOrDie(tempFileName, checkPointFileName);
+        net->Save(modelName);
+        SaveCheckPointInfo(checkPointFileName, totalSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, minibatchSize, readerSamplePosition);
+
+        for (const auto& obsoleteFile : obsoleteFiles)
+            _wunlink(obsoleteFile.c_str());
+        return;
     }
+
+    // Take a snapshot of everything into host memory. This is the only part that blocks training;
+    // serializing to disk and fsync'ing happens on the writer thread.
+    Timer snapshotTimer;
+    snapshotTimer.Start();
+    std::unique_ptr<CheckpointSnapshot> snapshot(new CheckpointSnapshot());
+    snapshot->DeleteBeforeWriting(checkPointFileName);
+    net->Save(snapshot->AddFile(modelName));
+    WriteCheckPointInfo(snapshot->AddFile(checkPointFileName), totalSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, minibatchSize, readerSamplePosition);
+    for (const auto& obsoleteFile : obsoleteFiles)
+        snapshot->DeleteAfterWriting(obsoleteFile);
+    snapshotTimer.Stop();
+    if (m_traceLevel > 0)
+        LOGPRINTF(stderr, "SGD: Checkpoint snapshot of %.1f MB taken in %.2f seconds.\n", snapshot->SizeInBytes() / (1024.0 * 1024.0), snapshotTimer.ElapsedSeconds());
+
+    if (!m_checkpointWriter)
+        m_checkpointWriter.reset(new AsyncCheckpointWriter(m_traceLevel));
+    m_checkpointWriter->Write(std::move(snapshot));
+}
+
+template <class ElemType>
+void SGD<ElemType>::WaitForPendingCheckPoints()
+{
+    if (m_checkpointWriter)
+        m_checkpointWriter->Wait();
 }
 
 template <class ElemType>
@@ -2352,7 +2662,19 @@ void SGD<ElemType>::LoadCheckPointInfo(const size_t epochNumber,
                                        /*out*/ double& prevCriterion,
                                        /*out*/ size_t& minibatchSize)
 {
-    let checkPointFileName = GetCheckPointFileNameForEpoch(int(epochNumber));
+    LoadCheckPointInfo(GetCheckPointFileNameForEpoch(int(epochNumber)), epochNumber,
+                       totalSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, minibatchSize);
+}
+
+template <class ElemType>
+void SGD<ElemType>::LoadCheckPointInfo(const wstring& checkPointFileName, const size_t epochNumber,
+                                       /*out*/ size_t& totalSamplesSeen,
+                                       /*out*/ double& learnRatePerSample,
+                                       std::list<Matrix<ElemType>>& smoothedGradients,
+                                       std::vector<double>& smoothedCounts,
+                                       /*out*/ double& prevCriterion,
+                                       /*out*/ size_t& minibatchSize)
+{
     //fprintf(stderr, "Loading checkpoint info from %ls\n", checkPointFileName.c_str());
     File fstream(checkPointFileName,
                  FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
@@ -2399,6 +2721,14 @@ void SGD<ElemType>::LoadCheckPointInfo(const size_t epochNumber,
     else // deal with legacy checkpoints
         std::fill(smoothedCounts.begin(), smoothedCounts.end(), static_cast<double>(minibatchSize));
 
+    // only intermediate checkpoints record where in the epoch to continue
+    m_resumeReaderSamplePosition = SIZE_MAX;
+    if (fstream.TryGetMarker(FileMarker::fileMarkerBeginSection, L"BSamplePosition"))
+    {
+        fstream >> m_resumeReaderSamplePosition;
+        fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ESamplePosition");
+    }
+
     fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ECKP");
 
     if (m_pMASGDHelper)
@@ -2406,6 +2736,8 @@ void SGD<ElemType>::LoadCheckPointInfo(const size_t epochNumber,
         m_pMASGDHelper->LoadFromCheckPoint(fstream);
     }
 
+    SetShardedSmoothedGradients(smoothedGradients);
+
     return;
 }
 
@@ -2415,6 +2747,19 @@ wstring SGD<ElemType>::GetCheckPointFileNameForEpoch(const int epoch)
     return GetModelNameForEpoch(epoch) + L".ckp";
 }
 
+// model written by intermediate checkpoints within an epoch (checkpointFrequencyInSamples); replaced by the epoch's model
+template <class ElemType>
+wstring SGD<ElemType>::GetIntermediateModelNameForEpoch(const int epoch)
+{
+    return GetModelNameForEpoch(epoch) + L".intermediate";
+}
+
+template <class ElemType>
+wstring SGD<ElemType>::GetIntermediateCheckPointFileNameForEpoch(const int epoch)
+{
+    return GetIntermediateModelNameForEpoch(epoch) + L".ckp";
+}
+
 template <class ElemType>
 wstring SGD<ElemType>::GetModelNameForEpoch(const int epoch, bool bLastModel)
 {
@@ -2460,9 +2805,32 @@ int SGD<ElemType>::DetermineStartEpoch(const bool makeMode)
     if (firstEpoch == m_maxEpochs)
         LOGPRINTF(stderr, "Final model exists: %ls\n", GetModelNameForEpoch(firstEpoch - 1).c_str());
 
+    // Was the first epoch to train interrupted after an intermediate checkpoint? The check-point info file is
+    // written after the model, hence its presence means that the intermediate model is complete.
+    // This includes the first epoch, whose initial model may not exist if it was never saved.
+    m_resumeFromIntermediateCheckPoint = false;
+    if (firstEpoch < (int) m_maxEpochs)
+    {
+        const int epoch = max(firstEpoch, 0);
+        const wstring intermediateModelFile = GetIntermediateModelNameForEpoch(epoch);
+        if (fexists(GetIntermediateCheckPointFileNameForEpoch(epoch).c_str()) &&
+            msra::files::fuptodate(intermediateModelFile, GetModelNameForEpoch(epoch - 1), false))
+        {
+            LOGPRINTF(stderr, "Intermediate checkpoint of epoch %d exists: %ls\n", epoch + 1, intermediateModelFile.c_str());
+            m_resumeFromIntermediateCheckPoint = true;
+            firstEpoch = epoch;
+        }
+    }
+
     return firstEpoch;
 }
 
+template <class ElemType>
+wstring SGD<ElemType>::GetModelNameForStartEpoch(const int startEpoch)
+{
+    return m_resumeFromIntermediateCheckPoint ? GetIntermediateModelNameForEpoch(startEpoch) : GetModelNameForEpoch(startEpoch - 1);
+}
+
 #define EPSILON 1e-5
 
 // this probes the automatic gradient computation with random inputs
@@ -2619,7 +2987,6 @@ static LearningRateSearchAlgorithm ParseLearningRateSearchType(const wstring& s)
     else InvalidArgument("autoAdjustLR: Invalid learning rate search type. Valid values are (none | searchBeforeEpoch | adjustAfterEpoch)");
 }
   
-#ifdef ASGD_PARALLEL_SUPPORT
 static AdjustLearningRateAtBeginning AdjustLearningRateAtBeginningType(const wstring& s)
 {
     if      (EqualCI(s.c_str(), L"") || EqualCI(s.c_str(), L"none")) return AdjustLearningRateAtBeginning::None;
@@ -2627,7 +2994,6 @@ static AdjustLearningRateAtBeginning AdjustLearningRateAtBeginningType(const wst
     else if (EqualCI(s.c_str(), L"staircase"))                       return AdjustLearningRateAtBeginning::Staircase;
     else InvalidArgument("AdjustLearningRateatBeginningType: Invalid Type. Valid values are (None | Linearly | Staircase)");
 }
-#endif
   
 template<class ConfigRecordType>
 SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
@@ -2874,9 +3240,12 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_numGradientBits = vector<int>{8 * (int)sizeofElemType}; // means no quantization
     m_zeroThresholdFor1Bit = true;
     m_bufferedAsyncGradientAggregation = false;
+    m_numBackupWorkers = 0;
+    m_dropLateGradients = false;
     m_enableDistributedMBReading = false;
     m_parallelizationStartEpochNum = 0;
     m_modelAggregationBlockSize = 0; 
+    m_useAsyncModelAggregation = false;
 
     if (configSGD.Exists(L"ParallelTrain"))
     {
@@ -2907,6 +3276,23 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
             m_numGradientBits = configDataParallelSGD(L"gradientBits", ConfigRecordType::Array(intargvector(vector<int>{defaultGradientBits})));
             m_zeroThresholdFor1Bit = configDataParallelSGD(L"useZeroThresholdFor1BitQuantization", true);
             m_bufferedAsyncGradientAggregation = configDataParallelSGD(L"useBufferedAsyncGradientAggregation", false);
+            m_shardedParameterNames = configDataParallelSGD(L"shardedParameters", ConfigRecordType::Array(stringargvector()));
+            // straggler tolerance: proceed with the gradients of the first N-backupWorkers workers; late ones are folded into the next round, or dropped
+            m_numBackupWorkers = configDataParallelSGD(L"backupWorkers", (size_t)0);
+            wstring lateGradients = configDataParallelSGD(L"lateGradients", L"fold");
+            if (EqualCI(lateGradients, L"drop"))
+                m_dropLateGradients = true;
+            else if (!EqualCI(lateGradients, L"fold"))
+                InvalidArgument("lateGradients: Invalid value. Valid values are (fold | drop)");
+            if (m_numBackupWorkers > 0)
+            {
+                if (m_numBackupWorkers >= numMPIWorkers)
+                    InvalidArgument("backupWorkers must be less than the number of workers (%d).", (int)numMPIWorkers);
+                if (m_bufferedAsyncGradientAggregation)
+                    InvalidArgument("backupWorkers cannot be combined with useBufferedAsyncGradientAggregation.");
+                if (!m_shardedParameterNames.empty())
+                    InvalidArgument("backupWorkers cannot be combined with shardedParameters.");
+            }
             for (size_t i = 0; i < m_numGradientBits.size(); i++)
             {
                 if (m_numGradientBits[i] < 1 || m_numGradientBits[i] > defaultGradientBits)
@@ -2945,6 +3331,7 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
                 fprintf(stderr, "WARNING: option syncPeroid in ModelAveragingSGD is going to be deprecated. Please use blockSizePerWorker instead in the future.\n");
             }
 #endif
+            m_useAsyncModelAggregation = configMASGD(L"useAsyncModelAggregation", false);
         }
         if (configParallelTrain.Exists(L"BlockMomentumSGD"))
         {
@@ -3002,13 +3389,15 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
 
         if (configParallelTrain.Exists(L"DataParallelASGD"))
         {
-#ifndef ASGD_PARALLEL_SUPPORT
-            InvalidArgument("DataParallelASGD is not enabled in this version.\n");
-#else
+            // without Multiverso, the workers serve the model to each other through MPI one-sided communication (see ASGDHelper.cpp)
             const ConfigRecordType & configDataParallelASGD(configParallelTrain(L"DataParallelASGD", ConfigRecordType::Record()));
             m_nFramesBetweenASGDSync = configDataParallelASGD(L"syncPeriod", ConfigRecordType::Array(intargvector(vector<int>{256})));
             m_isAsyncBufferEnabled = configDataParallelASGD(L"UsePipeline", false);
             m_isSimulateMA = configDataParallelASGD(L"SimModelAverage", false); // using parameter server-based version of ModefAveragingSGD
+            m_maxStaleness = configDataParallelASGD(L"maxStaleness", (size_t)0); // max #syncs a worker may run ahead of the slowest one; 0 means unbounded
+            m_adjustLearningRateAtBeginning = AdjustLearningRateAtBeginning::None;
+            m_adjustCoefficient = 0.1;
+            m_adjustPerMinibatches = 256;
             if (configDataParallelASGD.Exists(L"AdjustLearningRateAtBeginning")) // adjust learning rate per m_adjustNumInBatch minibatchs until to original one
                                                                                  // this option could be used to takcle the unstableness of ASGD
             {
@@ -3017,7 +3406,6 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
                 m_adjustCoefficient = configAdjustLearningRateAtBeginning(L"adjustCoefficient", (double)0.1);
                 m_adjustPerMinibatches = configAdjustLearningRateAtBeginning(L"adjustPerMinibatches", (size_t)256);
             }
-#endif
         }
         } // if (!pMPI)
     } // if (configSGD.Exists(L"ParallelTrain"))
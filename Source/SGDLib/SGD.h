@@ -20,6 +20,8 @@
 #include "Profiler.h"
 #include "MASGD.h"
 #include "ASGDHelper.h"
+#include "AsyncCheckpointWriter.h"
+#include "ShardedParameter.h"
 using namespace std; // ugh! TODO: get rid of this from .h files!!!
 
 #define CNTK_CHECKPOINT_VERSION_1 1     // 1 -> no version number 
@@ -275,9 +277,13 @@ protected:
     intargvector m_numGradientBits;
     bool m_bufferedAsyncGradientAggregation;
     bool m_zeroThresholdFor1Bit;
+    std::vector<std::wstring> m_shardedParameterNames; // embeddings whose columns are distributed across the workers instead of replicated
+    size_t m_numBackupWorkers;                          // gradient aggregation does not wait for the slowest m_numBackupWorkers workers
+    bool m_dropLateGradients;                           // discard, rather than fold in, gradients that missed their round
 
     // Parallel training related with MA / BM
     size_t m_modelAggregationBlockSize;
+    bool   m_useAsyncModelAggregation;   // ModelAveragingSGD: overlap the averaging with training on local data
     bool   m_resetSGDMomentum; 
     bool   m_useNesterovBlockMomentum;
     double m_blockLearningRate; 
@@ -294,6 +300,7 @@ protected:
     AdjustLearningRateAtBeginning m_adjustLearningRateAtBeginning;
     double m_adjustCoefficient;
     size_t m_adjustPerMinibatches;
+    size_t m_maxStaleness;
 
     // sequence training
     double m_hSmoothingWeight;
@@ -335,6 +342,12 @@ public:
           // TODO: The next few do not belong into SGD any more than the network or reader we operate on. Either move network and reader in here, or move these out.
           m_modelPath((const wstring&) configSGD(L"modelPath")),
           m_keepCheckPointFiles(configSGD(L"keepCheckPointFiles", false)),
+          m_asyncCheckpointing(configSGD(L"asyncCheckpointing", false)),
+          m_checkpointFrequencyInSamples(configSGD(L"checkpointFrequencyInSamples", (size_t)0)),
+          m_resumeFromIntermediateCheckPoint(false),
+          m_resumeReaderSamplePosition(SIZE_MAX),
+          m_epochStartTotalSamplesSeen(0),
+          m_epochStartPrevCriterion(0),
           m_trainCriterionNodeName((const wstring&) configSGD(L"trainCriterionNodeName", L"")),
           m_evalCriterionNodeName ((const wstring&) configSGD(L"evalCriterionNodeName", L"")),
           m_traceNodeNamesReal    (configSGD(L"traceNodeNamesReal",     ConfigRecordType::Array(stringargvector()))),
@@ -346,6 +359,13 @@ public:
           m_gradHeader(nullptr)
     {
         msra::files::make_intermediate_dirs(m_modelPath);
+#ifdef _WIN32
+        if (m_asyncCheckpointing)
+        {
+            fprintf(stderr, "WARNING: asyncCheckpointing is not supported on Windows; checkpoints will be written synchronously.\n");
+            m_asyncCheckpointing = false;
+        }
+#endif
     }
     // note: This must be in the header, as we cannot properly specialize this constructor in the CPP to make sure all versions are generated.
 
@@ -493,6 +513,17 @@ protected:
 
     void InitDistGradAgg(int numEvalNodes, int numGradientBits, int deviceId, int traceLevel);
     void InitModelAggregationHandler(int traceLevel, DEVICEID_TYPE devID);
+    void InitShardedParameters(const ComputationNetworkPtr& net, const std::list<ComputationNodeBasePtr>& learnableNodes);
+    std::shared_ptr<ShardedParameter<ElemType>> GetShardedParameter(const ComputationNodeBasePtr& node) const;
+    void GatherShardedParameters();
+    void ResetShardedParameters();
+    void GatherShardedSmoothedGradients(const std::list<Matrix<ElemType>>& smoothedGradients);
+    void SetShardedSmoothedGradients(std::list<Matrix<ElemType>>& smoothedGradients) const;
+    void UpdateShardedWeights(ShardedParameter<ElemType>& parameter, bool hasGradient,
+                              Matrix<ElemType>& smoothedGradient, double& smoothedCount,
+                              const double learnRatePerSample, const double momentumPerSample,
+                              size_t actualMBSize,
+                              const double L2RegWeight, const double L1RegWeight);
 public:
     // UpdateWeights() - actual weight update, implementing various update rules
     void UpdateWeights(Matrix<ElemType>& functionValues, Matrix<ElemType>& gradientValues,
@@ -505,17 +536,47 @@ public:
     // return -1 if nothing exists
     int DetermineStartEpoch(const bool makeMode);
 
+    // the model to load for continuing at the epoch returned by DetermineStartEpoch(): the intermediate checkpoint
+    // of that epoch if training was interrupted in its middle, otherwise the model of the previous epoch
+    wstring GetModelNameForStartEpoch(const int startEpoch);
+
     wstring GetModelNameForEpoch(const int epoch, bool bLastModel = false);
 
 protected:
     void ClipGradient(Matrix<ElemType>& gradient, const size_t actualMBSize) const;
 
-    void SaveCheckPointInfo(const size_t epoch, const size_t totalSamplesSeen, // TODO: combine totalSamplesSeen and prevCriterion into a EpochCriterion type
+    void SaveCheckPointInfo(const wstring& checkPointFileName, const size_t totalSamplesSeen, // TODO: combine totalSamplesSeen and prevCriterion into a EpochCriterion type
                             const double learnRatePerSample,
                             const std::list<Matrix<ElemType>>& smoothedGradients,
                             const std::vector<double>& smoothedCounts,
                             const double prevCriterion,
-                            const size_t minibatchSize);
+                            const size_t minibatchSize,
+                            const size_t readerSamplePosition = SIZE_MAX);
+    // readerSamplePosition - for intermediate checkpoints, the reader position to continue the epoch at; SIZE_MAX otherwise
+    void WriteCheckPointInfo(File& fstream, const size_t totalSamplesSeen,
+                             const double learnRatePerSample,
+                             const std::list<Matrix<ElemType>>& smoothedGradients,
+                             const std::vector<double>& smoothedCounts,
+                             const double prevCriterion,
+                             const size_t minibatchSize,
+                             const size_t readerSamplePosition = SIZE_MAX);
+
+    // persist model and check-point info; with asyncCheckpointing this only takes a host-side snapshot
+    // and the files are written by m_checkpointWriter in the background.
+    // The check-point info file is removed before and written after the model, so that it always belongs to the model next to it.
+    // 'obsoleteFiles' are deleted once the new files are on disk.
+    void SaveModelAndCheckPoint(ComputationNetworkPtr net, const std::wstring& modelName, const std::wstring& checkPointFileName,
+                                const size_t totalSamplesSeen,
+                                const double learnRatePerSample,
+                                const std::list<Matrix<ElemType>>& smoothedGradients,
+                                const std::vector<double>& smoothedCounts,
+                                const double prevCriterion,
+                                const size_t minibatchSize,
+                                const size_t readerSamplePosition,
+                                const std::vector<std::wstring>& obsoleteFiles);
+
+    // wait until all checkpoints written in the background are on disk
+    void WaitForPendingCheckPoints();
 
     bool TryLoadCheckPointInfo(const size_t epochNumber,
                                /*out*/ size_t& totalSamplesSeen,
@@ -531,8 +592,18 @@ protected:
                             std::vector<double>& smoothedCounts,
                             /*out*/ double& prevCriterion,
                             /*out*/ size_t& minibatchSize);
+    // also sets m_resumeReaderSamplePosition from an intermediate checkpoint
+    void LoadCheckPointInfo(const std::wstring& checkPointFileName, const size_t epochNumber,
+                            /*out*/ size_t& totalSamplesSeen,
+                            /*out*/ double& learnRatePerSample,
+                            std::list<Matrix<ElemType>>& smoothedGradients,
+                            std::vector<double>& smoothedCounts,
+                            /*out*/ double& prevCriterion,
+                            /*out*/ size_t& minibatchSize);
 
     wstring GetCheckPointFileNameForEpoch(const int epoch);
+    wstring GetIntermediateModelNameForEpoch(const int epoch);
+    wstring GetIntermediateCheckPointFileNameForEpoch(const int epoch);
 
     GradientsUpdateType GradUpdateType() const
     {
@@ -554,6 +625,16 @@ public:
 protected:
     std::wstring m_modelPath;
     bool m_keepCheckPointFiles;
+    bool m_asyncCheckpointing;                // write model and checkpoint files on a background thread
+    size_t m_checkpointFrequencyInSamples;    // if > 0, also write an intermediate checkpoint every that many samples within an epoch
+    std::unique_ptr<AsyncCheckpointWriter> m_checkpointWriter;
+
+    // continuing an epoch that was interrupted after an intermediate checkpoint
+    bool m_resumeFromIntermediateCheckPoint;  // set by DetermineStartEpoch()
+    size_t m_resumeReaderSamplePosition;      // reader position to continue the start epoch at, or SIZE_MAX; consumed by TrainOneEpoch()
+    // check-point info of the epoch being trained, for its intermediate checkpoints
+    size_t m_epochStartTotalSamplesSeen;      // samples seen before the epoch (resp. before it was resumed)
+    double m_epochStartPrevCriterion;
 
     std::wstring m_trainCriterionNodeName;
     std::wstring m_evalCriterionNodeName;
@@ -571,6 +652,9 @@ protected:
 
     shared_ptr<IMASGD<ElemType>> m_pMASGDHelper;
 
+    // sharded parameters, each with its position in the list of learnable nodes (and hence of the smoothed gradients)
+    std::vector<std::pair<size_t, std::shared_ptr<ShardedParameter<ElemType>>>> m_shardedParameters;
+
 private:
     void MarkDropoutNodesEvalTimeStampAsOutdated(const ComputationNetworkPtr& net, const ComputationNodeBasePtr& criterionNode);
     std::shared_ptr<ASGDHelper<ElemType>> m_pASGDHelper;
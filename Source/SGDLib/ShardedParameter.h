@@ -0,0 +1,470 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// ShardedParameter.h -- model-parallel storage of large embedding parameters across MPI ranks
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "MPIWrapper.h"
+#include "ComputationNetwork.h"
+#include "InputAndParamNodes.h"
+#include "LinearAlgebraNodes.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// ShardedParameter -- an embedding matrix E that is applied as Times(E, x) to sparse inputs x,
+// whose columns (the vocabulary axis) are partitioned across the ranks of a data-parallel job.
+//
+// Each rank owns a contiguous range of columns, and only keeps that shard and its optimizer state.
+// During training, E's Value() does not hold the full parameter but is a gather buffer. Per minibatch:
+//  - FetchColumns() copies the K columns referenced by the local minibatch from their owners into Value(),
+//    which becomes a [numRows x K] matrix, and renumbers the rows of the sparse inputs accordingly;
+//  - ExchangeGradients() routes the gradient columns to their owners and sums them there, so that
+//    the owner can update just the touched columns of its shard;
+//  - ReleaseColumns() restores the inputs and the shapes the network was validated with.
+// Values only ever travel as exact copies, so every rank sees the owner's values bit by bit.
+// AllGatherColumns() assembles the full parameter in Value() again, e.g. for cross-validation or saving.
+// Sharded parameters take no part in the dense gradient all-reduce.
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+class ShardedParameter
+{
+    typedef shared_ptr<ComputationNode<ElemType>> ComputationNodePtr;
+
+public:
+    ShardedParameter(const MPIWrapperPtr& mpi, const ComputationNodeBasePtr& node, const std::vector<ComputationNodeBasePtr>& allNodes)
+        : m_mpi(mpi), m_node(dynamic_pointer_cast<ComputationNode<ElemType>>(node)), m_isGathered(true),
+          m_shard(node->GetDeviceId()), m_gatheredState(node->GetDeviceId()), m_indices(node->GetDeviceId()), m_columnBuffer(node->GetDeviceId())
+    {
+        if (!m_node || !m_node->template Is<LearnableParameter<ElemType>>())
+            InvalidArgument("ShardedParameter: '%ls' is not a learnable parameter.", node->NodeName().c_str());
+        m_layout = m_node->GetSampleLayout();
+        if (m_layout.GetRank() != 2)
+            InvalidArgument("ShardedParameter: '%ls' must be a matrix, but has shape [%s].", node->NodeName().c_str(), string(m_layout).c_str());
+        m_numRows = m_layout[0];
+        m_numCols = m_layout[1];
+        if (m_numCols > ((size_t)1 << std::numeric_limits<ElemType>::digits))
+            InvalidArgument("ShardedParameter: '%ls' has too many columns (%d) to be indexed exactly.", node->NodeName().c_str(), (int)m_numCols);
+
+        // The parameter must only be consumed as the left operand of Times() with a sparse input on the right,
+        // so that the columns needed for a minibatch are known before the forward pass.
+        for (const auto& consumer : allNodes)
+        {
+            for (size_t i = 0; i < consumer->GetNumInputs(); i++)
+            {
+                if (consumer->Input(i) != node)
+                    continue;
+                if (consumer->OperationName() != OperationNameOf(TimesNode) || i != 0 ||
+                    !consumer->Input(1)->Is<InputValueBase<ElemType>>())
+                    InvalidArgument("ShardedParameter: '%ls' is used by %ls %ls operation; sharded parameters must be the left operand of Times() applied directly to a sparse input.",
+                                    node->NodeName().c_str(), consumer->NodeName().c_str(), consumer->OperationName().c_str());
+                auto input = dynamic_pointer_cast<ComputationNode<ElemType>>(consumer->Input(1));
+                if (std::find(m_inputs.begin(), m_inputs.end(), input) == m_inputs.end())
+                    m_inputs.push_back(input);
+            }
+        }
+        if (m_inputs.empty())
+            InvalidArgument("ShardedParameter: '%ls' is not used by the network.", node->NodeName().c_str());
+
+        // The inputs get renumbered to the columns of the gather buffer, so nothing else may look at them.
+        for (const auto& input : m_inputs)
+        {
+            if (input->GetSampleLayout().GetRank() != 1 || input->GetSampleLayout().GetNumElements() != m_numCols)
+                InvalidArgument("ShardedParameter: input '%ls' of '%ls' must be a vector of dimension %d.", input->NodeName().c_str(), node->NodeName().c_str(), (int)m_numCols);
+            for (const auto& consumer : allNodes)
+                for (size_t i = 0; i < consumer->GetNumInputs(); i++)
+                    if (consumer->Input(i) == input && (consumer->OperationName() != OperationNameOf(TimesNode) || i != 1 || consumer->Input(0) != node))
+                        InvalidArgument("ShardedParameter: input '%ls' of '%ls' is also used by %ls %ls operation.",
+                                        input->NodeName().c_str(), node->NodeName().c_str(), consumer->NodeName().c_str(), consumer->OperationName().c_str());
+        }
+        m_inputLayouts.resize(m_inputs.size());
+        m_inputValues.resize(m_inputs.size());
+        m_compactInputValues.resize(m_inputs.size());
+
+        size_t numRanks = m_mpi->NumNodesInUse();
+        m_shardBegin.resize(numRanks + 1);
+        for (size_t r = 0; r <= numRanks; r++)
+            m_shardBegin[r] = r * m_numCols / numRanks;
+
+        ResetShard();
+    }
+
+    const ComputationNodeBasePtr Node() const { return m_node; }
+    size_t NumColumns() const { return m_numCols; }
+    size_t FirstOwnedColumn() const { return m_shardBegin[m_mpi->CurrentNodeRank()]; }
+    size_t NumOwnedColumns() const { return m_shardBegin[m_mpi->CurrentNodeRank() + 1] - FirstOwnedColumn(); }
+
+    // the columns owned by this rank; the owner's values are the authoritative ones
+    Matrix<ElemType>& Shard() { return m_shard; }
+
+    // Takes the local shard from the full parameter in Value(), after construction or after the model was (re)loaded.
+    void ResetShard()
+    {
+        const auto& value = m_node->Value();
+        if (value.GetNumRows() != m_numRows || value.GetNumCols() != m_numCols)
+            LogicError("ShardedParameter: '%ls' does not hold the full parameter.", m_node->NodeName().c_str());
+        if (NumOwnedColumns() > 0)
+            m_shard.SetValue(value.ColumnSlice(FirstOwnedColumn(), NumOwnedColumns()));
+        else
+            m_shard.Resize(m_numRows, 0);
+        m_isGathered = true;
+    }
+
+    // Collective. Copies the columns referenced by the current minibatch into Value(), and renumbers the sparse inputs to match.
+    // Ranks without data for this minibatch must still call this with hasData = false.
+    void FetchColumns(bool hasData)
+    {
+        // get the inputs in CSC format; their row indices are the columns we need
+        m_columns.clear();
+        m_inputCSC.resize(m_inputs.size());
+        if (hasData)
+        {
+            for (size_t i = 0; i < m_inputs.size(); i++)
+            {
+                const auto& x = m_inputs[i]->Value();
+                if (x.GetMatrixType() != MatrixType::SPARSE)
+                    LogicError("ShardedParameter: input '%ls' of '%ls' is not sparse.", m_inputs[i]->NodeName().c_str(), m_node->NodeName().c_str());
+                auto& csc = m_inputCSC[i];
+                x.CopySparseCSCToArrays(csc.columnStarts, csc.rowIndices, csc.values);
+                m_columns.insert(m_columns.end(), csc.rowIndices.begin(), csc.rowIndices.end());
+            }
+            std::sort(m_columns.begin(), m_columns.end());
+            m_columns.erase(std::unique(m_columns.begin(), m_columns.end()), m_columns.end());
+        }
+
+        // tell the owners which of their columns we need
+        std::vector<int> sendCounts, sendOffsets, recvCounts, recvOffsets;
+        std::vector<size_t> requestedColumns;
+        CountByOwner(m_columns, sendCounts, sendOffsets);
+        Exchange(m_columns, sendCounts, sendOffsets, requestedColumns, recvCounts, recvOffsets, 1);
+
+        // serve the requests from our shard
+        m_sendValues.resize(requestedColumns.size() * m_numRows);
+        if (!requestedColumns.empty())
+        {
+            SetIndexMatrix(m_indices, requestedColumns, FirstOwnedColumn());
+            m_columnBuffer.DoGatherColumnsOf(0, m_indices, m_shard, 1);
+            ElemType* data = m_sendValues.data();
+            size_t size = m_sendValues.size();
+            m_columnBuffer.CopyToArray(data, size);
+        }
+        Exchange(m_sendValues, recvCounts, recvOffsets, m_recvValues, sendCounts, sendOffsets, m_numRows);
+
+        // The owners answer in rank order, which is the order of m_columns. The first time after the full parameter
+        // was held in Value(), its memory is released.
+        size_t numColumns = m_columns.size();
+        auto& value = m_node->Value();
+        value.Resize(m_numRows, numColumns, 0, /*growOnly=*/!m_isGathered);
+        if (numColumns > 0)
+            value.SetValue(m_numRows, numColumns, m_node->GetDeviceId(), m_recvValues.data());
+        m_isGathered = false;
+        m_node->SetDims(TensorShape(m_numRows, numColumns), false);
+        m_node->BumpEvalTimeStamp();
+
+        if (!hasData)
+            return;
+
+        // let the inputs refer to the columns of the gather buffer
+        for (size_t i = 0; i < m_inputs.size(); i++)
+        {
+            auto& input = m_inputs[i];
+            auto& csc = m_inputCSC[i];
+            for (auto& row : csc.rowIndices)
+                row = (CPUSPARSE_INDEX_TYPE)(std::lower_bound(m_columns.begin(), m_columns.end(), (size_t)row) - m_columns.begin());
+            if (!m_compactInputValues[i])
+                m_compactInputValues[i] = make_shared<Matrix<ElemType>>(numColumns, 0, input->GetDeviceId(), SPARSE, matrixFormatSparseCSC);
+            m_compactInputValues[i]->SetMatrixFromCSCFormat(csc.columnStarts.data(), csc.rowIndices.data(), csc.values.data(),
+                                                             csc.rowIndices.size(), numColumns, input->Value().GetNumCols());
+            m_inputLayouts[i] = input->GetSampleLayout();
+            m_inputValues[i] = input->ValuePtrRef();
+            input->ValuePtrRef() = m_compactInputValues[i];
+            input->SetDims(TensorShape(numColumns), true);
+        }
+    }
+
+    // Restores the inputs and shapes changed by FetchColumns(). Value() keeps the fetched columns until the next FetchColumns().
+    void ReleaseColumns()
+    {
+        for (size_t i = 0; i < m_inputs.size(); i++)
+        {
+            if (!m_inputValues[i])
+                continue;
+            m_inputs[i]->ValuePtrRef() = m_inputValues[i];
+            m_inputs[i]->SetDims(m_inputLayouts[i], true);
+            m_inputValues[i] = nullptr;
+        }
+        m_node->SetDims(m_layout, false);
+    }
+
+    // Collective. Sends the gradient columns of this minibatch to their owners. On return, 'ownedColumns' holds the indices of
+    // the columns of the local shard (relative to FirstOwnedColumn()) that received gradients from any rank, in ascending order,
+    // and 'gradient' their summed gradients (numRows x K) on the parameter's device. Returns K.
+    size_t ExchangeGradients(bool hasGradient, std::vector<size_t>& ownedColumns, Matrix<ElemType>& gradient)
+    {
+        // the gradient refers to the columns of the gather buffer
+        std::vector<size_t> columns;
+        std::vector<ElemType> values;
+        if (hasGradient)
+        {
+            const auto& g = m_node->Gradient();
+            if (g.GetMatrixType() == MatrixType::SPARSE)
+                g.CopySparseBlockColumnsToArray(columns, values);
+            else if (!m_columns.empty())
+            {
+                columns.resize(m_columns.size());
+                for (size_t j = 0; j < columns.size(); j++)
+                    columns[j] = j;
+                values.resize(columns.size() * m_numRows);
+                ElemType* data = values.data();
+                size_t size = values.size();
+                g.CopyToArray(data, size);
+            }
+            for (auto& column : columns)
+                column = m_columns[column];
+        }
+
+        // order the columns by owner (block-column gradients are not sorted)
+        std::vector<size_t> order(columns.size());
+        for (size_t j = 0; j < order.size(); j++)
+            order[j] = j;
+        std::sort(order.begin(), order.end(), [&columns](size_t a, size_t b) { return columns[a] < columns[b]; });
+        std::vector<size_t> sortedColumns(columns.size());
+        m_sendValues.resize(values.size());
+        for (size_t j = 0; j < order.size(); j++)
+        {
+            sortedColumns[j] = columns[order[j]];
+            std::copy(values.begin() + order[j] * m_numRows, values.begin() + (order[j] + 1) * m_numRows, m_sendValues.begin() + j * m_numRows);
+        }
+
+        std::vector<int> sendCounts, sendOffsets, recvCounts, recvOffsets;
+        std::vector<size_t> receivedColumns;
+        CountByOwner(sortedColumns, sendCounts, sendOffsets);
+        Exchange(sortedColumns, sendCounts, sendOffsets, receivedColumns, recvCounts, recvOffsets, 1);
+        Exchange(m_sendValues, sendCounts, sendOffsets, m_recvValues, recvCounts, recvOffsets, m_numRows);
+
+        // several ranks may have sent the same column: sum them up, in rank order
+        ownedColumns = receivedColumns;
+        std::sort(ownedColumns.begin(), ownedColumns.end());
+        ownedColumns.erase(std::unique(ownedColumns.begin(), ownedColumns.end()), ownedColumns.end());
+        std::vector<ElemType> summed(ownedColumns.size() * m_numRows, 0);
+        for (size_t j = 0; j < receivedColumns.size(); j++)
+        {
+            size_t k = std::lower_bound(ownedColumns.begin(), ownedColumns.end(), receivedColumns[j]) - ownedColumns.begin();
+            for (size_t r = 0; r < m_numRows; r++)
+                summed[k * m_numRows + r] += m_recvValues[j * m_numRows + r];
+        }
+        for (auto& column : ownedColumns)
+            column -= FirstOwnedColumn();
+
+        if (!ownedColumns.empty())
+            gradient.SetValue(m_numRows, ownedColumns.size(), m_node->GetDeviceId(), summed.data());
+        return ownedColumns.size();
+    }
+
+    // Collective. Assembles the complete, current parameter in Value() on every rank, e.g. before validation or saving the model.
+    void AllGatherColumns()
+    {
+        size_t numRanks = m_mpi->NumNodesInUse();
+        if (m_numRows * m_numCols > INT_MAX)
+            RuntimeError("ShardedParameter: '%ls' is too large (%d x %d) to be gathered in one piece.", m_node->NodeName().c_str(), (int)m_numRows, (int)m_numCols);
+
+        std::vector<int> recvCounts(numRanks), recvOffsets(numRanks);
+        for (size_t r = 0; r < numRanks; r++)
+        {
+            recvCounts[r] = (int)((m_shardBegin[r + 1] - m_shardBegin[r]) * m_numRows);
+            recvOffsets[r] = (int)(m_shardBegin[r] * m_numRows);
+        }
+
+        m_sendValues.resize(NumOwnedColumns() * m_numRows);
+        if (NumOwnedColumns() > 0)
+        {
+            ElemType* data = m_sendValues.data();
+            size_t size = m_sendValues.size();
+            m_shard.CopyToArray(data, size);
+        }
+        m_recvValues.resize(m_numRows * m_numCols);
+        m_mpi->AllGatherv(m_sendValues.data(), m_sendValues.size(), m_recvValues.data(), recvCounts.data(), recvOffsets.data());
+        m_node->Value().SetValue(m_numRows, m_numCols, m_node->GetDeviceId(), m_recvValues.data());
+        m_node->SetDims(m_layout, false);
+        m_node->BumpEvalTimeStamp();
+        m_isGathered = true;
+    }
+
+    // Collective. Assembles the complete optimizer state of the parameter, of which every rank keeps the columns it owns in
+    // 'stateShard', in GatheredState() on the main node, e.g. for writing a checkpoint.
+    void GatherState(const Matrix<ElemType>& stateShard)
+    {
+        size_t numRanks = m_mpi->NumNodesInUse();
+        size_t numStateRows = stateShard.GetNumRows();
+        if (stateShard.GetNumCols() != NumOwnedColumns())
+            LogicError("ShardedParameter: the optimizer state of '%ls' does not match the owned columns.", m_node->NodeName().c_str());
+        if (numStateRows * m_numCols > INT_MAX)
+            RuntimeError("ShardedParameter: the optimizer state of '%ls' is too large (%d x %d) to be gathered in one piece.", m_node->NodeName().c_str(), (int)numStateRows, (int)m_numCols);
+
+        std::vector<int> recvCounts(numRanks), recvOffsets(numRanks);
+        for (size_t r = 0; r < numRanks; r++)
+        {
+            recvCounts[r] = (int)((m_shardBegin[r + 1] - m_shardBegin[r]) * numStateRows);
+            recvOffsets[r] = (int)(m_shardBegin[r] * numStateRows);
+        }
+
+        m_sendValues.resize(NumOwnedColumns() * numStateRows);
+        if (!m_sendValues.empty())
+        {
+            ElemType* data = m_sendValues.data();
+            size_t size = m_sendValues.size();
+            stateShard.CopyToArray(data, size);
+        }
+        m_recvValues.resize(numStateRows * m_numCols);
+        // (MPI does not like null buffers, even for zero counts)
+        ElemType dummy = ElemType();
+        m_mpi->Gatherv(m_sendValues.empty() ? &dummy : m_sendValues.data(), m_sendValues.size(), m_recvValues.data(), recvCounts.data(), recvOffsets.data(), m_mpi->MainNodeRank());
+        if (m_mpi->IsMainNode())
+            m_gatheredState.SetValue(numStateRows, m_numCols, stateShard.GetDeviceId(), m_recvValues.data());
+    }
+
+    // the complete optimizer state on the main node, as of the last GatherState() or SetState()
+    const Matrix<ElemType>& GatheredState() const { return m_gatheredState; }
+
+    // Takes the owned columns of the complete optimizer 'state' into 'stateShard', e.g. after reading a checkpoint.
+    void SetState(const Matrix<ElemType>& state, Matrix<ElemType>& stateShard)
+    {
+        if (state.GetNumCols() != m_numCols)
+            LogicError("ShardedParameter: the optimizer state of '%ls' does not have all %d columns.", m_node->NodeName().c_str(), (int)m_numCols);
+        if (m_mpi->IsMainNode())
+            m_gatheredState.SetValue(state);
+        if (NumOwnedColumns() > 0)
+            stateShard.SetValue(state.ColumnSlice(FirstOwnedColumn(), NumOwnedColumns()));
+        else
+            stateShard.Resize(state.GetNumRows(), 0);
+    }
+
+    // FNV-1a hash of the bits of the gathered parameter, to compare the copies on different ranks
+    uint64_t ValueChecksum() const
+    {
+        if (!m_isGathered)
+            LogicError("ShardedParameter: ValueChecksum() requires the parameter '%ls' to be gathered.", m_node->NodeName().c_str());
+        std::vector<ElemType> values(m_numRows * m_numCols);
+        ElemType* data = values.data();
+        size_t size = values.size();
+        m_node->Value().CopyToArray(data, size);
+        uint64_t hash = 14695981039346656037ull;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values.data());
+        for (size_t i = 0; i < values.size() * sizeof(ElemType); i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    // target(:, columns[j]) = source(:, j); 'columns' must be ascending. Runs of consecutive columns are copied in one piece.
+    static void AssignColumns(Matrix<ElemType>& target, const std::vector<size_t>& columns, const Matrix<ElemType>& source)
+    {
+        for (size_t begin = 0, end; begin < columns.size(); begin = end)
+        {
+            for (end = begin + 1; end < columns.size() && columns[end] == columns[end - 1] + 1; end++)
+                ;
+            target.SetColumnSlice(source.ColumnSlice(begin, end - begin), columns[begin], end - begin);
+        }
+    }
+
+    // fills 'idx' with the row vector of 'columns' - 'shift', as needed by Do{Gather,Scatter}ColumnsOf()
+    void SetIndexMatrix(Matrix<ElemType>& idx, const std::vector<size_t>& columns, size_t shift) const
+    {
+        m_indexBuffer.resize(columns.size());
+        for (size_t j = 0; j < columns.size(); j++)
+            m_indexBuffer[j] = (ElemType)(columns[j] - shift);
+        idx.SetValue(1, columns.size(), m_node->GetDeviceId(), m_indexBuffer.data());
+    }
+
+private:
+    // 'columns' must be sorted
+    void CountByOwner(const std::vector<size_t>& columns, std::vector<int>& counts, std::vector<int>& offsets) const
+    {
+        size_t numRanks = m_mpi->NumNodesInUse();
+        counts.resize(numRanks);
+        offsets.resize(numRanks);
+        for (size_t r = 0; r < numRanks; r++)
+        {
+            auto begin = std::lower_bound(columns.begin(), columns.end(), m_shardBegin[r]);
+            auto end = std::lower_bound(columns.begin(), columns.end(), m_shardBegin[r + 1]);
+            offsets[r] = (int)(begin - columns.begin());
+            counts[r] = (int)(end - begin);
+        }
+    }
+
+    // all-to-all exchange of items of 'itemSize' elements; if 'recvCounts' is empty, it is determined by exchanging 'sendCounts' first
+    template <class T>
+    void Exchange(const std::vector<T>& send, const std::vector<int>& sendCounts, const std::vector<int>& sendOffsets,
+                  std::vector<T>& recv, std::vector<int>& recvCounts, std::vector<int>& recvOffsets, size_t itemSize) const
+    {
+        size_t numRanks = m_mpi->NumNodesInUse();
+        if (recvCounts.empty())
+        {
+            recvCounts.resize(numRanks);
+            m_mpi->AllToAll(sendCounts.data(), 1, recvCounts.data());
+            recvOffsets.resize(numRanks);
+            for (size_t r = 0, offset = 0; r < numRanks; offset += recvCounts[r], r++)
+                recvOffsets[r] = (int)offset;
+        }
+
+        std::vector<int> scaledSendCounts(numRanks), scaledSendOffsets(numRanks), scaledRecvCounts(numRanks), scaledRecvOffsets(numRanks);
+        size_t total = 0;
+        for (size_t r = 0; r < numRanks; r++)
+        {
+            scaledSendCounts[r] = (int)(sendCounts[r] * itemSize);
+            scaledSendOffsets[r] = (int)(sendOffsets[r] * itemSize);
+            scaledRecvCounts[r] = (int)(recvCounts[r] * itemSize);
+            scaledRecvOffsets[r] = (int)(recvOffsets[r] * itemSize);
+            total += recvCounts[r] * itemSize;
+        }
+        recv.resize(total);
+        // (MPI does not like null buffers, even for zero counts)
+        T dummy = T();
+        m_mpi->AllToAllv(send.empty() ? &dummy : send.data(), scaledSendCounts.data(), scaledSendOffsets.data(),
+                         recv.empty() ? &dummy : recv.data(), scaledRecvCounts.data(), scaledRecvOffsets.data());
+    }
+
+    struct CSCArrays
+    {
+        std::vector<CPUSPARSE_INDEX_TYPE> columnStarts;
+        std::vector<CPUSPARSE_INDEX_TYPE> rowIndices;
+        std::vector<ElemType> values;
+    };
+
+    MPIWrapperPtr m_mpi;
+    ComputationNodePtr m_node;
+    TensorShape m_layout;                         // the parameter's shape as validated
+    size_t m_numRows;
+    size_t m_numCols;
+    std::vector<size_t> m_shardBegin;             // rank r owns columns [m_shardBegin[r], m_shardBegin[r+1])
+    bool m_isGathered;                            // Value() holds the full parameter
+
+    std::vector<ComputationNodePtr> m_inputs;     // sparse inputs the parameter is applied to
+    std::vector<TensorShape> m_inputLayouts;      // their shapes, and their values while they are renumbered
+    std::vector<shared_ptr<Matrix<ElemType>>> m_inputValues;
+    std::vector<shared_ptr<Matrix<ElemType>>> m_compactInputValues;
+    std::vector<CSCArrays> m_inputCSC;
+
+    Matrix<ElemType> m_shard;                     // the owned columns [FirstOwnedColumn(), FirstOwnedColumn() + NumOwnedColumns())
+    Matrix<ElemType> m_gatheredState;             // main node: the complete optimizer state, for checkpoints
+    std::vector<size_t> m_columns;                // columns referenced by the current minibatch (sorted); column j of the gather buffer is m_columns[j]
+    std::vector<ElemType> m_sendValues;
+    std::vector<ElemType> m_recvValues;
+    mutable std::vector<ElemType> m_indexBuffer;
+    Matrix<ElemType> m_indices;
+    Matrix<ElemType> m_columnBuffer;
+};
+
+}}}
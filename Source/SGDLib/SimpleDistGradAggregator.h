@@ -10,6 +10,9 @@
 #include "CUDAPageLockedMemAllocator.h"
 #include "NcclComm.h"
 #include <future>
+#include <climits>
+#include <list>
+#include <thread>
 #include "GPUDataTransferer.h"
 #include "TimerUtility.h"
 #include "MatrixQuantizerImpl.h"
@@ -22,9 +25,25 @@ class SimpleDistGradAggregator : public IDistGradAggregator<ElemType>
     UsingIDistGradAggregatorMembers;
 
 public:
-    SimpleDistGradAggregator(const MPIWrapperPtr& mpi, bool useAsyncAggregation, int deviceId, int syncStatsTrace)
-        : IDistGradAggregator<ElemType>(mpi), m_useAsyncAggregation(useAsyncAggregation), m_initialized(false), m_bufferedGradHeader(nullptr), m_syncStatsTrace(syncStatsTrace), m_iterationCount(0), m_nccl(deviceId, mpi)
-    {}
+    // With numBackupWorkers = k > 0, each aggregation round completes once the first N-k workers have arrived, and only sums
+    // up their gradients; gradients arriving late are added to the worker's next contribution or, with dropLateGradients,
+    // discarded.
+    SimpleDistGradAggregator(const MPIWrapperPtr& mpi, bool useAsyncAggregation, int deviceId, int syncStatsTrace, size_t numBackupWorkers = 0, bool dropLateGradients = false)
+        : IDistGradAggregator<ElemType>(mpi), m_useAsyncAggregation(useAsyncAggregation), m_initialized(false), m_bufferedGradHeader(nullptr), m_syncStatsTrace(syncStatsTrace), m_iterationCount(0), m_nccl(deviceId, mpi),
+        m_numBackupWorkers(numBackupWorkers), m_dropLateGradients(dropLateGradients), m_arrivals(nullptr), m_round(0),
+        m_lateHeader(nullptr), m_hasLateGradients(false)
+    {
+        if (m_numBackupWorkers > 0)
+        {
+            if (m_numBackupWorkers >= NumProc())
+                InvalidArgument("SimpleDistGradAggregator: the number of backup workers (%d) must be less than the number of workers (%d).", (int)m_numBackupWorkers, (int)NumProc());
+            if (m_useAsyncAggregation)
+                InvalidArgument("SimpleDistGradAggregator: backup workers cannot be combined with buffered async gradient aggregation.");
+
+            // own communicator for the arrivals, the on-time communicators, and the aggregates sent to late workers
+            MPI_Comm_dup(m_mpi->Communicator(), &m_backupWorkersComm) || MpiFail("MPI_Comm_dup");
+        }
+    }
 
     ~SimpleDistGradAggregator()
     {
@@ -33,15 +52,36 @@ public:
 
         if (m_bufferedGradHeader != nullptr)
             DistGradHeader::Destroy(m_bufferedGradHeader);
+
+        if (m_numBackupWorkers > 0)
+        {
+            if (m_initialized)
+            {
+                // the late workers receive their aggregates before they get here
+                for (auto& pendingSend : m_lateAggregateSends)
+                    MPI_Waitall((int)pendingSend.requests.size(), pendingSend.requests.data(), MPI_STATUSES_IGNORE);
+                MPI_Win_unlock_all(m_arrivalWindow);
+                MPI_Win_free(&m_arrivalWindow);
+                MPI_Group_free(&m_backupWorkersGroup);
+            }
+            if (m_lateHeader != nullptr)
+                DistGradHeader::Destroy(m_lateHeader);
+
+            MPI_Comm_free(&m_backupWorkersComm);
+        }
     }
 
     // Aggregate the gradient matrices across all nodes
     bool AggregateGradients(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool resetState) override
     {
-        ResetState(gradients, headerCPU->numEvalNode, resetState);
         bool showSyncPerfStats = (m_syncStatsTrace > 0) && ((m_iterationCount % m_syncStatsTrace) == 0);
         m_iterationCount++;
 
+        if (m_numBackupWorkers > 0)
+            return AggregateGradientsWithBackupWorkers(gradients, headerCPU, showSyncPerfStats);
+
+        ResetState(gradients, headerCPU->numEvalNode, resetState);
+
         if (m_useAsyncAggregation)
         {
             // If we are performing async gradient aggregation, let's wait for the pending gradient aggregation to finish
@@ -345,6 +385,322 @@ private:
         }
     }
 
+    // Aggregation that tolerates stragglers. In every round, each worker takes a ticket from a counter on the main node (an
+    // atomic MPI_Fetch_and_op) and records its rank at that position of the round's arrival list there. The first N-k
+    // arrivals are on time: they allreduce their gradients and header over a communicator of just themselves, so the round
+    // completes without waiting for the k late workers. The first arrival then sends the aggregate to the late workers,
+    // which add their own gradients to their next contribution or, with dropLateGradients, discard them, and continue with
+    // the same aggregate, so the models stay identical. The header's sample counts only include the contributed gradients.
+    // The counters and arrival lists form a ring of s_numRoundSlots rounds; a worker only starts a round once all workers
+    // have arrived at the round that used its slot before, which bounds how far the others can get ahead of a straggler.
+    // A round whose on-time aggregate has no samples (the end of the epoch) is completed by all workers together, which
+    // drains the late gradients that were folded.
+    bool AggregateGradientsWithBackupWorkers(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool showSyncPerfStats)
+    {
+        Timer aggregationTimer;
+        if (showSyncPerfStats)
+            aggregationTimer.Start();
+
+        if (!m_initialized)
+            InitBackupWorkers(gradients, headerCPU->numEvalNode);
+        CompleteLateAggregateSends();
+
+        // If the current node did not process any samples, the gradients should be zero'd
+        bool hasNewGradients = (headerCPU->numSamples != 0);
+        if (!hasNewGradients)
+            std::fill(m_hostGradients.begin(), m_hostGradients.end(), (ElemType)0);
+        else
+        {
+            for (size_t i = 0; i < gradients.size(); ++i)
+            {
+                ElemType* data = m_hostGradients.data() + m_gradientOffsets[i];
+                size_t size = gradients[i]->GetNumElements();
+                gradients[i]->CopyToArray(data, size);
+            }
+        }
+
+        // the position among this round's arrivals decides whether the gradients make it into the round
+        size_t numProc = NumProc();
+        size_t numOnTime = numProc - m_numBackupWorkers;
+        size_t position = Arrive();
+        bool isLate = (position >= numOnTime);
+        m_lateness[isLate ? (position - numOnTime + 1) : 0]++;
+        PublishLateness();
+
+        if (isLate)
+        {
+            if (hasNewGradients && !m_dropLateGradients)
+            {
+                std::transform(m_lateGradients.begin(), m_lateGradients.end(), m_hostGradients.begin(), m_lateGradients.begin(), std::plus<ElemType>());
+                m_lateHeader->Aggregate(headerCPU, true);
+                m_hasLateGradients = true;
+            }
+            headerCPU->Clear();
+        }
+        else if (m_hasLateGradients)
+        {
+            std::transform(m_hostGradients.begin(), m_hostGradients.end(), m_lateGradients.begin(), m_hostGradients.begin(), std::plus<ElemType>());
+            headerCPU->Aggregate(m_lateHeader, true);
+            std::fill(m_lateGradients.begin(), m_lateGradients.end(), (ElemType)0);
+            m_lateHeader->Clear();
+            m_hasLateGradients = false;
+        }
+
+        size_t numEvalNodes = headerCPU->numEvalNode;
+        if (!isLate)
+        {
+            std::vector<int> onTimeRanks = WaitForOnTimeArrivals(numOnTime);
+            SetHeaderStats(headerCPU, hasNewGradients ? 1 : 0);
+            MPI_Comm onTimeComm = MPI_COMM_SELF;
+            if (numOnTime > 1)
+            {
+                MPI_Group onTimeGroup;
+                MPI_Group_incl(m_backupWorkersGroup, (int)numOnTime, onTimeRanks.data(), &onTimeGroup) || MpiFail("MPI_Group_incl");
+                MPI_Comm_create_group(m_backupWorkersComm, onTimeGroup, RoundTag(s_onTimeCommTag), &onTimeComm) || MpiFail("MPI_Comm_create_group");
+                MPI_Group_free(&onTimeGroup);
+            }
+            MPI_Request requests[2];
+            MPI_Iallreduce(MPI_IN_PLACE, m_headerStats.data(), (int)m_headerStats.size(), MPI_DOUBLE, MPI_SUM, onTimeComm, &requests[0]) || MpiFail("MPI_Iallreduce");
+            MPI_Iallreduce(MPI_IN_PLACE, m_hostGradients.data(), (int)m_hostGradients.size(), MPIWrapper::GetDataType(m_hostGradients.data()), MPI_SUM, onTimeComm, &requests[1]) || MpiFail("MPI_Iallreduce");
+            MPI_Waitall(2, requests, MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+            if (onTimeComm != MPI_COMM_SELF)
+                MPI_Comm_free(&onTimeComm);
+
+            if (onTimeRanks.front() == (int)MyRank())
+                SendAggregateToLateWorkers(onTimeRanks);
+        }
+        else
+        {
+            MPI_Status status;
+            MPI_Recv(m_headerStats.data(), (int)m_headerStats.size(), MPI_DOUBLE, MPI_ANY_SOURCE, RoundTag(s_lateAggregateHeaderTag), m_backupWorkersComm, &status) || MpiFail("MPI_Recv");
+            MPI_Recv(m_hostGradients.data(), (int)m_hostGradients.size(), MPIWrapper::GetDataType(m_hostGradients.data()), status.MPI_SOURCE, RoundTag(s_lateAggregateTag), m_backupWorkersComm, MPI_STATUS_IGNORE) || MpiFail("MPI_Recv");
+        }
+        GetHeaderStats(headerCPU);
+        size_t numContributors = (size_t)(m_headerStats[3 + 2 * numEvalNodes] + 0.5);
+
+        if (headerCPU->numSamples == 0 && !m_dropLateGradients)
+        {
+            // the end of the epoch: all workers add up the late gradients they have folded
+            if (m_hasLateGradients)
+            {
+                m_hostGradients = m_lateGradients;
+                headerCPU->Aggregate(m_lateHeader);
+                std::fill(m_lateGradients.begin(), m_lateGradients.end(), (ElemType)0);
+                m_lateHeader->Clear();
+                m_hasLateGradients = false;
+            }
+            else
+            {
+                std::fill(m_hostGradients.begin(), m_hostGradients.end(), (ElemType)0);
+                headerCPU->Clear();
+            }
+            SetHeaderStats(headerCPU, 0);
+            MPI_Request requests[2];
+            MPI_Iallreduce(MPI_IN_PLACE, m_headerStats.data(), (int)m_headerStats.size(), MPI_DOUBLE, MPI_SUM, m_backupWorkersComm, &requests[0]) || MpiFail("MPI_Iallreduce");
+            MPI_Iallreduce(MPI_IN_PLACE, m_hostGradients.data(), (int)m_hostGradients.size(), MPIWrapper::GetDataType(m_hostGradients.data()), MPI_SUM, m_backupWorkersComm, &requests[1]) || MpiFail("MPI_Iallreduce");
+            MPI_Waitall(2, requests, MPI_STATUSES_IGNORE) || MpiFail("MPI_Waitall");
+            GetHeaderStats(headerCPU);
+        }
+        m_round++;
+
+        for (size_t i = 0; i < gradients.size(); ++i)
+            gradients[i]->SetValue(gradients[i]->GetNumRows(), gradients[i]->GetNumCols(), gradients[i]->GetDeviceId(), m_hostGradients.data() + m_gradientOffsets[i]);
+
+        if (showSyncPerfStats)
+        {
+            aggregationTimer.Stop();
+            fprintf(stderr, "Gradient aggregation with %d backup workers: aggregated the new gradients of %d of %d workers, late gradients %s; this worker was %s.\n",
+                    (int)m_numBackupWorkers, (int)numContributors, (int)numProc, m_dropLateGradients ? "dropped" : "folded into the next round", isLate ? "late" : "on time");
+            if (m_mpi->IsMainNode())
+                PrintLatenessHistograms();
+            fprintf(stderr, "Actual gradient aggregation time: %.6g\n", aggregationTimer.ElapsedSeconds());
+        }
+
+        return (headerCPU->numSamples != 0);
+    }
+
+    void InitBackupWorkers(const std::vector<Matrix<ElemType>*>& gradients, int numEvalNodes)
+    {
+        m_initialized = true;
+        size_t totalSize = 0;
+        for (size_t i = 0; i < gradients.size(); i++)
+        {
+            if (gradients[i]->GetMatrixType() != DENSE)
+                RuntimeError("Gradient aggregation for sparse gradient matrices is currently unsupported!");
+            m_gradientOffsets.push_back(totalSize);
+            totalSize += gradients[i]->GetNumElements();
+        }
+        if (totalSize > INT_MAX)
+            RuntimeError("SimpleDistGradAggregator: the model is too large for aggregation with backup workers.");
+        m_hostGradients.resize(totalSize);
+        m_headerStats.resize(3 + 2 * numEvalNodes + 1);
+        m_lateness.assign(m_numBackupWorkers + 1, 0);
+        if (!m_dropLateGradients)
+        {
+            m_lateGradients.assign(totalSize, (ElemType)0);
+            m_lateHeader = DistGradHeader::Create(numEvalNodes);
+            m_lateHeader->Clear();
+        }
+        MPI_Comm_group(m_backupWorkersComm, &m_backupWorkersGroup) || MpiFail("MPI_Comm_group");
+
+        // the arrival counters and lists, and the lateness histograms, live on the main node; the lists start out empty
+        size_t windowSize = m_mpi->IsMainNode() ? ArrivalWindowSize() : 0;
+        MPI_Win_allocate((MPI_Aint)(windowSize * sizeof(long long)), sizeof(long long), MPI_INFO_NULL, m_backupWorkersComm, &m_arrivals, &m_arrivalWindow) || MpiFail("MPI_Win_allocate");
+        if (m_mpi->IsMainNode())
+        {
+            std::fill(m_arrivals, m_arrivals + windowSize, 0);
+            std::fill(m_arrivals + ArrivalListOffset(0), m_arrivals + LatenessOffset(0), -1);
+        }
+        MPI_Barrier(m_backupWorkersComm) || MpiFail("MPI_Barrier");
+        MPI_Win_lock_all(0, m_arrivalWindow) || MpiFail("MPI_Win_lock_all");
+    }
+
+    // Takes a ticket for the current round and records this worker at its position of the arrival list; returns the position.
+    size_t Arrive()
+    {
+        size_t numProc = NumProc();
+        size_t slot = m_round % s_numRoundSlots;
+        int mainNode = m_mpi->MainNodeRank();
+
+        // all workers have taken their ticket for the round that used the slot before once its counter is at roundBase
+        long long roundBase = (long long)(numProc * (m_round / s_numRoundSlots));
+        long long ticket = 0, one = 1;
+        for (;;)
+        {
+            MPI_Fetch_and_op(nullptr, &ticket, MPI_LONG_LONG, mainNode, (MPI_Aint)slot, MPI_NO_OP, m_arrivalWindow) || MpiFail("MPI_Fetch_and_op");
+            MPI_Win_flush(mainNode, m_arrivalWindow) || MpiFail("MPI_Win_flush");
+            if (ticket >= roundBase)
+                break;
+            std::this_thread::yield();
+        }
+        MPI_Fetch_and_op(&one, &ticket, MPI_LONG_LONG, mainNode, (MPI_Aint)slot, MPI_SUM, m_arrivalWindow) || MpiFail("MPI_Fetch_and_op");
+        MPI_Win_flush(mainNode, m_arrivalWindow) || MpiFail("MPI_Win_flush");
+        long long position = ticket - roundBase;
+        if (position < 0 || position >= (long long)numProc)
+            LogicError("SimpleDistGradAggregator: arrival %d is out of range for a round of %d workers.", (int)position, (int)numProc);
+
+        long long entry = ArrivalEntry(m_round, MyRank());
+        MPI_Accumulate(&entry, 1, MPI_LONG_LONG, mainNode, (MPI_Aint)(ArrivalListOffset(slot) + position), 1, MPI_LONG_LONG, MPI_REPLACE, m_arrivalWindow) || MpiFail("MPI_Accumulate");
+        MPI_Win_flush(mainNode, m_arrivalWindow) || MpiFail("MPI_Win_flush");
+        return (size_t)position;
+    }
+
+    // Waits until the first numOnTime workers of the current round have recorded themselves; returns their ranks in
+    // increasing order, the same on all of them.
+    std::vector<int> WaitForOnTimeArrivals(size_t numOnTime)
+    {
+        size_t numProc = NumProc();
+        size_t slot = m_round % s_numRoundSlots;
+        int mainNode = m_mpi->MainNodeRank();
+        std::vector<long long> entries(numOnTime);
+        for (;;)
+        {
+            MPI_Get_accumulate(nullptr, 0, MPI_LONG_LONG, entries.data(), (int)numOnTime, MPI_LONG_LONG, mainNode, (MPI_Aint)ArrivalListOffset(slot), (int)numOnTime, MPI_LONG_LONG, MPI_NO_OP, m_arrivalWindow) || MpiFail("MPI_Get_accumulate");
+            MPI_Win_flush(mainNode, m_arrivalWindow) || MpiFail("MPI_Win_flush");
+            if (std::all_of(entries.begin(), entries.end(), [&](long long entry) { return entry >= 0 && (size_t)entry / numProc == m_round; }))
+                break;
+            std::this_thread::yield();
+        }
+        std::vector<int> ranks;
+        for (auto entry : entries)
+            ranks.push_back((int)((size_t)entry % numProc));
+        std::sort(ranks.begin(), ranks.end());
+        return ranks;
+    }
+
+    // Sends the aggregate of the current round to all workers that are not on time; they receive it when they arrive.
+    void SendAggregateToLateWorkers(const std::vector<int>& onTimeRanks)
+    {
+        m_lateAggregateSends.emplace_back();
+        auto& pendingSend = m_lateAggregateSends.back();
+        pendingSend.headerStats = m_headerStats;
+        pendingSend.gradients = m_hostGradients;
+        for (int rank = 0; rank < (int)NumProc(); ++rank)
+        {
+            if (std::binary_search(onTimeRanks.begin(), onTimeRanks.end(), rank))
+                continue;
+            pendingSend.requests.push_back(MPI_REQUEST_NULL);
+            MPI_Isend(pendingSend.headerStats.data(), (int)pendingSend.headerStats.size(), MPI_DOUBLE, rank, RoundTag(s_lateAggregateHeaderTag), m_backupWorkersComm, &pendingSend.requests.back()) || MpiFail("MPI_Isend");
+            pendingSend.requests.push_back(MPI_REQUEST_NULL);
+            MPI_Isend(pendingSend.gradients.data(), (int)pendingSend.gradients.size(), MPIWrapper::GetDataType(pendingSend.gradients.data()), rank, RoundTag(s_lateAggregateTag), m_backupWorkersComm, &pendingSend.requests.back()) || MpiFail("MPI_Isend");
+        }
+    }
+
+    // Releases the buffers of the aggregates that the late workers have received.
+    void CompleteLateAggregateSends()
+    {
+        for (auto iter = m_lateAggregateSends.begin(); iter != m_lateAggregateSends.end();)
+        {
+            int completed = 0;
+            MPI_Testall((int)iter->requests.size(), iter->requests.data(), &completed, MPI_STATUSES_IGNORE) || MpiFail("MPI_Testall");
+            if (completed)
+                iter = m_lateAggregateSends.erase(iter);
+            else
+                ++iter;
+        }
+    }
+
+    // [numSamples, numSamplesWithLabel, criterion, (numer, denom) per eval node, #contributors with new gradients]
+    void SetHeaderStats(const DistGradHeader* header, double numContributors)
+    {
+        size_t numEvalNodes = header->numEvalNode;
+        double* stats = m_headerStats.data();
+        stats[0] = (double)header->numSamples;
+        stats[1] = (double)header->numSamplesWithLabel;
+        stats[2] = header->criterion;
+        for (size_t i = 0; i < numEvalNodes; ++i)
+        {
+            stats[3 + 2 * i]     = header->evalErrors[i].first;
+            stats[3 + 2 * i + 1] = (double)header->evalErrors[i].second;
+        }
+        stats[3 + 2 * numEvalNodes] = numContributors;
+    }
+
+    void GetHeaderStats(DistGradHeader* header) const
+    {
+        size_t numEvalNodes = header->numEvalNode;
+        const double* stats = m_headerStats.data();
+        header->numSamples          = (size_t)(stats[0] + 0.5);
+        header->numSamplesWithLabel = (size_t)(stats[1] + 0.5);
+        header->criterion           = stats[2];
+        for (size_t i = 0; i < numEvalNodes; ++i)
+        {
+            header->evalErrors[i].first  = stats[3 + 2 * i];
+            header->evalErrors[i].second = (size_t)(stats[3 + 2 * i + 1] + 0.5);
+        }
+    }
+
+    // The main node logs how late each worker has arrived: bucket 0 counts the rounds it was on time, bucket j the rounds
+    // in which it was the j-th late arrival. The workers publish their histograms into the arrival window.
+    void PrintLatenessHistograms()
+    {
+        size_t numBuckets = m_numBackupWorkers + 1;
+        std::vector<long long> histograms(NumProc() * numBuckets);
+        MPI_Get_accumulate(nullptr, 0, MPI_LONG_LONG, histograms.data(), (int)histograms.size(), MPI_LONG_LONG, m_mpi->MainNodeRank(), (MPI_Aint)LatenessOffset(0), (int)histograms.size(), MPI_LONG_LONG, MPI_NO_OP, m_arrivalWindow) || MpiFail("MPI_Get_accumulate");
+        MPI_Win_flush(m_mpi->MainNodeRank(), m_arrivalWindow) || MpiFail("MPI_Win_flush");
+        for (size_t rank = 0; rank < NumProc(); ++rank)
+        {
+            fprintf(stderr, "\tlateness of worker %d [late arrival: rounds]:", (int)rank);
+            for (size_t b = 0; b < numBuckets; ++b)
+                fprintf(stderr, " %d: %d", (int)b, (int)histograms[rank * numBuckets + b]);
+            fprintf(stderr, "\n");
+        }
+    }
+
+    void PublishLateness()
+    {
+        MPI_Accumulate(m_lateness.data(), (int)m_lateness.size(), MPI_LONG_LONG, m_mpi->MainNodeRank(), (MPI_Aint)LatenessOffset(MyRank()), (int)m_lateness.size(), MPI_LONG_LONG, MPI_REPLACE, m_arrivalWindow) || MpiFail("MPI_Accumulate");
+    }
+
+    // layout of the arrival window: s_numRoundSlots counters, s_numRoundSlots lists of N arrivals, N lateness histograms
+    size_t ArrivalListOffset(size_t slot) const { return s_numRoundSlots + slot * NumProc(); }
+    size_t LatenessOffset(size_t rank) const { return s_numRoundSlots * (1 + NumProc()) + rank * (m_numBackupWorkers + 1); }
+    size_t ArrivalWindowSize() const { return LatenessOffset(NumProc()); }
+    long long ArrivalEntry(size_t round, size_t rank) const { return (long long)(round * NumProc() + rank); }
+
+    // tags of the current round's messages; late workers are less than s_numRoundSlots rounds behind, so they can't mix up rounds
+    int RoundTag(int tag) const { return (int)(tag * s_numTagRounds + m_round % s_numTagRounds); }
+
 private:
     std::unique_ptr<CUDAPageLockedMemAllocator> m_allocator;
     std::vector<std::shared_ptr<ElemType>> m_intermediateCPUBuffers;
@@ -371,5 +727,35 @@ private:
     bool m_initialized;
 
     NcclComm m_nccl;
+
+    // Aggregation with backup workers
+    size_t m_numBackupWorkers;
+    bool m_dropLateGradients;
+    MPI_Comm m_backupWorkersComm;
+    static const size_t s_numRoundSlots = 4;                // rounds in flight in the arrival window
+    static const size_t s_numTagRounds = 8192;
+    static const int s_onTimeCommTag = 0;
+    static const int s_lateAggregateHeaderTag = 1;
+    static const int s_lateAggregateTag = 2;
+
+    struct LateAggregateSend
+    {
+        std::vector<double> headerStats;
+        std::vector<ElemType> gradients;
+        std::vector<MPI_Request> requests;
+    };
+
+    MPI_Group m_backupWorkersGroup;
+    MPI_Win m_arrivalWindow;
+    long long* m_arrivals;                                  // on the main node: the arrival window (see ArrivalWindowSize())
+    size_t m_round;                                         // current aggregation round
+    std::vector<size_t> m_gradientOffsets;                  // offsets of the gradient matrices in the flattened buffers
+    std::vector<ElemType> m_hostGradients;                  // own gradients, and the aggregate after the round
+    std::vector<double> m_headerStats;                      // header and contribution count, flattened for the allreduce
+    std::vector<ElemType> m_lateGradients;                  // late gradients to be folded into the next contribution
+    DistGradHeader* m_lateHeader;
+    bool m_hasLateGradients;
+    std::vector<long long> m_lateness;                      // this worker's lateness histogram (see PrintLatenessHistograms())
+    std::list<LateAggregateSend> m_lateAggregateSends;      // aggregates in flight to late workers
 };
 } } }
@@ -65,10 +65,10 @@ public:
         while (DataReaderHelpers::GetMinibatchIntoNetwork<ElemType>(dataReader, m_net, nullptr, false, false, inputMatrices, actualMBSize, nullptr))
         {
             ComputationNetwork::BumpEvalTimeStamp(inputNodes);
+            m_net->ForwardProp(outputNodes);
 
             for (int i = 0; i < outputNodes.size(); i++)
             {
-                m_net->ForwardProp(outputNodes[i]);
                 outputMatrices[outputNodes[i]->NodeName()] = (void*) (&dynamic_pointer_cast<ComputationNode<ElemType>>(outputNodes[i])->Value());
             }
 
@@ -109,9 +109,9 @@ public:
 
         std::map<std::wstring, void*, nocase_compare> outputMatrices;
 
+        m_net->ForwardProp(outputNodes);
         for (int i = 0; i < outputNodes.size(); i++)
         {
-            m_net->ForwardProp(outputNodes[i]);
             outputMatrices[outputNodes[i]->NodeName()] = (void*)(&dynamic_pointer_cast<ComputationNode<ElemType>>(outputNodes[i])->Value());
         }
 
@@ -5,8 +5,10 @@
 
 #include "stdafx.h"
 #include "EvalTestHelper.h"
+#include "EvalBatchingQueue.h"
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <thread>
 
 using namespace Microsoft::MSR::CNTK;
 
@@ -219,6 +221,246 @@ BOOST_AUTO_TEST_CASE(EvalDenseTimesTest)
     eval->Destroy();
 }
 
+BOOST_AUTO_TEST_CASE(EvalDenseTimesBatchTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(2) \n"
+        "o1 = Times(Constant(2, rows=1, cols=2), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // Three sequences of different lengths, evaluated in one minibatch
+    std::vector<Values<float>> inputBatch(3, Values<float>(1));
+    inputBatch[0][0].m_buffer = { 1, 2, 3, 4 };
+    inputBatch[1][0].m_buffer = { 5, 6 };
+    inputBatch[2][0].m_buffer = { 1, 1, 0, 1, 2, 0 };
+
+    std::vector<Values<float>> outputBatch(2, outputLayouts.CreateBuffers<float>({ 3 }));
+    BOOST_REQUIRE_THROW(eval->ForwardPass(inputBatch, outputBatch), std::exception); // Outputs for every sequence required
+
+    outputBatch.push_back(outputLayouts.CreateBuffers<float>({ 3 }));
+    eval->ForwardPass(inputBatch, outputBatch);
+
+    std::vector<std::vector<float>> expected{ { 6, 14 }, { 22 }, { 4, 2, 4 } };
+    for (size_t seq = 0; seq < expected.size(); ++seq)
+    {
+        auto buf = outputBatch[seq][0].m_buffer;
+        BOOST_CHECK_EQUAL_COLLECTIONS(buf.begin(), buf.end(), expected[seq].begin(), expected[seq].end());
+    }
+
+    // The batch must give the same results as evaluating the sequences one by one
+    Values<float> outputBuffer = outputLayouts.CreateBuffers<float>({ 3 });
+    for (size_t seq = 0; seq < expected.size(); ++seq)
+    {
+        eval->ForwardPass(inputBatch[seq], outputBuffer);
+        auto buf = outputBuffer[0].m_buffer;
+        BOOST_CHECK_EQUAL_COLLECTIONS(buf.begin(), buf.end(), expected[seq].begin(), expected[seq].end());
+    }
+
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalExternalBufferTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(2) \n"
+        "h1 = Times(Constant(1, rows=3, cols=2), i1) \n"
+        "o1 = Times(Constant(2, rows=1, cols=3), h1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // Dense CPU inputs and outputs are bound to the caller's buffers; results must be the same for
+    // changing sequence lengths, and when mixed with calls that copy
+    std::vector<float> input{ 1, 2, 3, 4, 5, 6 };
+    std::vector<float> output(3);
+    ValueRefs<float> inputRefs(1);
+    ValueRefs<float> outputRefs(1);
+    for (size_t length = 1; length <= 3; ++length)
+    {
+        inputRefs[0].m_buffer.InitFrom(input.data(), input.size(), 2 * length);
+        outputRefs[0].m_buffer.InitFrom(output.data(), output.size(), 0);
+        eval->ForwardPass(inputRefs, outputRefs);
+
+        std::vector<float> expected{ 18, 42, 66 };
+        BOOST_REQUIRE_EQUAL(outputRefs[0].m_buffer.size(), length);
+        BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.begin() + length, expected.begin(), expected.begin() + length);
+
+        std::vector<Values<float>> inputBatch(1, Values<float>(1));
+        inputBatch[0][0].m_buffer = { 1, 1 };
+        std::vector<Values<float>> outputBatch(1, outputLayouts.CreateBuffers<float>({ 1 }));
+        eval->ForwardPass(inputBatch, outputBatch);
+        BOOST_CHECK_EQUAL(outputBatch[0][0].m_buffer[0], 12);
+    }
+
+    // The input is left unchanged
+    std::vector<float> expectedInput{ 1, 2, 3, 4, 5, 6 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(input.begin(), input.end(), expectedInput.begin(), expectedInput.end());
+
+    // An output buffer that is too small is reported, and the network is usable afterwards
+    inputRefs[0].m_buffer.InitFrom(input.data(), input.size(), input.size());
+    outputRefs[0].m_buffer.InitFrom(output.data(), 2, 0);
+    BOOST_REQUIRE_THROW(eval->ForwardPass(inputRefs, outputRefs), std::exception);
+
+    Values<float> inputBuffer(1);
+    inputBuffer[0].m_buffer = { 1, 2 };
+    Values<float> outputBuffer = outputLayouts.CreateBuffers<float>({ 1 });
+    eval->ForwardPass(inputBuffer, outputBuffer);
+    BOOST_CHECK_EQUAL(outputBuffer[0].m_buffer.size(), 1);
+    BOOST_CHECK_EQUAL(outputBuffer[0].m_buffer[0], 18);
+
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalSharedModelTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(4) \n"
+        "o1 = Times(Constant(2, rows=1, cols=4), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    IEvaluateModelShared<float>* model;
+    GetEvalSharedF(&model);
+    model->CreateNetwork(modelDefinition);
+
+    const size_t numThreads = 4;
+    std::vector<IEvaluateModelExtended<float>*> evaluators;
+    for (size_t i = 0; i < numThreads; ++i)
+        evaluators.push_back(model->CreateEvaluator());
+
+    // The evaluators keep the shared parameters alive
+    model->Destroy();
+
+    std::vector<int> failures(numThreads, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        threads.push_back(std::thread([&, i]()
+        {
+            auto eval = evaluators[i];
+            eval->StartForwardEvaluation({ L"o1" });
+            Values<float> outputBuffer = eval->GetOutputSchema().CreateBuffers<float>({ 1 });
+            Values<float> inputBuffer(1);
+            for (size_t iteration = 0; iteration < 100; ++iteration)
+            {
+                float x = (float)(i + iteration);
+                inputBuffer[0].m_buffer = { x, x, x, x };
+                eval->ForwardPass(inputBuffer, outputBuffer);
+                if (outputBuffer[0].m_buffer.size() != 1 || outputBuffer[0].m_buffer[0] != 8 * x)
+                    failures[i]++;
+            }
+        }));
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        BOOST_CHECK_EQUAL(failures[i], 0);
+        evaluators[i]->Destroy();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EvalBatchingQueueTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(2) \n"
+        "o1 = Times(Constant(2, rows=1, cols=2), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    const size_t numThreads = 4;
+    const size_t numRequests = 50;
+    std::vector<int> failures(numThreads, 0);
+    {
+        EvalBatchingQueue<float> queue(eval, 8, std::chrono::milliseconds(2));
+
+        // Every thread submits sequences of different lengths and checks its own results
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < numThreads; ++i)
+        {
+            threads.push_back(std::thread([&, i]()
+            {
+                std::vector<std::future<Values<float>>> results;
+                for (size_t request = 0; request < numRequests; ++request)
+                {
+                    size_t length = 1 + (i + request) % 5;
+                    Values<float> inputs(1);
+                    inputs[0].m_buffer.assign(2 * length, (float)request);
+                    results.push_back(queue.Submit(std::move(inputs)));
+                }
+                for (size_t request = 0; request < numRequests; ++request)
+                {
+                    size_t length = 1 + (i + request) % 5;
+                    Values<float> outputs = results[request].get();
+                    if (outputs.size() != 1 || outputs[0].m_buffer != std::vector<float>(length, 4.0f * request))
+                        failures[i]++;
+                }
+            }));
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        auto statistics = queue.GetStatistics();
+        BOOST_CHECK_EQUAL(statistics.m_numRequests, numThreads * numRequests);
+        BOOST_CHECK(statistics.m_numBatches <= statistics.m_numRequests);
+        BOOST_CHECK(statistics.m_meanBatchOccupancy > 0 && statistics.m_meanBatchOccupancy <= 1);
+        BOOST_CHECK(statistics.m_latencyP50Ms <= statistics.m_latencyP99Ms);
+
+        // Inputs that don't match the schema are rejected by Submit(), and don't affect the requests batched with them
+        Values<float> goodInput(1);
+        goodInput[0].m_buffer = { 1, 2 };
+        auto goodResult = queue.Submit(std::move(goodInput));
+        Values<float> wrongInput(1);
+        wrongInput[0].m_buffer = { 1, 2, 3 };
+        BOOST_REQUIRE_THROW(queue.Submit(std::move(wrongInput)), std::invalid_argument);
+        Values<float> emptyInput(1);
+        BOOST_REQUIRE_THROW(queue.Submit(std::move(emptyInput)), std::invalid_argument);
+        BOOST_REQUIRE_THROW(queue.Submit(Values<float>(2)), std::invalid_argument);
+        BOOST_CHECK(goodResult.get()[0].m_buffer == std::vector<float>{ 6 });
+    }
+
+    for (size_t i = 0; i < numThreads; ++i)
+        BOOST_CHECK_EQUAL(failures[i], 0);
+
+    eval->Destroy();
+}
+
 BOOST_AUTO_TEST_CASE(EvalSparseTimesTest)
 {
     std::string modelDefinition =
@@ -284,6 +526,215 @@ BOOST_AUTO_TEST_CASE(EvalSparseTimesTest)
     eval->Destroy();
 }
 
+BOOST_AUTO_TEST_CASE(EvalStreamingSessionTest)
+{
+    // o(t) = i(t) + o(t-2)
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(1) \n"
+        "d1 = PastValue(1, o1, timeStep=2, defaultHiddenActivity=0) \n"
+        "o1 = Plus(i1, d1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    IEvaluateSession* sessionA = eval->CreateSession();
+    IEvaluateSession* sessionB = eval->CreateSession();
+
+    // Two streams, fed in chunks of different lengths, sometimes batched together and sometimes alone
+    std::vector<std::vector<IEvaluateSession*>> sessions{ { sessionA, sessionB }, { sessionB, sessionA }, { sessionA } };
+    std::vector<std::vector<std::vector<float>>> chunks{ { { 1 }, { 10, 20 } }, { { 30 }, { 2, 3, 4 } }, { { 5 } } };
+    std::vector<std::vector<std::vector<float>>> expected{ { { 1 }, { 10, 20 } }, { { 40 }, { 2, 4, 6 } }, { { 9 } } };
+    for (size_t call = 0; call < sessions.size(); ++call)
+    {
+        std::vector<Values<float>> inputBatch;
+        std::vector<Values<float>> outputBatch;
+        for (const auto& chunk : chunks[call])
+        {
+            inputBatch.push_back(Values<float>(1));
+            inputBatch.back()[0].m_buffer = chunk;
+            outputBatch.push_back(outputLayouts.CreateBuffers<float>({ 3 }));
+        }
+        eval->ForwardPass(sessions[call], inputBatch, outputBatch);
+
+        for (size_t seq = 0; seq < expected[call].size(); ++seq)
+        {
+            auto buf = outputBatch[seq][0].m_buffer;
+            BOOST_CHECK_EQUAL_COLLECTIONS(buf.begin(), buf.end(), expected[call][seq].begin(), expected[call][seq].end());
+        }
+    }
+
+    // A stream evaluated in chunks gives the same result as in one piece
+    Values<float> inputBuffer(1);
+    inputBuffer[0].m_buffer = { 1, 2, 3, 4, 5 };
+    Values<float> outputBuffer = outputLayouts.CreateBuffers<float>({ 5 });
+    eval->ForwardPass(inputBuffer, outputBuffer);
+    std::vector<float> expectedA{ 1, 2, 4, 6, 9 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(outputBuffer[0].m_buffer.begin(), outputBuffer[0].m_buffer.end(), expectedA.begin(), expectedA.end());
+
+    // After a reset, the session starts a new sequence
+    sessionA->Reset();
+    std::vector<Values<float>> inputBatch(1, Values<float>(1));
+    inputBatch[0][0].m_buffer = { 7, 8, 9 };
+    std::vector<Values<float>> outputBatch(1, outputLayouts.CreateBuffers<float>({ 3 }));
+    eval->ForwardPass({ sessionA }, inputBatch, outputBatch);
+    std::vector<float> expectedReset{ 7, 8, 16 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(outputBatch[0][0].m_buffer.begin(), outputBatch[0][0].m_buffer.end(), expectedReset.begin(), expectedReset.end());
+
+    // A session must not appear twice in one call
+    inputBatch.push_back(inputBatch[0]);
+    outputBatch.push_back(outputBatch[0]);
+    BOOST_REQUIRE_THROW(eval->ForwardPass({ sessionA, sessionA }, inputBatch, outputBatch), std::exception);
+
+    sessionA->Destroy();
+    sessionB->Destroy();
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalMultipleOutputsTest)
+{
+    // Two outputs on top of a shared hidden layer, computed in one traversal
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(2) \n"
+        "h1 = Times(Constant(2, rows=2, cols=2), i1) \n"
+        "o1 = Plus(h1, Constant(1), tag=\"output\") \n"
+        "o2 = Times(Constant(1, rows=1, cols=2), h1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    IEvaluateModelExtended<float>* eval;
+    GetEvalExtendedF(&eval);
+    eval->CreateNetwork(modelDefinition);
+    eval->StartForwardEvaluation({ L"o1", L"o2" });
+
+    Values<float> inputBuffer(1);
+    inputBuffer[0].m_buffer = { 1, 2, 3, 4 };
+    Values<float> outputBuffer = eval->GetOutputSchema().CreateBuffers<float>({ 2, 2 });
+    eval->ForwardPass(inputBuffer, outputBuffer);
+
+    std::vector<float> expected1{ 7, 7, 15, 15 };
+    std::vector<float> expected2{ 12, 28 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(outputBuffer[0].m_buffer.begin(), outputBuffer[0].m_buffer.end(), expected1.begin(), expected1.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(outputBuffer[1].m_buffer.begin(), outputBuffer[1].m_buffer.end(), expected2.begin(), expected2.end());
+
+    // again with new input, the shared hidden layer must be recomputed once for both outputs
+    inputBuffer[0].m_buffer = { 0, 1 };
+    eval->ForwardPass(inputBuffer, outputBuffer);
+    expected1 = { 3, 3 };
+    expected2 = { 4 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(outputBuffer[0].m_buffer.begin(), outputBuffer[0].m_buffer.end(), expected1.begin(), expected1.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(outputBuffer[1].m_buffer.begin(), outputBuffer[1].m_buffer.end(), expected2.begin(), expected2.end());
+
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalOptimizeForInferenceTest)
+{
+    // W is a parameter-only subgraph, the batch normalization is folded into Times(W, i1), the dropout is removed,
+    // and the criterion with its labels is not needed for the output
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "optimizeForInference = true \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(2) \n"
+        "labels = Input(1) \n"
+        "W = Times(Constant(1, rows=2, cols=2), Constant(2, rows=2, cols=2)) \n"
+        "h1 = Times(W, i1) \n"
+        "bn = BatchNormalization(h1, Constant(2, rows=2), Constant(1, rows=2), Constant(3, rows=2), Constant(4, rows=2), spatial=false, epsilon=0) \n"
+        "d = Dropout(bn) \n"
+        "o1 = Times(Constant(1, rows=1, cols=2), d, tag=\"output\") \n"
+        "ce = SquareError(labels, o1, tag=\"criterion\") \n"
+        "FeatureNodes = (i1:labels) \n"
+        "] \n";
+
+    IEvaluateModelExtended<float>* eval;
+    GetEvalExtendedF(&eval);
+    eval->CreateNetwork(modelDefinition);
+
+    // The dropout, the criterion and its labels are gone, so they can no longer be evaluated; the batch normalization
+    // keeps its name for the Plus it is folded into. OptimizeForInferenceTests in the NetworkTests check the nodes in detail.
+    BOOST_CHECK_THROW(eval->StartForwardEvaluation({ L"d" }), std::exception);
+    BOOST_CHECK_THROW(eval->StartForwardEvaluation({ L"ce" }), std::exception);
+    BOOST_CHECK_THROW(eval->StartForwardEvaluation({ L"labels" }), std::exception);
+
+    eval->StartForwardEvaluation({ L"o1" });
+    BOOST_REQUIRE_EQUAL(eval->GetInputSchema().size(), (size_t)1);
+
+    Values<float> inputBuffer(1);
+    inputBuffer[0].m_buffer = { 1, 2, 0, 1 };
+    Values<float> outputBuffer = eval->GetOutputSchema().CreateBuffers<float>({ 2 });
+    eval->ForwardPass(inputBuffer, outputBuffer);
+
+    // W = 4, h1 = { 12, 12 } and { 4, 4 }, bn = 2 * (h1 - 3) / sqrt(4) + 1
+    std::vector<float> expected{ 20, 4 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(outputBuffer[0].m_buffer.begin(), outputBuffer[0].m_buffer.end(), expected.begin(), expected.end());
+
+    eval->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalParameterPrecisionTest)
+{
+    // 1 + 2^-10 is a float16 value, but rounds to 1 in bfloat16
+    auto modelDefinition = [](const std::string& parameterPrecision)
+    {
+        return
+            "deviceId = -1 \n"
+            "precision = \"float\" \n"
+            "traceLevel = 1 \n"
+            "parameterPrecision = \"" + parameterPrecision + "\" \n"
+            "run=NDLNetworkBuilder \n"
+            "NDLNetworkBuilder=[ \n"
+            "i1 = Input(2) \n"
+            "W = Constant(1.0009765625, rows=2, cols=2) \n"
+            "o1 = Times(W, i1, tag=\"output\") \n"
+            "FeatureNodes = (i1) \n"
+            "] \n";
+    };
+
+    auto evaluate = [&](const std::string& parameterPrecision) -> std::vector<float>
+    {
+        IEvaluateModelExtended<float>* eval;
+        GetEvalExtendedF(&eval);
+        eval->CreateNetwork(modelDefinition(parameterPrecision));
+        eval->StartForwardEvaluation({ L"o1" });
+        Values<float> inputBuffer(1);
+        inputBuffer[0].m_buffer = { 1, 2 };
+        Values<float> outputBuffer = eval->GetOutputSchema().CreateBuffers<float>({ 1 });
+        eval->ForwardPass(inputBuffer, outputBuffer);
+        eval->Destroy();
+        return outputBuffer[0].m_buffer;
+    };
+
+    std::vector<float> expectedFloat16{ 3.0029296875f, 3.0029296875f };
+    auto float16 = evaluate("float16");
+    BOOST_CHECK_EQUAL_COLLECTIONS(float16.begin(), float16.end(), expectedFloat16.begin(), expectedFloat16.end());
+
+    std::vector<float> expectedBFloat16{ 3, 3 };
+    auto bfloat16 = evaluate("bfloat16");
+    BOOST_CHECK_EQUAL_COLLECTIONS(bfloat16.begin(), bfloat16.end(), expectedBFloat16.begin(), expectedBFloat16.end());
+
+    IEvaluateModelExtended<float>* eval;
+    GetEvalExtendedF(&eval);
+    BOOST_CHECK_THROW(eval->CreateNetwork(modelDefinition("int4")), std::invalid_argument);
+    eval->Destroy();
+}
+
 BOOST_AUTO_TEST_CASE(EvalRNNTest)
 {
     std::string modelDefinition =
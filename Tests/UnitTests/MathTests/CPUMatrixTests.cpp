@@ -4,6 +4,7 @@
 //
 #include "stdafx.h"
 #include "../../../Source/Math/CPUMatrix.h"
+#include "../../../Source/Math/CPUFusedUpdate.h"
 
 using namespace Microsoft::MSR::CNTK;
 
@@ -898,6 +899,114 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixSeedingDouble, RandomSeedFixture)
     BOOST_CHECK(m1.IsEqualTo(m2));
 }
 
+// Reference for CPUMatrixFusedUpdate: the CPUMatrix functions that the learners call one parameter after the other,
+// with the gradient clipping and regularization of LearnerBase around them.
+static void ReferenceUpdate(const FusedUpdateParameters& update, double adaMultiplier, SMatrix& value, SMatrix& gradient, SMatrix& state)
+{
+    const float learningRate = (float) update.m_learningRate;
+    const float momentum = (float) update.m_momentum;
+    if (update.m_clipThreshold != std::numeric_limits<double>::infinity())
+        gradient.InplaceTruncate((float) update.m_clipThreshold);
+    if (update.m_l2Weight > 0)
+        SMatrix::ScaleAndAdd((float) update.m_l2Weight, value, gradient);
+
+    float aveMultiplier = 1;
+    switch (update.m_kind)
+    {
+    case FusedUpdateKind::SGD:
+        SMatrix::Scale(momentum, state);
+        SMatrix::ScaleAndAdd((1 - momentum) * learningRate, gradient, state);
+        value -= state;
+        break;
+    case FusedUpdateKind::Nesterov:
+        SMatrix::Scale(momentum, state);
+        SMatrix::ScaleAndAdd((1 - momentum) * learningRate, gradient, state);
+        SMatrix::ScaleAndAdd(-momentum, state, value);
+        SMatrix::ScaleAndAdd(-(1 - momentum) * learningRate, gradient, value);
+        break;
+    case FusedUpdateKind::AdaGrad:
+        aveMultiplier = state.Adagrad(gradient, update.m_needAveMultiplier);
+        SMatrix::ScaleAndAdd(-learningRate / aveMultiplier, gradient, value);
+        break;
+    case FusedUpdateKind::FSAdaGrad:
+        state.FSAdagrad(gradient, value, learningRate, momentum, (float) update.m_varianceMomentum, (float) adaMultiplier);
+        break;
+    case FusedUpdateKind::RmsProp:
+        aveMultiplier = state.RmsProp(gradient, (float) update.m_rmsGamma, (float) update.m_rmsWeightInc, (float) update.m_rmsWeightMax,
+                                      (float) update.m_rmsWeightDec, (float) update.m_rmsWeightMin, update.m_needAveMultiplier);
+        SMatrix::ScaleAndAdd(-learningRate / aveMultiplier, gradient, value);
+        break;
+    }
+
+    if (update.m_l1Weight > 0)
+        value.InplaceSoftThreshold((float) update.m_l1Weight);
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUMatrixFusedUpdate, RandomSeedFixture)
+{
+    const std::vector<size_t> sizes = { 1, 7, 100, 40000 }; // the last one spans several chunks
+
+    std::vector<FusedUpdateParameters> updates;
+    for (auto kind : { FusedUpdateKind::SGD, FusedUpdateKind::Nesterov, FusedUpdateKind::AdaGrad, FusedUpdateKind::FSAdaGrad, FusedUpdateKind::RmsProp })
+    {
+        for (int variant = 0; variant < 3; variant++)
+        {
+            FusedUpdateParameters update;
+            update.m_kind = kind;
+            update.m_learningRate = 0.1;
+            update.m_momentum = variant == 0 ? 0 : 0.9;
+            update.m_varianceMomentum = 0.99;
+            update.m_needAveMultiplier = variant != 1;
+            update.m_rmsGamma = 0.9;
+            update.m_rmsWeightInc = 1.2;
+            update.m_rmsWeightDec = 0.75;
+            update.m_rmsWeightMax = 10;
+            update.m_rmsWeightMin = 0.1;
+            if (variant == 2)
+            {
+                update.m_clipThreshold = 0.5;
+                update.m_l2Weight = 0.01;
+                update.m_l1Weight = 0.001;
+            }
+            updates.push_back(update);
+        }
+    }
+
+    unsigned long seed = 1;
+    for (const auto& update : updates)
+    {
+        std::vector<SMatrix> values, gradients, states, expectedValues, expectedGradients, expectedStates;
+        for (size_t n : sizes)
+        {
+            values.push_back(SMatrix::RandomUniform(n, 1, -1, 1, seed++));
+            gradients.push_back(SMatrix::RandomUniform(n, 1, -1, 1, seed++));
+            states.push_back(SMatrix::RandomUniform(n, update.StateSize(), 0.1f, 1, seed++));
+            expectedValues.push_back(values.back());
+            expectedGradients.push_back(gradients.back());
+            expectedStates.push_back(states.back());
+        }
+
+        std::vector<FusedUpdateTensor<float>> tensors;
+        for (size_t t = 0; t < sizes.size(); t++)
+        {
+            const double adaMultiplier = 1.0 + t;
+            tensors.push_back({ values[t].Data(), gradients[t].Data(), states[t].Data(), sizes[t], adaMultiplier });
+            ReferenceUpdate(update, adaMultiplier, expectedValues[t], expectedGradients[t], expectedStates[t]);
+        }
+
+        BOOST_CHECK_EQUAL(CPUFusedUpdate::Update(update, tensors), SIZE_MAX);
+        for (size_t t = 0; t < sizes.size(); t++)
+        {
+            BOOST_CHECK(values[t].IsEqualTo(expectedValues[t], 1e-5f));
+            BOOST_CHECK(states[t].IsEqualTo(expectedStates[t], 1e-5f));
+        }
+
+        // a NaN in the gradient of the third tensor is reported for that tensor
+        gradients[2](3, 0) = std::numeric_limits<float>::quiet_NaN();
+        BOOST_CHECK_EQUAL(CPUFusedUpdate::Update(update, tensors), 2);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }
 } } }
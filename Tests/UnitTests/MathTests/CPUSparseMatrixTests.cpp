@@ -6,6 +6,7 @@
 #ifdef _WIN32
 #include <crtdefs.h>
 #endif
+#include <algorithm>
 #include "../../../Source/Math/CPUSparseMatrix.h"
 
 using namespace Microsoft::MSR::CNTK;
@@ -61,6 +62,231 @@ BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixCopyColumnSliceToDense, RandomSeedFixture
     BOOST_CHECK(dm1.IsEqualTo(dm2, c_epsilonFloatE4));
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixCopyCSCToArrays, RandomSeedFixture)
+{
+    SparseMatrix sm(MatrixFormat::matrixFormatSparseCSC, 10, 3, 0);
+    sm.SetValue(7, 0, 1);
+    sm.SetValue(2, 1, 2);
+    sm.SetValue(7, 2, 3);
+
+    std::vector<CPUSPARSE_INDEX_TYPE> columnStarts, rowIndices;
+    std::vector<double> values;
+    sm.CopyCSCToArrays(columnStarts, rowIndices, values);
+
+    std::vector<CPUSPARSE_INDEX_TYPE> expectedColumnStarts = {0, 1, 2, 3};
+    std::vector<CPUSPARSE_INDEX_TYPE> expectedRowIndices = {7, 2, 7};
+    std::vector<double> expectedValues = {1, 2, 3};
+    BOOST_CHECK_EQUAL_COLLECTIONS(columnStarts.begin(), columnStarts.end(), expectedColumnStarts.begin(), expectedColumnStarts.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(rowIndices.begin(), rowIndices.end(), expectedRowIndices.begin(), expectedRowIndices.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expectedValues.begin(), expectedValues.end());
+
+    // a column slice is rebased to start at 0
+    sm.ColumnSlice(1, 2).CopyCSCToArrays(columnStarts, rowIndices, values);
+    expectedColumnStarts = {0, 1, 2};
+    expectedRowIndices = {2, 7};
+    expectedValues = {2, 3};
+    BOOST_CHECK_EQUAL_COLLECTIONS(columnStarts.begin(), columnStarts.end(), expectedColumnStarts.begin(), expectedColumnStarts.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(rowIndices.begin(), rowIndices.end(), expectedRowIndices.begin(), expectedRowIndices.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expectedValues.begin(), expectedValues.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixCopyBlockColumnsToArray, RandomSeedFixture)
+{
+    const size_t m = 4;
+    const size_t vocabSize = 10;
+    const size_t numSamples = 3;
+
+    // one-hot samples with ids 7, 2, 7, as for the gradient of an embedding E in Times(E, x)
+    SparseMatrix x(MatrixFormat::matrixFormatSparseCSC, vocabSize, numSamples, 0);
+    x.SetValue(7, 0, 1);
+    x.SetValue(2, 1, 1);
+    x.SetValue(7, 2, 1);
+    DenseMatrix dy(m, numSamples);
+    dy.SetUniformRandomValue(-1, 1, IncrementCounter());
+
+    // gradient = dy * x^T, which only has columns 2 and 7
+    SparseMatrix gradient(MatrixFormat::matrixFormatSparseBlockCol, m, vocabSize, 0);
+    SparseMatrix::MultiplyAndAdd(1, dy, false, x, true, gradient);
+
+    std::vector<size_t> columnIds;
+    std::vector<double> values;
+    gradient.CopyBlockColumnsToArray(columnIds, values);
+
+    BOOST_REQUIRE_EQUAL(columnIds.size(), 2);
+    BOOST_REQUIRE_EQUAL(values.size(), 2 * m);
+    DenseMatrix dense = gradient.CopyColumnSliceToDense(0, vocabSize);
+    for (size_t j = 0; j < columnIds.size(); j++)
+    {
+        BOOST_CHECK(columnIds[j] == 2 || columnIds[j] == 7);
+        for (size_t i = 0; i < m; i++)
+            BOOST_CHECK_SMALL(values[j * m + i] - dense(i, columnIds[j]), (double) c_epsilonFloatE4);
+    }
+    for (size_t i = 0; i < m; i++)
+        BOOST_CHECK_SMALL(dense(i, 7) - (dy(i, 0) + dy(i, 2)), (double) c_epsilonFloatE4);
+}
+
+// Sparse x dense and dense x sparse products for all transpositions and sparse formats, compared with the dense product
+BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixMultiplyAndWeightedAdd, RandomSeedFixture)
+{
+    const size_t rows = 37;
+    const size_t cols = 23;
+    const double alpha = 0.7;
+
+    // a random sparse matrix of rows x cols in CSC and CSR format, and one in block-column format
+    DenseMatrix dense(rows, cols);
+    dense.SetUniformRandomValue(-1, 1, IncrementCounter());
+    SparseMatrix csc(MatrixFormat::matrixFormatSparseCSC, rows, cols, 0);
+    SparseMatrix csr(MatrixFormat::matrixFormatSparseCSR, rows, cols, 0);
+    for (size_t row = 0; row < rows; row++)
+    {
+        for (size_t col = 0; col < cols; col++)
+        {
+            if ((row * 7 + col * 3) % 5 != 0)
+                dense(row, col) = 0;
+            else
+                csr.SetValue(row, col, dense(row, col));
+        }
+    }
+    foreach_coord (row, col, dense)
+    {
+        if (dense(row, col) != 0)
+            csc.SetValue(row, col, dense(row, col));
+    }
+    SparseMatrix oneHot(MatrixFormat::matrixFormatSparseCSC, cols, 2, 0);
+    oneHot.SetValue(3, 0, 1);
+    oneHot.SetValue(17, 0, 1);
+    oneHot.SetValue(5, 1, 1);
+    DenseMatrix blockValues(rows, 2);
+    blockValues.SetUniformRandomValue(-1, 1, IncrementCounter());
+    SparseMatrix blockCol(MatrixFormat::matrixFormatSparseBlockCol, rows, cols, 0);
+    SparseMatrix::MultiplyAndAdd(1, blockValues, false, oneHot, true, blockCol);
+    DenseMatrix blockColDense = blockCol.CopyColumnSliceToDense(0, cols);
+
+    std::vector<std::pair<const SparseMatrix*, const DenseMatrix*>> sparseMatrices = {{&csc, &dense}, {&csr, &dense}, {&blockCol, &blockColDense}};
+    for (const auto& sparse : sparseMatrices)
+    {
+        for (size_t outerDim : {1, 5, 300}) // the dimension of the product that is not that of the sparse matrix
+        {
+            for (bool transposeA : {false, true})
+            {
+                for (bool transposeB : {false, true})
+                {
+                    for (double beta : {0.0, 0.5})
+                    {
+                        // dense x sparse
+                        size_t inner = transposeB ? cols : rows;
+                        size_t n = transposeB ? rows : cols;
+                        DenseMatrix a(transposeA ? inner : outerDim, transposeA ? outerDim : inner);
+                        a.SetUniformRandomValue(-1, 1, IncrementCounter());
+                        DenseMatrix c(outerDim, n);
+                        c.SetUniformRandomValue(-1, 1, IncrementCounter());
+                        DenseMatrix expected(outerDim, n);
+                        expected.SetValue(c);
+                        SparseMatrix::MultiplyAndWeightedAdd(alpha, a, transposeA, *sparse.first, transposeB, beta, c);
+                        DenseMatrix::MultiplyAndWeightedAdd(alpha, a, transposeA, *sparse.second, transposeB, beta, expected);
+                        BOOST_CHECK(c.IsEqualTo(expected, c_epsilonFloatE4));
+
+                        // sparse x dense
+                        inner = transposeA ? rows : cols;
+                        size_t m = transposeA ? cols : rows;
+                        DenseMatrix b(transposeB ? outerDim : inner, transposeB ? inner : outerDim);
+                        b.SetUniformRandomValue(-1, 1, IncrementCounter());
+                        DenseMatrix d(m, outerDim);
+                        d.SetUniformRandomValue(-1, 1, IncrementCounter());
+                        expected.Resize(m, outerDim);
+                        expected.SetValue(d);
+                        SparseMatrix::MultiplyAndWeightedAdd(alpha, *sparse.first, transposeA, b, transposeB, beta, d);
+                        DenseMatrix::MultiplyAndWeightedAdd(alpha, *sparse.second, transposeA, b, transposeB, beta, expected);
+                        BOOST_CHECK(d.IsEqualTo(expected, c_epsilonFloatE4));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Dense x sparse into a block-column matrix for all transpositions
+BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixMultiplyAndAdd, RandomSeedFixture)
+{
+    const size_t m = 6;
+    const size_t vocabSize = 50;
+    const size_t numSamples = 4;
+
+    SparseMatrix x(MatrixFormat::matrixFormatSparseCSC, vocabSize, numSamples, 0);
+    x.SetValue(7, 0, 1);
+    x.SetValue(31, 0, 2);
+    x.SetValue(2, 1, 1);
+    x.SetValue(7, 3, 0.5);
+    DenseMatrix xDense = x.CopyColumnSliceToDense(0, numSamples);
+
+    for (bool transposeA : {false, true})
+    {
+        for (bool transposeB : {false, true})
+        {
+            size_t inner = transposeB ? numSamples : vocabSize;
+            size_t n = transposeB ? vocabSize : numSamples;
+            DenseMatrix a(transposeA ? inner : m, transposeA ? m : inner);
+            a.SetUniformRandomValue(-1, 1, IncrementCounter());
+
+            SparseMatrix c(MatrixFormat::matrixFormatSparseBlockCol, m, n, 0);
+            SparseMatrix::MultiplyAndAdd(1, a, transposeA, x, transposeB, c);
+            DenseMatrix expected(m, n);
+            DenseMatrix::MultiplyAndWeightedAdd(1, a, transposeA, xDense, transposeB, 0, expected);
+            BOOST_CHECK(c.CopyColumnSliceToDense(0, n).IsEqualTo(expected, c_epsilonFloatE4));
+        }
+    }
+}
+
+// Lookup in an embedding E with a one-hot input x, and its gradient dy * x^T, which has one block per distinct id
+BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixEmbedding, RandomSeedFixture)
+{
+    const size_t m = 8;
+    const size_t vocabSize = 100000;
+    DenseMatrix embedding(m, vocabSize);
+    embedding.SetUniformRandomValue(-1, 1, IncrementCounter());
+    SparseMatrix gradient(MatrixFormat::matrixFormatSparseBlockCol, m, vocabSize, 0);
+
+    // two minibatches into the same gradient matrix
+    for (const auto& ids : std::vector<std::vector<size_t>>{{vocabSize - 1, 5, 5, 123, vocabSize - 1, 7}, {2, 1}})
+    {
+        SparseMatrix x(MatrixFormat::matrixFormatSparseCSC, vocabSize, ids.size(), 0);
+        for (size_t j = 0; j < ids.size(); j++)
+            x.SetValue(ids[j], j, 1);
+
+        DenseMatrix y(m, ids.size());
+        y.SetUniformRandomValue(-1, 1, IncrementCounter()); // overwritten
+        SparseMatrix::MultiplyAndWeightedAdd(1, embedding, false, x, false, 0, y);
+        for (size_t j = 0; j < ids.size(); j++)
+        {
+            for (size_t i = 0; i < m; i++)
+                BOOST_CHECK_EQUAL(y(i, j), embedding(i, ids[j]));
+        }
+
+        DenseMatrix dy(m, ids.size());
+        dy.SetUniformRandomValue(-1, 1, IncrementCounter());
+        SparseMatrix::MultiplyAndAdd(1, dy, false, x, true, gradient);
+
+        std::vector<size_t> expectedIds = ids;
+        std::sort(expectedIds.begin(), expectedIds.end());
+        expectedIds.erase(std::unique(expectedIds.begin(), expectedIds.end()), expectedIds.end());
+        std::vector<size_t> columnIds;
+        std::vector<double> values;
+        gradient.CopyBlockColumnsToArray(columnIds, values);
+        BOOST_CHECK_EQUAL_COLLECTIONS(columnIds.begin(), columnIds.end(), expectedIds.begin(), expectedIds.end());
+        BOOST_REQUIRE_EQUAL(values.size(), expectedIds.size() * m);
+        for (size_t block = 0; block < expectedIds.size(); block++)
+        {
+            for (size_t i = 0; i < m; i++)
+            {
+                double sum = 0;
+                for (size_t j = 0; j < ids.size(); j++)
+                    sum += ids[j] == expectedIds[block] ? dy(i, j) : 0;
+                BOOST_CHECK_SMALL(values[block * m + i] - sum, (double) c_epsilonFloatE4);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }
 } } }
@@ -5,6 +5,7 @@
 #include "stdafx.h"
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <random>
 #include <numeric>
 #include <boost/random/normal_distribution.hpp>
@@ -14,6 +15,7 @@
 #include "../../../Source/Math/GPUMatrix.h"
 #include "../../../Source/Math/ConvolutionEngine.h"
 #include "../../../Source/Math/CuDnnFactories.h"
+#include "../../../Source/Math/CPUConvolution.h"
 #include "common.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
@@ -61,6 +63,14 @@ std::vector<std::tuple<ConvolutionEngineKind, DEVICEID_TYPE, size_t>> GetTestEng
     res.push_back(std::make_tuple(ConvolutionEngineKind::Gemm, -1, 0));
     res.push_back(std::make_tuple(ConvolutionEngineKind::Gemm, -1, 1));
     res.push_back(std::make_tuple(ConvolutionEngineKind::Gemm, -1, 3));
+
+    // Direct and Winograd engines. CPU only, 2D convolutions only, the reference engine is used for everything else.
+    auto withReference = [](ConvolutionEngineKind kind) { return (ConvolutionEngineKind)((int)kind | (int)ConvolutionEngineKind::Reference); };
+    res.push_back(std::make_tuple(withReference(ConvolutionEngineKind::Direct), -1, 0));
+    res.push_back(std::make_tuple(withReference(ConvolutionEngineKind::Winograd), -1, 0));
+    res.push_back(std::make_tuple(withReference(ConvolutionEngineKind::Winograd), -1, 3));
+    // Grouped engine. CPU only; the test geometries are not grouped, so this tests the fallback to the reference engine.
+    res.push_back(std::make_tuple(withReference(ConvolutionEngineKind::Grouped), -1, 0));
     return res;
 }
 
@@ -115,6 +125,12 @@ std::vector<ConvolveGeometryPtr> GenerateConvTestConfigs()
         ConvolveGeometry::BoolVec{true}, ConvolveGeometry::BoolVec{true, true, false},
         TensorShape(0), TensorShape(0)));
 
+    // 3x3 convolution with an output large enough for Winograd F(4x4, 3x3).
+    res.push_back(std::make_shared<ConvolveGeometry>(TensorShape(12, 10, 4),
+        TensorShape(3, 3, 4), TensorShape(6), TensorShape(1, 1, 4),
+        ConvolveGeometry::BoolVec{true}, ConvolveGeometry::BoolVec{true, true, false},
+        TensorShape(0), TensorShape(0)));
+
     // 1x1 convolution (shortcuts in ResNet).
     res.push_back(std::make_shared<ConvolveGeometry>(TensorShape(16, 16, 2),
         TensorShape(1, 1, 2), TensorShape(1), TensorShape(2, 2, 1),
@@ -583,6 +599,318 @@ BOOST_AUTO_TEST_CASE(MaxUnpooling)
     }
 }
 
+// Grouped and depthwise convolutions are not supported by cuDNN in this form, so the grouped engine is compared with
+// the reference engine.
+BOOST_AUTO_TEST_CASE(GroupedConvolution)
+{
+    std::mt19937 rng(0);
+    boost::random::normal_distribution<float> nd;
+    using BoolVec = ConvolveGeometry::BoolVec;
+
+    std::vector<ConvolveGeometryPtr> geometries;
+    // depthwise 3x3 with a channel multiplier of 2, stride 1 and 2
+    for (size_t stride : {1, 2})
+        geometries.push_back(std::make_shared<ConvolveGeometry>(TensorShape(11, 9, 6), TensorShape(3, 3, 1), TensorShape(1, 1, 2), TensorShape(stride, stride, 1),
+                                                                BoolVec{true, true, false}, BoolVec{true}, TensorShape(0), TensorShape(0)));
+    // 4 groups of 2 channels, 3 maps each
+    geometries.push_back(std::make_shared<ConvolveGeometry>(TensorShape(8, 7, 8), TensorShape(3, 3, 2), TensorShape(1, 1, 3), TensorShape(1, 1, 2),
+                                                            BoolVec{true, true, false}, BoolVec{true, true, false}, TensorShape(0), TensorShape(0)));
+    // the same 5x5 kernel applied to every channel
+    geometries.push_back(std::make_shared<ConvolveGeometry>(TensorShape(10, 10, 3), TensorShape(5, 5, 1), TensorShape(1), TensorShape(1),
+                                                            BoolVec{true}, BoolVec{false}, TensorShape(0), TensorShape(0)));
+
+    for (const auto& g : geometries)
+    {
+        auto refEng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, PoolKind::None, ConvolutionEngineKind::Reference);
+        auto eng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, PoolKind::None, ConvolutionEngineKind::Grouped);
+
+        size_t n = 3, inSize = g->InputShape().GetNumElements(), outSize = g->OutputShape().GetNumElements();
+        size_t kernelCount = g->KernelCount(), kernelSize = g->KernelShape().GetNumElements();
+        vec input(inSize * n), kernel(kernelSize * kernelCount), outGrad(outSize * n);
+        std::generate(begin(input), end(input), [&] { return nd(rng); });
+        std::generate(begin(kernel), end(kernel), [&] { return nd(rng); });
+        std::generate(begin(outGrad), end(outGrad), [&] { return nd(rng); });
+        SingleMatrix in(inSize, n, input.data(), CPUDEVICE, matrixFlagNormal);
+        SingleMatrix kern(kernelCount, kernelSize, kernel.data(), CPUDEVICE, matrixFlagNormal);
+        SingleMatrix srcGrad(outSize, n, outGrad.data(), CPUDEVICE, matrixFlagNormal);
+        SingleMatrix workspace(CPUDEVICE);
+
+        SingleMatrix out(outSize, n, CPUDEVICE), outRef(outSize, n, CPUDEVICE);
+        eng->Forward(in, kern, out, workspace);
+        refEng->Forward(in, kern, outRef, workspace);
+
+        // the backward functions add to their result
+        SingleMatrix grad(inSize, n, CPUDEVICE), gradRef(inSize, n, CPUDEVICE);
+        grad.SetValue(1);
+        gradRef.SetValue(1);
+        eng->BackwardData(srcGrad, kern, grad, workspace);
+        refEng->BackwardData(srcGrad, kern, gradRef, workspace);
+
+        SingleMatrix kernGrad(kernelCount, kernelSize, CPUDEVICE), kernGradRef(kernelCount, kernelSize, CPUDEVICE);
+        kernGrad.SetValue(1);
+        kernGradRef.SetValue(1);
+        eng->BackwardKernel(srcGrad, in, kernGrad, false, workspace);
+        refEng->BackwardKernel(srcGrad, in, kernGradRef, false, workspace);
+
+        std::string msg = " differs, geometry: " + (std::string)(*g) + ". ";
+        std::string emsg;
+        BOOST_REQUIRE_MESSAGE(CheckEqual(out, outRef, emsg, Err<float>::Rel * 4, Err<float>::Abs * 14), "out" << msg << emsg);
+        BOOST_REQUIRE_MESSAGE(CheckEqual(grad, gradRef, emsg, Err<float>::Rel * 4, Err<float>::Abs * 14), "grad" << msg << emsg);
+        BOOST_REQUIRE_MESSAGE(CheckEqual(kernGrad, kernGradRef, emsg, Err<float>::Rel * 4, Err<float>::Abs * 14), "kernGrad" << msg << emsg);
+    }
+}
+
+// The CPU engines add the bias and apply the activation in their output epilogue.
+BOOST_AUTO_TEST_CASE(ConvolutionForwardFused)
+{
+    std::mt19937 rng(0);
+    boost::random::normal_distribution<float> nd;
+    using BoolVec = ConvolveGeometry::BoolVec;
+
+    auto g = std::make_shared<ConvolveGeometry>(TensorShape(9, 7, 4), TensorShape(3, 3, 4), TensorShape(6), TensorShape(1, 1, 4),
+                                                BoolVec{true}, BoolVec{true, true, false}, TensorShape(0), TensorShape(0));
+    size_t n = 3, mapCount = 6, mapSize = g->OutputShape().GetNumElements() / mapCount;
+    auto refEng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, PoolKind::None, ConvolutionEngineKind::Reference);
+
+    vec input(g->InputShape().GetNumElements() * n), kernel(g->KernelShape().GetNumElements() * mapCount), bias(mapCount);
+    std::generate(begin(input), end(input), [&] { return nd(rng); });
+    std::generate(begin(kernel), end(kernel), [&] { return nd(rng); });
+    std::generate(begin(bias), end(bias), [&] { return nd(rng); });
+    SingleMatrix in(g->InputShape().GetNumElements(), n, input.data(), CPUDEVICE, matrixFlagNormal);
+    SingleMatrix kern(mapCount, g->KernelShape().GetNumElements(), kernel.data(), CPUDEVICE, matrixFlagNormal);
+    SingleMatrix biasMat(mapCount, 1, bias.data(), CPUDEVICE, matrixFlagNormal);
+    SingleMatrix out(g->OutputShape().GetNumElements(), n, CPUDEVICE);
+    SingleMatrix workspace(CPUDEVICE);
+    refEng->Forward(in, kern, out, workspace);
+    vec plain(out.Data(), out.Data() + out.GetNumElements());
+
+    for (auto activation : {FusedActivation::None, FusedActivation::ReLU, FusedActivation::Sigmoid, FusedActivation::Tanh})
+    {
+        for (bool hasBias : {false, true})
+        {
+            vec expected(plain.size());
+            for (size_t i = 0; i < plain.size(); i++)
+                expected[i] = ConvolutionEpilogue<float>(hasBias ? bias.data() : nullptr, activation).Apply(plain[i], (i / mapSize) % mapCount);
+            SingleMatrix expectedMat(out.GetNumRows(), n, expected.data(), CPUDEVICE, matrixFlagNormal);
+
+            for (auto engKind : {ConvolutionEngineKind::Gemm, ConvolutionEngineKind::Direct, ConvolutionEngineKind::Winograd})
+            {
+                auto eng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, PoolKind::None, engKind);
+                SingleMatrix result(out.GetNumRows(), n, CPUDEVICE);
+                BOOST_REQUIRE(eng->ForwardFused(in, kern, hasBias ? &biasMat : nullptr, activation, result, workspace));
+
+                std::string emsg;
+                BOOST_REQUIRE_MESSAGE(CheckEqual(result, expectedMat, emsg, Err<float>::Rel * 4, Err<float>::Abs * 14),
+                                      "Fused convolution with engine " << (int)engKind << ", activation " << (int)activation
+                                      << (hasBias ? " and bias" : "") << " differs. " << emsg);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BlockedConvolutionForward)
+{
+    std::mt19937 rng(0);
+    boost::random::normal_distribution<float> nd;
+    using BoolVec = ConvolveGeometry::BoolVec;
+
+    std::vector<ConvolveGeometryPtr> geometries;
+    // first layer: plain input with 3 channels
+    geometries.push_back(std::make_shared<ConvolveGeometry>(TensorShape(11, 9, 3), TensorShape(3, 3, 3), TensorShape(16), TensorShape(1, 1, 3),
+                                                            BoolVec{true}, BoolVec{true, true, false}, TensorShape(0), TensorShape(0)));
+    geometries.push_back(std::make_shared<ConvolveGeometry>(TensorShape(10, 10, 16), TensorShape(3, 3, 16), TensorShape(32), TensorShape(2, 2, 16),
+                                                            BoolVec{true}, BoolVec{true, true, false}, TensorShape(0), TensorShape(0)));
+    geometries.push_back(std::make_shared<ConvolveGeometry>(TensorShape(7, 6, 16), TensorShape(1, 1, 16), TensorShape(16), TensorShape(1, 1, 16),
+                                                            BoolVec{true}, BoolVec{false}, TensorShape(0), TensorShape(0)));
+
+    for (const auto& g : geometries)
+    {
+        Convolution2DShape shape;
+        BOOST_REQUIRE(Convolution2DShape::TryCreate(*g, shape));
+        size_t n = 3;
+        auto refEng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, PoolKind::None, ConvolutionEngineKind::Reference);
+
+        vec input(shape.InputSize() * n), kernel(shape.KernelSize() * shape.m_mapCount);
+        std::generate(begin(input), end(input), [&] { return nd(rng); });
+        std::generate(begin(kernel), end(kernel), [&] { return nd(rng); });
+        SingleMatrix in(shape.InputSize(), n, input.data(), CPUDEVICE, matrixFlagNormal);
+        SingleMatrix kern(shape.m_mapCount, shape.KernelSize(), kernel.data(), CPUDEVICE, matrixFlagNormal);
+        SingleMatrix out(shape.OutputSize(), n, CPUDEVICE);
+        SingleMatrix workspace(CPUDEVICE);
+        refEng->Forward(in, kern, out, workspace);
+
+        for (size_t blockSize : {8, 16})
+        {
+            if (shape.m_mapCount % blockSize != 0)
+                continue;
+            vec blockedKernel(kernel.size());
+            CPUConvolution::BlockKernel(shape, blockSize, kernel.data(), blockedKernel.data());
+            for (bool inputBlocked : {false, true})
+            {
+                if (inputBlocked && shape.m_inC % blockSize != 0)
+                    continue;
+                vec x(input.size()), blockedOut(shape.OutputSize() * n), y(blockedOut.size());
+                if (inputBlocked)
+                    CPUConvolution::ToChannelBlocked(input.data(), shape.m_inW * shape.m_inH, shape.m_inC, blockSize, n, x.data());
+                else
+                    x = input;
+                CPUConvolution::BlockedForward(shape, blockSize, inputBlocked, x.data(), blockedKernel.data(), blockedOut.data(), n);
+                CPUConvolution::FromChannelBlocked(blockedOut.data(), shape.m_outW * shape.m_outH, shape.m_mapCount, blockSize, n, y.data());
+
+                SingleMatrix result(shape.OutputSize(), n, y.data(), CPUDEVICE, matrixFlagNormal);
+                std::string emsg;
+                BOOST_REQUIRE_MESSAGE(CheckEqual(result, out, emsg, Err<float>::Rel * 4, Err<float>::Abs * 14),
+                                      "Blocked convolution with block size " << blockSize << (inputBlocked ? " and blocked input" : "")
+                                      << " differs, geometry: " << (std::string)(*g) << ". " << emsg);
+            }
+        }
+    }
+}
+
+// Pooling a channel-blocked tensor [B x W x H x C/B] with a kernel of 1 in the B axis is pooling in CHW layout.
+BOOST_AUTO_TEST_CASE(BlockedPoolingForward)
+{
+    std::mt19937 rng(0);
+    boost::random::normal_distribution<float> nd;
+    using BoolVec = ConvolveGeometry::BoolVec;
+    const size_t blockSize = 8, inW = 9, inH = 8, inC = 16, n = 2;
+
+    for (auto poolKind : {PoolKind::Max, PoolKind::Average})
+    {
+        auto g = std::make_shared<ConvolveGeometry>(TensorShape(inW, inH, inC), TensorShape(3, 3, 1), TensorShape(1), TensorShape(2, 2, 1),
+                                                    BoolVec{true}, BoolVec{true, true, false}, TensorShape(0), TensorShape(0));
+        auto blockedG = std::make_shared<ConvolveGeometry>(TensorShape(blockSize, inW, inH, inC / blockSize), TensorShape(1, 3, 3, 1), TensorShape(1),
+                                                           TensorShape(1, 2, 2, 1), BoolVec{true}, BoolVec{false, true, true, false},
+                                                           TensorShape(0), TensorShape(0));
+        auto eng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, poolKind, ConvolutionEngineKind::Reference);
+        auto blockedEng = ConvEng::Create(blockedG, CPUDEVICE, ImageLayoutKind::CHW, 0, poolKind, ConvolutionEngineKind::Reference);
+        size_t outSize = g->OutputShape().GetNumElements();
+        BOOST_REQUIRE_EQUAL(blockedG->OutputShape().GetNumElements(), outSize);
+
+        vec input(inW * inH * inC * n), blockedInput(input.size());
+        std::generate(begin(input), end(input), [&] { return nd(rng); });
+        CPUConvolution::ToChannelBlocked(input.data(), inW * inH, inC, blockSize, n, blockedInput.data());
+        SingleMatrix in(inW * inH * inC, n, input.data(), CPUDEVICE, matrixFlagNormal);
+        SingleMatrix blockedIn(inW * inH * inC, n, blockedInput.data(), CPUDEVICE, matrixFlagNormal);
+        SingleMatrix out(outSize, n, CPUDEVICE);
+        SingleMatrix blockedOut(outSize, n, CPUDEVICE);
+        eng->ForwardPooling(in, out);
+        blockedEng->ForwardPooling(blockedIn, blockedOut);
+
+        vec y(outSize * n);
+        CPUConvolution::FromChannelBlocked(blockedOut.Data(), outSize / inC, inC, blockSize, n, y.data());
+        SingleMatrix result(outSize, n, y.data(), CPUDEVICE, matrixFlagNormal);
+        std::string emsg;
+        BOOST_REQUIRE_MESSAGE(CheckEqual(result, out, emsg, Err<float>::Rel, Err<float>::Abs), "Blocked pooling differs. " << emsg);
+    }
+}
+
+// The pooling engine specializes 2D pooling with windows of 2x2 and 3x3 on CPU; it is compared with the reference engine,
+// including the geometries that it leaves to the reference implementation.
+BOOST_AUTO_TEST_CASE(CpuPooling)
+{
+    std::mt19937 rng(0);
+    boost::random::uniform_int_distribution<> batchSizeG(1, 8);
+    boost::random::uniform_int_distribution<> valueG(-4, 4); // with ties in the windows
+    using BoolVec = ConvolveGeometry::BoolVec;
+
+    auto geometries = GeneratePoolTestConfigs();
+    for (size_t k : {2, 3})
+    {
+        for (size_t stride : {1, 2})
+        {
+            for (bool autoPad : {false, true})
+                geometries.push_back(std::make_shared<ConvolveGeometry>(TensorShape(17, 12, 5), TensorShape(k, k, 1), TensorShape(1), TensorShape(stride, stride, 1),
+                                                                        BoolVec{true}, BoolVec{autoPad, autoPad, false}, TensorShape(0), TensorShape(0)));
+        }
+    }
+
+    for (auto kind : {PoolKind::Max, PoolKind::Average})
+    {
+        for (const auto& g : geometries)
+        {
+            auto refEng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, kind, ConvolutionEngineKind::Reference);
+            auto eng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, kind, (ConvolutionEngineKind)((int)ConvolutionEngineKind::Pooling | (int)ConvolutionEngineKind::Reference));
+
+            size_t n = batchSizeG(rng), inSize = g->InputShape().GetNumElements(), outSize = g->OutputShape().GetNumElements();
+            vec input(inSize * n), outGrad(outSize * n);
+            std::generate(begin(input), end(input), [&] { return (float)valueG(rng); });
+            std::generate(begin(outGrad), end(outGrad), [&] { return (float)valueG(rng); });
+            SingleMatrix in(inSize, n, input.data(), CPUDEVICE, matrixFlagNormal);
+            SingleMatrix srcGrad(outSize, n, outGrad.data(), CPUDEVICE, matrixFlagNormal);
+
+            SingleMatrix out(outSize, n, CPUDEVICE), outRef(outSize, n, CPUDEVICE);
+            eng->ForwardPooling(in, out);
+            refEng->ForwardPooling(in, outRef);
+
+            // the backward functions add to their result
+            SingleMatrix grad(inSize, n, CPUDEVICE), gradRef(inSize, n, CPUDEVICE);
+            grad.SetValue(1);
+            gradRef.SetValue(1);
+            eng->BackwardPooling(out, srcGrad, in, grad);
+            refEng->BackwardPooling(outRef, srcGrad, in, gradRef);
+
+            std::string msg = " differs, geometry: " + (std::string)(*g) + ", Pool: " + std::to_string((int)kind) + ". ";
+            std::string emsg;
+            BOOST_REQUIRE_MESSAGE(CheckEqual(out, outRef, emsg, Err<float>::Rel, Err<float>::Abs), "out" << msg << emsg);
+            BOOST_REQUIRE_MESSAGE(CheckEqual(grad, gradRef, emsg, Err<float>::Rel, Err<float>::Abs), "grad" << msg << emsg);
+        }
+    }
+}
+
+// Times the pooling engine against the reference engine on a typical early layer of an image network. Only the results
+// are checked; the times are reported in the log. Wall-clock times are meaningless on shared build machines, so this is
+// disabled by default; run it explicitly with --run_test=ConvolutionSuite/CpuPoolingBenchmark --log_level=message.
+BOOST_AUTO_TEST_CASE(CpuPoolingBenchmark, *boost::unit_test::disabled())
+{
+    std::mt19937 rng(0);
+    boost::random::normal_distribution<float> nd;
+    using BoolVec = ConvolveGeometry::BoolVec;
+    const size_t n = 8, repeat = 5;
+
+    for (size_t k : {2, 3})
+    {
+        for (auto kind : {PoolKind::Max, PoolKind::Average})
+        {
+            auto g = std::make_shared<ConvolveGeometry>(TensorShape(112, 112, 64), TensorShape(k, k, 1), TensorShape(1), TensorShape(2, 2, 1),
+                                                        BoolVec{true}, BoolVec{k == 3, k == 3, false}, TensorShape(0), TensorShape(0));
+            auto refEng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, kind, ConvolutionEngineKind::Reference);
+            auto eng = ConvEng::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, kind, ConvolutionEngineKind::Pooling);
+
+            size_t inSize = g->InputShape().GetNumElements(), outSize = g->OutputShape().GetNumElements();
+            vec input(inSize * n), outGrad(outSize * n);
+            std::generate(begin(input), end(input), [&] { return nd(rng); });
+            std::generate(begin(outGrad), end(outGrad), [&] { return nd(rng); });
+            SingleMatrix in(inSize, n, input.data(), CPUDEVICE, matrixFlagNormal);
+            SingleMatrix srcGrad(outSize, n, outGrad.data(), CPUDEVICE, matrixFlagNormal);
+            SingleMatrix out(outSize, n, CPUDEVICE), outRef(outSize, n, CPUDEVICE);
+            SingleMatrix grad(inSize, n, CPUDEVICE), gradRef(inSize, n, CPUDEVICE);
+            grad.SetValue(0);
+            gradRef.SetValue(0);
+
+            // average time of one forward and backward pass, in milliseconds
+            auto time = [&](ConvEng& e, SingleMatrix& y, SingleMatrix& dx)
+            {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < repeat; i++)
+                {
+                    e.ForwardPooling(in, y);
+                    e.BackwardPooling(y, srcGrad, in, dx);
+                }
+                return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeat;
+            };
+            double refTime = time(*refEng, outRef, gradRef);
+            double engTime = time(*eng, out, grad);
+            BOOST_TEST_MESSAGE("Pooling " << (kind == PoolKind::Max ? "max " : "average ") << k << "x" << k << " of " << (std::string)(*g) << " x " << n
+                               << ": reference engine " << refTime << " ms, pooling engine " << engTime << " ms.");
+
+            std::string emsg;
+            BOOST_REQUIRE_MESSAGE(CheckEqual(out, outRef, emsg, Err<float>::Rel, Err<float>::Abs), "out differs. " << emsg);
+            BOOST_REQUIRE_MESSAGE(CheckEqual(grad, gradRef, emsg, Err<float>::Rel * 4, Err<float>::Abs * 4), "grad differs. " << emsg);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } } } }
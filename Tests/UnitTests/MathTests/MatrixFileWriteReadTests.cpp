@@ -37,6 +37,32 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixFileWriteRead, RandomSeedFixture)
     BOOST_CHECK(matrixCpuCopy.IsEqualTo(matrixCpuRead, c_epsilonFloatE5));
 }
 
+#ifndef _WIN32
+BOOST_FIXTURE_TEST_CASE(CPUMatrixInMemoryFileWriteRead, RandomSeedFixture)
+{
+    CPUMatrix<float> matrixCpu = CPUMatrix<float>::RandomUniform(43, 10, -26.3f, 30.2f, IncrementCounter());
+    CPUMatrix<float> matrixCpuCopy = matrixCpu;
+
+    // serialize into memory, then persist the bytes the way AsyncCheckpointWriter does
+    auto memoryFile = File::CreateMemoryWriter(fileOptionsBinary);
+    *memoryFile << matrixCpu;
+    size_t size;
+    const char* data = memoryFile->GetMemoryBuffer(size);
+    BOOST_CHECK(size > matrixCpu.GetNumElements() * sizeof(float));
+
+    std::wstring fileNameCpu(L"MCPUMEM.bin");
+    FILE* f = fopenOrDie(fileNameCpu, L"wb");
+    fwriteOrDie(data, 1, size, f);
+    fcloseOrDie(f);
+
+    File fileCpu(fileNameCpu, fileOptionsBinary | fileOptionsRead);
+    CPUMatrix<float> matrixCpuRead;
+    fileCpu >> matrixCpuRead;
+
+    BOOST_CHECK(matrixCpuCopy.IsEqualTo(matrixCpuRead, c_epsilonFloatE5));
+}
+#endif
+
 BOOST_FIXTURE_TEST_CASE(MatrixFileWriteRead, RandomSeedFixture)
 {
     // Test Matrix in Dense mode
@@ -73,6 +99,63 @@ BOOST_FIXTURE_TEST_CASE(MatrixFileWriteRead, RandomSeedFixture)
     BOOST_CHECK(matrixSparseRead.IsEqualTo(matrixSparseCopy, c_epsilonFloatE5));
 }
 
+BOOST_FIXTURE_TEST_CASE(MatrixAlignedMemoryMappedFileWriteRead, RandomSeedFixture)
+{
+    Matrix<float> matrix = Matrix<float>::RandomUniform(43, 10, CPUDEVICE, -26.3f, 30.2f, IncrementCounter());
+    Matrix<float> matrixCopy = matrix.DeepClone();
+
+    std::wstring fileName(L"MALIGNED.bin");
+    {
+        File file(fileName, fileOptionsBinary | fileOptionsWrite | fileOptionsAlignedData);
+        file << std::wstring(L"header") << matrix; // something odd-sized in front of the matrix
+    }
+
+    File file(fileName, fileOptionsBinary | fileOptionsRead | fileOptionsMemoryMapped);
+    std::wstring header;
+    Matrix<float> matrixRead(CPUDEVICE);
+    file >> header >> matrixRead;
+
+    BOOST_CHECK(matrixRead.IsEqualTo(matrixCopy, c_epsilonFloatE5));
+
+    // the data is used in place from the mapping, aligned
+    const char* mapping = (const char*)file.GetMemoryMapping().get();
+    const char* data = (const char*)matrixRead.Data();
+    BOOST_REQUIRE(mapping != nullptr);
+    BOOST_CHECK(data >= mapping && data + matrixRead.GetNumElements() * sizeof(float) <= mapping + file.Size());
+    BOOST_CHECK_EQUAL((data - mapping) % File::s_dataAlignment, 0);
+
+    // without mapping, the same file is read into a matrix that owns its data
+    File fileNotMapped(fileName, fileOptionsBinary | fileOptionsRead);
+    Matrix<float> matrixCopied(CPUDEVICE);
+    fileNotMapped >> header >> matrixCopied;
+    BOOST_CHECK(matrixCopied.IsEqualTo(matrixCopy, c_epsilonFloatE5));
+}
+
+BOOST_FIXTURE_TEST_CASE(MatrixMemoryMappedOutlivesFile, RandomSeedFixture)
+{
+    Matrix<float> matrix = Matrix<float>::RandomUniform(43, 10, CPUDEVICE, -26.3f, 30.2f, IncrementCounter());
+
+    std::wstring fileName(L"MALIGNEDLIFETIME.bin");
+    {
+        File file(fileName, fileOptionsBinary | fileOptionsWrite | fileOptionsAlignedData);
+        file << matrix;
+    }
+
+    // the matrix and a view of it hold the mapping after the File is closed
+    Matrix<float> slice(CPUDEVICE);
+    {
+        Matrix<float> matrixRead(CPUDEVICE);
+        {
+            File file(fileName, fileOptionsBinary | fileOptionsRead | fileOptionsMemoryMapped);
+            file >> matrixRead;
+            BOOST_REQUIRE(matrixRead.Data() != nullptr && !matrixRead.OwnBuffer());
+        }
+        BOOST_CHECK(matrixRead.IsEqualTo(matrix, c_epsilonFloatE5));
+        slice = matrixRead.ColumnSlice(2, 5);
+    }
+    BOOST_CHECK(slice.IsEqualTo(matrix.ColumnSlice(2, 5), c_epsilonFloatE5));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(GPUMatrixSuite)
@@ -5,6 +5,10 @@
 #include "stdafx.h"
 #include "../../../Source/Math/Quantizers.h"
 #include "../../../Source/Math/Helpers.h"
+#include "../../../Source/Math/Int8Gemm.h"
+#include "../../../Source/Math/HalfGemm.h"
+#include <random>
+#include <cmath>
 
 using namespace Microsoft::MSR::CNTK;
 namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
@@ -47,6 +51,159 @@ BOOST_FIXTURE_TEST_CASE(FloatToShort, RandomSeedFixture)
 
 }
 
+// The int8 product must match the float product up to the quantization error, for sizes that
+// are not multiples of the kernel blocking, and results written transposed (as the quantized convolution does).
+BOOST_FIXTURE_TEST_CASE(Int8GemmMatchesFloatProduct, RandomSeedFixture)
+{
+    const size_t m = 13, k = 70, n = 5;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+
+    // column-major [m x k] weights as in TimesNode, and activations in [-1.5, 2.5]
+    std::vector<float> weights(m * k), activations(k * n);
+    for (auto& w : weights)
+        w = distribution(rng);
+    for (auto& a : activations)
+        a = 2 * distribution(rng) + 0.5f;
+
+    std::vector<int8_t> quantizedWeights;
+    std::vector<float> scales;
+    std::vector<int32_t> rowSums;
+    Int8Gemm::QuantizeWeights(weights.data(), m, k, 1, m, quantizedWeights, scales, rowSums);
+    BOOST_CHECK_EQUAL(quantizedWeights.size(), m * Int8Gemm::PaddedDepth(k));
+
+    float activationScale;
+    int32_t zeroPoint;
+    Int8Gemm::ComputeActivationQuantization(-1.5f, 2.5f, activationScale, zeroPoint);
+    BOOST_CHECK(zeroPoint > 0 && zeroPoint < Int8Gemm::ActivationMax);
+
+    std::vector<uint8_t> quantizedActivations(Int8Gemm::PaddedDepth(k) * n);
+    Int8Gemm::QuantizeActivations(activations.data(), k, n, activationScale, zeroPoint, quantizedActivations.data());
+
+    std::vector<float> result(m * n), transposedResult(m * n);
+    Int8Gemm::Multiply(quantizedWeights.data(), scales.data(), rowSums.data(), m, k, quantizedActivations.data(), n,
+                       activationScale, zeroPoint, result.data(), 1, m);
+    Int8Gemm::Multiply(quantizedWeights.data(), scales.data(), rowSums.data(), m, k, quantizedActivations.data(), n,
+                       activationScale, zeroPoint, transposedResult.data(), n, 1);
+
+    for (size_t i = 0; i < m; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            double expected = 0;
+            for (size_t p = 0; p < k; p++)
+                expected += weights[i + p * m] * activations[p + j * k];
+            BOOST_CHECK_SMALL(result[i + j * m] - expected, 0.25);
+            BOOST_CHECK_EQUAL(result[i + j * m], transposedResult[i * n + j]);
+        }
+    }
+}
+
+// Zero is represented exactly by the zero point, so that e.g. convolution padding does not contribute to the product.
+BOOST_FIXTURE_TEST_CASE(Int8GemmZeroPoint, RandomSeedFixture)
+{
+    const size_t m = 2, k = 3, n = 2;
+    float weights[m * k] = { 127, -127, 1, 0, -2, 64 }; // column-major: rows (127, 1, -2) and (-127, 0, 64)
+    float activations[k * n] = { 0, 0, 0, 2, -1, 3 }; // the first column is all zero
+
+    std::vector<int8_t> quantizedWeights;
+    std::vector<float> scales;
+    std::vector<int32_t> rowSums;
+    Int8Gemm::QuantizeWeights(weights, m, k, 1, m, quantizedWeights, scales, rowSums);
+    BOOST_CHECK_EQUAL(scales[0], 1.0f);
+    BOOST_CHECK_EQUAL(quantizedWeights[0], 127);
+    BOOST_CHECK_EQUAL(rowSums[0], 127 + 1 - 2);
+
+    float activationScale;
+    int32_t zeroPoint;
+    Int8Gemm::ComputeActivationQuantization(-1.0f, 3.0f, activationScale, zeroPoint);
+    std::vector<uint8_t> quantizedActivations(Int8Gemm::PaddedDepth(k) * n);
+    Int8Gemm::QuantizeActivations(activations, k, n, activationScale, zeroPoint, quantizedActivations.data());
+    for (size_t p = 0; p < k; p++)
+        BOOST_CHECK_EQUAL(quantizedActivations[p], zeroPoint);
+
+    float result[m * n];
+    Int8Gemm::Multiply(quantizedWeights.data(), scales.data(), rowSums.data(), m, k, quantizedActivations.data(), n,
+                       activationScale, zeroPoint, result, 1, m);
+    BOOST_CHECK_EQUAL(result[0], 0.0f);
+    BOOST_CHECK_EQUAL(result[1], 0.0f);
+    // the activation step is 4/127, and the weights are up to 127
+    BOOST_CHECK_SMALL(result[2] - (127 * 2 + 1 * -1 - 2 * 3), 4.0f);
+    BOOST_CHECK_SMALL(result[3] - (-127 * 2 + 0 * -1 + 64 * 3), 4.0f);
+}
+
+// Conversion to and from 16-bit floating point must round to nearest even and round-trip every 16-bit value.
+BOOST_AUTO_TEST_CASE(HalfPrecisionConversion)
+{
+    // exactly representable values, ties, overflow, and the smallest Float16 subnormal
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(1.0f, HalfPrecisionFormat::Float16), 0x3c00);
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(-2.5f, HalfPrecisionFormat::Float16), 0xc100);
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(1.0f + 1.0f / 2048, HalfPrecisionFormat::Float16), 0x3c00);
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(1.0f + 3.0f / 2048, HalfPrecisionFormat::Float16), 0x3c02);
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(1e6f, HalfPrecisionFormat::Float16), 0x7c00);
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(std::ldexp(1.0f, -24), HalfPrecisionFormat::Float16), 0x0001);
+    BOOST_CHECK_EQUAL(HalfGemm::ToFloat(0x0001, HalfPrecisionFormat::Float16), std::ldexp(1.0f, -24));
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(1.0f, HalfPrecisionFormat::BFloat16), 0x3f80);
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(1.0f + 1.0f / 256, HalfPrecisionFormat::BFloat16), 0x3f80);
+    BOOST_CHECK_EQUAL(HalfGemm::FromFloat(1.0f + 3.0f / 256, HalfPrecisionFormat::BFloat16), 0x3f82);
+
+    // the bulk conversion must agree with the scalar one, also for the vectorized part
+    std::vector<uint16_t> values;
+    for (uint32_t bits = 0; bits < 0x10000; bits += 7)
+        values.push_back((uint16_t)bits);
+    std::vector<float> converted(values.size());
+    for (auto format : { HalfPrecisionFormat::Float16, HalfPrecisionFormat::BFloat16 })
+    {
+        HalfGemm::ToFloat(values.data(), values.size(), format, converted.data());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            float expected = HalfGemm::ToFloat(values[i], format);
+            BOOST_CHECK(converted[i] == expected || (std::isnan(converted[i]) && std::isnan(expected)));
+            if (!std::isnan(expected))
+                BOOST_CHECK_EQUAL(HalfGemm::FromFloat(expected, format), values[i]);
+        }
+    }
+}
+
+// The product with 16-bit weights must match the float product, for sizes that are not multiples of the blocking.
+BOOST_FIXTURE_TEST_CASE(HalfGemmMatchesFloatProduct, RandomSeedFixture)
+{
+    const size_t m = 150, k = 37, n = 11;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+
+    std::vector<float> weights(m * k), activations(k * n);
+    for (auto& w : weights)
+        w = distribution(rng);
+    for (auto& a : activations)
+        a = distribution(rng);
+
+    for (auto format : { HalfPrecisionFormat::Float16, HalfPrecisionFormat::BFloat16 })
+    {
+        std::vector<uint16_t> halfWeights(m * k);
+        HalfGemm::FromFloat(weights.data(), weights.size(), format, halfWeights.data());
+
+        std::vector<float> result(m * n);
+        HalfGemm::Multiply(halfWeights.data(), format, m, k, activations.data(), n, result.data());
+
+        // the products of the converted weights are exact up to float rounding
+        double tolerance = format == HalfPrecisionFormat::Float16 ? 0.02 : 0.1;
+        for (size_t i = 0; i < m; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                double expected = 0, expectedConverted = 0;
+                for (size_t p = 0; p < k; p++)
+                {
+                    expected += weights[i + p * m] * activations[p + j * k];
+                    expectedConverted += HalfGemm::ToFloat(halfWeights[i + p * m], format) * activations[p + j * k];
+                }
+                BOOST_CHECK_SMALL(result[i + j * m] - expectedConverted, 1e-4);
+                BOOST_CHECK_SMALL(result[i + j * m] - expected, tolerance);
+            }
+        }
+    }
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,102 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/InputAndParamNodes.h"
+#include "../../../Source/SGDLib/SGD.h" // for AsyncModelAveragingSGD
+#include "TestHelpers.h"
+#include <memory>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// We perform test on CPU; with a single process, the averaging runs through the same allreduce as with many workers.
+const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+static const float c_epsilonFloatE4 = 0.0001f;
+
+static MPIWrapperPtr GetSingleProcessMPI()
+{
+    auto mpi = MPIWrapper::GetInstance();
+    if (!mpi)
+        mpi = MPIWrapper::GetInstance(/*create=*/true);
+    return mpi;
+}
+
+template <class ElemType>
+shared_ptr<LearnableParameter<ElemType>> CreateParameter(const wstring& name, const std::vector<ElemType>& values)
+{
+    auto parameter = make_shared<LearnableParameter<ElemType>>(c_deviceId, name, TensorShape(2, values.size() / 2));
+    parameter->Value().SetValue(2, values.size() / 2, c_deviceId, const_cast<ElemType*>(values.data()));
+    return parameter;
+}
+
+template <class ElemType>
+bool IsValueEqualTo(const shared_ptr<LearnableParameter<ElemType>>& parameter, const std::vector<ElemType>& expected)
+{
+    return AreEqual(expected.data(), parameter->Value().Data(), expected.size(), c_epsilonFloatE4);
+}
+
+template <class ElemType>
+void AsyncModelAveragingSingleWorkerTestImpl()
+{
+    auto mpi = GetSingleProcessMPI();
+    BOOST_REQUIRE_EQUAL(mpi->NumNodesInUse(), (size_t)1);
+
+    auto w = CreateParameter<ElemType>(L"W", {1, 2, 3, 4, 5, 6});
+    auto b = CreateParameter<ElemType>(L"B", {-1, -2});
+    std::list<ComputationNodeBasePtr> learnableNodes{w, b};
+    std::list<Matrix<ElemType>> smoothedGradients;
+
+    AsyncModelAveragingSGD<ElemType> masgd(mpi, /*reportFreq=*/1, c_deviceId);
+    masgd.OnEpochStart(learnableNodes);
+
+    // The first sync point starts averaging the current model and returns to training right away.
+    BOOST_REQUIRE(masgd.OnArrivingAtSyncPoint(learnableNodes, smoothedGradients, /*samplesSinceLastSync=*/8));
+    BOOST_REQUIRE_MESSAGE(IsValueEqualTo(w, {1, 2, 3, 4, 5, 6}), "Starting an aggregation must not change the model");
+
+    // Local progress while the aggregation is in flight.
+    w->Value() += (ElemType)0.5;
+    b->Value() += (ElemType)0.25;
+
+    // The second sync point completes it: the average of the snapshots (with a single worker: the snapshot itself),
+    // plus the local progress since.
+    BOOST_REQUIRE(masgd.OnArrivingAtSyncPoint(learnableNodes, smoothedGradients, /*samplesSinceLastSync=*/4));
+    BOOST_REQUIRE_MESSAGE(IsValueEqualTo(w, {1.5, 2.5, 3.5, 4.5, 5.5, 6.5}), "The local progress must be re-applied on top of the average");
+    BOOST_REQUIRE_MESSAGE(IsValueEqualTo(b, {-0.75, -1.75}), "The local progress must be re-applied on top of the average");
+
+    // A synchronous round reports the samples aggregated across all workers.
+    size_t totalSamplesProcessed = 0;
+    float secondsOnCommunication = 0;
+    masgd.ModelAggregationProcessing(/*samplesSinceLastSync=*/6, learnableNodes, smoothedGradients, totalSamplesProcessed, secondsOnCommunication);
+    BOOST_REQUIRE_EQUAL(totalSamplesProcessed, (size_t)6);
+    BOOST_REQUIRE_MESSAGE(IsValueEqualTo(w, {1.5, 2.5, 3.5, 4.5, 5.5, 6.5}), "Averaging a single worker must not change the model");
+
+    // More local progress, then the end of the epoch, which must complete all pending aggregations.
+    w->Value() += (ElemType)1;
+    BOOST_REQUIRE(masgd.OnArrivingAtSyncPoint(learnableNodes, smoothedGradients, /*samplesSinceLastSync=*/2));
+    w->Value() += (ElemType)1;
+    masgd.OnEpochEnd(learnableNodes, smoothedGradients, /*samplesSinceLastSync=*/2);
+    BOOST_REQUIRE_MESSAGE(IsValueEqualTo(w, {3.5, 4.5, 5.5, 6.5, 7.5, 8.5}), "The end of the epoch must keep all local progress");
+    BOOST_REQUIRE_MESSAGE(IsValueEqualTo(b, {-0.75, -1.75}), "The end of the epoch must not change untouched parameters");
+
+    // The next epoch starts without a pending aggregation.
+    masgd.OnEpochStart(learnableNodes);
+    masgd.OnEpochEnd(learnableNodes, smoothedGradients, /*samplesSinceLastSync=*/0);
+}
+
+BOOST_AUTO_TEST_SUITE(AsyncModelAveragingTestSuite)
+
+BOOST_AUTO_TEST_CASE(AsyncModelAveragingSingleWorkerTest)
+{
+    AsyncModelAveragingSingleWorkerTestImpl<float>();
+    AsyncModelAveragingSingleWorkerTestImpl<double>();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} } } }
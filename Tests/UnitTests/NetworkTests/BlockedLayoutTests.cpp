@@ -0,0 +1,144 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/ComputationNetwork.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetworkBuilder.h"
+#include "../../../Source/ComputationNetworkLib/BlockedLayoutNodes.h"
+#include "TestHelpers.h"
+#include <memory>
+#include <random>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// The blocked layout is only implemented on the CPU.
+const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+static const size_t c_blockSize = 8;
+static const float c_epsilonFloatE3 = 0.001f;
+
+// conv1 (3 -> 16 channels) + per-channel bias -> relu1 -> pool -> conv2 (16 -> 8 channels) -> relu2 -> out (Times)
+// Everything from conv1 to relu2 can be evaluated in blocked layout; the input is in CHW layout, and the Times needs it back.
+template <class ElemType>
+ComputationNetworkPtr CreateConvolutionalNetwork()
+{
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<ElemType> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", TensorShape(8, 6, 3));
+    auto w1 = builder.CreateLearnableParameter(L"W1", TensorShape(3, 3, 3, 16));
+    auto b1 = builder.CreateLearnableParameter(L"b1", TensorShape(1, 1, 16));
+    auto w2 = builder.CreateLearnableParameter(L"W2", TensorShape(3, 3, 16, 8));
+    auto wOut = builder.CreateLearnableParameter(L"WOut", TensorShape(SmallVector<size_t>{ 5, 4, 3, 8 }));
+
+    auto conv1 = builder.Convolution(w1, features, TensorShape(3, 3, 3), TensorShape(16), TensorShape(1, 1, 3), vector<bool>{ true },
+                                     vector<bool>{ true, true, false }, TensorShape(0), TensorShape(0), /*transpose=*/false, ImageLayoutKind::CHW, 0, L"conv1");
+    auto plus1 = builder.Plus(conv1, b1, L"plus1");
+    auto relu1 = builder.RectifiedLinear(plus1, L"relu1");
+    auto pool = builder.Pooling(relu1, PoolKind::Max, TensorShape(2, 2, 1), TensorShape(2, 2, 1), vector<bool>{ false },
+                                TensorShape(0), TensorShape(0), ImageLayoutKind::CHW, L"pool");
+    auto conv2 = builder.Convolution(w2, pool, TensorShape(3, 3, 16), TensorShape(8), TensorShape(1, 1, 16), vector<bool>{ true },
+                                     vector<bool>{ true, true, false }, TensorShape(0), TensorShape(0), /*transpose=*/false, ImageLayoutKind::CHW, 0, L"conv2");
+    auto relu2 = builder.RectifiedLinear(conv2, L"relu2");
+    auto out = builder.Times(wOut, relu2, /*outputRank=*/1, L"out");
+    net->AddToNodeGroup(L"output", out);
+
+    // the same parameter values in every network created here
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    for (const auto& parameter : { w1, b1, w2, wOut })
+    {
+        auto& value = parameter->Value();
+        std::vector<ElemType> values(value.GetNumElements());
+        for (auto& v : values)
+            v = (ElemType)distribution(rng);
+        value.SetValue(value.GetNumRows(), value.GetNumCols(), c_deviceId, values.data());
+    }
+
+    net->CompileNetwork();
+    return net;
+}
+
+template <class ElemType>
+std::vector<ElemType> EvaluateNetwork(const ComputationNetworkPtr& net, std::vector<ElemType> features, size_t numSamples)
+{
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::inferring);
+    auto outputNodes = net->OutputNodesByName({ L"out" });
+    auto inputNodes = net->InputNodesForOutputs({ L"out" });
+    net->AllocateAllMatrices({}, outputNodes, nullptr);
+    net->StartEvaluateMinibatchLoop(outputNodes);
+
+    auto input = dynamic_pointer_cast<ComputationNode<ElemType>>(net->GetNodeFromName(L"features"));
+    size_t numRows = ComputationNodeBasePtr(input)->GetSampleLayout().GetNumElements();
+    ComputationNodeBasePtr(input)->GetMBLayout()->InitAsFrameMode(numSamples);
+    input->Value().SetValue(numRows, numSamples, c_deviceId, features.data());
+
+    ComputationNetwork::BumpEvalTimeStamp(inputNodes);
+    net->ForwardProp(outputNodes);
+
+    auto output = dynamic_pointer_cast<ComputationNode<ElemType>>(outputNodes[0]);
+    std::unique_ptr<ElemType[]> values(output->Value().CopyToArray());
+    return std::vector<ElemType>(values.get(), values.get() + output->Value().GetNumElements());
+}
+
+template <class ElemType>
+void ConvertToBlockedLayoutTestImpl()
+{
+    const size_t numSamples = 3;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    std::vector<ElemType> features(8 * 6 * 3 * numSamples);
+    for (auto& x : features)
+        x = (ElemType)distribution(rng);
+
+    auto expected = EvaluateNetwork(CreateConvolutionalNetwork<ElemType>(), features, numSamples);
+
+    auto net = CreateConvolutionalNetwork<ElemType>();
+    net->template ConvertToBlockedLayout<ElemType>(net->OutputNodesByName({ L"out" }), c_blockSize);
+
+    // the convolutions are replaced, and their float parameters by blocked ones
+    BOOST_CHECK(net->GetNodeFromName(L"conv1")->OperationName() == OperationNameOf(BlockedConvolutionNode));
+    BOOST_CHECK(net->GetNodeFromName(L"conv2")->OperationName() == OperationNameOf(BlockedConvolutionNode));
+    BOOST_CHECK(!net->NodeNameExists(L"W1") && !net->NodeNameExists(L"W2") && !net->NodeNameExists(L"b1"));
+    BOOST_CHECK(net->NodeNameExists(L"W1.blocked") && net->NodeNameExists(L"W2.blocked") && net->NodeNameExists(L"b1.blocked"));
+
+    // The CHW input is read by the first convolution directly, and the blocked nodes use each other's values without
+    // a reorder. The only reorder is at the end of the blocked part, where the Times uses relu2.
+    BOOST_CHECK(net->GetNodeFromName(L"conv1")->Input(1)->NodeName() == L"features");
+    BOOST_CHECK(net->GetNodeFromName(L"plus1")->Input(0)->NodeName() == L"conv1");
+    BOOST_CHECK(net->GetNodeFromName(L"relu1")->Input(0)->NodeName() == L"plus1");
+    BOOST_CHECK(net->GetNodeFromName(L"pool")->Input(0)->NodeName() == L"relu1");
+    BOOST_CHECK(net->GetNodeFromName(L"conv2")->Input(1)->NodeName() == L"pool");
+    BOOST_CHECK(net->GetNodeFromName(L"relu2")->Input(0)->NodeName() == L"conv2");
+
+    size_t numReorders = 0;
+    for (const auto& node : net->GetAllNodes())
+        numReorders += node->OperationName() == OperationNameOf(ChannelBlockReorderNode);
+    BOOST_CHECK_EQUAL(numReorders, (size_t)1);
+    const auto& reorder = net->GetNodeFromName(L"out")->Input(1);
+    BOOST_CHECK(reorder->OperationName() == OperationNameOf(ChannelBlockReorderNode));
+    BOOST_CHECK(reorder->Input(0)->NodeName() == L"relu2");
+    BOOST_CHECK(reorder->GetSampleLayout() == TensorShape(4, 3, 8));
+
+    // and it computes the same outputs
+    auto actual = EvaluateNetwork(net, features, numSamples);
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    BOOST_CHECK(AreEqual(expected.data(), actual.data(), expected.size(), c_epsilonFloatE3));
+}
+
+BOOST_AUTO_TEST_SUITE(BlockedLayoutTestSuite)
+
+BOOST_AUTO_TEST_CASE(ConvertToBlockedLayoutTest)
+{
+    ConvertToBlockedLayoutTestImpl<float>();
+    ConvertToBlockedLayoutTestImpl<double>();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} } } }
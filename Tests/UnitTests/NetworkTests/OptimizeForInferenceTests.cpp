@@ -0,0 +1,223 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/ComputationNetwork.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetworkBuilder.h"
+#include "../../../Source/ComputationNetworkLib/ConvolutionalNodes.h"
+#include "../../../Source/ComputationNetworkLib/LinearAlgebraNodes.h"
+#include "../../../Source/ComputationNetworkLib/TrainingNodes.h"
+#include "TestHelpers.h"
+#include <memory>
+#include <random>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// Fused convolutions are only implemented on the CPU.
+const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+static const float c_epsilonFloatE3 = 0.001f;
+
+// sets all parameters to the same values in every network created with the same seed
+template <class ElemType>
+void InitParameters(const vector<shared_ptr<ComputationNode<ElemType>>>& parameters, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    for (const auto& parameter : parameters)
+    {
+        auto& value = parameter->Value();
+        std::vector<ElemType> values(value.GetNumElements());
+        for (auto& v : values)
+            v = (ElemType)distribution(rng);
+        value.SetValue(value.GetNumRows(), value.GetNumCols(), c_deviceId, values.data());
+    }
+}
+
+// conv (3 -> 16 channels) + per-channel bias -> relu -> out (Times)
+template <class ElemType>
+ComputationNetworkPtr CreateConvolutionBiasReLUNetwork()
+{
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<ElemType> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", TensorShape(8, 6, 3));
+    auto w = builder.CreateLearnableParameter(L"W", TensorShape(3, 3, 3, 16));
+    auto b = builder.CreateLearnableParameter(L"b", TensorShape(1, 1, 16));
+    auto wOut = builder.CreateLearnableParameter(L"WOut", TensorShape(SmallVector<size_t>{ 5, 8, 6, 16 }));
+
+    auto conv = builder.Convolution(w, features, TensorShape(3, 3, 3), TensorShape(16), TensorShape(1, 1, 3), vector<bool>{ true },
+                                    vector<bool>{ true, true, false }, TensorShape(0), TensorShape(0), /*transpose=*/false, ImageLayoutKind::CHW, 0, L"conv");
+    auto plus = builder.Plus(conv, b, L"plus");
+    auto relu = builder.RectifiedLinear(plus, L"relu");
+    auto out = builder.Times(wOut, relu, /*outputRank=*/1, L"out");
+    net->AddToNodeGroup(L"output", out);
+
+    InitParameters<ElemType>({ w, b, wOut }, 42);
+    net->CompileNetwork();
+    return net;
+}
+
+template <class ElemType>
+void SetParameter(const shared_ptr<ComputationNode<ElemType>>& parameter, ElemType value)
+{
+    parameter->Value().SetValue(value);
+}
+
+// W = Times(C1, C2) is a parameter-only subgraph, bn is folded into h = Times(W, features), the dropout is removed,
+// and the criterion with its labels is not needed for the output. As in EvalOptimizeForInferenceTest (EvalTests).
+template <class ElemType>
+ComputationNetworkPtr CreateTrainingNetwork()
+{
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<ElemType> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", TensorShape(2));
+    auto labels = builder.CreateInputNode(L"labels", TensorShape(1));
+    auto c1 = builder.CreateLearnableParameter(L"C1", TensorShape(2, 2));
+    auto c2 = builder.CreateLearnableParameter(L"C2", TensorShape(2, 2));
+    auto scale = builder.CreateLearnableParameter(L"scale", TensorShape(2));
+    auto bias = builder.CreateLearnableParameter(L"bias", TensorShape(2));
+    auto mean = builder.CreateLearnableParameter(L"mean", TensorShape(2));
+    auto variance = builder.CreateLearnableParameter(L"variance", TensorShape(2));
+    auto wOut = builder.CreateLearnableParameter(L"WOut", TensorShape(1, 2));
+
+    auto w = builder.Times(c1, c2, /*outputRank=*/1, L"W");
+    auto h = builder.Times(w, features, /*outputRank=*/1, L"h");
+    auto bn = builder.BatchNormalization(h, scale, bias, mean, variance, /*spatial=*/false, 0, 0, /*epsilon=*/0, true, ImageLayoutKind::CHW, L"bn");
+    auto d = builder.Dropout(bn, L"d");
+    auto out = builder.Times(wOut, d, /*outputRank=*/1, L"out");
+    auto ce = builder.SquareError(labels, out, L"ce");
+    net->AddToNodeGroup(L"output", out);
+    net->AddToNodeGroup(L"criterion", ce);
+
+    SetParameter<ElemType>(c1, 1);
+    SetParameter<ElemType>(c2, 2);
+    SetParameter<ElemType>(scale, 2);
+    SetParameter<ElemType>(bias, 1);
+    SetParameter<ElemType>(mean, 3);
+    SetParameter<ElemType>(variance, 4);
+    SetParameter<ElemType>(wOut, 1);
+
+    net->CompileNetwork();
+    return net;
+}
+
+template <class ElemType>
+std::vector<ElemType> EvaluateOutput(const ComputationNetworkPtr& net, std::vector<ElemType> features, size_t numSamples)
+{
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::inferring);
+    auto outputNodes = net->OutputNodesByName({ L"out" });
+    auto inputNodes = net->InputNodesForOutputs({ L"out" });
+    net->AllocateAllMatrices({}, outputNodes, nullptr);
+    net->StartEvaluateMinibatchLoop(outputNodes);
+
+    auto input = dynamic_pointer_cast<ComputationNode<ElemType>>(net->GetNodeFromName(L"features"));
+    ComputationNodeBasePtr(input)->GetMBLayout()->InitAsFrameMode(numSamples);
+    input->Value().SetValue(features.size() / numSamples, numSamples, c_deviceId, features.data());
+
+    ComputationNetwork::BumpEvalTimeStamp(inputNodes);
+    net->ForwardProp(outputNodes);
+
+    auto output = dynamic_pointer_cast<ComputationNode<ElemType>>(outputNodes[0]);
+    std::unique_ptr<ElemType[]> values(output->Value().CopyToArray());
+    return std::vector<ElemType>(values.get(), values.get() + output->Value().GetNumElements());
+}
+
+template <class ElemType>
+std::vector<ElemType> CreateFeatures(size_t numElements, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    std::vector<ElemType> features(numElements);
+    for (auto& x : features)
+        x = (ElemType)distribution(rng);
+    return features;
+}
+
+template <class ElemType>
+void FuseConvolutionTestImpl()
+{
+    const size_t numSamples = 3;
+    auto features = CreateFeatures<ElemType>(8 * 6 * 3 * numSamples, 7);
+
+    auto expected = EvaluateOutput(CreateConvolutionBiasReLUNetwork<ElemType>(), features, numSamples);
+
+    auto net = CreateConvolutionBiasReLUNetwork<ElemType>();
+    size_t numNodes = net->GetTotalNumberOfNodes();
+    net->template OptimizeForInference<ElemType>(net->OutputNodesByName({ L"out" }));
+
+    // conv, plus and relu are replaced by one fused convolution, which takes over the name of the relu
+    BOOST_CHECK(!net->NodeNameExists(L"conv") && !net->NodeNameExists(L"plus"));
+    const auto& fused = net->GetNodeFromName(L"relu");
+    BOOST_REQUIRE(fused->OperationName() == OperationNameOf(FusedConvolutionNode));
+    BOOST_REQUIRE_EQUAL(fused->GetNumInputs(), (size_t)3);
+    BOOST_CHECK(fused->Input(0)->NodeName() == L"W");
+    BOOST_CHECK(fused->Input(1)->NodeName() == L"features");
+    BOOST_CHECK(fused->Input(2)->NodeName() == L"b");
+    BOOST_CHECK(net->GetNodeFromName(L"out")->Input(1) == fused);
+    BOOST_CHECK_EQUAL(net->GetTotalNumberOfNodes(), numNodes - 2);
+
+    // and it computes the same outputs
+    auto actual = EvaluateOutput(net, features, numSamples);
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    BOOST_CHECK(AreEqual(expected.data(), actual.data(), expected.size(), c_epsilonFloatE3));
+}
+
+template <class ElemType>
+void RemoveTrainingNodesTestImpl()
+{
+    std::vector<ElemType> features{ 1, 2, 0, 1 };
+
+    auto expected = EvaluateOutput(CreateTrainingNetwork<ElemType>(), features, 2);
+
+    auto net = CreateTrainingNetwork<ElemType>();
+    size_t numNodes = net->GetTotalNumberOfNodes();
+    net->template OptimizeForInference<ElemType>(net->OutputNodesByName({ L"out" }));
+
+    // no batch normalization, dropout or criterion is left, nor the labels or the inputs of folded nodes
+    for (const auto& node : net->GetAllNodes())
+    {
+        BOOST_CHECK(node->OperationName() != OperationNameOf(BatchNormalizationNode));
+        BOOST_CHECK(node->OperationName() != OperationNameOf(DropoutNode));
+        BOOST_CHECK(node->OperationName() != OperationNameOf(SquareErrorNode));
+    }
+    for (const auto& name : { L"d", L"ce", L"labels", L"C1", L"C2", L"scale", L"bias", L"mean", L"variance" })
+        BOOST_CHECK_MESSAGE(!net->NodeNameExists(name), "node should have been removed");
+    BOOST_CHECK(net->GetNodeFromName(L"W")->OperationName() == OperationNameOf(LearnableParameter));
+    BOOST_CHECK(net->GetNodeFromName(L"bn")->OperationName() == OperationNameOf(PlusNode));
+    BOOST_CHECK(net->GetNodeFromName(L"bn")->Input(0)->NodeName() == L"h");
+    BOOST_CHECK(net->GetNodeFromName(L"out")->Input(1)->NodeName() == L"bn");
+    BOOST_CHECK(net->FinalCriterionNodes().empty());
+    BOOST_CHECK_LT(net->GetTotalNumberOfNodes(), numNodes);
+
+    // W = 4, h = { 12, 12 } and { 4, 4 }, bn = 2 * (h - 3) / sqrt(4) + 1
+    auto actual = EvaluateOutput(net, features, 2);
+    std::vector<ElemType> values{ 20, 4 };
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    BOOST_CHECK(AreEqual(expected.data(), actual.data(), expected.size(), c_epsilonFloatE3));
+    BOOST_CHECK(AreEqual(values.data(), actual.data(), values.size(), c_epsilonFloatE3));
+}
+
+BOOST_AUTO_TEST_SUITE(OptimizeForInferenceTestSuite)
+
+BOOST_AUTO_TEST_CASE(RemoveTrainingNodesTest)
+{
+    RemoveTrainingNodesTestImpl<float>();
+    RemoveTrainingNodesTestImpl<double>();
+}
+
+BOOST_AUTO_TEST_CASE(FuseConvolutionBiasReLUTest)
+{
+    FuseConvolutionTestImpl<float>();
+    FuseConvolutionTestImpl<double>();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} } } }
@@ -0,0 +1,283 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/ComputationNetwork.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetworkBuilder.h"
+#include "../../../Source/ComputationNetworkLib/InputAndParamNodes.h"
+#include "../../../Source/ComputationNetworkLib/LinearAlgebraNodes.h"
+#include "../../../Source/ComputationNetworkLib/ConvolutionalNodes.h"
+#include "../../../Source/ComputationNetworkLib/QuantizedNodes.h"
+#include "../../../Source/ComputationNetworkLib/MatrixPool.h"
+#include "TestHelpers.h"
+#include <memory>
+#include <random>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// Quantized evaluation is only implemented on the CPU.
+const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+// Inputs and weights are drawn from [-1, 1]. The int8 result differs from the float result by the quantization error,
+// which is far below this for the reduction dimensions used here.
+static const double c_quantizationTolerance = 0.1;
+
+// bfloat16 keeps 8 significant bits, i.e. each weight is off by at most 2^-9 relative; float16 is 8 times more precise.
+// With 45 products of magnitude below 1, the result is off by less than 45 * 2^-9.
+static const double c_halfPrecisionTolerance = 0.1;
+
+template <class ElemType>
+shared_ptr<DummyNodeTest<ElemType>> CreateInput(const SmallVector<size_t>& sampleDims, size_t numSamples, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    std::vector<ElemType> data(TensorShape(sampleDims).GetNumElements() * numSamples);
+    for (auto& x : data)
+        x = (ElemType)distribution(rng);
+    auto input = make_shared<DummyNodeTest<ElemType>>(c_deviceId, numSamples, sampleDims, data);
+    // one column per sample, as the nodes under test expect
+    input->Value().SetValue(data.size() / numSamples, numSamples, c_deviceId, data.data());
+    return input;
+}
+
+template <class ElemType>
+shared_ptr<LearnableParameter<ElemType>> CreateWeights(const TensorShape& shape, std::mt19937& rng, std::vector<ElemType>& values)
+{
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    values.resize(shape.GetNumElements());
+    for (auto& w : values)
+        w = (ElemType)distribution(rng);
+    auto weights = make_shared<LearnableParameter<ElemType>>(c_deviceId, L"W", shape);
+    weights->Value().SetValue(weights->Value().GetNumRows(), weights->Value().GetNumCols(), c_deviceId, values.data());
+    return weights;
+}
+
+// validate the node, allocate its value and temporary matrices, and evaluate it for the whole minibatch
+template <class ElemType>
+void ForwardPropNode(ComputationNode<ElemType>& node)
+{
+    MatrixPool matrixPool;
+    node.Validate(/*isFinalValidationPass=*/true);
+    node.RequestMatricesBeforeForwardProp(matrixPool);
+    node.BeginForwardProp();
+    node.ForwardProp(FrameRange(node.GetMBLayout()));
+}
+
+template <class ElemType>
+void CheckQuantizedValue(const Matrix<ElemType>& expected, const Matrix<ElemType>& actual, double tolerance = c_quantizationTolerance)
+{
+    BOOST_REQUIRE_EQUAL(actual.GetNumRows(), expected.GetNumRows());
+    BOOST_REQUIRE_EQUAL(actual.GetNumCols(), expected.GetNumCols());
+    unique_ptr<ElemType[]> expectedValues(expected.CopyToArray());
+    unique_ptr<ElemType[]> actualValues(actual.CopyToArray());
+    for (size_t i = 0; i < expected.GetNumElements(); i++)
+        BOOST_CHECK_SMALL((double)actualValues[i] - (double)expectedValues[i], tolerance);
+}
+
+template <class ElemType>
+void QuantizedTimesNodeTestImpl()
+{
+    const size_t outputDim = 7, inputDim = 45, numSamples = 5;
+    std::mt19937 rng(42);
+
+    std::vector<ElemType> weightValues;
+    auto weights = CreateWeights<ElemType>(TensorShape(outputDim, inputDim), rng, weightValues);
+    auto input = CreateInput<ElemType>({ inputDim }, numSamples, rng);
+
+    auto timesNode = make_shared<TimesNode<ElemType>>(c_deviceId, L"Times");
+    timesNode->AttachInputs({ weights, input });
+    ForwardPropNode(*timesNode);
+
+    // the weights are a column-major [output x input] matrix, quantized as by QuantizeModel
+    auto quantizedNode = make_shared<QuantizedTimesNode<ElemType>>(c_deviceId, L"QuantizedTimes", ComputationNodeBasePtr(timesNode)->GetSampleLayout());
+    quantizedNode->SetWeights(make_shared<Int8Weights>(weightValues.data(), outputDim, inputDim, 1, outputDim, -1.0f, 1.0f));
+    quantizedNode->AttachInputs({ input });
+    ForwardPropNode(*quantizedNode);
+
+    CheckQuantizedValue(timesNode->Value(), quantizedNode->Value());
+
+    // sparse inputs are not supported
+    input->Value().SwitchToMatrixType(MatrixType::SPARSE, MatrixFormat::matrixFormatSparseCSC, /*keepValues=*/true);
+    BOOST_REQUIRE_THROW(ForwardPropNode(*quantizedNode), std::invalid_argument);
+}
+
+template <class ElemType>
+void QuantizedConvolutionNodeTestImpl()
+{
+    // 3 x 3 kernels over all 2 channels of a 6 x 5 image, with auto padding and a horizontal stride of 2
+    const size_t mapOutCount = 4, numSamples = 3;
+    const TensorShape kernelShape(3, 3, 2);
+    std::mt19937 rng(42);
+
+    std::vector<ElemType> weightValues;
+    auto weights = CreateWeights<ElemType>(TensorShape(3, 3, 2, mapOutCount), rng, weightValues);
+    auto input = CreateInput<ElemType>({ 6, 5, 2 }, numSamples, rng);
+
+    auto convNode = make_shared<ConvolutionNode<ElemType>>(c_deviceId, L"Convolution", kernelShape, TensorShape(mapOutCount), TensorShape(2, 1, 2),
+                                                           vector<bool>{ true }, vector<bool>{ true, true, false }, TensorShape(0), TensorShape(0),
+                                                           /*transpose=*/false, ImageLayoutKind::CHW, /*maxTempMemSizeInSamples=*/0);
+    convNode->AttachInputs({ weights, input });
+    ForwardPropNode(*convNode);
+
+    // kernels are stored one output channel after the other, quantized as by QuantizeModel
+    auto quantizedNode = make_shared<QuantizedConvolutionNode<ElemType>>(c_deviceId, L"QuantizedConvolution", kernelShape, TensorShape(mapOutCount), TensorShape(2, 1, 2),
+                                                                         vector<bool>{ true }, vector<bool>{ true, true, false }, TensorShape(0), TensorShape(0));
+    size_t kernelSize = kernelShape.GetNumElements();
+    quantizedNode->SetWeights(make_shared<Int8Weights>(weightValues.data(), mapOutCount, kernelSize, kernelSize, 1, -1.0f, 1.0f));
+    quantizedNode->AttachInputs({ input });
+    ForwardPropNode(*quantizedNode);
+
+    BOOST_REQUIRE(ComputationNodeBasePtr(quantizedNode)->GetSampleLayout() == ComputationNodeBasePtr(convNode)->GetSampleLayout());
+    CheckQuantizedValue(convNode->Value(), quantizedNode->Value());
+
+    // sparse inputs are not supported
+    input->Value().SwitchToMatrixType(MatrixType::SPARSE, MatrixFormat::matrixFormatSparseCSC, /*keepValues=*/true);
+    BOOST_REQUIRE_THROW(ForwardPropNode(*quantizedNode), std::invalid_argument);
+}
+
+template <class ElemType>
+void HalfPrecisionTimesNodeTestImpl(HalfPrecisionFormat format)
+{
+    const size_t outputDim = 7, inputDim = 45, numSamples = 5;
+    std::mt19937 rng(42);
+
+    std::vector<ElemType> weightValues;
+    auto weights = CreateWeights<ElemType>(TensorShape(outputDim, inputDim), rng, weightValues);
+    auto input = CreateInput<ElemType>({ inputDim }, numSamples, rng);
+
+    auto timesNode = make_shared<TimesNode<ElemType>>(c_deviceId, L"Times");
+    timesNode->AttachInputs({ weights, input });
+    ForwardPropNode(*timesNode);
+
+    // the weights are a column-major [output x input] matrix, converted as by ReduceParameterPrecision
+    auto halfNode = make_shared<HalfPrecisionTimesNode<ElemType>>(c_deviceId, L"HalfPrecisionTimes", ComputationNodeBasePtr(timesNode)->GetSampleLayout());
+    halfNode->SetWeights(make_shared<HalfPrecisionWeights>(weightValues.data(), outputDim, inputDim, format));
+    halfNode->AttachInputs({ input });
+    ForwardPropNode(*halfNode);
+
+    CheckQuantizedValue(timesNode->Value(), halfNode->Value(), c_halfPrecisionTolerance);
+
+    // sparse inputs are not supported
+    input->Value().SwitchToMatrixType(MatrixType::SPARSE, MatrixFormat::matrixFormatSparseCSC, /*keepValues=*/true);
+    BOOST_REQUIRE_THROW(ForwardPropNode(*halfNode), std::invalid_argument);
+}
+
+// features -> h = Times(W, features) + b -> out = Times(WOut, h)
+template <class ElemType>
+ComputationNetworkPtr CreateTimesNetwork(size_t inputDim)
+{
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<ElemType> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", TensorShape(inputDim));
+    auto w = builder.CreateLearnableParameter(L"W", TensorShape(9, inputDim));
+    auto b = builder.CreateLearnableParameter(L"b", TensorShape(9));
+    auto wOut = builder.CreateLearnableParameter(L"WOut", TensorShape(3, 9));
+
+    auto times = builder.Times(w, features, /*outputRank=*/1, L"times");
+    auto h = builder.Plus(times, b, L"h");
+    auto out = builder.Times(wOut, h, /*outputRank=*/1, L"out");
+    net->AddToNodeGroup(L"output", out);
+
+    // the same parameter values in every network created here
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    for (const auto& parameter : { w, b, wOut })
+    {
+        auto& value = parameter->Value();
+        std::vector<ElemType> values(value.GetNumElements());
+        for (auto& v : values)
+            v = (ElemType)distribution(rng);
+        value.SetValue(value.GetNumRows(), value.GetNumCols(), c_deviceId, values.data());
+    }
+
+    net->CompileNetwork();
+    return net;
+}
+
+template <class ElemType>
+const Matrix<ElemType>& EvaluateTimesNetwork(const ComputationNetworkPtr& net, std::vector<ElemType> features, size_t numSamples)
+{
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::inferring);
+    auto outputNodes = net->OutputNodesByName({ L"out" });
+    auto inputNodes = net->InputNodesForOutputs({ L"out" });
+    net->AllocateAllMatrices({}, outputNodes, nullptr);
+    net->StartEvaluateMinibatchLoop(outputNodes);
+
+    auto input = dynamic_pointer_cast<ComputationNode<ElemType>>(net->GetNodeFromName(L"features"));
+    ComputationNodeBasePtr(input)->GetMBLayout()->InitAsFrameMode(numSamples);
+    input->Value().SetValue(features.size() / numSamples, numSamples, c_deviceId, features.data());
+
+    ComputationNetwork::BumpEvalTimeStamp(inputNodes);
+    net->ForwardProp(outputNodes);
+    return dynamic_pointer_cast<ComputationNode<ElemType>>(outputNodes[0])->Value();
+}
+
+template <class ElemType>
+void ReduceParameterPrecisionTestImpl(HalfPrecisionFormat format)
+{
+    const size_t inputDim = 45, numSamples = 4;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    std::vector<ElemType> features(inputDim * numSamples);
+    for (auto& x : features)
+        x = (ElemType)distribution(rng);
+
+    auto fullNet = CreateTimesNetwork<ElemType>(inputDim);
+    const auto& expected = EvaluateTimesNetwork(fullNet, features, numSamples);
+
+    auto net = CreateTimesNetwork<ElemType>(inputDim);
+    size_t numNodes = net->GetTotalNumberOfNodes();
+    net->template ReduceParameterPrecision<ElemType>(format);
+
+    // both Times nodes are replaced under their names, and their weights are no longer needed; the bias stays
+    BOOST_CHECK(net->GetNodeFromName(L"times")->OperationName() == OperationNameOf(HalfPrecisionTimesNode));
+    BOOST_CHECK(net->GetNodeFromName(L"out")->OperationName() == OperationNameOf(HalfPrecisionTimesNode));
+    BOOST_CHECK(!net->NodeNameExists(L"W") && !net->NodeNameExists(L"WOut"));
+    BOOST_CHECK(net->GetNodeFromName(L"b")->OperationName() == OperationNameOf(LearnableParameter));
+    BOOST_CHECK_EQUAL(net->GetTotalNumberOfNodes(), numNodes - 2);
+    BOOST_CHECK_EQUAL(dynamic_pointer_cast<HalfPrecisionTimesNode<ElemType>>(net->GetNodeFromName(L"times"))->Weights().SizeInBytes(), 9 * inputDim * sizeof(uint16_t));
+
+    // out sums 9 products of a weight below 1 and an element of h, which is off by up to c_halfPrecisionTolerance and
+    // below inputDim + 1 in magnitude; the product is then off by up to c_halfPrecisionTolerance + (inputDim + 1) * 2^-9
+    const auto& actual = EvaluateTimesNetwork(net, features, numSamples);
+    CheckQuantizedValue(expected, actual, 9 * (c_halfPrecisionTolerance + (inputDim + 1) / 512.0));
+}
+
+BOOST_AUTO_TEST_SUITE(QuantizedNodesTestSuite)
+
+BOOST_AUTO_TEST_CASE(QuantizedTimesNodeMatchesTimesNode)
+{
+    QuantizedTimesNodeTestImpl<float>();
+    QuantizedTimesNodeTestImpl<double>();
+}
+
+BOOST_AUTO_TEST_CASE(QuantizedConvolutionNodeMatchesConvolutionNode)
+{
+    QuantizedConvolutionNodeTestImpl<float>();
+    QuantizedConvolutionNodeTestImpl<double>();
+}
+
+BOOST_AUTO_TEST_CASE(HalfPrecisionTimesNodeMatchesTimesNode)
+{
+    HalfPrecisionTimesNodeTestImpl<float>(HalfPrecisionFormat::Float16);
+    HalfPrecisionTimesNodeTestImpl<float>(HalfPrecisionFormat::BFloat16);
+    HalfPrecisionTimesNodeTestImpl<double>(HalfPrecisionFormat::Float16);
+    HalfPrecisionTimesNodeTestImpl<double>(HalfPrecisionFormat::BFloat16);
+}
+
+BOOST_AUTO_TEST_CASE(ReduceParameterPrecisionTest)
+{
+    ReduceParameterPrecisionTestImpl<float>(HalfPrecisionFormat::Float16);
+    ReduceParameterPrecisionTestImpl<float>(HalfPrecisionFormat::BFloat16);
+    ReduceParameterPrecisionTestImpl<double>(HalfPrecisionFormat::Float16);
+    ReduceParameterPrecisionTestImpl<double>(HalfPrecisionFormat::BFloat16);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} } } }
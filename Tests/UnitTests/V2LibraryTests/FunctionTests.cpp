@@ -4,6 +4,7 @@
 //
 #include "CNTKLibrary.h"
 #include "Common.h"
+#include <thread>
 
 using namespace CNTK;
 
@@ -458,6 +459,216 @@ void TestRecurrenceShapeInference()
     testShapeInferenceInRecurrence(2, 2);
 }
 
+void TestPackedSequences(const DeviceDescriptor& device)
+{
+    srand(1);
+
+    size_t numSequences = 9;
+    size_t maxAllowedSequenceLength = 13;
+    NDShape inputShape = { 3, 2 };
+    size_t vocabularySize = 7;
+    size_t outputDim = 4;
+
+    auto sequenceLengths = GenerateSequenceLengths(numSequences, maxAllowedSequenceLength);
+    auto sequences = GenerateSequences<float>(sequenceLengths, inputShape);
+    auto oneHotSequences = GenerateOneHotSequences(sequenceLengths, vocabularySize);
+
+    auto copyToCPU = [](const NDArrayViewPtr& view) {
+        std::vector<float> data(view->Shape().TotalSize());
+        NDArrayView cpuView(view->Shape(), data, /*readOnly =*/ false);
+        cpuView.CopyFrom(*view);
+        return data;
+    };
+
+    // The views of a packed Value are the specified sequences themselves
+    auto packedValue = Value::CreatePacked(inputShape, sequences, device, true);
+    auto inputSequenceViews = packedValue->SequenceViews(inputShape);
+    if (inputSequenceViews.size() != numSequences)
+        throw std::runtime_error("TestPackedSequences: The number of sequence views of the packed Value does not match the number of sequences");
+
+    for (size_t i = 0; i < numSequences; ++i)
+    {
+        if (inputSequenceViews[i]->Shape() != inputShape.AppendShape({ sequenceLengths[i] }))
+            throw std::runtime_error("TestPackedSequences: The shape of a sequence view of the packed Value is incorrect");
+
+        FloatingPointVectorCompare(copyToCPU(inputSequenceViews[i]), sequences[i], "TestPackedSequences: A sequence view of the packed Value does not match the sequence");
+    }
+
+    // A recurrent Function must produce the same results for the padded and the packed form of the same sequences
+    auto inputVar = InputVariable(inputShape, DataType::Float, L"input");
+    auto oneHotInputVar = InputVariable({ vocabularySize }, true, DataType::Float, L"oneHotInput");
+    Parameter timesParam(NDArrayView::RandomUniform<float>({ outputDim, inputShape.TotalSize() }, -1.0, 1.0, 1, device), L"timesParameters");
+    Parameter oneHotTimesParam(NDArrayView::RandomUniform<float>({ outputDim, vocabularySize }, -1.0, 1.0, 2, device), L"oneHotTimesParameters");
+
+    auto projection = Plus(Times(timesParam, Reshape(inputVar, { inputShape.TotalSize() })), Times(oneHotTimesParam, oneHotInputVar));
+    auto func = Plus(projection, PastValue(projection), L"output");
+
+    auto evaluate = [&](const ValuePtr& inputValue, const ValuePtr& oneHotInputValue) {
+        std::unordered_map<Variable, ValuePtr> outputs = { { func->Output(), nullptr } };
+        func->Forward({ { inputVar, inputValue }, { oneHotInputVar, oneHotInputValue } }, outputs, device);
+        auto outputSequenceViews = outputs[func->Output()]->SequenceViews(func->Output().Shape());
+
+        std::vector<std::vector<float>> outputSequences;
+        for (auto& outputSequenceView : outputSequenceViews)
+            outputSequences.push_back(copyToCPU(outputSequenceView));
+
+        return outputSequences;
+    };
+
+    auto paddedOutputSequences = evaluate(Value::Create(inputShape, sequences, device, true), Value::Create<float>(vocabularySize, oneHotSequences, device, true));
+    auto packedOutputSequences = evaluate(packedValue, Value::CreatePacked<float>(vocabularySize, oneHotSequences, device, true));
+    if ((paddedOutputSequences.size() != numSequences) || (packedOutputSequences.size() != numSequences))
+        throw std::runtime_error("TestPackedSequences: The number of output sequence views does not match the number of sequences");
+
+    for (size_t i = 0; i < numSequences; ++i)
+    {
+        if ((paddedOutputSequences[i].size() != (outputDim * sequenceLengths[i])) || (packedOutputSequences[i].size() != (outputDim * sequenceLengths[i])))
+            throw std::runtime_error("TestPackedSequences: The size of an output sequence view does not match the length of the sequence");
+
+        FloatingPointVectorCompare(packedOutputSequences[i], paddedOutputSequences[i], "TestPackedSequences: The outputs for the packed sequences do not match the outputs for the padded sequences");
+    }
+}
+
+// Evaluates a Function with a single argument and returns its output sequences
+std::vector<std::vector<float>> EvaluateSharedNetworkClone(const FunctionPtr& function, const ValuePtr& inputValue, const DeviceDescriptor& device)
+{
+    auto functionInputs = function->Arguments();
+    if (functionInputs.size() != 1)
+        throw std::runtime_error("TestSharedNetworkClones: The clone does not have exactly one argument");
+
+    std::unordered_map<Variable, ValuePtr> outputs = { { function->Output(), nullptr } };
+    function->Forward({ { functionInputs[0], inputValue } }, outputs, device);
+
+    std::vector<std::vector<float>> outputSequences;
+    for (auto& outputSequenceView : outputs[function->Output()]->SequenceViews(function->Output().Shape()))
+    {
+        std::vector<float> outputSequence(outputSequenceView->Shape().TotalSize());
+        NDArrayView cpuView(outputSequenceView->Shape(), outputSequence, /*readOnly =*/ false);
+        cpuView.CopyFrom(*outputSequenceView);
+        outputSequences.push_back(std::move(outputSequence));
+    }
+
+    return outputSequences;
+}
+
+void CompareSharedNetworkCloneOutputs(const std::vector<std::vector<float>>& outputSequences, const std::vector<std::vector<float>>& expectedOutputSequences, const char* message)
+{
+    if (outputSequences.size() != expectedOutputSequences.size())
+        throw std::runtime_error("TestSharedNetworkClones: The number of output sequences of the clone does not match the number of sequences");
+
+    for (size_t i = 0; i < outputSequences.size(); ++i)
+        FloatingPointVectorCompare(outputSequences[i], expectedOutputSequences[i], message);
+}
+
+void TestSharedNetworkClones(const DeviceDescriptor& device)
+{
+    srand(1);
+
+    size_t numSequences = 5;
+    size_t maxAllowedSequenceLength = 11;
+    size_t inputDim = 6;
+    size_t outputDim = 3;
+
+    auto sequenceLengths = GenerateSequenceLengths(numSequences, maxAllowedSequenceLength);
+    auto sequences = GenerateSequences<float>(sequenceLengths, { inputDim });
+    auto inputValue = Value::Create({ inputDim }, sequences, device, true);
+
+    auto inputVar = InputVariable({ inputDim }, DataType::Float, L"input");
+    Parameter timesParam(NDArrayView::RandomUniform<float>({ outputDim, inputDim }, -1.0, 1.0, 1, device), L"timesParameters");
+    Parameter plusParam(NDArrayView::RandomUniform<float>({ outputDim }, -1.0, 1.0, 2, device), L"plusParameters");
+
+    auto projection = Plus(Times(timesParam, inputVar), plusParam);
+    auto func = Plus(projection, PastValue(projection), L"output");
+
+    auto expectedOutputSequences = EvaluateSharedNetworkClone(func, inputValue, device);
+
+    // Clones sharing the parameters, including a clone of such a clone, all copy the network compiled for the original graph
+    auto firstClone = func->Clone(ParameterCloningMethod::Share);
+    auto secondClone = func->Clone(ParameterCloningMethod::Share);
+    auto cloneOfClone = firstClone->Clone(ParameterCloningMethod::Share);
+    for (auto& clone : { firstClone, secondClone, cloneOfClone, firstClone })
+        CompareSharedNetworkCloneOutputs(EvaluateSharedNetworkClone(clone, inputValue, device), expectedOutputSequences, "TestSharedNetworkClones: The output of a clone sharing the parameters does not match the output of the original Function");
+
+    // The clone of the clone shares the compiled networks of its clonee, and all clones hold the same parameter value matrices
+    if (!Internal::AreSharingComputationNetworks(firstClone, cloneOfClone))
+        throw std::runtime_error("TestSharedNetworkClones: The clone of a clone does not share the compiled networks of its clonee");
+
+    for (auto& clone : { secondClone, cloneOfClone })
+    {
+        if (!Internal::AreSharingParameterValues(firstClone, clone))
+            throw std::runtime_error("TestSharedNetworkClones: The clones do not share the values of their parameters");
+    }
+
+    // The clones compute with the values of the shared parameters
+    plusParam.Value()->CopyFrom(*NDArrayView::RandomUniform<float>({ outputDim }, -1.0, 1.0, 3, device));
+    plusParam.RecordValueUpdate();
+    expectedOutputSequences = EvaluateSharedNetworkClone(func, inputValue, device);
+    CompareSharedNetworkCloneOutputs(EvaluateSharedNetworkClone(cloneOfClone, inputValue, device), expectedOutputSequences, "TestSharedNetworkClones: The output of a clone after updating the shared parameters does not match the output of the original Function");
+}
+
+void TestSharedNetworkClonesMultiThreaded(const DeviceDescriptor& device)
+{
+    srand(1);
+
+    const size_t numThreads = 4;
+    const size_t numEvaluationsPerThread = 5;
+    size_t numSequences = 5;
+    size_t maxAllowedSequenceLength = 11;
+    size_t inputDim = 6;
+    size_t outputDim = 3;
+
+    auto sequenceLengths = GenerateSequenceLengths(numSequences, maxAllowedSequenceLength);
+    auto sequences = GenerateSequences<float>(sequenceLengths, { inputDim });
+
+    auto inputVar = InputVariable({ inputDim }, DataType::Float, L"input");
+    Parameter timesParam(NDArrayView::RandomUniform<float>({ outputDim, inputDim }, -1.0, 1.0, 1, device), L"timesParameters");
+    Parameter plusParam(NDArrayView::RandomUniform<float>({ outputDim }, -1.0, 1.0, 2, device), L"plusParameters");
+
+    auto projection = Plus(Times(timesParam, inputVar), plusParam);
+    auto func = Plus(projection, PastValue(projection), L"output");
+
+    auto expectedOutputSequences = EvaluateSharedNetworkClone(func, Value::Create({ inputDim }, sequences, device, true), device);
+
+    // One clone per thread; none of them has been evaluated, so the threads also race to compile the shared network
+    auto sharedClone = func->Clone(ParameterCloningMethod::Share);
+    std::vector<FunctionPtr> clones;
+    for (size_t i = 0; i < numThreads; ++i)
+        clones.push_back(sharedClone->Clone(ParameterCloningMethod::Share));
+
+    std::vector<std::exception_ptr> errors(numThreads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        threads.push_back(std::thread([&, i]() {
+            try
+            {
+                auto inputValue = Value::Create({ inputDim }, sequences, device, true);
+                for (size_t j = 0; j < numEvaluationsPerThread; ++j)
+                    CompareSharedNetworkCloneOutputs(EvaluateSharedNetworkClone(clones[i], inputValue, device), expectedOutputSequences, "TestSharedNetworkClonesMultiThreaded: The output of a clone evaluated concurrently does not match the output of the original Function");
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }));
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    for (size_t i = 1; i < numThreads; ++i)
+    {
+        if (!Internal::AreSharingComputationNetworks(clones[0], clones[i]) || !Internal::AreSharingParameterValues(clones[0], clones[i]))
+            throw std::runtime_error("TestSharedNetworkClonesMultiThreaded: The clones evaluated concurrently do not share the compiled network and the parameter values");
+    }
+}
+
 void FunctionTests()
 {
     fprintf(stderr, "\nFunctionTests..\n");
@@ -484,4 +695,18 @@ void FunctionTests()
     {
         TestTranspose(3, 1, 2, DeviceDescriptor::GPUDevice(0));
     }
+
+    TestPackedSequences(DeviceDescriptor::CPUDevice());
+    if (IsGPUAvailable())
+    {
+        TestPackedSequences(DeviceDescriptor::GPUDevice(0));
+    }
+
+    TestSharedNetworkClones(DeviceDescriptor::CPUDevice());
+    TestSharedNetworkClonesMultiThreaded(DeviceDescriptor::CPUDevice());
+    if (IsGPUAvailable())
+    {
+        TestSharedNetworkClones(DeviceDescriptor::GPUDevice(0));
+        TestSharedNetworkClonesMultiThreaded(DeviceDescriptor::GPUDevice(0));
+    }
 }
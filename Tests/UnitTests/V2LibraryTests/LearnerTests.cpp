@@ -104,6 +104,64 @@ void TestRMSPropLearner(size_t numParameters, size_t numMinibatches, const Devic
     TestUpdate<ElementType>(learner, shape, numMinibatches, device);
 }
 
+// With AdditionalLearningOptions::fuseParameterUpdates, the learners update the parameters on the CPU in one pass
+// over all of them; the result has to match that of the per-parameter update.
+template <typename ElementType>
+void TestFusedUpdates(size_t numParameters, size_t numMinibatches)
+{
+    const auto device = DeviceDescriptor::CPUDevice();
+    NDShape shape = CreateShape(rng() % maxNumAxes + 1, maxDimSize);
+
+    AdditionalLearningOptions options;
+    options.l1RegularizationWeight = 0.001;
+    options.l2RegularizationWeight = 0.01;
+    options.gradientClippingThresholdPerSample = 0.8;
+    AdditionalLearningOptions fusedOptions = options;
+    fusedOptions.fuseParameterUpdates = true;
+
+    typedef function<LearnerPtr(const vector<Parameter>&, AdditionalLearningOptions)> LearnerFactory;
+    vector<LearnerFactory> learnerFactories = {
+        [](const vector<Parameter>& parameters, AdditionalLearningOptions options) { return SGDLearner(parameters, LearningRatePerSampleSchedule(0.4), options); },
+        [](const vector<Parameter>& parameters, AdditionalLearningOptions options) { return MomentumSGDLearner(parameters, LearningRatePerSampleSchedule(0.4), MomentumPerMinibatchSchedule(0.9), options); },
+        [](const vector<Parameter>& parameters, AdditionalLearningOptions options) { return NesterovLearner(parameters, LearningRatePerSampleSchedule(0.4), MomentumPerMinibatchSchedule(0.9), options); },
+        [](const vector<Parameter>& parameters, AdditionalLearningOptions options) { return AdaGradLearner(parameters, LearningRatePerSampleSchedule(0.1), true, options); },
+        [](const vector<Parameter>& parameters, AdditionalLearningOptions options) { return AdamLearner(parameters, LearningRatePerSampleSchedule(0.1), MomentumAsTimeConstantSchedule(10), MomentumAsTimeConstantSchedule(100), true, options); },
+        [](const vector<Parameter>& parameters, AdditionalLearningOptions options) { return RMSPropLearner(parameters, LearningRatePerSampleSchedule(0.1), 0.95, 1.2, 0.7, 10, 0.001, true, options); },
+    };
+
+    for (const auto& createLearner : learnerFactories)
+    {
+        auto parameters = CreateParameters<ElementType>(shape, numParameters, device);
+        auto fusedParameters = CreateParameters<ElementType>(shape, numParameters, device);
+        auto learner = createLearner(parameters, options);
+        auto fusedLearner = createLearner(fusedParameters, fusedOptions);
+
+        auto seed = (unsigned long) rng();
+        for (size_t i = 0; i < numMinibatches; i++)
+        {
+            unordered_map<Parameter, NDArrayViewPtr> gradientValues, fusedGradientValues;
+            for (size_t j = 0; j < numParameters; j++)
+            {
+                gradientValues[parameters[j]] = NDArrayView::RandomUniform<ElementType>(shape, -1.0, 1.0, seed + i * numParameters + j, device);
+                fusedGradientValues[fusedParameters[j]] = NDArrayView::RandomUniform<ElementType>(shape, -1.0, 1.0, seed + i * numParameters + j, device);
+            }
+            learner->Update(gradientValues, 2);
+            fusedLearner->Update(fusedGradientValues, 2);
+        }
+
+        for (size_t j = 0; j < numParameters; j++)
+        {
+            const ElementType* expected = parameters[j].Value()->template DataBuffer<ElementType>();
+            const ElementType* actual = fusedParameters[j].Value()->template DataBuffer<ElementType>();
+            FloatingPointVectorCompare(vector<ElementType>(actual, actual + shape.TotalSize()), vector<ElementType>(expected, expected + shape.TotalSize()),
+                                       "Fused learner update does not match the per-parameter update");
+        }
+
+        // the learner state now lives in one buffer, the checkpoint must still hold one value per parameter
+        fusedLearner->RestoreFromCheckpoint(fusedLearner->Serialize());
+    }
+}
+
 void TestTrainingParametersSchedule()
 {
     VerifyException([]() {
@@ -252,4 +310,7 @@ void LearnerTests()
     
     TestFSAdaGradLearner<double>(10, 2, DeviceDescriptor::CPUDevice());
     TestRMSPropLearner<float>(3, 3, DeviceDescriptor::CPUDevice());
+
+    TestFusedUpdates<float>(5, 4);
+    TestFusedUpdates<double>(3, 4);
 }
\ No newline at end of file
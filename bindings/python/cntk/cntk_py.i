@@ -47,6 +47,7 @@
 %template() std::vector<CNTK::StreamConfiguration>;
 %template() std::vector<std::shared_ptr<CNTK::Function>>;
 %template() std::vector<std::shared_ptr<CNTK::Learner>>;
+%template() std::vector<std::shared_ptr<CNTK::NDArrayView>>;
 %template() std::pair<size_t, double>;
 %template() std::vector<std::pair<size_t, double>>;
 
@@ -1007,6 +1008,26 @@ public:
         const CNTK::DeviceDescriptor& device, bool readOnly = false) {
         return CNTK::Value::Create<double>(vocabularySize, oneHotSequences, device, readOnly);
     }
+
+    static CNTK::ValuePtr CNTK::Value::CreatePackedDenseFloat(const CNTK::NDShape& sampleShape, const std::vector<std::vector<float>>& sequences, 
+        const CNTK::DeviceDescriptor& device, bool readOnly = false) {
+        return CNTK::Value::CreatePacked<float>(sampleShape, sequences, device, readOnly);
+    }
+
+    static CNTK::ValuePtr CNTK::Value::CreatePackedDenseDouble(const CNTK::NDShape& sampleShape, const std::vector<std::vector<double>>& sequences, 
+        const CNTK::DeviceDescriptor& device, bool readOnly = false) {
+        return CNTK::Value::CreatePacked<double>(sampleShape, sequences, device, readOnly);
+    }
+
+    static CNTK::ValuePtr CNTK::Value::CreatePackedOneHotFloat(size_t vocabularySize, const std::vector<std::vector<size_t>>& oneHotSequences, 
+        const CNTK::DeviceDescriptor& device, bool readOnly = false) {
+        return CNTK::Value::CreatePacked<float>(vocabularySize, oneHotSequences, device, readOnly);
+    }
+
+    static CNTK::ValuePtr CNTK::Value::CreatePackedOneHotDouble(size_t vocabularySize, const std::vector<std::vector<size_t>>& oneHotSequences, 
+        const CNTK::DeviceDescriptor& device, bool readOnly = false) {
+        return CNTK::Value::CreatePacked<double>(vocabularySize, oneHotSequences, device, readOnly);
+    }
 }
 
 //